@@ -16,7 +16,12 @@ Examples
 
 import numpy as np
 
-from cygraph.graph_ import Graph, DynamicGraph, StaticGraph
+from cygraph.graph_ import Graph, DynamicGraph, GraphBatch, GraphBuilder, \
+    IntGraph, StaticGraph, StreamingGraph, TemporalGraph, UnitWeight, WeightFunction, \
+    build_csr, from_arrow, load_graph
+from cygraph import tracing
+from cygraph.parallel import get_num_threads, is_deterministic, \
+    parallel_config, set_deterministic, set_num_threads
 
 
 __version__ = '0.2.1'
@@ -2,6 +2,15 @@
 #cython: language_level=3
 
 from cygraph.algorithms.articulation_points cimport *
+from cygraph.algorithms.batch cimport *
 from cygraph.algorithms.components cimport *
+from cygraph.algorithms.gas cimport *
+from cygraph.algorithms.labeling cimport *
+from cygraph.algorithms.neighborhood cimport *
 from cygraph.algorithms.partitioning cimport *
-from cygraph.algorithms.shortest_path cimport *
\ No newline at end of file
+from cygraph.algorithms.pregel cimport *
+from cygraph.algorithms.shortest_path cimport *
+from cygraph.algorithms.spectral cimport *
+from cygraph.algorithms.stats cimport *
+from cygraph.algorithms.tasks cimport *
+from cygraph.algorithms.temporal cimport *
\ No newline at end of file
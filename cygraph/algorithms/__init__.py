@@ -4,9 +4,27 @@
 """
 
 from cygraph.algorithms.articulation_points import py_get_articulation_points as get_articulation_points
+from cygraph.algorithms.batch import py_batch_connected_components as batch_connected_components
+from cygraph.algorithms.batch import py_batch_degree_stats as batch_degree_stats
+from cygraph.algorithms.batch import py_batch_shortest_path_lengths as batch_shortest_path_lengths
+from cygraph.algorithms.batch import py_batch_wl_hash as batch_wl_hash
 from cygraph.algorithms.components import py_get_connected_components as get_connected_components
 from cygraph.algorithms.components import py_get_number_connected_components as get_number_connected_components
 from cygraph.algorithms.components import py_get_strongly_connected_components as get_strongly_connected_components
 from cygraph.algorithms.components import py_get_number_strongly_connected_components as get_number_strongly_connected_components
+from cygraph.algorithms.gas import DiffusionProgram, GASProgram
+from cygraph.algorithms.gas import py_run_gas as run_gas
+from cygraph.algorithms.labeling import LandmarkIndex
+from cygraph.algorithms.neighborhood import MinHashIndex
+from cygraph.algorithms.neighborhood import py_khop_neighbors as khop_neighbors
+from cygraph.algorithms.neighborhood import py_neighborhood_function as neighborhood_function
+from cygraph.algorithms.neighborhood import py_neighborhood_sketches as neighborhood_sketches
+from cygraph.algorithms.partitioning import py_min_cut_karger_stein as min_cut_karger_stein
 from cygraph.algorithms.partitioning import py_partition_karger as partition_karger
-from cygraph.algorithms.shortest_path import py_get_shortest_path_dijkstra as get_shortest_path_dijkstra
\ No newline at end of file
+from cygraph.algorithms.pregel import PageRankProgram, ShortestPathProgram, VertexProgram
+from cygraph.algorithms.pregel import py_run_vertex_program as run_vertex_program
+from cygraph.algorithms.shortest_path import py_get_shortest_path_dijkstra as get_shortest_path_dijkstra
+from cygraph.algorithms.stats import ExecutionStats
+from cygraph.algorithms.spectral import py_spectral_embedding as spectral_embedding
+from cygraph.algorithms.temporal import py_get_earliest_arrival_times as get_earliest_arrival_times
+from cygraph.algorithms.temporal import py_is_temporally_reachable as is_temporally_reachable
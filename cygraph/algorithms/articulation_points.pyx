@@ -4,6 +4,7 @@
 """
 
 from cygraph.graph_ cimport Graph, StaticGraph, DynamicGraph
+from cygraph.tracing import span
 
 
 cdef set get_articulation_points(Graph graph):
@@ -43,13 +44,13 @@ cdef set get_articulation_points(Graph graph):
     
     cdef set visited = set()
     cdef set articulation_points = set()
-    cdef int n_articulation_points = 0
+    cdef Py_ssize_t n_articulation_points = 0
 
     # Local loop variables.
     cdef object start, grandparent, parent, child
     cdef set children
     cdef dict discovery_times, lowpoints
-    cdef int root_children
+    cdef Py_ssize_t root_children
     cdef list stack
     for start in graph.vertices:
         # Each iteration that is not skipped is checking a new component.
@@ -121,4 +122,5 @@ def py_get_articulation_points(graph):
     >>> alg.get_articulation_points(G)
     {1, 2}
     """
-    return get_articulation_points(graph)
\ No newline at end of file
+    with span("get_articulation_points", "algorithm"):
+        return get_articulation_points(graph)
\ No newline at end of file
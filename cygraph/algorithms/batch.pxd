@@ -0,0 +1,16 @@
+#!python
+#cython: language_level=3
+
+cimport numpy as np
+
+from cygraph.algorithms.stats cimport ExecutionStats
+from cygraph.graph_.batch cimport GraphBatch
+
+
+cdef tuple batch_connected_components(GraphBatch batch,
+    ExecutionStats stats=*)
+cdef np.ndarray batch_shortest_path_lengths(GraphBatch batch, object sources,
+    ExecutionStats stats=*)
+cdef np.ndarray batch_wl_hash(GraphBatch batch, int iterations=*,
+    ExecutionStats stats=*)
+cdef tuple batch_degree_stats(GraphBatch batch, ExecutionStats stats=*)
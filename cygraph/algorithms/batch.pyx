@@ -0,0 +1,522 @@
+#!python
+#cython: language_level=3
+"""Algorithms that run over every graph of a cygraph.GraphBatch in one
+parallel call.
+"""
+
+from libc.math cimport INFINITY
+from libc.stdint cimport int64_t, uint64_t
+
+cimport numpy as np
+import numpy as np
+from time import perf_counter
+
+from cygraph.algorithms.neighborhood cimport splitmix64
+from cygraph.algorithms.shortest_path cimport _dijkstra
+from cygraph.algorithms.stats cimport Counters, ExecutionStats, STATS_ENABLED
+from cygraph.graph_.batch cimport GraphBatch
+from cygraph.graph_.streaming_graph cimport _find, _union
+from cygraph.parallel import map_blocks
+from cygraph.tracing import span
+
+
+# Number of graphs processed by a single task.
+cdef Py_ssize_t GRAPHS_PER_BLOCK = 1024
+
+
+cdef void _components_block(const int64_t[::1] indptr,
+        const int64_t[::1] indices, const int64_t[::1] offsets,
+        np.int64_t[::1] parents, np.int64_t[::1] sizes, int64_t[::1] labels,
+        int64_t[::1] counts, Py_ssize_t start, Py_ssize_t stop,
+        Counters *counters) noexcept nogil:
+    """Labels the (weakly) connected components of graphs [start, stop)
+    with a union-find forest over their vertices, numbering them within
+    each graph in the order of their first vertex.
+    """
+    cdef Py_ssize_t g, j
+    cdef int64_t u, root, n_components
+    for g in range(start, stop):
+        for u in range(offsets[g], offsets[g + 1]):
+            parents[u] = u
+            sizes[u] = 1
+            labels[u] = -1
+        for u in range(offsets[g], offsets[g + 1]):
+            for j in range(indptr[u], indptr[u + 1]):
+                _union(parents, sizes, u, indices[j])
+        n_components = 0
+        for u in range(offsets[g], offsets[g + 1]):
+            root = _find(parents, u)
+            if labels[root] == -1:
+                labels[root] = n_components
+                n_components += 1
+            labels[u] = labels[root]
+        counts[g] = n_components
+        if STATS_ENABLED:
+            counters.vertices_settled += offsets[g + 1] - offsets[g]
+            counters.edges_relaxed += (indptr[offsets[g + 1]]
+                                       - indptr[offsets[g]])
+
+
+cdef tuple batch_connected_components(GraphBatch batch,
+        ExecutionStats stats=None):
+    """Finds the connected components of every graph of a batch, or the
+    weakly connected components if the graphs are directed.
+
+    Parameters
+    ----------
+    batch: cygraph.GraphBatch
+        A batch of graphs.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the labeling.
+
+    Returns
+    -------
+    tuple
+        An array holding the number of components of each graph, and an
+        array holding the component of each vertex of the batch,
+        numbered from 0 within its graph in the order of the components'
+        first vertices.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("batch_connected_components")
+    cdef double start = perf_counter()
+    cdef np.ndarray indptr, indices, weights, offsets
+    indptr, indices, weights, offsets = batch._get_csr()
+    cdef Py_ssize_t n_vertices = offsets[-1]
+    cdef np.ndarray parents = np.empty(n_vertices, dtype=np.int64)
+    cdef np.ndarray sizes = np.empty(n_vertices, dtype=np.int64)
+    cdef np.ndarray labels = np.empty(n_vertices, dtype=np.int64)
+    cdef np.ndarray counts = np.empty(batch.number_of_graphs, dtype=np.int64)
+    stats.allocate(parents.nbytes + sizes.nbytes)
+    stats.add_phase("setup", start)
+
+    def label_block(b):
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] indices_view = indices
+        cdef const int64_t[::1] offsets_view = offsets
+        cdef np.int64_t[::1] parents_view = parents
+        cdef np.int64_t[::1] sizes_view = sizes
+        cdef int64_t[::1] labels_view = labels
+        cdef int64_t[::1] counts_view = counts
+        cdef Py_ssize_t start = b * GRAPHS_PER_BLOCK
+        cdef Py_ssize_t stop = min(start + GRAPHS_PER_BLOCK, len(counts))
+        cdef Counters counters = Counters(0, 0, 0, 0)
+        with nogil:
+            _components_block(indptr_view, indices_view, offsets_view,
+                              parents_view, sizes_view, labels_view,
+                              counts_view, start, stop, &counters)
+        return counters
+
+    start = perf_counter()
+    for counters in map_blocks(label_block,
+            (batch.number_of_graphs + GRAPHS_PER_BLOCK - 1)
+            // GRAPHS_PER_BLOCK):
+        stats.add_counters(counters)
+    stats.add_phase("label", start)
+    return counts, labels
+
+
+cdef void _shortest_paths_block(const int64_t[::1] indptr,
+        const int64_t[::1] indices, const double[::1] weights,
+        const int64_t[::1] offsets, const int64_t[::1] sources,
+        double[::1] distances, int64_t[::1] previous, double[::1] heap_keys,
+        int64_t[::1] heap_values, Py_ssize_t start, Py_ssize_t stop,
+        Counters *counters) noexcept nogil:
+    """Runs Dijkstra's algorithm from the source of each of graphs
+    [start, stop), each with its own part of the heap arrays.
+    """
+    cdef Py_ssize_t g, heap_start, heap_stop
+    for g in range(start, stop):
+        if offsets[g] == offsets[g + 1]:
+            continue
+        heap_start = indptr[offsets[g]] + g
+        heap_stop = indptr[offsets[g + 1]] + g + 1
+        _dijkstra(indptr, indices, weights, offsets[g] + sources[g], -1,
+                  distances, previous, heap_keys[heap_start:heap_stop],
+                  heap_values[heap_start:heap_stop], counters)
+
+
+cdef np.ndarray batch_shortest_path_lengths(GraphBatch batch,
+        object sources, ExecutionStats stats=None):
+    """Finds the length of the shortest path from a source vertex of
+    each graph of a batch to every vertex of that graph, with Dijkstra's
+    algorithm.
+
+    Parameters
+    ----------
+    batch: cygraph.GraphBatch
+        A batch of graphs with non-negative edge weights.
+    sources: array-like of int
+        The source vertex of each graph, numbered within the graph.
+        Ignored for graphs without vertices.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the searches.
+
+    Returns
+    -------
+    np.ndarray
+        The length of the shortest path to each vertex of the batch from
+        the source of its graph, or np.inf if there is none.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("batch_shortest_path_lengths")
+    cdef double start = perf_counter()
+    cdef np.ndarray indptr, indices, weights, offsets
+    indptr, indices, weights, offsets = batch._get_csr()
+    cdef np.ndarray source_array = np.ascontiguousarray(sources,
+                                                        dtype=np.int64)
+    cdef np.ndarray vertex_counts = np.diff(offsets)
+    if len(source_array) != batch.number_of_graphs:
+        raise ValueError(f"Got {len(source_array)} sources for "
+                         f"{batch.number_of_graphs} graphs.")
+    if ((vertex_counts > 0)
+            & ((source_array < 0) | (source_array >= vertex_counts))).any():
+        raise ValueError("Every source must be a vertex of its graph.")
+    if (weights < 0).any():
+        raise ValueError("Dijkstra's algorithm requires non-negative edge "
+                         "weights.")
+
+    cdef Py_ssize_t n_vertices = offsets[-1]
+    cdef np.ndarray distances = np.full(n_vertices, INFINITY)
+    cdef np.ndarray previous = np.full(n_vertices, -1, dtype=np.int64)
+    cdef Py_ssize_t heap_size = len(indices) + batch.number_of_graphs
+    cdef np.ndarray heap_keys = np.empty(heap_size)
+    cdef np.ndarray heap_values = np.empty(heap_size, dtype=np.int64)
+    stats.allocate(previous.nbytes + heap_keys.nbytes + heap_values.nbytes)
+    stats.add_phase("setup", start)
+
+    def search_block(b):
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] indices_view = indices
+        cdef const double[::1] weights_view = weights
+        cdef const int64_t[::1] offsets_view = offsets
+        cdef const int64_t[::1] sources_view = source_array
+        cdef double[::1] distances_view = distances
+        cdef int64_t[::1] previous_view = previous
+        cdef double[::1] heap_keys_view = heap_keys
+        cdef int64_t[::1] heap_values_view = heap_values
+        cdef Py_ssize_t start = b * GRAPHS_PER_BLOCK
+        cdef Py_ssize_t stop = min(start + GRAPHS_PER_BLOCK,
+                                   len(source_array))
+        cdef Counters counters = Counters(0, 0, 0, 0)
+        with nogil:
+            _shortest_paths_block(indptr_view, indices_view, weights_view,
+                                  offsets_view, sources_view, distances_view,
+                                  previous_view, heap_keys_view,
+                                  heap_values_view, start, stop, &counters)
+        return counters
+
+    start = perf_counter()
+    for counters in map_blocks(search_block,
+            (batch.number_of_graphs + GRAPHS_PER_BLOCK - 1)
+            // GRAPHS_PER_BLOCK):
+        stats.add_counters(counters)
+    stats.add_phase("search", start)
+    return distances
+
+
+cdef void _wl_hash_block(const int64_t[::1] indptr,
+        const int64_t[::1] indices, const int64_t[::1] offsets,
+        uint64_t[::1] labels, uint64_t[::1] new_labels, uint64_t[::1] hashes,
+        int iterations, Py_ssize_t start, Py_ssize_t stop,
+        Counters *counters) noexcept nogil:
+    """Computes the Weisfeiler-Lehman hashes of graphs [start, stop).
+    Each round relabels every vertex by its label and the multiset of
+    its children's labels, combined by summing their scrambled bits so
+    that their order does not matter, and folds the multiset of new
+    labels into the graph's hash.
+    """
+    cdef Py_ssize_t g, j
+    cdef int64_t u
+    cdef int i
+    cdef uint64_t h, total
+    for g in range(start, stop):
+        for u in range(offsets[g], offsets[g + 1]):
+            labels[u] = 0
+        h = splitmix64(<uint64_t>(offsets[g + 1] - offsets[g]))
+        for i in range(iterations):
+            for u in range(offsets[g], offsets[g + 1]):
+                total = 0
+                for j in range(indptr[u], indptr[u + 1]):
+                    total += splitmix64(labels[indices[j]])
+                new_labels[u] = splitmix64(labels[u]
+                                           ^ splitmix64(total + <uint64_t>i))
+            total = 0
+            for u in range(offsets[g], offsets[g + 1]):
+                labels[u] = new_labels[u]
+                total += splitmix64(labels[u])
+            h = splitmix64(h ^ total)
+        hashes[g] = h
+        if STATS_ENABLED:
+            counters.vertices_settled += (iterations
+                                          * (offsets[g + 1] - offsets[g]))
+            counters.edges_relaxed += iterations * (indptr[offsets[g + 1]]
+                                                    - indptr[offsets[g]])
+
+
+cdef np.ndarray batch_wl_hash(GraphBatch batch, int iterations=3,
+        ExecutionStats stats=None):
+    """Hashes every graph of a batch with the Weisfeiler-Lehman
+    subtree kernel, so that isomorphic graphs get the same hash and
+    other graphs almost always get different ones. Edge weights are
+    ignored; directed graphs are hashed through their outgoing edges.
+
+    Parameters
+    ----------
+    batch: cygraph.GraphBatch
+        A batch of graphs.
+    iterations: int, optional
+        The number of relabeling rounds, which is the radius of the
+        neighborhoods that the hash tells apart.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the hashing. Every round relabels
+        all vertices of the batch.
+
+    Returns
+    -------
+    np.ndarray
+        The np.uint64 hash of each graph.
+    """
+    if iterations < 0:
+        raise ValueError("The number of iterations cannot be negative.")
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("batch_wl_hash")
+    cdef double start = perf_counter()
+    cdef np.ndarray indptr, indices, weights, offsets
+    indptr, indices, weights, offsets = batch._get_csr()
+    cdef Py_ssize_t n_vertices = offsets[-1]
+    cdef np.ndarray labels = np.empty(n_vertices, dtype=np.uint64)
+    cdef np.ndarray new_labels = np.empty(n_vertices, dtype=np.uint64)
+    cdef np.ndarray hashes = np.empty(batch.number_of_graphs, dtype=np.uint64)
+    stats.allocate(labels.nbytes + new_labels.nbytes)
+    stats.add_phase("setup", start)
+
+    def hash_block(b):
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] indices_view = indices
+        cdef const int64_t[::1] offsets_view = offsets
+        cdef uint64_t[::1] labels_view = labels
+        cdef uint64_t[::1] new_labels_view = new_labels
+        cdef uint64_t[::1] hashes_view = hashes
+        cdef Py_ssize_t start = b * GRAPHS_PER_BLOCK
+        cdef Py_ssize_t stop = min(start + GRAPHS_PER_BLOCK, len(hashes))
+        cdef Counters counters = Counters(0, 0, 0, 0)
+        with nogil:
+            _wl_hash_block(indptr_view, indices_view, offsets_view,
+                           labels_view, new_labels_view, hashes_view,
+                           iterations, start, stop, &counters)
+        return counters
+
+    start = perf_counter()
+    for counters in map_blocks(hash_block,
+            (batch.number_of_graphs + GRAPHS_PER_BLOCK - 1)
+            // GRAPHS_PER_BLOCK):
+        stats.add_counters(counters)
+    for _ in range(iterations):
+        stats.add_iteration(n_vertices)
+    stats.add_phase("hash", start)
+    return hashes
+
+
+cdef void _degree_stats_block(const int64_t[::1] indptr,
+        const int64_t[::1] offsets, int64_t[::1] minima, int64_t[::1] maxima,
+        double[::1] means, Py_ssize_t start, Py_ssize_t stop,
+        Counters *counters) noexcept nogil:
+    """Finds the smallest, largest and mean degree of graphs
+    [start, stop).
+    """
+    cdef Py_ssize_t g
+    cdef int64_t u, degree, smallest, largest
+    for g in range(start, stop):
+        smallest = 0
+        largest = 0
+        for u in range(offsets[g], offsets[g + 1]):
+            degree = indptr[u + 1] - indptr[u]
+            if u == offsets[g] or degree < smallest:
+                smallest = degree
+            if degree > largest:
+                largest = degree
+        minima[g] = smallest
+        maxima[g] = largest
+        if offsets[g + 1] > offsets[g]:
+            means[g] = (<double>(indptr[offsets[g + 1]] - indptr[offsets[g]])
+                        / (offsets[g + 1] - offsets[g]))
+        else:
+            means[g] = 0.0
+        if STATS_ENABLED:
+            counters.vertices_settled += offsets[g + 1] - offsets[g]
+
+
+cdef tuple batch_degree_stats(GraphBatch batch, ExecutionStats stats=None):
+    """Summarizes the (out-)degrees of the vertices of every graph of a
+    batch. A self-loop adds 1 to the degree of its vertex.
+
+    Parameters
+    ----------
+    batch: cygraph.GraphBatch
+        A batch of graphs.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the summary.
+
+    Returns
+    -------
+    tuple
+        Arrays holding the smallest, largest and mean degree of each
+        graph, all 0 for graphs without vertices.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("batch_degree_stats")
+    cdef double start = perf_counter()
+    cdef np.ndarray indptr, indices, weights, offsets
+    indptr, indices, weights, offsets = batch._get_csr()
+    cdef np.ndarray minima = np.empty(batch.number_of_graphs, dtype=np.int64)
+    cdef np.ndarray maxima = np.empty(batch.number_of_graphs, dtype=np.int64)
+    cdef np.ndarray means = np.empty(batch.number_of_graphs)
+    stats.add_phase("setup", start)
+
+    def summarize_block(b):
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] offsets_view = offsets
+        cdef int64_t[::1] minima_view = minima
+        cdef int64_t[::1] maxima_view = maxima
+        cdef double[::1] means_view = means
+        cdef Py_ssize_t start = b * GRAPHS_PER_BLOCK
+        cdef Py_ssize_t stop = min(start + GRAPHS_PER_BLOCK, len(means))
+        cdef Counters counters = Counters(0, 0, 0, 0)
+        with nogil:
+            _degree_stats_block(indptr_view, offsets_view, minima_view,
+                                maxima_view, means_view, start, stop,
+                                &counters)
+        return counters
+
+    start = perf_counter()
+    for counters in map_blocks(summarize_block,
+            (batch.number_of_graphs + GRAPHS_PER_BLOCK - 1)
+            // GRAPHS_PER_BLOCK):
+        stats.add_counters(counters)
+    stats.add_phase("summarize", start)
+    return minima, maxima, means
+
+
+def py_batch_connected_components(batch, stats=None):
+    """Finds the connected components of every graph of a batch, or the
+    weakly connected components if the graphs are directed, in one
+    parallel call.
+
+    Parameters
+    ----------
+    batch: cygraph.GraphBatch
+        A batch of graphs.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the labeling.
+
+    Returns
+    -------
+    tuple
+        An array holding the number of components of each graph, and an
+        array holding the component of each vertex of the batch,
+        numbered from 0 within its graph in the order of the components'
+        first vertices.
+
+    Examples
+    --------
+    >>> batch = cg.GraphBatch.from_edges([3, 2], [1, 1], [0, 0], [1, 1])
+    >>> counts, labels = alg.batch_connected_components(batch)
+    >>> counts
+    array([2, 1])
+    >>> labels
+    array([0, 0, 1, 0, 0])
+    """
+    with span("batch_connected_components", "algorithm"):
+        return batch_connected_components(batch, stats)
+
+
+def py_batch_shortest_path_lengths(batch, sources, stats=None):
+    """Finds the length of the shortest path from a source vertex of
+    each graph of a batch to every vertex of that graph, with Dijkstra's
+    algorithm, in one parallel call.
+
+    Parameters
+    ----------
+    batch: cygraph.GraphBatch
+        A batch of graphs with non-negative edge weights.
+    sources: array-like of int
+        The source vertex of each graph, numbered within the graph.
+        Ignored for graphs without vertices.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the searches.
+
+    Returns
+    -------
+    np.ndarray
+        The length of the shortest path to each vertex of the batch from
+        the source of its graph, or np.inf if there is none.
+
+    Examples
+    --------
+    >>> batch = cg.GraphBatch.from_edges([3, 2], [2, 0], [0, 1], [1, 2],
+    ...                                  [1.0, 2.0])
+    >>> alg.batch_shortest_path_lengths(batch, [0, 1])
+    array([ 0.,  1.,  3., inf,  0.])
+    """
+    with span("batch_shortest_path_lengths", "algorithm"):
+        return batch_shortest_path_lengths(batch, sources, stats)
+
+
+def py_batch_wl_hash(batch, iterations=3, stats=None):
+    """Hashes every graph of a batch with the Weisfeiler-Lehman
+    subtree kernel, in one parallel call, so that isomorphic graphs get
+    the same hash and other graphs almost always get different ones.
+    Edge weights are ignored; directed graphs are hashed through their
+    outgoing edges.
+
+    Parameters
+    ----------
+    batch: cygraph.GraphBatch
+        A batch of graphs.
+    iterations: int, optional
+        The number of relabeling rounds, which is the radius of the
+        neighborhoods that the hash tells apart.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the hashing. Every round relabels
+        all vertices of the batch.
+
+    Returns
+    -------
+    np.ndarray
+        The np.uint64 hash of each graph.
+    """
+    with span("batch_wl_hash", "algorithm"):
+        return batch_wl_hash(batch, iterations, stats)
+
+
+def py_batch_degree_stats(batch, stats=None):
+    """Summarizes the (out-)degrees of the vertices of every graph of a
+    batch, in one parallel call. A self-loop adds 1 to the degree of its
+    vertex.
+
+    Parameters
+    ----------
+    batch: cygraph.GraphBatch
+        A batch of graphs.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the summary.
+
+    Returns
+    -------
+    tuple
+        Arrays holding the smallest, largest and mean degree of each
+        graph, all 0 for graphs without vertices.
+
+    Examples
+    --------
+    >>> batch = cg.GraphBatch.from_edges([3, 2], [2, 0], [0, 1], [1, 2])
+    >>> alg.batch_degree_stats(batch)
+    (array([1, 0]), array([2, 0]), array([1.33333333, 0.        ]))
+    """
+    with span("batch_degree_stats", "algorithm"):
+        return batch_degree_stats(batch, stats)
@@ -5,6 +5,6 @@ from cygraph.graph_ cimport DynamicGraph, Graph, StaticGraph
 
 
 cdef list get_connected_components(Graph graph, bint static)
-cdef int get_number_connected_components(Graph graph) except *
+cdef Py_ssize_t get_number_connected_components(Graph graph) except -1
 cdef list get_strongly_connected_components(Graph graph, bint static)
-cdef int get_number_strongly_connected_components(Graph graph) except *
\ No newline at end of file
+cdef Py_ssize_t get_number_strongly_connected_components(Graph graph) except -1
\ No newline at end of file
@@ -6,10 +6,11 @@
 from collections import deque
 
 from cygraph.graph_ cimport Graph, StaticGraph, DynamicGraph
+from cygraph.tracing import span
 
 
 # Global variables required for Tarjan's algorithm.
-cdef int _index = 0
+cdef Py_ssize_t _index = 0
 cdef list _stack = []
 cdef dict _indices = {}
 cdef dict _lowlinks = {}
@@ -114,7 +115,7 @@ cdef set _get_connected_components(Graph graph, bint vertices):
 
     cdef set components = set()
     cdef set visited = set()
-    cdef int n_components = 0
+    cdef Py_ssize_t n_components = 0
     cdef object vertex
     cdef set component_vertices
 
@@ -174,7 +175,7 @@ cdef set _get_strongly_connected_components(Graph graph, bint vertices):
     cdef set visited = set()
     cdef set comp
     cdef object v, w
-    cdef int n_components = 0
+    cdef Py_ssize_t n_components = 0
     for v in graph.vertices:
         if v not in _indices:
             comp = _strongconnect(graph, v)
@@ -257,7 +258,7 @@ cdef list get_connected_components(Graph graph, bint static):
     return component_graphs
 
 
-cdef int get_number_connected_components(Graph graph) except *:
+cdef Py_ssize_t get_number_connected_components(Graph graph) except -1:
     """Finds the number of connected components of a graph.
 
     Parameters
@@ -346,7 +347,7 @@ cdef list get_strongly_connected_components(Graph graph, bint static):
     return graph_components
 
 
-cdef int get_number_strongly_connected_components(Graph graph) except *:
+cdef Py_ssize_t get_number_strongly_connected_components(Graph graph) except -1:
     """Gets the number of strongly connected components in a graph.
 
     Parameters
@@ -407,7 +408,8 @@ def py_get_connected_components(graph, static=False):
     >>> alg.get_connected_components(G)
     {<DynamicGraph; vertices=[1, 2, 3]; edges={(1, 2, 1.0), (2, 3, 1.0)}>, <DynamicGraph; vertices=[0]; edges=set()>}
     """
-    return get_connected_components(graph, static)
+    with span("get_connected_components", "algorithm"):
+        return get_connected_components(graph, static)
 
 
 def py_get_number_connected_components(graph):
@@ -435,7 +437,8 @@ def py_get_number_connected_components(graph):
     >>> alg.get_number_connected_components(G)
     2
     """
-    return get_number_connected_components(graph)
+    with span("get_number_connected_components", "algorithm"):
+        return get_number_connected_components(graph)
 
 
 def py_get_strongly_connected_components(graph, static=False):
@@ -470,7 +473,8 @@ def py_get_strongly_connected_components(graph, static=False):
     >>> alg.get_strongly_connected_components(G)
     {<DynamicGraph; vertices=[2, 3]; edges={(2, 3, 1.0), (3, 2, 1.0)}>, <DynamicGraph; vertices=[0, 1]; edges={(1, 0, 1.0), (0, 1, 1.0)}>}
     """
-    return get_strongly_connected_components(graph, static)
+    with span("get_strongly_connected_components", "algorithm"):
+        return get_strongly_connected_components(graph, static)
 
 
 def py_get_number_strongly_connected_components(graph):
@@ -502,4 +506,5 @@ def py_get_number_strongly_connected_components(graph):
     >>> alg.get_number_strongly_connected_components(G)
     2
     """
-    return get_number_strongly_connected_components(graph)
\ No newline at end of file
+    with span("get_number_strongly_connected_components", "algorithm"):
+        return get_number_strongly_connected_components(graph)
\ No newline at end of file
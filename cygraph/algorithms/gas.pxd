@@ -0,0 +1,30 @@
+#!python
+#cython: language_level=3
+from libc.stdint cimport int64_t
+
+from cygraph.algorithms.stats cimport ExecutionStats
+
+
+cdef class GASProgram:
+    cdef public int64_t number_of_vertices
+    cdef public double tolerance
+
+    cdef void setup(self, int64_t n_vertices) except *
+    cdef double initial_value(self, int64_t v) noexcept nogil
+    cdef double gather(self, int64_t v, int64_t u, double value,
+        double weight, int64_t out_degree) noexcept nogil
+    cdef double sum(self, double first, double second) noexcept nogil
+    cdef double zero(self) noexcept nogil
+    cdef double apply(self, int64_t v, double value, double total,
+        Py_ssize_t iteration) noexcept nogil
+    cdef bint scatter(self, int64_t v, int64_t u, double old_value,
+        double new_value, double weight) noexcept nogil
+
+
+cdef class DiffusionProgram(GASProgram):
+    cdef double[::1] _seeds
+    cdef readonly double damping
+
+
+cdef tuple run_gas(GASProgram program, object graph, object weight=*,
+    object active=*, object max_iterations=*, ExecutionStats stats=*)
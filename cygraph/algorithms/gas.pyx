@@ -0,0 +1,399 @@
+#!python
+#cython: language_level=3
+"""A gather-apply-scatter engine running propagation programs over the
+active vertices of a graph, in parallel and without the GIL.
+"""
+
+from libc.math cimport fabs
+from libc.stdint cimport int64_t, uint8_t
+
+cimport numpy as np
+import numpy as np
+from time import perf_counter
+
+from cygraph.algorithms.stats cimport Counters, ExecutionStats, STATS_ENABLED
+from cygraph.graph_.graph cimport Graph
+from cygraph.graph_.int_graph cimport IntGraph
+from cygraph.graph_.weights cimport weighted_csr
+from cygraph.parallel import map_blocks
+from cygraph.tracing import span
+
+
+# Number of active vertices processed by a single task.
+cdef Py_ssize_t BLOCK_SIZE = 4096
+
+
+cdef class GASProgram:
+    """A propagation algorithm for cygraph.algorithms.run_gas, which keeps
+    a float value per vertex and updates the active vertices of each
+    iteration from their parents.
+
+    Subclass this in Cython and override its cdef methods, which are
+    called without the GIL, from several threads at once, except for
+    setup:
+
+    - `void setup(self, int64_t n_vertices) except *` is called with the
+      GIL before the first iteration. It sets `number_of_vertices`, and
+      can check that the program suits a graph of that size.
+    - `double initial_value(self, int64_t v) noexcept nogil` gives the
+      value of vertex v before the first iteration.
+    - `double gather(self, int64_t v, int64_t u, double value,
+      double weight, int64_t out_degree) noexcept nogil` gives what
+      active vertex v collects along its edge from parent u, which has
+      the given value and number of children.
+    - `double sum(self, double first, double second) noexcept nogil`
+      merges two gathered values. It must be commutative and
+      associative. Defaults to their sum.
+    - `double zero(self) noexcept nogil` is what a vertex without
+      parents gathers, the identity of sum. Defaults to 0.
+    - `double apply(self, int64_t v, double value, double total,
+      Py_ssize_t iteration) noexcept nogil` gives the new value of v
+      from its value and what it gathered. Defaults to the latter.
+    - `bint scatter(self, int64_t v, int64_t u, double old_value,
+      double new_value, double weight) noexcept nogil` tells whether
+      the update of v activates its child u for the next iteration.
+      Defaults to whether the value of v changed by more than
+      `tolerance`.
+
+    Vertices are numbered by their position in graph.vertices. Every
+    iteration reads the values of the previous one, so the result does
+    not depend on the order in which vertices are processed.
+
+    Attributes
+    ----------
+    number_of_vertices: int
+        The number of vertices of the graph being run on.
+    tolerance: double
+        The change in value below which the default scatter does not
+        activate children. Defaults to 0.
+    """
+
+    cdef void setup(self, int64_t n_vertices) except *:
+        self.number_of_vertices = n_vertices
+
+    cdef double initial_value(self, int64_t v) noexcept nogil:
+        return 0.0
+
+    cdef double gather(self, int64_t v, int64_t u, double value,
+            double weight, int64_t out_degree) noexcept nogil:
+        return value
+
+    cdef double sum(self, double first, double second) noexcept nogil:
+        return first + second
+
+    cdef double zero(self) noexcept nogil:
+        return 0.0
+
+    cdef double apply(self, int64_t v, double value, double total,
+            Py_ssize_t iteration) noexcept nogil:
+        return total
+
+    cdef bint scatter(self, int64_t v, int64_t u, double old_value,
+            double new_value, double weight) noexcept nogil:
+        return fabs(new_value - old_value) > self.tolerance
+
+
+cdef class DiffusionProgram(GASProgram):
+    """Diffuses scores from seed vertices along edges, as in
+    personalized PageRank: the score of a vertex is
+    (1 - damping) * seed + damping * sum(score(u) / out_degree(u))
+    over its parents u. Useful for spreading risk or relevance from
+    known vertices to their neighborhoods.
+
+    Parameters
+    ----------
+    seeds: array-like of float
+        The seed score of every vertex.
+    damping: double, optional
+        The fraction of its score that a vertex passes on to its
+        children.
+    tolerance: double, optional
+        The change in score below which a vertex stops activating its
+        children.
+    """
+
+    def __cinit__(self, object seeds, double damping=0.85,
+            double tolerance=1e-9):
+        if not 0.0 <= damping < 1.0:
+            raise ValueError("The damping factor must be at least 0 and "
+                             "less than 1.")
+        self._seeds = np.array(seeds, dtype=np.float64)
+        self.damping = damping
+        self.tolerance = tolerance
+
+    cdef void setup(self, int64_t n_vertices) except *:
+        if self._seeds.shape[0] != n_vertices:
+            raise ValueError(f"Got {self._seeds.shape[0]} seeds for "
+                             f"{n_vertices} vertices.")
+        GASProgram.setup(self, n_vertices)
+
+    cdef double initial_value(self, int64_t v) noexcept nogil:
+        return (1.0 - self.damping) * self._seeds[v]
+
+    cdef double gather(self, int64_t v, int64_t u, double value,
+            double weight, int64_t out_degree) noexcept nogil:
+        return value / out_degree
+
+    cdef double apply(self, int64_t v, double value, double total,
+            Py_ssize_t iteration) noexcept nogil:
+        return (1.0 - self.damping) * self._seeds[v] + self.damping * total
+
+    @property
+    def seeds(self):
+        return np.asarray(self._seeds).copy()
+
+
+cdef tuple _transpose_csr(np.ndarray indptr, np.ndarray indices,
+        np.ndarray weights):
+    """Returns the compressed sparse rows of the reverse of a graph,
+    that is the compressed sparse columns of the graph, with sorted
+    rows.
+    """
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    cdef np.ndarray rows = np.repeat(np.arange(n_vertices, dtype=np.int64),
+                                     np.diff(indptr))
+    cdef np.ndarray order = np.argsort(indices, kind="stable")
+    cdef np.ndarray transposed_indptr = np.zeros(n_vertices + 1,
+                                                 dtype=np.int64)
+    np.cumsum(np.bincount(indices, minlength=n_vertices),
+              out=transposed_indptr[1:])
+    return transposed_indptr, rows[order], weights[order]
+
+
+cdef void _gather_apply(GASProgram program, const int64_t[::1] in_indptr,
+        const int64_t[::1] in_indices, const double[::1] in_weights,
+        const int64_t[::1] indptr, const int64_t[::1] frontier,
+        const double[::1] values, double[::1] new_values,
+        Py_ssize_t iteration, Py_ssize_t start, Py_ssize_t stop,
+        Counters *counters) noexcept nogil:
+    """Computes the new values of active vertices start to stop - 1 of
+    the frontier.
+    """
+    cdef Py_ssize_t i, j
+    cdef int64_t v, u
+    cdef double total
+    for i in range(start, stop):
+        v = frontier[i]
+        total = program.zero()
+        for j in range(in_indptr[v], in_indptr[v + 1]):
+            u = in_indices[j]
+            total = program.sum(total, program.gather(
+                v, u, values[u], in_weights[j], indptr[u + 1] - indptr[u]))
+        new_values[v] = program.apply(v, values[v], total, iteration)
+        if STATS_ENABLED:
+            counters.vertices_settled += 1
+            counters.edges_relaxed += in_indptr[v + 1] - in_indptr[v]
+
+
+cdef void _scatter(GASProgram program, const int64_t[::1] indptr,
+        const int64_t[::1] indices, const double[::1] weights,
+        const int64_t[::1] frontier, double[::1] values,
+        const double[::1] new_values, uint8_t[::1] next_active,
+        Py_ssize_t start, Py_ssize_t stop, Counters *counters) noexcept nogil:
+    """Activates the children of active vertices start to stop - 1 of
+    the frontier as their program decides, then stores their new
+    values. Children are only ever marked active, so blocks marking the
+    same child do not conflict.
+    """
+    cdef Py_ssize_t i, j
+    cdef int64_t v, u
+    for i in range(start, stop):
+        v = frontier[i]
+        for j in range(indptr[v], indptr[v + 1]):
+            u = indices[j]
+            if not next_active[u] and program.scatter(
+                    v, u, values[v], new_values[v], weights[j]):
+                next_active[u] = True
+        values[v] = new_values[v]
+        if STATS_ENABLED:
+            counters.edges_relaxed += indptr[v + 1] - indptr[v]
+
+
+cdef tuple run_gas(GASProgram program, object graph, object weight=None,
+        object active=None, object max_iterations=None,
+        ExecutionStats stats=None):
+    """Runs a gather-apply-scatter program on a graph until no vertex is
+    active.
+
+    Parameters
+    ----------
+    program: GASProgram
+        The algorithm to run.
+    graph: cygraph.Graph or cygraph.IntGraph
+        A graph.
+    weight: str or cygraph.WeightFunction, optional
+        The key of the edge attribute holding the weights given to
+        `program`, or a function computing them. By default, the edge
+        weights are used. Only supported for cygraph.Graph.
+    active: array-like of int, optional
+        The vertices active in the first iteration. Defaults to all
+        vertices.
+    max_iterations: int, optional
+        The number of iterations after which to stop even if vertices
+        are still active. By default there is no limit.
+    stats: ExecutionStats, optional
+        Statistics to fill in about the run.
+
+    Returns
+    -------
+    tuple
+        The final value of each vertex, and the number of iterations
+        run.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("run_gas")
+    cdef double start = perf_counter()
+    cdef np.ndarray indptr, indices, weights
+    if isinstance(graph, Graph):
+        indptr, indices, weights = weighted_csr(graph, weight)
+    elif isinstance(graph, IntGraph):
+        if weight is not None:
+            raise TypeError("cygraph.IntGraph edges can only be weighted by "
+                            "their stored weights.")
+        indptr, indices, weights = (<IntGraph>graph)._get_csr()
+    else:
+        raise TypeError("GAS programs run on cygraph.Graph and "
+                        "cygraph.IntGraph instances, not "
+                        f"{type(graph).__name__}.")
+    indptr = np.ascontiguousarray(indptr, dtype=np.int64)
+    indices = np.ascontiguousarray(indices, dtype=np.int64)
+    weights = np.ascontiguousarray(weights, dtype=np.float64)
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    if max_iterations is not None and max_iterations < 0:
+        raise ValueError("The number of iterations cannot be negative.")
+
+    cdef np.ndarray in_indptr, in_indices, in_weights
+    if graph.directed:
+        in_indptr, in_indices, in_weights = _transpose_csr(indptr, indices,
+                                                           weights)
+        stats.allocate(in_indptr.nbytes + in_indices.nbytes
+                       + in_weights.nbytes)
+    else:
+        in_indptr, in_indices, in_weights = indptr, indices, weights
+
+    cdef np.ndarray frontier
+    if active is None:
+        frontier = np.arange(n_vertices, dtype=np.int64)
+    else:
+        frontier = np.unique(np.asarray(active, dtype=np.int64))
+        if len(frontier) and (frontier[0] < 0
+                              or frontier[-1] >= n_vertices):
+            raise ValueError("Every active vertex must be between 0 and "
+                             f"{n_vertices - 1}.")
+
+    program.setup(n_vertices)
+    cdef np.ndarray values = np.empty(n_vertices, dtype=np.float64)
+    cdef double[::1] values_view = values
+    cdef int64_t v
+    with nogil:
+        for v in range(n_vertices):
+            values_view[v] = program.initial_value(v)
+    cdef np.ndarray new_values = values.copy()
+    cdef np.ndarray next_active = np.zeros(n_vertices, dtype=np.uint8)
+    cdef Py_ssize_t iteration = 0
+    stats.allocate(new_values.nbytes + next_active.nbytes)
+    stats.add_phase("setup", start)
+
+    def gather_apply_block(b):
+        cdef const int64_t[::1] in_indptr_view = in_indptr
+        cdef const int64_t[::1] in_indices_view = in_indices
+        cdef const double[::1] in_weights_view = in_weights
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] frontier_view = frontier
+        cdef const double[::1] values_view = values
+        cdef double[::1] new_values_view = new_values
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        cdef Py_ssize_t stop = min(start + BLOCK_SIZE, len(frontier))
+        cdef Py_ssize_t i = iteration
+        cdef Counters counters = Counters(0, 0, 0, 0)
+        with nogil:
+            _gather_apply(program, in_indptr_view, in_indices_view,
+                          in_weights_view, indptr_view, frontier_view,
+                          values_view, new_values_view, i, start, stop,
+                          &counters)
+        return counters
+
+    def scatter_block(b):
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] indices_view = indices
+        cdef const double[::1] weights_view = weights
+        cdef const int64_t[::1] frontier_view = frontier
+        cdef double[::1] values_view = values
+        cdef const double[::1] new_values_view = new_values
+        cdef uint8_t[::1] next_active_view = next_active
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        cdef Py_ssize_t stop = min(start + BLOCK_SIZE, len(frontier))
+        cdef Counters counters = Counters(0, 0, 0, 0)
+        with nogil:
+            _scatter(program, indptr_view, indices_view, weights_view,
+                     frontier_view, values_view, new_values_view,
+                     next_active_view, start, stop, &counters)
+        return counters
+
+    cdef Py_ssize_t n_blocks
+    while len(frontier) and (max_iterations is None
+                             or iteration < max_iterations):
+        stats.add_iteration(len(frontier))
+        stats.allocate(frontier.nbytes)
+        n_blocks = (len(frontier) + BLOCK_SIZE - 1) // BLOCK_SIZE
+        # Scattering only starts once every active vertex has gathered
+        # the values of the previous iteration.
+        start = perf_counter()
+        for counters in map_blocks(gather_apply_block, n_blocks):
+            stats.add_counters(counters)
+        stats.add_phase("gather_apply", start)
+        start = perf_counter()
+        for counters in map_blocks(scatter_block, n_blocks):
+            stats.add_counters(counters)
+        stats.add_phase("scatter", start)
+        stats.release(frontier.nbytes)
+        frontier = np.flatnonzero(next_active)
+        next_active[frontier] = False
+        iteration += 1
+    return values, iteration
+
+
+def py_run_gas(program, graph, weight=None, active=None,
+        max_iterations=None, stats=None):
+    """Runs a gather-apply-scatter program on a graph until it
+    converges, that is until no vertex is active. Each iteration, every
+    active vertex gathers from its parents and applies the result to
+    its value, in parallel and without the GIL, then scatters to its
+    children to decide which are active in the next iteration.
+
+    Parameters
+    ----------
+    program: cygraph.algorithms.GASProgram
+        The algorithm to run, such as a DiffusionProgram.
+    graph: cygraph.Graph or cygraph.IntGraph
+        A graph.
+    weight: str or cygraph.WeightFunction, optional
+        The key of the edge attribute holding the weights given to
+        `program`, or a function computing them. By default, the edge
+        weights are used. Only supported for cygraph.Graph.
+    active: array-like of int, optional
+        The integers of the vertices (their positions in graph.vertices)
+        active in the first iteration. Defaults to all vertices.
+    max_iterations: int, optional
+        The number of iterations after which to stop even if vertices
+        are still active. By default there is no limit.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the run.
+
+    Returns
+    -------
+    tuple
+        The final value of each vertex, in the order of graph.vertices,
+        and the number of iterations run.
+
+    Examples
+    --------
+    >>> G = cg.graph(directed=True, vertices=["a", "b", "c"])
+    >>> G.add_edges({("a", "b"), ("b", "c")})
+    >>> program = alg.DiffusionProgram([1.0, 0.0, 0.0], damping=0.5)
+    >>> alg.run_gas(program, G)
+    (array([0.5  , 0.25 , 0.125]), 2)
+    """
+    with span("run_gas", "algorithm"):
+        return run_gas(program, graph, weight, active, max_iterations, stats)
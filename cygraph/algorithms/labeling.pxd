@@ -0,0 +1,34 @@
+#!python
+#cython: language_level=3
+from libc.stdint cimport int32_t, int64_t
+
+cimport numpy as np
+
+from cygraph.algorithms.stats cimport ExecutionStats
+
+
+cdef class LandmarkIndex:
+    cdef readonly bint directed
+    cdef readonly Py_ssize_t number_of_vertices
+    cdef list _vertices
+    cdef dict _vertex_ints
+    # The rank of every vertex, from the most to the least connected.
+    # Labels name their hubs by rank.
+    cdef np.ndarray _ranks
+    # Labels in CSR form, by rank: the hubs that reach each vertex and
+    # the hubs each vertex reaches, sorted by rank, with their
+    # distances. Undirected graphs only have the first.
+    cdef np.ndarray _in_indptr
+    cdef np.ndarray _in_hubs
+    cdef np.ndarray _in_distances
+    cdef np.ndarray _out_indptr
+    cdef np.ndarray _out_hubs
+    cdef np.ndarray _out_distances
+
+    cdef void _build(self, np.ndarray indptr, np.ndarray indices,
+        ExecutionStats stats) except *
+    cdef Py_ssize_t _get_rank(self, object vertex) except -1
+    cdef np.ndarray _get_ranks(self, object vertices)
+    cdef np.ndarray _query(self, object sources, object targets)
+    cpdef double distance(self, object source, object target) except -1.0
+    cpdef bint is_reachable(self, object source, object target) except -1
@@ -0,0 +1,616 @@
+#!python
+#cython: language_level=3
+"""A 2-hop labeling index answering distance and reachability queries
+on general graphs by pruned landmark labeling.
+"""
+
+from libc.math cimport INFINITY
+from libc.stdint cimport INT32_MAX, int32_t, int64_t
+from libc.stdlib cimport calloc, free, realloc
+
+cimport numpy as np
+import numpy as np
+from time import perf_counter
+
+from cygraph.algorithms.stats cimport Counters, ExecutionStats, STATS_ENABLED
+from cygraph.graph_.graph cimport Graph
+from cygraph.graph_.int_graph cimport IntGraph
+from cygraph.graph_.sparse import build_csr
+from cygraph.parallel import get_num_threads, map_blocks
+from cygraph.tracing import span
+
+
+# Number of queries answered by a single task.
+cdef Py_ssize_t BLOCK_SIZE = 4096
+# Larger than any distance, so that sums of two of them do not
+# overflow.
+cdef int32_t UNREACHED = INT32_MAX // 2
+
+
+# A growable array of (vertex or hub, distance) pairs.
+cdef struct PairList:
+    int32_t *items
+    int32_t *distances
+    Py_ssize_t size
+    Py_ssize_t capacity
+
+
+cdef bint _append(PairList *pairs, int32_t item,
+        int32_t distance) noexcept nogil:
+    """Appends a pair to a list, returning False if it cannot grow.
+    """
+    cdef Py_ssize_t capacity
+    cdef void *grown
+    if pairs.size == pairs.capacity:
+        capacity = max(4, 2 * pairs.capacity)
+        grown = realloc(pairs.items, capacity * sizeof(int32_t))
+        if grown == NULL:
+            return False
+        pairs.items = <int32_t *>grown
+        grown = realloc(pairs.distances, capacity * sizeof(int32_t))
+        if grown == NULL:
+            return False
+        pairs.distances = <int32_t *>grown
+        pairs.capacity = capacity
+    pairs.items[pairs.size] = item
+    pairs.distances[pairs.size] = distance
+    pairs.size += 1
+    return True
+
+
+cdef void _free_pair_lists(PairList *lists, Py_ssize_t n) noexcept:
+    cdef Py_ssize_t i
+    if lists == NULL:
+        return
+    for i in range(n):
+        free(lists[i].items)
+        free(lists[i].distances)
+    free(lists)
+
+
+cdef bint _pruned_search(int32_t hub, const int64_t[::1] indptr,
+        const int64_t[::1] indices, const PairList *hub_labels,
+        const PairList *labels, int32_t[::1] hub_distances,
+        int32_t[::1] depths, int32_t[::1] queue, PairList *found,
+        Counters *counters) noexcept nogil:
+    """Searches breadth-first from a hub, and adds the vertices it
+    reaches to `found` with their distances, except that the search
+    stops at the vertices whose distance from the hub the labels already
+    give. `hub_labels` are the labels on the hub's side of the pairs,
+    and `labels` those on the side of the vertices searched.
+
+    hub_distances and depths must hold UNREACHED for every vertex, and
+    are restored before returning. The vertices labeled and the edges
+    they are expanded along are added to counters in instrumented
+    builds.
+
+    Returns
+    -------
+    bint
+        False if `found` could not grow.
+    """
+    cdef const PairList *pairs = &hub_labels[hub]
+    cdef Py_ssize_t head = 0
+    cdef Py_ssize_t tail = 1
+    cdef Py_ssize_t i
+    cdef int64_t j
+    cdef int32_t v, u, depth
+    cdef bint pruned
+    cdef bint grown = True
+    for i in range(pairs.size):
+        hub_distances[pairs.items[i]] = pairs.distances[i]
+    queue[0] = hub
+    depths[hub] = 0
+    while head < tail:
+        v = queue[head]
+        head += 1
+        depth = depths[v]
+        pruned = False
+        for i in range(labels[v].size):
+            if hub_distances[labels[v].items[i]] \
+                    + labels[v].distances[i] <= depth:
+                pruned = True
+                break
+        if pruned:
+            continue
+        if not _append(found, v, depth):
+            grown = False
+            break
+        if STATS_ENABLED:
+            counters.vertices_settled += 1
+            counters.edges_relaxed += indptr[v + 1] - indptr[v]
+        for j in range(indptr[v], indptr[v + 1]):
+            u = <int32_t>indices[j]
+            if depths[u] == UNREACHED:
+                depths[u] = depth + 1
+                queue[tail] = u
+                tail += 1
+    for i in range(tail):
+        depths[queue[i]] = UNREACHED
+    for i in range(pairs.size):
+        hub_distances[pairs.items[i]] = UNREACHED
+    return grown
+
+
+cdef void _query_block(const int64_t[::1] sources, const int64_t[::1] targets,
+        const int64_t[::1] out_indptr, const int32_t[::1] out_hubs,
+        const int32_t[::1] out_distances, const int64_t[::1] in_indptr,
+        const int32_t[::1] in_hubs, const int32_t[::1] in_distances,
+        double[::1] distances, Py_ssize_t start,
+        Py_ssize_t stop) noexcept nogil:
+    """Finds the distance of each pair in [start, stop) by merging the
+    sorted labels of its source and target.
+    """
+    cdef Py_ssize_t q
+    cdef int64_t a, a_end, b, b_end
+    cdef int32_t best, d
+    for q in range(start, stop):
+        a, a_end = out_indptr[sources[q]], out_indptr[sources[q] + 1]
+        b, b_end = in_indptr[targets[q]], in_indptr[targets[q] + 1]
+        best = UNREACHED
+        while a < a_end and b < b_end:
+            if out_hubs[a] < in_hubs[b]:
+                a += 1
+            elif out_hubs[a] > in_hubs[b]:
+                b += 1
+            else:
+                d = out_distances[a] + in_distances[b]
+                if d < best:
+                    best = d
+                a += 1
+                b += 1
+        distances[q] = INFINITY if best == UNREACHED else best
+
+
+cdef class LandmarkIndex:
+    """An index of the distances between the vertices of a graph, in
+    edges, built by pruned landmark labeling (Akiba, Iwata and Yoshida,
+    "Fast exact shortest-path distance queries on large networks",
+    2013).
+
+    Every vertex gets the labels of the hubs it reaches and that reach
+    it, with their distances, so that the distance from s to t is the
+    smallest sum over the hubs in both the out-label of s and the
+    in-label of t. Vertices become hubs in decreasing order of degree,
+    and a breadth-first search from each hub stops at the vertices whose
+    distance the labels of earlier hubs already give, which keeps labels
+    small on real-world graphs. Searches from consecutive hubs run in
+    parallel, one per thread, pruned by the labels of the hubs before
+    them, so more threads make labels slightly larger but every answer
+    stays exact.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph or cygraph.IntGraph
+        A graph, directed or not, whose edge weights are ignored.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about building the index, with an
+        iteration per batch of hubs searched in parallel and the number
+        of label entries it added as its frontier. Every label entry
+        counts as a vertex settled, and the edges searched from it as
+        edges relaxed.
+
+    Attributes
+    ----------
+    directed: bool
+        Whether the graph is directed.
+    number_of_vertices: int
+        The number of vertices of the graph.
+
+    Examples
+    --------
+    >>> G = cg.graph(directed=True, vertices=["a", "b", "c", "d"])
+    >>> G.add_edges({("a", "b"), ("b", "c"), ("c", "a"), ("c", "d")})
+    >>> index = alg.LandmarkIndex(G)
+    >>> index.distance("b", "a"), index.is_reachable("d", "a")
+    (2.0, False)
+    >>> index.distances(["a", "a"], ["c", "d"])
+    array([2., 3.])
+    """
+    def __cinit__(self, object graph=None, ExecutionStats stats=None):
+        if graph is None:
+            # Created empty by load or unpickling.
+            return
+        cdef np.ndarray indptr, indices
+        if isinstance(graph, Graph):
+            indptr, indices, _ = (<Graph>graph)._get_csr()
+            self._vertices = graph.vertices[:]
+            self._vertex_ints = {v: i for i, v in enumerate(self._vertices)}
+        elif isinstance(graph, IntGraph):
+            indptr, indices, _ = (<IntGraph>graph)._get_csr()
+        else:
+            raise TypeError("Landmark indexes are built for cygraph.Graph "
+                            "and cygraph.IntGraph instances, not "
+                            f"{type(graph).__name__}.")
+        self.directed = graph.directed
+        self.number_of_vertices = len(indptr) - 1
+        if self.number_of_vertices >= UNREACHED:
+            raise ValueError("Landmark indexes support fewer than "
+                             f"{UNREACHED} vertices.")
+        if stats is None:
+            stats = ExecutionStats()
+        with span("LandmarkIndex", "algorithm"):
+            self._build(np.asarray(indptr, dtype=np.int64),
+                        np.asarray(indices, dtype=np.int64), stats)
+
+    cdef void _build(self, np.ndarray indptr, np.ndarray indices,
+            ExecutionStats stats) except *:
+        """Ranks the vertices and labels them from every hub in turn.
+        """
+        stats.begin("LandmarkIndex")
+        cdef double start = perf_counter()
+        cdef Py_ssize_t n = self.number_of_vertices
+        cdef np.ndarray sources = np.repeat(np.arange(n, dtype=np.int64),
+                                            np.diff(indptr))
+        cdef np.ndarray degrees = np.diff(indptr) + np.bincount(indices,
+                                                                minlength=n)
+        cdef np.ndarray order = np.argsort(-degrees, kind="stable")
+        self._ranks = np.empty(n, dtype=np.int64)
+        self._ranks[order] = np.arange(n, dtype=np.int64)
+        # The graph with vertices numbered by rank, and its transpose.
+        cdef object forward = build_csr(self._ranks[sources],
+            self._ranks[indices], shape=(n, n), combine="first",
+            index_dtype=np.int64)
+        cdef object backward = build_csr(self._ranks[indices],
+            self._ranks[sources], shape=(n, n), combine="first",
+            index_dtype=np.int64)
+        cdef np.ndarray forward_indptr = forward.indptr
+        cdef np.ndarray forward_indices = forward.indices
+        cdef np.ndarray backward_indptr = backward.indptr
+        cdef np.ndarray backward_indices = backward.indices
+        stats.allocate(forward_indptr.nbytes + forward_indices.nbytes
+                       + backward_indptr.nbytes + backward_indices.nbytes)
+
+        cdef Py_ssize_t n_threads = get_num_threads()
+        cdef PairList *in_labels = <PairList *>calloc(max(n, 1),
+                                                      sizeof(PairList))
+        cdef PairList *out_labels = in_labels
+        cdef PairList *found = <PairList *>calloc(2 * n_threads,
+                                                  sizeof(PairList))
+        if self.directed:
+            out_labels = <PairList *>calloc(max(n, 1), sizeof(PairList))
+        if in_labels == NULL or out_labels == NULL or found == NULL:
+            _free_pair_lists(found, 2 * n_threads)
+            _free_pair_lists(in_labels, n)
+            if self.directed:
+                _free_pair_lists(out_labels, n)
+            raise MemoryError()
+        # Scratch arrays are taken by a search and given back when it
+        # ends, so there are at most as many as threads.
+        cdef list scratches = []
+        cdef Py_ssize_t batch_start = 0
+        cdef Py_ssize_t batch_size
+        cdef bint directed = self.directed
+
+        def search(Py_ssize_t b):
+            cdef tuple scratch
+            if scratches:
+                scratch = scratches.pop()
+            else:
+                scratch = (np.full(n, UNREACHED, dtype=np.int32),
+                           np.full(n, UNREACHED, dtype=np.int32),
+                           np.empty(n, dtype=np.int32))
+                stats.allocate(3 * n * sizeof(int32_t))
+            cdef int32_t[::1] hub_distances = scratch[0]
+            cdef int32_t[::1] depths = scratch[1]
+            cdef int32_t[::1] queue = scratch[2]
+            cdef const int64_t[::1] forward_indptr_view = forward_indptr
+            cdef const int64_t[::1] forward_indices_view = forward_indices
+            cdef const int64_t[::1] backward_indptr_view = backward_indptr
+            cdef const int64_t[::1] backward_indices_view = backward_indices
+            cdef int32_t hub = batch_start + b
+            cdef bint grown
+            cdef Counters counters = Counters(0, 0, 0, 0)
+            found[2 * b].size = 0
+            found[2 * b + 1].size = 0
+            try:
+                with nogil:
+                    # Searching forward from the hub finds the vertices it
+                    # reaches, whose in-labels get the hub, pruned by the
+                    # out-label of the hub; backward is the reverse.
+                    grown = _pruned_search(hub, forward_indptr_view,
+                        forward_indices_view, out_labels, in_labels,
+                        hub_distances, depths, queue, &found[2 * b],
+                        &counters)
+                    if grown and directed:
+                        grown = _pruned_search(hub, backward_indptr_view,
+                            backward_indices_view, in_labels, out_labels,
+                            hub_distances, depths, queue, &found[2 * b + 1],
+                            &counters)
+                if not grown:
+                    raise MemoryError()
+            finally:
+                scratches.append(scratch)
+            return counters
+
+        cdef Py_ssize_t b, i, entries
+        cdef bint grown = True
+        stats.add_phase("setup", start)
+        start = perf_counter()
+        try:
+            while batch_start < n:
+                batch_size = min(n_threads, n - batch_start)
+                for counters in map_blocks(search, batch_size):
+                    stats.add_counters(counters)
+                entries = 0
+                for b in range(2 * batch_size):
+                    entries += found[b].size
+                stats.add_iteration(entries)
+                # Hubs are added in rank order, which keeps labels sorted.
+                with nogil:
+                    for b in range(batch_size):
+                        for i in range(found[2 * b].size):
+                            grown &= _append(&in_labels[found[2 * b].items[i]],
+                                <int32_t>(batch_start + b),
+                                found[2 * b].distances[i])
+                        for i in range(found[2 * b + 1].size):
+                            grown &= _append(
+                                &out_labels[found[2 * b + 1].items[i]],
+                                <int32_t>(batch_start + b),
+                                found[2 * b + 1].distances[i])
+                if not grown:
+                    raise MemoryError()
+                batch_start += batch_size
+            stats.add_phase("labeling", start)
+            start = perf_counter()
+            self._in_indptr, self._in_hubs, self._in_distances = \
+                _labels_to_csr(in_labels, n)
+            if self.directed:
+                self._out_indptr, self._out_hubs, self._out_distances = \
+                    _labels_to_csr(out_labels, n)
+            else:
+                self._out_indptr, self._out_hubs, self._out_distances = \
+                    self._in_indptr, self._in_hubs, self._in_distances
+            stats.add_phase("compress", start)
+        finally:
+            _free_pair_lists(found, 2 * n_threads)
+            _free_pair_lists(in_labels, n)
+            if self.directed:
+                _free_pair_lists(out_labels, n)
+
+    @property
+    def label_sizes(self):
+        """The number of hubs in the labels of each vertex, in the order
+        of graph.vertices: those of its in-label plus, for directed
+        graphs, those of its out-label.
+        """
+        cdef np.ndarray sizes = np.diff(self._in_indptr)
+        if self.directed:
+            sizes = sizes + np.diff(self._out_indptr)
+        return sizes[self._ranks]
+
+    cpdef double distance(self, object source, object target) except -1.0:
+        """Finds the number of edges on a shortest path between two
+        vertices.
+
+        Parameters
+        ----------
+        source
+            A vertex in the graph.
+        target
+            A vertex in the graph.
+
+        Returns
+        -------
+        double
+            The distance, or inf if `target` cannot be reached from
+            `source`.
+        """
+        return self._query([source], [target])[0]
+
+    cpdef bint is_reachable(self, object source, object target) except -1:
+        """Finds whether there is a path from one vertex to another.
+
+        Parameters
+        ----------
+        source
+            A vertex in the graph.
+        target
+            A vertex in the graph.
+
+        Returns
+        -------
+        bint
+            Whether `target` can be reached from `source`.
+        """
+        return self.distance(source, target) != INFINITY
+
+    def distances(self, sources, targets):
+        """Finds the distances of many pairs of vertices at once, in
+        parallel.
+
+        Parameters
+        ----------
+        sources: iterable
+            The first vertex of each pair.
+        targets: iterable
+            The second vertex of each pair.
+
+        Returns
+        -------
+        np.ndarray
+            The distance of each pair, inf where the target cannot be
+            reached from the source.
+        """
+        return self._query(sources, targets)
+
+    def are_reachable(self, sources, targets):
+        """Finds whether the target of each of many pairs of vertices can
+        be reached from its source, in parallel.
+
+        Parameters
+        ----------
+        sources: iterable
+            The first vertex of each pair.
+        targets: iterable
+            The second vertex of each pair.
+
+        Returns
+        -------
+        np.ndarray
+            A boolean array with an entry per pair.
+        """
+        return self._query(sources, targets) != np.inf
+
+    def save(self, path):
+        """Saves this index to a file, such as one next to the file the
+        graph was saved to with cygraph.Graph.save. Vertices are stored by
+        their positions in graph.vertices.
+
+        Parameters
+        ----------
+        path: str or os.PathLike
+            The file to write.
+        """
+        arrays = {"ranks": self._ranks,
+                  "directed": np.array(self.directed),
+                  "in_indptr": self._in_indptr, "in_hubs": self._in_hubs,
+                  "in_distances": self._in_distances}
+        if self.directed:
+            arrays.update(out_indptr=self._out_indptr,
+                          out_hubs=self._out_hubs,
+                          out_distances=self._out_distances)
+        with open(path, "wb") as f:
+            np.savez(f, **arrays)
+
+    @staticmethod
+    def load(path, graph):
+        """Loads an index saved with LandmarkIndex.save.
+
+        Parameters
+        ----------
+        path: str or os.PathLike
+            The file to read.
+        graph: cygraph.Graph or cygraph.IntGraph
+            The graph the index was built for, whose vertices the
+            queries take.
+
+        Returns
+        -------
+        cygraph.algorithms.LandmarkIndex
+            The index.
+
+        Raises
+        ------
+        ValueError
+            The index was built for a graph with a different number of
+            vertices or directedness.
+        """
+        cdef LandmarkIndex index = LandmarkIndex()
+        with np.load(path, allow_pickle=False) as arrays:
+            index._set_state(graph.vertices if isinstance(graph, Graph)
+                             else None, {name: arrays[name]
+                                         for name in arrays.files})
+        if index.number_of_vertices != len(graph.vertices) \
+                or index.directed != graph.directed:
+            raise ValueError("The index was built for another graph.")
+        return index
+
+    def __reduce__(self):
+        state = {"ranks": self._ranks, "directed": np.array(self.directed),
+                 "in_indptr": self._in_indptr, "in_hubs": self._in_hubs,
+                 "in_distances": self._in_distances,
+                 "out_indptr": self._out_indptr, "out_hubs": self._out_hubs,
+                 "out_distances": self._out_distances}
+        return (_unpickle_landmark_index, (self._vertices, state))
+
+    def _set_state(self, vertices, dict arrays):
+        self.directed = bool(arrays["directed"])
+        self._ranks = np.ascontiguousarray(arrays["ranks"], dtype=np.int64)
+        self.number_of_vertices = len(self._ranks)
+        if vertices is not None:
+            self._vertices = list(vertices)
+            self._vertex_ints = {v: i for i, v in enumerate(self._vertices)}
+        side = "out" if self.directed else "in"
+        self._in_indptr = np.ascontiguousarray(arrays["in_indptr"],
+                                               dtype=np.int64)
+        self._in_hubs = np.ascontiguousarray(arrays["in_hubs"],
+                                             dtype=np.int32)
+        self._in_distances = np.ascontiguousarray(arrays["in_distances"],
+                                                  dtype=np.int32)
+        self._out_indptr = np.ascontiguousarray(arrays[side + "_indptr"],
+                                                dtype=np.int64)
+        self._out_hubs = np.ascontiguousarray(arrays[side + "_hubs"],
+                                              dtype=np.int32)
+        self._out_distances = np.ascontiguousarray(
+            arrays[side + "_distances"], dtype=np.int32)
+
+    cdef Py_ssize_t _get_rank(self, object vertex) except -1:
+        cdef Py_ssize_t v
+        if self._vertex_ints is not None:
+            try:
+                v = self._vertex_ints[vertex]
+            except KeyError:
+                raise ValueError(f"{vertex} is not in graph.")
+        else:
+            v = vertex
+            if not 0 <= v < self.number_of_vertices:
+                raise ValueError(f"{vertex} is not in graph.")
+        return self._ranks[v]
+
+    cdef np.ndarray _get_ranks(self, object vertices):
+        if self._vertex_ints is not None:
+            return np.array([self._get_rank(v) for v in vertices],
+                            dtype=np.int64)
+        cdef np.ndarray ints = np.array(vertices, dtype=np.int64).reshape(-1)
+        if ((ints < 0) | (ints >= self.number_of_vertices)).any():
+            raise ValueError("Every vertex must be in the graph.")
+        return self._ranks[ints]
+
+    cdef np.ndarray _query(self, object sources, object targets):
+        """Finds the distance of each pair of vertices, in parallel blocks
+        of pairs.
+        """
+        cdef np.ndarray source_ranks = self._get_ranks(sources)
+        cdef np.ndarray target_ranks = self._get_ranks(targets)
+        if len(source_ranks) != len(target_ranks):
+            raise ValueError(f"Got {len(source_ranks)} sources and "
+                             f"{len(target_ranks)} targets.")
+        cdef Py_ssize_t n_pairs = len(source_ranks)
+        cdef np.ndarray distances = np.empty(n_pairs)
+
+        def query_block(Py_ssize_t b):
+            cdef const int64_t[::1] sources_view = source_ranks
+            cdef const int64_t[::1] targets_view = target_ranks
+            cdef const int64_t[::1] out_indptr = self._out_indptr
+            cdef const int32_t[::1] out_hubs = self._out_hubs
+            cdef const int32_t[::1] out_distances = self._out_distances
+            cdef const int64_t[::1] in_indptr = self._in_indptr
+            cdef const int32_t[::1] in_hubs = self._in_hubs
+            cdef const int32_t[::1] in_distances = self._in_distances
+            cdef double[::1] distances_view = distances
+            cdef Py_ssize_t start = b * BLOCK_SIZE
+            cdef Py_ssize_t stop = min(start + BLOCK_SIZE, n_pairs)
+            with nogil:
+                _query_block(sources_view, targets_view, out_indptr,
+                    out_hubs, out_distances, in_indptr, in_hubs,
+                    in_distances, distances_view, start, stop)
+
+        map_blocks(query_block, (n_pairs + BLOCK_SIZE - 1) // BLOCK_SIZE)
+        return distances
+
+
+cdef tuple _labels_to_csr(const PairList *labels, Py_ssize_t n):
+    """Copies labels into (indptr, hubs, distances) arrays.
+    """
+    cdef np.ndarray indptr = np.zeros(n + 1, dtype=np.int64)
+    cdef int64_t[::1] indptr_view = indptr
+    cdef Py_ssize_t v, i
+    for v in range(n):
+        indptr_view[v + 1] = indptr_view[v] + labels[v].size
+    cdef np.ndarray hubs = np.empty(indptr_view[n], dtype=np.int32)
+    cdef np.ndarray distances = np.empty(indptr_view[n], dtype=np.int32)
+    cdef int32_t[::1] hubs_view = hubs
+    cdef int32_t[::1] distances_view = distances
+    with nogil:
+        for v in range(n):
+            for i in range(labels[v].size):
+                hubs_view[indptr_view[v] + i] = labels[v].items[i]
+                distances_view[indptr_view[v] + i] = labels[v].distances[i]
+    return indptr, hubs, distances
+
+
+def _unpickle_landmark_index(vertices, state):
+    cdef LandmarkIndex index = LandmarkIndex()
+    index._set_state(vertices, state)
+    return index
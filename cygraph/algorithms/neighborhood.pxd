@@ -0,0 +1,35 @@
+#!python
+#cython: language_level=3
+
+from libc.stdint cimport uint64_t
+
+cimport numpy as np
+
+from cygraph.algorithms.stats cimport ExecutionStats
+from cygraph.graph_ cimport Graph
+
+
+cdef uint64_t splitmix64(uint64_t x) noexcept nogil
+cdef dict neighborhood_function(Graph graph, int registers=*, uint64_t seed=*,
+    int max_distance=*, ExecutionStats stats=*)
+cdef np.ndarray neighborhood_sketches(Graph graph, int k=*, uint64_t seed=*)
+cdef object khop_neighbors(object graph, object seeds=*, int k=*,
+    str output=*, int registers=*, uint64_t hash_seed=*,
+    ExecutionStats stats=*)
+
+
+cdef class MinHashIndex:
+    cdef readonly list vertices
+    cdef dict _vertex_ints
+    cdef readonly Py_ssize_t bands
+    cdef readonly Py_ssize_t rows
+    cdef np.ndarray _sketches
+    cdef np.ndarray _keys
+    # Row b holds the keys of band b in sorted order, and the vertices
+    # they belong to.
+    cdef np.ndarray _sorted_keys
+    cdef np.ndarray _orders
+
+    cdef Py_ssize_t _get_vertex_int(self, object vertex) except -1
+    cpdef double similarity(self, object v1, object v2) except -1.0
+    cpdef list query(self, object v, int n=*, double threshold=*)
@@ -0,0 +1,1103 @@
+#!python
+#cython: language_level=3
+"""Functions for approximating neighborhoods of vertices with
+probabilistic sketches: how many vertices are within each distance of
+every vertex, and how similar the neighbors of two vertices are.
+"""
+
+from libc.math cimport INFINITY, M_LN2, sqrt
+from libc.stdint cimport UINT64_MAX, int32_t, int64_t, uint8_t, uint64_t
+from libc.stdlib cimport free, qsort, realloc
+
+cimport numpy as np
+import numpy as np
+from time import perf_counter
+
+from cygraph.algorithms.stats cimport Counters, ExecutionStats, STATS_ENABLED
+from cygraph.graph_ cimport Graph
+from cygraph.graph_.int_graph cimport IntGraph
+from cygraph.graph_.sparse import CSRMatrix, smallest_index_dtype
+from cygraph.parallel import map_blocks
+from cygraph.tracing import span
+
+
+# Number of vertices whose counters are updated by a single task.
+cdef Py_ssize_t BLOCK_SIZE = 4096
+# Number of seeds searched by a single task of khop_neighbors.
+cdef Py_ssize_t SEEDS_PER_BLOCK = 256
+
+
+cdef uint64_t splitmix64(uint64_t x) noexcept nogil:
+    """Scrambles the bits of a 64-bit integer (SplitMix64 finalizer).
+    """
+    x += 0x9E3779B97F4A7C15ULL
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL
+    return x ^ (x >> 31)
+
+
+cdef void _init_counters(uint8_t[:, ::1] counters, int log2_registers,
+        uint64_t seed) noexcept nogil:
+    """Adds each vertex to its own HyperLogLog counter. The first bits
+    of the hash of a vertex pick a register, and the register stores
+    one more than the number of leading zeros in the remaining bits.
+    """
+    cdef Py_ssize_t x, register
+    cdef uint64_t h
+    cdef uint8_t rank
+    seed = splitmix64(seed)
+    for x in range(counters.shape[0]):
+        h = splitmix64(seed + <uint64_t>x)
+        register = h >> (64 - log2_registers)
+        # The sentinel bit bounds the rank when the remaining bits are 0.
+        h = (h << log2_registers) | (1ULL << (log2_registers - 1))
+        rank = 1
+        while not (h >> 63):
+            h <<= 1
+            rank += 1
+        counters[x, register] = rank
+
+
+cdef bint _union_block(const int64_t[::1] indptr, const int64_t[::1] indices,
+        const uint8_t[:, ::1] counters, uint8_t[:, ::1] next_counters,
+        const uint8_t[::1] modified, uint8_t[::1] next_modified,
+        Py_ssize_t start, Py_ssize_t stop, Counters *work) noexcept nogil:
+    """Merges into the counter of each vertex in [start, stop) the
+    counters of its children, as a register-wise maximum. Children whose
+    counters did not change in the previous iteration are skipped, since
+    their counters are already contained in their parents'. The merges
+    are added to work in instrumented builds.
+
+    Returns whether or not any counter changed.
+    """
+    cdef Py_ssize_t n_registers = counters.shape[1]
+    cdef Py_ssize_t x, i, j
+    cdef const uint8_t* source
+    cdef uint8_t* destination
+    cdef uint8_t a, b, changed
+    cdef bint any_changed = False
+    for x in range(start, stop):
+        changed = 0
+        destination = &next_counters[x, 0]
+        for i in range(indptr[x], indptr[x + 1]):
+            if not modified[indices[i]]:
+                continue
+            if STATS_ENABLED:
+                work.edges_relaxed += 1
+            source = &counters[indices[i], 0]
+            # Branch-free so that the compiler can vectorize it.
+            for j in range(n_registers):
+                a = destination[j]
+                b = source[j]
+                changed |= b > a
+                destination[j] = b if b > a else a
+        next_modified[x] = changed
+        any_changed |= changed
+    if STATS_ENABLED:
+        work.vertices_settled += stop - start
+    return any_changed
+
+
+cdef double _sigma(double x) noexcept nogil:
+    """Ertl's sigma function, x + sum over k >= 1 of x^(2^k) * 2^(k - 1).
+    """
+    if x == 1.0:
+        return INFINITY
+    cdef double y = 1.0
+    cdef double z = x
+    cdef double previous = -1.0
+    while z != previous:
+        x *= x
+        previous = z
+        z += x * y
+        y += y
+    return z
+
+
+cdef double _tau(double x) noexcept nogil:
+    """Ertl's tau function, (1 - x - sum over k >= 1 of
+    (1 - x^(2^-k))^2 * 2^-k) / 3.
+    """
+    if x == 0.0 or x == 1.0:
+        return 0.0
+    cdef double y = 1.0
+    cdef double z = 1.0 - x
+    cdef double previous = -1.0
+    while z != previous:
+        x = sqrt(x)
+        previous = z
+        y *= 0.5
+        z -= (1.0 - x) * (1.0 - x) * y
+    return z / 3.0
+
+
+cdef double _estimate_counter(const uint8_t *counter, Py_ssize_t n_registers,
+        int log2_registers) noexcept nogil:
+    """Returns the size estimated by a HyperLogLog counter.
+
+    Uses the estimator from Ertl, "New cardinality estimation algorithms
+    for HyperLogLog sketches" (2017), which, unlike the original one,
+    needs no empirical bias correction between the small and large
+    ranges. That matters here, since the counters of the vertices of a
+    component converge to the same one and their errors do not average
+    out.
+    """
+    cdef double m = <double>n_registers
+    # Registers hold ranks from 0 to max_rank.
+    cdef int max_rank = 65 - log2_registers
+    cdef double histogram[66]
+    cdef double z
+    cdef Py_ssize_t j
+    cdef int k
+    for k in range(max_rank + 1):
+        histogram[k] = 0.0
+    for j in range(n_registers):
+        histogram[counter[j]] += 1.0
+
+    z = m * _tau(1.0 - histogram[max_rank] / m)
+    for k in range(max_rank - 1, 0, -1):
+        z = 0.5 * (z + histogram[k])
+    z += m * _sigma(histogram[0] / m)
+    return m * m / (2.0 * M_LN2 * z)
+
+
+cdef double _estimate_block(const uint8_t[:, ::1] counters, int log2_registers,
+        Py_ssize_t start, Py_ssize_t stop) noexcept nogil:
+    """Returns the sum of the sizes estimated by the HyperLogLog
+    counters of the vertices in [start, stop).
+    """
+    cdef double total = 0.0
+    cdef Py_ssize_t x
+    for x in range(start, stop):
+        total += _estimate_counter(&counters[x, 0], counters.shape[1],
+                                   log2_registers)
+    return total
+
+
+cdef int _log2_registers(int registers) except -1:
+    """Returns the base 2 logarithm of a number of HyperLogLog registers,
+    which must be a power of two from 16 to 65536.
+    """
+    if registers < 16 or registers > 65536 or registers & (registers - 1):
+        raise ValueError("The number of registers must be a power of two "
+                         f"from 16 to 65536, not {registers}.")
+    cdef int log2_registers = 4
+    while (1 << log2_registers) < registers:
+        log2_registers += 1
+    return log2_registers
+
+
+cdef dict neighborhood_function(Graph graph, int registers=128,
+        uint64_t seed=0, int max_distance=-1, ExecutionStats stats=None):
+    """Approximates the neighborhood function of a graph with HyperANF.
+
+    The neighborhood function N(t) is the number of ordered pairs of
+    vertices (x, y) such that y can be reached from x in at most t
+    steps. Every vertex gets a HyperLogLog counter of the vertices
+    within distance t of it, and at each iteration merges in the
+    counters of its children, so that it reaches distance t + 1.
+    Iterations run over blocks of vertices in parallel until no counter
+    changes.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph
+        A graph.
+    registers: int, optional
+        The number of registers in each counter, a power of two from 16
+        to 65536. Each counter takes this many bytes, and the relative
+        standard error of each estimate is about 1.04 / sqrt(registers).
+    seed: int, optional
+        Seeds the hash function that assigns vertices to registers.
+    max_distance: int, optional
+        Stops after this many iterations if it is not negative.
+    stats: ExecutionStats, optional
+        Statistics to fill in about the run. The frontier of an
+        iteration is the vertices whose counters changed in the previous
+        one.
+
+    Returns
+    -------
+    dict
+        "neighborhood_function": np.ndarray of N(t) for each t.
+        "distance_distribution": np.ndarray of the number of pairs at
+        each distance t, N(t) - N(t - 1).
+        "reachable_pairs": the number of pairs (x, y) with x != y and y
+        reachable from x.
+        "average_distance": the mean distance over those pairs.
+        "effective_diameter": the interpolated distance within which 90%
+        of the pairs in N(t) are.
+        "diameter_lower_bound": the last distance at which N(t) grew.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("neighborhood_function")
+    cdef double start = perf_counter()
+    cdef int log2_registers = _log2_registers(registers)
+
+    cdef np.ndarray indptr, indices
+    indptr, indices, _ = graph._get_csr()
+    cdef Py_ssize_t n_vertices = len(graph.vertices)
+    cdef Py_ssize_t n_blocks = (n_vertices + BLOCK_SIZE - 1) // BLOCK_SIZE
+
+    cdef np.ndarray counters = np.zeros((n_vertices, registers),
+                                        dtype=np.uint8)
+    cdef np.ndarray next_counters = np.empty_like(counters)
+    cdef np.ndarray modified = np.ones(n_vertices, dtype=np.uint8)
+    cdef np.ndarray next_modified = np.zeros(n_vertices, dtype=np.uint8)
+    cdef uint8_t[:, ::1] counters_view = counters
+    with nogil:
+        _init_counters(counters_view, log2_registers, seed)
+    stats.allocate(2 * counters.nbytes + 2 * modified.nbytes)
+
+    def estimate(b):
+        cdef const uint8_t[:, ::1] counters_view = counters
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        cdef Py_ssize_t stop = min(start + BLOCK_SIZE, n_vertices)
+        cdef double total
+        with nogil:
+            total = _estimate_block(counters_view, log2_registers, start, stop)
+        return total
+
+    def step(b):
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] indices_view = indices
+        cdef const uint8_t[:, ::1] counters_view = counters
+        cdef uint8_t[:, ::1] next_counters_view = next_counters
+        cdef const uint8_t[::1] modified_view = modified
+        cdef uint8_t[::1] next_modified_view = next_modified
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        cdef Py_ssize_t stop = min(start + BLOCK_SIZE, n_vertices)
+        cdef bint changed
+        cdef double total
+        cdef Counters work = Counters(0, 0, 0, 0)
+        with nogil:
+            changed = _union_block(indptr_view, indices_view, counters_view,
+                next_counters_view, modified_view, next_modified_view, start,
+                stop, &work)
+            total = _estimate_block(next_counters_view, log2_registers,
+                start, stop)
+        return changed, total, work
+
+    # Blocks are summed in order, so results do not depend on timing.
+    cdef list values = [sum(map_blocks(estimate, n_blocks))]
+    stats.add_phase("setup", start)
+    cdef list results
+    cdef int distance = 0
+    while max_distance < 0 or distance < max_distance:
+        stats.add_iteration(np.count_nonzero(modified))
+        start = perf_counter()
+        np.copyto(next_counters, counters)
+        results = map_blocks(step, n_blocks)
+        for _, _, work in results:
+            stats.add_counters(work)
+        stats.add_phase("union", start)
+        if not any([changed for changed, _, _ in results]):
+            break
+        values.append(sum([total for _, total, _ in results]))
+        counters, next_counters = next_counters, counters
+        modified, next_modified = next_modified, modified
+        distance += 1
+
+    cdef np.ndarray function = np.array(values)
+    return _get_distance_statistics(function)
+
+
+cdef dict _get_distance_statistics(np.ndarray function):
+    """Derives distance statistics from a neighborhood function.
+    """
+    cdef np.ndarray distribution = np.diff(function, prepend=0.0)
+    cdef double reachable_pairs = function[-1] - function[0]
+    cdef double average_distance = np.nan
+    if reachable_pairs > 0:
+        average_distance = float(
+            np.dot(np.arange(len(distribution)), distribution)
+            / reachable_pairs)
+
+    cdef double threshold = 0.9 * function[-1]
+    cdef Py_ssize_t t = int(np.searchsorted(function, threshold))
+    cdef double effective_diameter = 0.0
+    if t > 0:
+        effective_diameter = (t - 1 + (threshold - function[t - 1])
+                              / (function[t] - function[t - 1]))
+
+    return {
+        "neighborhood_function": function,
+        "distance_distribution": distribution,
+        "reachable_pairs": reachable_pairs,
+        "average_distance": average_distance,
+        "effective_diameter": effective_diameter,
+        "diameter_lower_bound": len(function) - 1
+    }
+
+
+def py_neighborhood_function(graph, registers=128, seed=0, max_distance=None,
+        stats=None):
+    """Approximates the neighborhood function of a graph with HyperANF.
+
+    The neighborhood function N(t) is the number of ordered pairs of
+    vertices (x, y) such that y can be reached from x in at most t
+    steps. Every vertex gets a HyperLogLog counter of the vertices
+    within distance t of it, and at each iteration merges in the
+    counters of its children, so that it reaches distance t + 1.
+    Iterations run over blocks of vertices in parallel until no counter
+    changes.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph
+        A graph.
+    registers: int, optional
+        The number of registers in each counter, a power of two from 16
+        to 65536. Each counter takes this many bytes, and the relative
+        standard error of each estimate is about 1.04 / sqrt(registers).
+    seed: int, optional
+        Seeds the hash function that assigns vertices to registers.
+    max_distance: int, optional
+        The maximum number of iterations.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the run. The frontier of an
+        iteration is the vertices whose counters changed in the previous
+        one.
+
+    Returns
+    -------
+    dict
+        "neighborhood_function": np.ndarray of N(t) for each t.
+        "distance_distribution": np.ndarray of the number of pairs at
+        each distance t, N(t) - N(t - 1).
+        "reachable_pairs": the number of pairs (x, y) with x != y and y
+        reachable from x.
+        "average_distance": the mean distance over those pairs.
+        "effective_diameter": the interpolated distance within which 90%
+        of the pairs in N(t) are.
+        "diameter_lower_bound": the last distance at which N(t) grew.
+
+    Examples
+    --------
+    >>> G = cg.graph(vertices=list(range(3)))
+    >>> G.add_edges({(0, 1), (1, 2)})
+    >>> stats = alg.neighborhood_function(G, registers=1024)
+    >>> stats["neighborhood_function"].round()
+    array([3., 7., 9.])
+    """
+    if max_distance is None:
+        max_distance = -1
+    elif max_distance < 0:
+        raise ValueError("max_distance cannot be negative.")
+    with span("neighborhood_function", "algorithm"):
+        return neighborhood_function(graph, registers, seed, max_distance,
+                                     stats)
+
+
+cdef class _SearchScratch:
+    """The arrays a thread reuses for the searches of khop_neighbors.
+    A vertex is visited in the current search if its stamp is the
+    current one, so the arrays are never cleared.
+    """
+    cdef np.ndarray stamps
+    cdef np.ndarray queue
+    cdef np.ndarray depths
+    cdef int64_t stamp
+
+    def __cinit__(self, Py_ssize_t n_vertices):
+        self.stamps = np.zeros(n_vertices, dtype=np.int64)
+        self.queue = np.empty(n_vertices, dtype=np.int64)
+        self.depths = np.empty(n_vertices, dtype=np.int32)
+        self.stamp = 0
+
+
+cdef Py_ssize_t _khop_search(const int64_t[::1] indptr,
+        const int64_t[::1] indices, int64_t source, int k,
+        int64_t[::1] stamps, int64_t stamp, int64_t[::1] queue,
+        int32_t[::1] depths, int64_t[::1] frontier_sizes,
+        Counters *counters) noexcept nogil:
+    """Searches breadth-first from a vertex up to k hops away. The
+    queue holds the visited vertices in the order they were found, and
+    each hop's frontier is a contiguous range of it. The size of the
+    frontier of hop h is added to frontier_sizes[h - 1], and the work
+    done to counters in instrumented builds.
+
+    Returns
+    -------
+    Py_ssize_t
+        The number of vertices visited, including the source.
+    """
+    cdef Py_ssize_t head = 0
+    cdef Py_ssize_t tail = 1
+    cdef Py_ssize_t frontier_end
+    cdef int64_t v, u, j
+    cdef int depth
+    stamps[source] = stamp
+    depths[source] = 0
+    queue[0] = source
+    for depth in range(1, k + 1):
+        frontier_end = tail
+        if head == frontier_end:
+            break
+        frontier_sizes[depth - 1] += frontier_end - head
+        while head < frontier_end:
+            v = queue[head]
+            head += 1
+            if STATS_ENABLED:
+                counters.edges_relaxed += indptr[v + 1] - indptr[v]
+            for j in range(indptr[v], indptr[v + 1]):
+                u = indices[j]
+                if stamps[u] != stamp:
+                    stamps[u] = stamp
+                    depths[u] = depth
+                    queue[tail] = u
+                    tail += 1
+    if STATS_ENABLED:
+        counters.vertices_settled += tail
+    return tail
+
+
+cdef int _compare_int64(const void *a, const void *b) noexcept nogil:
+    cdef int64_t x = (<const int64_t *>a)[0]
+    cdef int64_t y = (<const int64_t *>b)[0]
+    return (x > y) - (x < y)
+
+
+cdef bint _khop_members_block(const int64_t[::1] indptr,
+        const int64_t[::1] indices, const int64_t[::1] seeds, int k,
+        int64_t[::1] stamps, int64_t *stamp, int64_t[::1] queue,
+        int32_t[::1] depths, int64_t[::1] counts, int64_t **members,
+        int32_t **hops, Py_ssize_t *size, int64_t[::1] frontier_sizes,
+        Counters *counters) noexcept nogil:
+    """Appends the k-hop neighbors of each seed, in increasing order, and
+    their distances to growing buffers. Neighbors are read from the
+    stamps when they are a large part of the graph, which is faster than
+    sorting them.
+
+    Returns
+    -------
+    bint
+        False if a buffer could not grow.
+    """
+    cdef Py_ssize_t n_vertices = stamps.shape[0]
+    cdef Py_ssize_t capacity = size[0]
+    cdef Py_ssize_t i, visited, count, j
+    cdef int64_t v
+    cdef void *grown
+    for i in range(seeds.shape[0]):
+        stamp[0] += 1
+        visited = _khop_search(indptr, indices, seeds[i], k, stamps,
+                               stamp[0], queue, depths, frontier_sizes,
+                               counters)
+        count = visited - 1
+        counts[i] = count
+        if size[0] + count > capacity:
+            capacity = max(2 * capacity, size[0] + count)
+            grown = realloc(members[0], capacity * sizeof(int64_t))
+            if grown == NULL:
+                return False
+            members[0] = <int64_t *>grown
+            grown = realloc(hops[0], capacity * sizeof(int32_t))
+            if grown == NULL:
+                return False
+            hops[0] = <int32_t *>grown
+        if count * 16 > n_vertices:
+            j = size[0]
+            for v in range(n_vertices):
+                if stamps[v] == stamp[0] and v != seeds[i]:
+                    members[0][j] = v
+                    j += 1
+        else:
+            for j in range(count):
+                members[0][size[0] + j] = queue[j + 1]
+            qsort(members[0] + size[0], count, sizeof(int64_t),
+                  _compare_int64)
+        for j in range(size[0], size[0] + count):
+            hops[0][j] = depths[members[0][j]]
+        size[0] += count
+    return True
+
+
+cdef object khop_neighbors(object graph, object seeds=None, int k=2,
+        str output="count", int registers=128, uint64_t hash_seed=0,
+        ExecutionStats stats=None):
+    """Finds the vertices within k hops of each of a set of vertices, by
+    breadth-first searches over blocks of seeds in parallel, or
+    estimates how many there are with HyperLogLog counters.
+
+    Each thread keeps its search arrays from one block of seeds to the
+    next, and a search only touches the vertices it visits, so the cost
+    of a seed does not depend on the size of the graph.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph or cygraph.IntGraph
+        A graph, whose edges are followed from parent to child.
+    seeds: iterable, optional
+        The vertices to search from. Defaults to all of them.
+    k: int, optional
+        The number of hops.
+    output: str, optional
+        "count" for the number of vertices within k hops of each seed,
+        "members" for those vertices, or "approximate_count" for
+        HyperLogLog estimates of their numbers, which take time
+        proportional to k times the number of edges whatever the number
+        of seeds and the size of the neighborhoods.
+    registers: int, optional
+        The number of registers of each HyperLogLog counter, for
+        "approximate_count". See neighborhood_function.
+    hash_seed: int, optional
+        Seeds the hash function of the HyperLogLog counters.
+    stats: ExecutionStats, optional
+        Statistics to fill in about the run, with an iteration per hop.
+        The frontier of a hop is the number of vertices it expands,
+        summed over the seeds, or for "approximate_count" the vertices
+        whose counters changed in the previous hop.
+
+    Returns
+    -------
+    np.ndarray or cygraph.graph_.sparse.CSRMatrix
+        For "count", an np.int64 array of the number of vertices within
+        k hops of each seed, not counting the seed itself. For
+        "approximate_count", the same as np.float64 estimates. For
+        "members", a matrix with a row per seed, whose column indices
+        are the integers of the vertices within k hops of the seed (their
+        positions in graph.vertices) in increasing order, and whose
+        entries are their distances in hops.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("khop_neighbors")
+    cdef double start = perf_counter()
+    if output not in ("count", "members", "approximate_count"):
+        raise ValueError(f"Unknown output {output!r}. Expected one of "
+                         "count, members, approximate_count.")
+    if k < 0:
+        raise ValueError("The number of hops cannot be negative.")
+    cdef np.ndarray indptr, indices
+    cdef np.ndarray seed_array
+    cdef Py_ssize_t n_vertices
+    cdef dict vertex_ints
+    cdef object v
+    if isinstance(graph, Graph):
+        indptr, indices, _ = (<Graph>graph)._get_csr()
+        n_vertices = len(graph.vertices)
+        if seeds is None:
+            seed_array = np.arange(n_vertices, dtype=np.int64)
+        else:
+            vertex_ints = {v: i for i, v in enumerate(graph.vertices)}
+            try:
+                seed_array = np.array([vertex_ints[v] for v in seeds],
+                                      dtype=np.int64)
+            except KeyError as e:
+                raise ValueError(f"{e.args[0]} is not in graph.") from None
+    elif isinstance(graph, IntGraph):
+        indptr, indices, _ = (<IntGraph>graph)._get_csr()
+        n_vertices = len(indptr) - 1
+        seed_array = np.arange(n_vertices, dtype=np.int64) if seeds is None \
+            else np.array(seeds, dtype=np.int64).reshape(-1)
+        if ((seed_array < 0) | (seed_array >= n_vertices)).any():
+            raise ValueError("Every seed must be a vertex of the graph.")
+    else:
+        raise TypeError("k-hop neighborhoods are found in cygraph.Graph and "
+                        "cygraph.IntGraph instances, not "
+                        f"{type(graph).__name__}.")
+    indptr = np.ascontiguousarray(indptr, dtype=np.int64)
+    indices = np.ascontiguousarray(indices, dtype=np.int64)
+    cdef Py_ssize_t n_seeds = len(seed_array)
+    cdef Py_ssize_t n_blocks = (n_seeds + SEEDS_PER_BLOCK - 1) \
+        // SEEDS_PER_BLOCK
+
+    if output == "approximate_count":
+        return _approximate_khop_counts(indptr, indices, seed_array, k,
+                                        registers, hash_seed, stats, start)
+
+    cdef np.ndarray counts = np.zeros(n_seeds, dtype=np.int64)
+    # Scratch arrays are taken by a block and given back when it ends,
+    # so there are at most as many as threads.
+    cdef list scratches = []
+    stats.add_phase("setup", start)
+    start = perf_counter()
+
+    def search_block(b):
+        cdef _SearchScratch scratch
+        if scratches:
+            scratch = scratches.pop()
+        else:
+            scratch = _SearchScratch(n_vertices)
+            stats.allocate(scratch.stamps.nbytes + scratch.queue.nbytes
+                           + scratch.depths.nbytes)
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] indices_view = indices
+        cdef Py_ssize_t start = b * SEEDS_PER_BLOCK
+        cdef Py_ssize_t stop = min(start + SEEDS_PER_BLOCK, n_seeds)
+        cdef const int64_t[::1] seeds_view = seed_array[start:stop]
+        cdef int64_t[::1] counts_view = counts[start:stop]
+        cdef int64_t[::1] stamps_view = scratch.stamps
+        cdef int64_t[::1] queue_view = scratch.queue
+        cdef int32_t[::1] depths_view = scratch.depths
+        cdef int64_t *members = NULL
+        cdef int32_t *hops = NULL
+        cdef Py_ssize_t size = 0
+        cdef Py_ssize_t i
+        cdef bint grown = True
+        cdef np.ndarray frontier_sizes = np.zeros(k, dtype=np.int64)
+        cdef int64_t[::1] frontier_sizes_view = frontier_sizes
+        cdef Counters counters = Counters(0, 0, 0, 0)
+        try:
+            if output == "count":
+                with nogil:
+                    for i in range(stop - start):
+                        scratch.stamp += 1
+                        counts_view[i] = _khop_search(indptr_view,
+                            indices_view, seeds_view[i], k, stamps_view,
+                            scratch.stamp, queue_view, depths_view,
+                            frontier_sizes_view, &counters) - 1
+                return None, None, frontier_sizes, counters
+            with nogil:
+                grown = _khop_members_block(indptr_view, indices_view,
+                    seeds_view, k, stamps_view, &scratch.stamp, queue_view,
+                    depths_view, counts_view, &members, &hops, &size,
+                    frontier_sizes_view, &counters)
+            if not grown:
+                raise MemoryError()
+            if size == 0:
+                return (np.zeros(0, dtype=np.int64),
+                        np.zeros(0, dtype=np.int32), frontier_sizes,
+                        counters)
+            return (np.asarray(<int64_t[:size]>members).copy(),
+                    np.asarray(<int32_t[:size]>hops).copy(), frontier_sizes,
+                    counters)
+        finally:
+            free(members)
+            free(hops)
+            scratches.append(scratch)
+
+    cdef list blocks = map_blocks(search_block, n_blocks)
+    cdef np.ndarray frontier_sizes = np.zeros(k, dtype=np.int64)
+    for block in blocks:
+        frontier_sizes += block[2]
+        stats.add_counters(block[3])
+    cdef Py_ssize_t hop
+    for hop in range(k):
+        if frontier_sizes[hop] == 0:
+            break
+        stats.add_iteration(frontier_sizes[hop])
+    stats.add_phase("search", start)
+    if output == "count":
+        return counts
+    start = perf_counter()
+    cdef np.ndarray matrix_indptr = np.zeros(n_seeds + 1, dtype=np.int64)
+    np.cumsum(counts, out=matrix_indptr[1:])
+    cdef object index_dtype = smallest_index_dtype(n_vertices)
+    cdef object matrix
+    if not blocks:
+        matrix = CSRMatrix(np.zeros(0, dtype=np.int32),
+                           np.zeros(0, dtype=index_dtype), matrix_indptr,
+                           (n_seeds, n_vertices))
+    else:
+        matrix = CSRMatrix(np.concatenate([block[1] for block in blocks]),
+                           np.concatenate([block[0] for block in blocks])
+                           .astype(index_dtype, copy=False),
+                           matrix_indptr, (n_seeds, n_vertices))
+    stats.add_phase("assemble", start)
+    return matrix
+
+
+cdef np.ndarray _approximate_khop_counts(np.ndarray indptr,
+        np.ndarray indices, np.ndarray seeds, int k, int registers,
+        uint64_t hash_seed, ExecutionStats stats, double start):
+    """Estimates the number of vertices within k hops of each seed with
+    k HyperANF iterations (see neighborhood_function), without the
+    seeds themselves. The setup phase of `stats` began at `start`.
+    """
+    cdef int log2_registers = _log2_registers(registers)
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    cdef Py_ssize_t n_blocks = (n_vertices + BLOCK_SIZE - 1) // BLOCK_SIZE
+    cdef np.ndarray counters = np.zeros((n_vertices, registers),
+                                        dtype=np.uint8)
+    cdef np.ndarray next_counters = np.empty_like(counters)
+    cdef np.ndarray modified = np.ones(n_vertices, dtype=np.uint8)
+    cdef np.ndarray next_modified = np.zeros(n_vertices, dtype=np.uint8)
+    cdef uint8_t[:, ::1] counters_view = counters
+    with nogil:
+        _init_counters(counters_view, log2_registers, hash_seed)
+    stats.allocate(2 * counters.nbytes + 2 * modified.nbytes)
+    stats.add_phase("setup", start)
+
+    def union_block(b):
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] indices_view = indices
+        cdef const uint8_t[:, ::1] counters_view = counters
+        cdef uint8_t[:, ::1] next_counters_view = next_counters
+        cdef const uint8_t[::1] modified_view = modified
+        cdef uint8_t[::1] next_modified_view = next_modified
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        cdef Py_ssize_t stop = min(start + BLOCK_SIZE, n_vertices)
+        cdef bint changed
+        cdef Counters work = Counters(0, 0, 0, 0)
+        with nogil:
+            changed = _union_block(indptr_view, indices_view, counters_view,
+                next_counters_view, modified_view, next_modified_view, start,
+                stop, &work)
+        return changed, work
+
+    cdef int hop
+    cdef list results
+    for hop in range(k):
+        stats.add_iteration(np.count_nonzero(modified))
+        start = perf_counter()
+        np.copyto(next_counters, counters)
+        results = map_blocks(union_block, n_blocks)
+        for _, work in results:
+            stats.add_counters(work)
+        stats.add_phase("union", start)
+        if not any([changed for changed, _ in results]):
+            break
+        counters, next_counters = next_counters, counters
+        modified, next_modified = next_modified, modified
+
+    cdef np.ndarray estimates = np.empty(len(seeds))
+    cdef double[::1] estimates_view = estimates
+    cdef const int64_t[::1] seeds_view = seeds
+    counters_view = counters
+    cdef Py_ssize_t i
+    start = perf_counter()
+    with nogil:
+        for i in range(seeds_view.shape[0]):
+            estimates_view[i] = max(0.0, _estimate_counter(
+                &counters_view[seeds_view[i], 0], registers,
+                log2_registers) - 1.0)
+    stats.add_phase("estimate", start)
+    return estimates
+
+
+def py_khop_neighbors(graph, seeds=None, k=2, output="count", registers=128,
+        hash_seed=0, stats=None):
+    """Finds the vertices within k hops of each of a set of vertices, by
+    breadth-first searches over blocks of seeds in parallel, or
+    estimates how many there are with HyperLogLog counters.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph or cygraph.IntGraph
+        A graph, whose edges are followed from parent to child.
+    seeds: iterable, optional
+        The vertices to search from. Defaults to all of them.
+    k: int, optional
+        The number of hops.
+    output: str, optional
+        "count" for the number of vertices within k hops of each seed,
+        "members" for those vertices, or "approximate_count" for
+        HyperLogLog estimates of their numbers, which take time
+        proportional to k times the number of edges whatever the number
+        of seeds and the size of the neighborhoods.
+    registers: int, optional
+        The number of registers of each HyperLogLog counter, for
+        "approximate_count". See neighborhood_function.
+    hash_seed: int, optional
+        Seeds the hash function of the HyperLogLog counters.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the run, with an iteration per hop.
+        The frontier of a hop is the number of vertices it expands,
+        summed over the seeds, or for "approximate_count" the vertices
+        whose counters changed in the previous hop.
+
+    Returns
+    -------
+    np.ndarray or cygraph.graph_.sparse.CSRMatrix
+        For "count", an np.int64 array of the number of vertices within
+        k hops of each seed, not counting the seed itself. For
+        "approximate_count", the same as np.float64 estimates. For
+        "members", a matrix with a row per seed, whose column indices
+        are the integers of the vertices within k hops of the seed (their
+        positions in graph.vertices) in increasing order, and whose
+        entries are their distances in hops.
+
+    Examples
+    --------
+    >>> G = cg.graph(vertices=list(range(5)))
+    >>> G.add_edges({(0, 1), (1, 2), (2, 3), (3, 4)})
+    >>> alg.khop_neighbors(G, [0, 2], k=2)
+    array([2, 4])
+    >>> members = alg.khop_neighbors(G, [0], k=2, output="members")
+    >>> members.indices, members.data
+    (array([1, 2], dtype=int32), array([1, 2], dtype=int32))
+    """
+    with span("khop_neighbors", "algorithm"):
+        return khop_neighbors(graph, seeds, k, output, registers, hash_seed,
+                              stats)
+
+
+cdef void _hash_vertices(uint64_t[:, ::1] hashes, uint64_t seed,
+        Py_ssize_t start, Py_ssize_t stop) noexcept nogil:
+    """Fills rows [start, stop) of `hashes` with the value of each of the
+    MinHash hash functions on each vertex.
+    """
+    cdef Py_ssize_t k = hashes.shape[1]
+    cdef Py_ssize_t v, i
+    cdef uint64_t h
+    for v in range(start, stop):
+        h = splitmix64(seed ^ splitmix64(<uint64_t>v))
+        for i in range(k):
+            hashes[v, i] = splitmix64(h + <uint64_t>i)
+
+
+cdef void _sketch_block(const int64_t[::1] indptr, const int64_t[::1] indices,
+        const uint64_t[:, ::1] hashes, uint64_t[:, ::1] sketches,
+        Py_ssize_t start, Py_ssize_t stop) noexcept nogil:
+    """Sets the sketch of each vertex in [start, stop) to the
+    element-wise minimum of the hashes of its children.
+    """
+    cdef Py_ssize_t k = hashes.shape[1]
+    cdef Py_ssize_t x, i, j
+    cdef const uint64_t* source
+    cdef uint64_t* destination
+    cdef uint64_t a, b
+    for x in range(start, stop):
+        destination = &sketches[x, 0]
+        for j in range(k):
+            destination[j] = UINT64_MAX
+        for i in range(indptr[x], indptr[x + 1]):
+            source = &hashes[indices[i], 0]
+            # Branch-free so that the compiler can vectorize it.
+            for j in range(k):
+                a = destination[j]
+                b = source[j]
+                destination[j] = b if b < a else a
+
+
+cdef np.ndarray neighborhood_sketches(Graph graph, int k=64, uint64_t seed=0):
+    """Computes a MinHash sketch of the set of children of every vertex.
+
+    Entry i of a sketch is the minimum of the i-th hash function over
+    the set, so the probability that entry i of the sketches of two
+    vertices is equal is the Jaccard similarity of their sets of
+    children.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph
+        A graph.
+    k: int, optional
+        The number of hash functions, which is the length of each
+        sketch. The standard error of a similarity estimated from two
+        sketches is at most 0.5 / sqrt(k).
+    seed: int, optional
+        Seeds the hash functions.
+
+    Returns
+    -------
+    np.ndarray
+        A (number of vertices, k) array of np.uint64. Vertices without
+        children have sketches of all 2^64 - 1.
+    """
+    if k < 1:
+        raise ValueError(f"The length of a sketch must be positive, not {k}.")
+
+    cdef np.ndarray indptr, indices
+    indptr, indices, _ = graph._get_csr()
+    cdef Py_ssize_t n_vertices = len(graph.vertices)
+    cdef Py_ssize_t n_blocks = (n_vertices + BLOCK_SIZE - 1) // BLOCK_SIZE
+    cdef np.ndarray hashes = np.empty((n_vertices, k), dtype=np.uint64)
+    cdef np.ndarray sketches = np.empty((n_vertices, k), dtype=np.uint64)
+    seed = splitmix64(seed)
+
+    def hash_block(b):
+        cdef uint64_t[:, ::1] hashes_view = hashes
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        cdef Py_ssize_t stop = min(start + BLOCK_SIZE, n_vertices)
+        with nogil:
+            _hash_vertices(hashes_view, seed, start, stop)
+
+    def sketch_block(b):
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] indices_view = indices
+        cdef const uint64_t[:, ::1] hashes_view = hashes
+        cdef uint64_t[:, ::1] sketches_view = sketches
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        cdef Py_ssize_t stop = min(start + BLOCK_SIZE, n_vertices)
+        with nogil:
+            _sketch_block(indptr_view, indices_view, hashes_view,
+                sketches_view, start, stop)
+
+    map_blocks(hash_block, n_blocks)
+    map_blocks(sketch_block, n_blocks)
+    return sketches
+
+
+cdef void _band_keys(const uint64_t[:, ::1] sketches, uint64_t[:, ::1] keys,
+        Py_ssize_t rows) noexcept nogil:
+    """Hashes each band of `rows` consecutive entries of every sketch
+    into a single key.
+    """
+    cdef Py_ssize_t x, band, j
+    cdef uint64_t key
+    for x in range(sketches.shape[0]):
+        for band in range(keys.shape[1]):
+            key = <uint64_t>band
+            for j in range(band * rows, (band + 1) * rows):
+                key = splitmix64(key ^ sketches[x, j])
+            keys[x, band] = key
+
+
+cdef class MinHashIndex:
+    """A locality-sensitive hashing index for finding the vertices of a
+    graph whose sets of children are most similar to a vertex's.
+
+    The sketches of the vertices are split into bands of consecutive
+    entries. Vertices whose sketches are equal in at least one band are
+    candidates for each other, and candidates are ranked by the
+    similarity estimated from their full sketches. With b bands of r
+    entries, two vertices with Jaccard similarity s become candidates
+    with probability 1 - (1 - s^r)^b, so more bands find less similar
+    vertices at the cost of more candidates.
+
+    The vertices sharing a band with a vertex are found by binary
+    searches in sorted arrays of band keys, so queries do not scan all
+    of the vertices.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph
+        The graph the sketches were computed from.
+    sketches: np.ndarray
+        The sketches returned by neighborhood_sketches(graph, ...).
+    bands: int, optional
+        The number of bands, which must divide the length of the
+        sketches.
+
+    Examples
+    --------
+    >>> G = cg.graph(vertices=list(range(6)))
+    >>> G.add_edges({(0, 2), (0, 3), (0, 4), (1, 2), (1, 3), (1, 4), (5, 2)})
+    >>> index = alg.MinHashIndex(G, alg.neighborhood_sketches(G, k=64))
+    >>> index.query(0, n=1)
+    [(1, 1.0)]
+    """
+    def __cinit__(self, Graph graph, np.ndarray sketches, int bands=16):
+        if sketches.ndim != 2 or sketches.shape[0] != len(graph.vertices):
+            raise ValueError("There must be one sketch per vertex.")
+        if bands < 1 or sketches.shape[1] % bands:
+            raise ValueError(f"{bands} bands do not divide sketches of "
+                             f"length {sketches.shape[1]}.")
+        self.vertices = graph.vertices[:]
+        self._vertex_ints = {v: i for i, v in enumerate(self.vertices)}
+        self.bands = bands
+        self.rows = sketches.shape[1] // bands
+        self._sketches = np.ascontiguousarray(sketches, dtype=np.uint64)
+        self._keys = np.empty((len(self.vertices), bands), dtype=np.uint64)
+
+        cdef const uint64_t[:, ::1] sketches_view = self._sketches
+        cdef uint64_t[:, ::1] keys_view = self._keys
+        with nogil:
+            _band_keys(sketches_view, keys_view, self.rows)
+
+        self._orders = np.argsort(self._keys.T, axis=1, kind="stable")
+        self._sorted_keys = np.take_along_axis(self._keys.T, self._orders,
+                                               axis=1)
+
+    cpdef double similarity(self, object v1, object v2) except -1.0:
+        """Estimates the Jaccard similarity of the sets of children of
+        two vertices.
+
+        Parameters
+        ----------
+        v1
+            A vertex in the graph.
+        v2
+            A vertex in the graph.
+
+        Returns
+        -------
+        double
+            The fraction of equal entries in their sketches. 0.0 if
+            either vertex has no children.
+        """
+        cdef np.ndarray a = self._sketches[self._get_vertex_int(v1)]
+        cdef np.ndarray b = self._sketches[self._get_vertex_int(v2)]
+        if a[0] == UINT64_MAX or b[0] == UINT64_MAX:
+            return 0.0
+        return np.count_nonzero(a == b) / len(a)
+
+    cpdef list query(self, object v, int n=10, double threshold=0.0):
+        """Finds the vertices whose sets of children are most similar to
+        those of a vertex.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+        n: int, optional
+            The maximum number of vertices to return.
+        threshold: double, optional
+            The minimum estimated similarity of the returned vertices.
+
+        Returns
+        -------
+        list
+            (vertex, estimated similarity) tuples for candidate
+            vertices other than `v`, most similar first.
+        """
+        cdef Py_ssize_t u = self._get_vertex_int(v)
+        cdef np.ndarray sketch = self._sketches[u]
+        if sketch[0] == UINT64_MAX:
+            return []
+
+        cdef np.ndarray keys = self._keys[u]
+        cdef list candidates = []
+        cdef Py_ssize_t band, lo, hi
+        for band in range(self.bands):
+            lo = np.searchsorted(self._sorted_keys[band], keys[band], "left")
+            hi = np.searchsorted(self._sorted_keys[band], keys[band], "right")
+            candidates.append(self._orders[band, lo:hi])
+        cdef np.ndarray found = np.unique(np.concatenate(candidates))
+        found = found[found != u]
+
+        cdef np.ndarray similarities = np.count_nonzero(
+            self._sketches[found] == sketch, axis=1) / len(sketch)
+        cdef np.ndarray order = np.argsort(-similarities, kind="stable")[:n]
+        return [(self.vertices[found[i]], similarity) for i, similarity
+                in zip(order.tolist(), similarities[order].tolist())
+                if similarity >= threshold]
+
+    cdef Py_ssize_t _get_vertex_int(self, object vertex) except -1:
+        try:
+            return self._vertex_ints[vertex]
+        except KeyError:
+            raise ValueError(f"{vertex} is not in graph.")
+
+
+def py_neighborhood_sketches(graph, k=64, seed=0):
+    """Computes a MinHash sketch of the set of children of every vertex.
+
+    Entry i of a sketch is the minimum of the i-th hash function over
+    the set, so the probability that entry i of the sketches of two
+    vertices is equal is the Jaccard similarity of their sets of
+    children. Use cygraph.algorithms.MinHashIndex to search them.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph
+        A graph.
+    k: int, optional
+        The number of hash functions, which is the length of each
+        sketch. The standard error of a similarity estimated from two
+        sketches is at most 0.5 / sqrt(k).
+    seed: int, optional
+        Seeds the hash functions.
+
+    Returns
+    -------
+    np.ndarray
+        A (number of vertices, k) array of np.uint64. Vertices without
+        children have sketches of all 2^64 - 1.
+
+    Examples
+    --------
+    >>> G = cg.graph(vertices=list(range(3)))
+    >>> G.add_edges({(0, 1), (1, 2)})
+    >>> sketches = alg.neighborhood_sketches(G, k=16)
+    >>> sketches.shape
+    (3, 16)
+    >>> bool((sketches[0] == sketches[2]).all())
+    True
+    """
+    with span("neighborhood_sketches", "algorithm"):
+        return neighborhood_sketches(graph, k, seed)
@@ -1,7 +1,12 @@
 #!python
 #cython: language_level=3
 
+from libc.stdint cimport uint64_t
+
+from cygraph.algorithms.stats cimport ExecutionStats
 from cygraph.graph_ cimport DynamicGraph, Graph, StaticGraph
 
 
-cdef tuple partition_karger(Graph graph, bint static)
\ No newline at end of file
+cdef tuple partition_karger(Graph graph, bint static)
+cdef tuple min_cut_karger_stein(object graph, object trials=*,
+    uint64_t seed=*, object weight=*, ExecutionStats stats=*)
\ No newline at end of file
@@ -3,9 +3,24 @@
 """Functions related to graph partitioning.
 """
 
-from libc.stdlib cimport rand, srand
+from libc.math cimport ceil, log2, sqrt
+from libc.stdint cimport int64_t, uint8_t, uint64_t
+from libc.stdlib cimport calloc, free, malloc, rand, srand
+from libc.string cimport memcpy
 
+cimport numpy as np
+import numpy as np
+from time import perf_counter
+
+from cygraph.algorithms.neighborhood cimport splitmix64
+from cygraph.algorithms.stats cimport Counters, ExecutionStats, STATS_ENABLED
+from cygraph.algorithms.tasks cimport TaskScheduler, fail, free_scheduler, \
+    new_scheduler, run_scheduler, spawn
 from cygraph.graph_ cimport Graph, StaticGraph, DynamicGraph
+from cygraph.graph_.int_graph cimport IntGraph
+from cygraph.graph_.weights cimport weighted_csr
+from cygraph.parallel import get_num_threads
+from cygraph.tracing import span
 
 
 cdef extern from "time.h":
@@ -151,4 +166,413 @@ def py_partition_karger(graph, static=False):
     >>> alg.partition_karger(G)
     (<DynamicGraph; vertices=[1]; edges=set()>, <DynamicGraph; vertices=[2]; edges=set()>, {(1, 2, 1.0)})
     """
-    return partition_karger(graph, static)
+    with span("partition_karger", "algorithm"):
+        return partition_karger(graph, static)
+
+
+# The size at or below which Karger-Stein recursion stops and tries
+# every cut of the contracted graph.
+cdef int64_t BRUTE_FORCE_SIZE = 6
+# Mixed into the seed of a recursion step to derive those of its
+# contractions and subtasks.
+cdef uint64_t SEED_STEP = 0x9e3779b97f4a7c15
+
+
+# The best cut found by each worker of min_cut_karger_stein, and the
+# work it did.
+cdef struct CutResults:
+    int64_t n_vertices
+    double *weights
+    uint8_t *sides
+    Counters *counters
+
+
+# A Karger-Stein recursion step on a graph contracted to n vertices.
+cdef struct ContractionTask:
+    # The n * n matrix of weights between the contracted vertices, which
+    # the task frees unless it is shared by the trials.
+    double *matrix
+    bint owns_matrix
+    int64_t n
+    # The contracted vertex of every vertex of the input graph.
+    int64_t *labels
+    uint64_t seed
+    CutResults *results
+
+
+cdef inline double _uniform(uint64_t *state) noexcept nogil:
+    """Draws a double in [0, 1) from a splitmix64 stream.
+    """
+    state[0] = splitmix64(state[0])
+    return (state[0] >> 11) * (1.0 / 9007199254740992.0)
+
+
+cdef void _contract(const double *matrix, int64_t n, double *work,
+        int64_t *slots, double *degrees, int64_t size, uint64_t seed,
+        Counters *counters) noexcept nogil:
+    """Contracts random edges, picked with probabilities proportional to
+    their weights, until `size` vertices are left.
+
+    On return, the first `size` rows and columns of the n * n matrix
+    `work` hold the contracted graph, and slots[k] is the contracted
+    vertex that vertex k of `matrix` ended up in. Every merged vertex
+    and the matrix entries it is merged along are added to counters in
+    instrumented builds.
+    """
+    cdef uint64_t state = seed
+    cdef int64_t m = n
+    cdef int64_t i, j, k, last
+    cdef double total, r
+    memcpy(work, matrix, n * n * sizeof(double))
+    for i in range(n):
+        slots[i] = i
+        degrees[i] = 0.0
+        for k in range(n):
+            degrees[i] += work[i * n + k]
+    while m > size:
+        total = 0.0
+        for k in range(m):
+            total += degrees[k]
+        if total <= 0.0:
+            # No edges are left, so any merge keeps every cut at 0.
+            i, j = m - 2, m - 1
+        else:
+            r = _uniform(&state) * total
+            i = m - 1
+            for k in range(m):
+                r -= degrees[k]
+                if r < 0.0 and degrees[k] > 0.0:
+                    i = k
+                    break
+            while degrees[i] <= 0.0:
+                i -= 1
+            r = _uniform(&state) * degrees[i]
+            j = -1
+            for k in range(m):
+                if work[i * n + k] > 0.0:
+                    j = k
+                    r -= work[i * n + k]
+                    if r < 0.0:
+                        break
+            if j == -1:
+                # Rounding left a degree without edges.
+                degrees[i] = 0.0
+                continue
+        # Merge j into i, dropping the edges between them, and move the
+        # last vertex into the slot of j.
+        degrees[i] = max(0.0, degrees[i] + degrees[j] - 2.0 * work[i * n + j])
+        for k in range(m):
+            if k != i and k != j:
+                work[i * n + k] += work[j * n + k]
+                work[k * n + i] += work[k * n + j]
+        work[i * n + j] = 0.0
+        work[j * n + i] = 0.0
+        if STATS_ENABLED:
+            counters.vertices_settled += 1
+            counters.edges_relaxed += m
+        last = m - 1
+        if j != last:
+            for k in range(m):
+                work[j * n + k] = work[last * n + k]
+            for k in range(m):
+                work[k * n + j] = work[k * n + last]
+            work[j * n + j] = 0.0
+            degrees[j] = degrees[last]
+        for k in range(n):
+            if slots[k] == j:
+                slots[k] = i
+            if slots[k] == last:
+                slots[k] = j
+        m -= 1
+
+
+cdef void _record_cut(ContractionTask *task, const double *matrix,
+        int64_t stride, int64_t n, Py_ssize_t worker) noexcept nogil:
+    """Tries every cut of a graph of at most BRUTE_FORCE_SIZE vertices,
+    and keeps the lightest as the worker's best cut if it is lighter
+    than it, or as light with a smaller side array, so that the result
+    does not depend on which worker ran which task.
+    """
+    cdef CutResults *results = task.results
+    cdef int64_t n_vertices = results.n_vertices
+    cdef uint8_t *best = results.sides + worker * n_vertices
+    cdef uint64_t mask, best_mask = 0
+    cdef double weight, best_weight = -1.0
+    cdef int64_t a, b, v
+    cdef uint8_t side, flip
+    # The last vertex stays on side 0, so each cut is tried once.
+    for mask in range(1, (<uint64_t>1) << (n - 1)):
+        weight = 0.0
+        for a in range(n):
+            if not (mask >> a) & 1:
+                continue
+            for b in range(n):
+                if not (mask >> b) & 1:
+                    weight += matrix[a * stride + b]
+        if best_weight < 0.0 or weight < best_weight:
+            best_weight, best_mask = weight, mask
+    if best_weight > results.weights[worker]:
+        return
+    flip = (best_mask >> task.labels[0]) & 1
+    if best_weight == results.weights[worker]:
+        for v in range(n_vertices):
+            side = ((best_mask >> task.labels[v]) & 1) ^ flip
+            if side != best[v]:
+                if side > best[v]:
+                    return
+                break
+        else:
+            return
+    results.weights[worker] = best_weight
+    for v in range(n_vertices):
+        best[v] = ((best_mask >> task.labels[v]) & 1) ^ flip
+
+
+cdef void _free_contraction(ContractionTask *task) noexcept nogil:
+    if task.owns_matrix:
+        free(task.matrix)
+    free(task.labels)
+    free(task)
+
+
+cdef void _karger_stein_task(TaskScheduler *scheduler, void *data,
+        Py_ssize_t worker) noexcept nogil:
+    """Contracts a graph twice independently to about n / sqrt(2)
+    vertices and spawns a task for each contraction, or tries every cut
+    of small graphs.
+    """
+    cdef ContractionTask *task = <ContractionTask *>data
+    cdef int64_t n = task.n
+    cdef int64_t n_vertices = task.results.n_vertices
+    if n <= BRUTE_FORCE_SIZE:
+        _record_cut(task, task.matrix, n, n, worker)
+        _free_contraction(task)
+        return
+    cdef int64_t size = <int64_t>ceil(1.0 + n / sqrt(2.0))
+    cdef double *work = <double *>malloc(n * n * sizeof(double))
+    cdef int64_t *slots = <int64_t *>malloc(n * sizeof(int64_t))
+    cdef double *degrees = <double *>malloc(n * sizeof(double))
+    cdef ContractionTask *child
+    cdef int64_t c, i, v
+    if work == NULL or slots == NULL or degrees == NULL:
+        fail(scheduler)
+    else:
+        for c in range(2):
+            _contract(task.matrix, n, work, slots, degrees, size,
+                      splitmix64(task.seed ^ (SEED_STEP * (2 * c + 1))),
+                      &task.results.counters[worker])
+            child = <ContractionTask *>malloc(sizeof(ContractionTask))
+            if child == NULL:
+                fail(scheduler)
+                break
+            child.matrix = <double *>malloc(size * size * sizeof(double))
+            child.labels = <int64_t *>malloc(n_vertices * sizeof(int64_t))
+            child.owns_matrix = True
+            if child.matrix == NULL or child.labels == NULL:
+                _free_contraction(child)
+                fail(scheduler)
+                break
+            for i in range(size):
+                memcpy(child.matrix + i * size, work + i * n,
+                       size * sizeof(double))
+            for v in range(n_vertices):
+                child.labels[v] = slots[task.labels[v]]
+            child.n = size
+            child.seed = splitmix64(task.seed ^ (SEED_STEP * (2 * c + 2)))
+            child.results = task.results
+            spawn(scheduler, worker, _karger_stein_task, child)
+    free(work)
+    free(slots)
+    free(degrees)
+    _free_contraction(task)
+
+
+cdef tuple min_cut_karger_stein(object graph, object trials=None,
+        uint64_t seed=0, object weight=None, ExecutionStats stats=None):
+    """Finds a cut of minimum total weight with the Karger-Stein
+    algorithm, which repeatedly contracts random edges.
+
+    Each recursion step is a task of the work-stealing scheduler of
+    cygraph.algorithms.tasks, since the recursion trees of trials are
+    unbalanced. Every trial draws from its own random stream, so the
+    result only depends on the seed, not on the number of threads.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph or cygraph.IntGraph
+        An undirected graph with non-negative edge weights.
+    trials: int, optional
+        The number of independent recursion trees, each of which finds
+        a minimum cut with probability at least about 1 / log2(V).
+        Defaults to ceil(log2(V)) ** 2, which makes failing unlikely.
+    seed: int, optional
+        The seed of the random contractions.
+    weight: str or cygraph.WeightFunction, optional
+        The key of the edge attribute holding the weights, or a function
+        computing them. Only supported for cygraph.Graph.
+    stats: ExecutionStats, optional
+        Statistics to fill in about the run, with an iteration per level
+        of the recursion and its number of tasks as the frontier.
+
+    Returns
+    -------
+    tuple
+        The weight of the cut, and the side (0 or 1) of every vertex, in
+        the order of graph.vertices, with the first vertex on side 0.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("min_cut_karger_stein")
+    cdef double start = perf_counter()
+    cdef np.ndarray indptr, indices, weights
+    if isinstance(graph, Graph):
+        indptr, indices, weights = weighted_csr(graph, weight)
+    elif isinstance(graph, IntGraph):
+        if weight is not None:
+            raise TypeError("cygraph.IntGraph edges can only be weighted by "
+                            "their stored weights.")
+        indptr, indices, weights = (<IntGraph>graph)._get_csr()
+    else:
+        raise TypeError("Minimum cuts are found on cygraph.Graph and "
+                        "cygraph.IntGraph instances, not "
+                        f"{type(graph).__name__}.")
+    if graph.directed:
+        raise NotImplementedError("Cannot find the minimum cut of a directed "
+                                  "graph.")
+    cdef int64_t n_vertices = len(indptr) - 1
+    if n_vertices < 2:
+        raise ValueError("Inputted graph has fewer than 2 vertices.")
+    weights = np.asarray(weights, dtype=np.float64)
+    if (weights < 0).any():
+        raise ValueError("Edge weights cannot be negative.")
+    if trials is None:
+        trials = max(1, int(ceil(log2(n_vertices))) ** 2)
+    if trials < 1:
+        raise ValueError("At least one trial is needed.")
+
+    cdef np.ndarray matrix = np.zeros((n_vertices, n_vertices))
+    matrix[np.repeat(np.arange(n_vertices), np.diff(indptr)),
+           np.asarray(indices, dtype=np.int64)] = weights
+    np.fill_diagonal(matrix, 0.0)
+    cdef double[:, ::1] matrix_view = matrix
+    cdef np.ndarray identity = np.arange(n_vertices, dtype=np.int64)
+
+    cdef Py_ssize_t n_workers = get_num_threads()
+    cdef np.ndarray best_weights = np.full(n_workers, np.inf)
+    cdef np.ndarray best_sides = np.ones((n_workers, n_vertices),
+                                         dtype=np.uint8)
+    cdef double[::1] best_weights_view = best_weights
+    cdef uint8_t[:, ::1] best_sides_view = best_sides
+    cdef CutResults results
+    results.n_vertices = n_vertices
+    results.weights = &best_weights_view[0]
+    results.sides = &best_sides_view[0, 0]
+    results.counters = <Counters *>calloc(n_workers, sizeof(Counters))
+    if results.counters == NULL:
+        raise MemoryError()
+    stats.allocate(matrix.nbytes + best_weights.nbytes + best_sides.nbytes)
+    stats.add_phase("setup", start)
+    start = perf_counter()
+
+    cdef TaskScheduler *scheduler
+    cdef ContractionTask *task
+    cdef Py_ssize_t t, w
+    try:
+        scheduler = new_scheduler(n_workers)
+    except MemoryError:
+        free(results.counters)
+        raise
+    try:
+        for t in range(trials):
+            task = <ContractionTask *>malloc(sizeof(ContractionTask))
+            if task == NULL:
+                raise MemoryError()
+            task.labels = <int64_t *>malloc(n_vertices * sizeof(int64_t))
+            if task.labels == NULL:
+                free(task)
+                raise MemoryError()
+            memcpy(task.labels, <int64_t *>np.PyArray_DATA(identity),
+                   n_vertices * sizeof(int64_t))
+            # Trials share the input matrix, which they only read.
+            task.matrix = &matrix_view[0, 0]
+            task.owns_matrix = False
+            task.n = n_vertices
+            task.seed = splitmix64(seed + <uint64_t>t)
+            task.results = &results
+            spawn(scheduler, t % n_workers, _karger_stein_task, task)
+        run_scheduler(scheduler)
+    finally:
+        free_scheduler(scheduler)
+        for w in range(n_workers):
+            stats.add_counters(results.counters[w])
+        free(results.counters)
+    stats.add_phase("contraction", start)
+    # Every task above BRUTE_FORCE_SIZE vertices spawns two, so the
+    # number of tasks at each level follows from the sizes.
+    cdef int64_t size = n_vertices
+    cdef Py_ssize_t level_tasks = trials
+    while True:
+        stats.add_iteration(level_tasks)
+        if size <= BRUTE_FORCE_SIZE:
+            break
+        size = <int64_t>ceil(1.0 + size / sqrt(2.0))
+        level_tasks *= 2
+
+    # The same tie-break as the workers.
+    cdef Py_ssize_t best = 0
+    for w in range(1, n_workers):
+        if best_weights[w] < best_weights[best] or (
+                best_weights[w] == best_weights[best]
+                and tuple(best_sides[w]) < tuple(best_sides[best])):
+            best = w
+    return float(best_weights[best]), best_sides[best].astype(np.int64)
+
+
+def py_min_cut_karger_stein(graph, trials=None, seed=0, weight=None,
+        stats=None):
+    """Finds a cut of minimum total weight with the Karger-Stein
+    algorithm, which repeatedly contracts random edges, running its
+    unbalanced recursion on a work-stealing scheduler. The result is
+    the same for any number of threads.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph or cygraph.IntGraph
+        An undirected graph with non-negative edge weights.
+    trials: int, optional
+        The number of independent recursion trees, each of which finds
+        a minimum cut with probability at least about 1 / log2(V).
+        Defaults to ceil(log2(V)) ** 2, which makes failing unlikely.
+    seed: int, optional
+        The seed of the random contractions.
+    weight: str or cygraph.WeightFunction, optional
+        The key of the edge attribute holding the weights, or a function
+        computing them. Only supported for cygraph.Graph.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the run, with an iteration per level
+        of the recursion and its number of tasks as the frontier. Every
+        contracted vertex counts as a vertex settled, and the matrix
+        entries it is merged along as edges relaxed.
+
+    Returns
+    -------
+    tuple
+        The weight of the cut, and the side (0 or 1) of every vertex, in
+        the order of graph.vertices, with the first vertex on side 0.
+
+    Raises
+    ------
+    NotImplementedError
+        `graph` is directed.
+    ValueError
+        `graph` has fewer than 2 vertices or a negative edge weight.
+
+    Examples
+    --------
+    >>> G = cg.graph(vertices=list(range(4)))
+    >>> G.add_edges({(0, 1, 3.0), (1, 2, 1.0), (2, 3, 3.0), (3, 0, 1.0)})
+    >>> alg.min_cut_karger_stein(G)
+    (2.0, array([0, 0, 1, 1]))
+    """
+    with span("min_cut_karger_stein", "algorithm"):
+        return min_cut_karger_stein(graph, trials, seed, weight, stats)
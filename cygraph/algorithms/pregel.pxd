@@ -0,0 +1,33 @@
+#!python
+#cython: language_level=3
+from libc.stdint cimport int64_t
+
+cimport numpy as np
+
+from cygraph.algorithms.stats cimport ExecutionStats
+
+
+cdef class VertexProgram:
+    cdef public int64_t number_of_vertices
+
+    cdef double initial_value(self, int64_t v) noexcept nogil
+    cdef bint compute(self, int64_t v, double *value, double message,
+        bint has_message, Py_ssize_t superstep,
+        int64_t out_degree) noexcept nogil
+    cdef double message(self, int64_t v, double value, int64_t target,
+        double weight, int64_t out_degree) noexcept nogil
+    cdef double combine(self, double first, double second) noexcept nogil
+
+
+cdef class PageRankProgram(VertexProgram):
+    cdef readonly double damping
+    cdef readonly Py_ssize_t iterations
+
+
+cdef class ShortestPathProgram(VertexProgram):
+    cdef readonly int64_t source
+
+
+cdef np.ndarray run_vertex_program(VertexProgram program, object graph,
+    object weight=*, object max_supersteps=*, object n_workers=*,
+    object partition=*, object deterministic=*, ExecutionStats stats=*)
@@ -0,0 +1,512 @@
+#!python
+#cython: language_level=3
+"""A Pregel-style engine running vertex programs in bulk-synchronous
+supersteps, on worker processes that share memory.
+"""
+
+from libc.math cimport INFINITY
+from libc.stdint cimport int64_t, uint8_t, uint64_t
+
+cimport numpy as np
+import numpy as np
+from time import perf_counter
+
+from cygraph.algorithms.neighborhood cimport splitmix64
+from cygraph.algorithms.stats cimport Counters, ExecutionStats, STATS_ENABLED
+from cygraph.graph_.graph cimport Graph
+from cygraph.graph_.int_graph cimport IntGraph
+from cygraph.graph_.weights cimport weighted_csr
+from cygraph.parallel import get_num_threads, is_deterministic, \
+    run_processes, shared_array
+from cygraph.tracing import span
+
+
+cdef class VertexProgram:
+    """A vertex-centric algorithm for cygraph.algorithms.run_vertex_program,
+    which keeps a float value per vertex and exchanges float messages
+    along edges.
+
+    Subclass this in Cython and override its cdef methods, which are
+    called without the GIL, possibly in several processes at once:
+
+    - `double initial_value(self, int64_t v) noexcept nogil` gives the
+      value of vertex v before the first superstep.
+    - `bint compute(self, int64_t v, double *value, double message,
+      bint has_message, Py_ssize_t superstep, int64_t out_degree)
+      noexcept nogil` updates the value of vertex v from the combination
+      of the messages sent to it in the previous superstep, if any, and
+      returns whether v sends messages to its children in this
+      superstep. A vertex that returns False votes to halt: it is only
+      computed again once it receives a message.
+    - `double message(self, int64_t v, double value, int64_t target,
+      double weight, int64_t out_degree) noexcept nogil` gives the
+      message that v sends along its edge to target.
+    - `double combine(self, double first, double second) noexcept nogil`
+      merges two messages sent to the same vertex. It must be
+      commutative and associative. Defaults to their sum.
+
+    Vertices are numbered by their position in graph.vertices. Every
+    vertex is computed in superstep 0, and the program ends once no
+    vertex sends messages.
+
+    Attributes
+    ----------
+    number_of_vertices: int
+        The number of vertices of the graph being run on, which is set
+        before the first superstep.
+    """
+
+    cdef double initial_value(self, int64_t v) noexcept nogil:
+        return 0.0
+
+    cdef bint compute(self, int64_t v, double *value, double message,
+            bint has_message, Py_ssize_t superstep,
+            int64_t out_degree) noexcept nogil:
+        return False
+
+    cdef double message(self, int64_t v, double value, int64_t target,
+            double weight, int64_t out_degree) noexcept nogil:
+        return value
+
+    cdef double combine(self, double first, double second) noexcept nogil:
+        return first + second
+
+
+cdef class PageRankProgram(VertexProgram):
+    """Computes PageRank by power iteration, as in the Pregel paper:
+    each vertex spreads its rank evenly among its children, and the rank
+    of vertices without children is lost.
+
+    Parameters
+    ----------
+    damping: double, optional
+        The probability of following an edge rather than jumping to a
+        random vertex.
+    iterations: int, optional
+        The number of power iterations.
+    """
+
+    def __cinit__(self, double damping=0.85, Py_ssize_t iterations=30):
+        if not 0.0 <= damping <= 1.0:
+            raise ValueError("The damping factor must be between 0 and 1.")
+        if iterations < 0:
+            raise ValueError("The number of iterations cannot be negative.")
+        self.damping = damping
+        self.iterations = iterations
+
+    cdef double initial_value(self, int64_t v) noexcept nogil:
+        return 1.0 / self.number_of_vertices
+
+    cdef bint compute(self, int64_t v, double *value, double message,
+            bint has_message, Py_ssize_t superstep,
+            int64_t out_degree) noexcept nogil:
+        if superstep > 0:
+            value[0] = ((1.0 - self.damping) / self.number_of_vertices
+                        + self.damping * message)
+        return superstep < self.iterations
+
+    cdef double message(self, int64_t v, double value, int64_t target,
+            double weight, int64_t out_degree) noexcept nogil:
+        return value / out_degree
+
+
+cdef class ShortestPathProgram(VertexProgram):
+    """Computes the length of the shortest path from a source vertex to
+    every vertex with the Bellman-Ford algorithm, which allows negative
+    edge weights but not negative cycles. Unreachable vertices are at
+    distance inf.
+
+    Parameters
+    ----------
+    source: int
+        The integer of the source vertex (its position in
+        graph.vertices).
+    """
+
+    def __cinit__(self, int64_t source):
+        self.source = source
+
+    cdef double initial_value(self, int64_t v) noexcept nogil:
+        return 0.0 if v == self.source else INFINITY
+
+    cdef bint compute(self, int64_t v, double *value, double message,
+            bint has_message, Py_ssize_t superstep,
+            int64_t out_degree) noexcept nogil:
+        if superstep == 0:
+            return v == self.source
+        if has_message and message < value[0]:
+            value[0] = message
+            return True
+        return False
+
+    cdef double message(self, int64_t v, double value, int64_t target,
+            double weight, int64_t out_degree) noexcept nogil:
+        return value + weight
+
+    cdef double combine(self, double first, double second) noexcept nogil:
+        return first if first < second else second
+
+
+cdef int64_t _compute_superstep(VertexProgram program,
+        const int64_t[::1] indptr, const int64_t[::1] indices,
+        const double[::1] weights, const int64_t[::1] owned,
+        double[::1] values, const double[::1] inbox,
+        const uint8_t[::1] has_message, uint8_t[::1] active,
+        double[::1] outbox, uint8_t[::1] sent, double[::1] edge_messages,
+        uint8_t[::1] edge_sent, bint fixed_order, Py_ssize_t superstep,
+        Counters *counters) noexcept nogil:
+    """Computes the vertices of a worker that are active or have
+    messages, combining the messages they send into the worker's outbox,
+    or with fixed_order, storing them in the slots of their edges.
+    The work done is added to counters in instrumented builds.
+
+    Returns
+    -------
+    int64_t
+        The number of vertices that sent messages.
+    """
+    cdef Py_ssize_t i, j
+    cdef int64_t v, u, out_degree
+    cdef int64_t n_active = 0
+    cdef double message
+    for i in range(owned.shape[0]):
+        v = owned[i]
+        if superstep > 0 and not active[v] and not has_message[v]:
+            continue
+        out_degree = indptr[v + 1] - indptr[v]
+        active[v] = program.compute(v, &values[v], inbox[v], has_message[v],
+                                    superstep, out_degree)
+        if STATS_ENABLED:
+            counters.vertices_settled += 1
+        if not active[v]:
+            continue
+        n_active += 1
+        if STATS_ENABLED:
+            counters.edges_relaxed += out_degree
+        for j in range(indptr[v], indptr[v + 1]):
+            u = indices[j]
+            message = program.message(v, values[v], u, weights[j],
+                                      out_degree)
+            if fixed_order:
+                edge_messages[j] = message
+                edge_sent[j] = True
+            elif sent[u]:
+                outbox[u] = program.combine(outbox[u], message)
+            else:
+                outbox[u] = message
+                sent[u] = True
+    return n_active
+
+
+cdef void _gather_messages(VertexProgram program, const int64_t[::1] owned,
+        double[:, ::1] outboxes, uint8_t[:, ::1] sent, double[::1] inbox,
+        uint8_t[::1] has_message) noexcept nogil:
+    """Combines the messages that every worker sent to the vertices of a
+    worker into their inbox, and empties those outbox slots.
+    """
+    cdef Py_ssize_t i, w
+    cdef int64_t v
+    for i in range(owned.shape[0]):
+        v = owned[i]
+        has_message[v] = False
+        for w in range(outboxes.shape[0]):
+            if not sent[w, v]:
+                continue
+            if has_message[v]:
+                inbox[v] = program.combine(inbox[v], outboxes[w, v])
+            else:
+                inbox[v] = outboxes[w, v]
+                has_message[v] = True
+            sent[w, v] = False
+
+
+cdef void _gather_edge_messages(VertexProgram program,
+        const int64_t[::1] owned, const int64_t[::1] in_indptr,
+        const int64_t[::1] in_edges, double[::1] edge_messages,
+        uint8_t[::1] edge_sent, double[::1] inbox,
+        uint8_t[::1] has_message) noexcept nogil:
+    """Combines the messages sent along the edges into the vertices of a
+    worker in the order of their sources, whatever worker sent them, and
+    empties those edge slots.
+    """
+    cdef Py_ssize_t i, k
+    cdef int64_t v, j
+    for i in range(owned.shape[0]):
+        v = owned[i]
+        has_message[v] = False
+        for k in range(in_indptr[v], in_indptr[v + 1]):
+            j = in_edges[k]
+            if not edge_sent[j]:
+                continue
+            if has_message[v]:
+                inbox[v] = program.combine(inbox[v], edge_messages[j])
+            else:
+                inbox[v] = edge_messages[j]
+                has_message[v] = True
+            edge_sent[j] = False
+
+
+cdef np.ndarray _hash_partition(Py_ssize_t n_vertices, Py_ssize_t n_workers):
+    """Assigns the vertices to workers by hashing their integers.
+    """
+    cdef np.ndarray owners = np.empty(n_vertices, dtype=np.int64)
+    cdef int64_t[::1] owners_view = owners
+    cdef Py_ssize_t v
+    with nogil:
+        for v in range(n_vertices):
+            owners_view[v] = splitmix64(<uint64_t>v) % <uint64_t>n_workers
+    return owners
+
+
+cdef np.ndarray run_vertex_program(VertexProgram program, object graph,
+        object weight=None, object max_supersteps=None,
+        object n_workers=None, object partition=None,
+        object deterministic=None, ExecutionStats stats=None):
+    """Runs a vertex program on a graph in bulk-synchronous supersteps.
+
+    The vertices are divided among worker processes, which compute their
+    own vertices, combine the messages they send per target vertex into
+    an outbox in shared memory, and after a barrier gather the messages
+    sent to their own vertices from every outbox. Deterministic runs
+    instead store each message in a slot of its edge, and combine the
+    messages to a vertex in the order of their sources, so that the
+    result is the same as with a single worker.
+
+    Parameters
+    ----------
+    program: VertexProgram
+        The algorithm to run.
+    graph: cygraph.Graph or cygraph.IntGraph
+        A graph.
+    weight: str or cygraph.WeightFunction, optional
+        The key of the edge attribute holding the weights given to
+        `program`, or a function computing them. By default, the edge
+        weights are used. Only supported for cygraph.Graph.
+    max_supersteps: int, optional
+        The number of supersteps after which to stop even if vertices
+        still send messages. By default there is no limit.
+    n_workers: int, optional
+        The number of worker processes, including the calling one.
+        Defaults to the number of workers in `partition`, or else
+        cygraph.get_num_threads().
+    partition: array-like of int, optional
+        The worker of each vertex, between 0 and n_workers - 1, for
+        example to keep the communities found by a partitioner on the
+        same worker. By default vertices are spread by hashing them.
+    deterministic: bool, optional
+        Whether to combine messages in a fixed order. Defaults to
+        cygraph.is_deterministic().
+    stats: ExecutionStats, optional
+        Statistics to fill in about the run. Frontier sizes are the
+        numbers of vertices that sent messages in each superstep, and
+        phase times are those of the calling worker.
+
+    Returns
+    -------
+    np.ndarray
+        The final value of each vertex.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("run_vertex_program")
+    cdef double start = perf_counter()
+    cdef np.ndarray indptr, indices, weights
+    if isinstance(graph, Graph):
+        indptr, indices, weights = weighted_csr(graph, weight)
+    elif isinstance(graph, IntGraph):
+        if weight is not None:
+            raise TypeError("cygraph.IntGraph edges can only be weighted by "
+                            "their stored weights.")
+        indptr, indices, weights = (<IntGraph>graph)._get_csr()
+    else:
+        raise TypeError("Vertex programs run on cygraph.Graph and "
+                        "cygraph.IntGraph instances, not "
+                        f"{type(graph).__name__}.")
+    indptr = np.ascontiguousarray(indptr, dtype=np.int64)
+    indices = np.ascontiguousarray(indices, dtype=np.int64)
+    weights = np.ascontiguousarray(weights, dtype=np.float64)
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    if max_supersteps is not None and max_supersteps < 0:
+        raise ValueError("The number of supersteps cannot be negative.")
+
+    cdef np.ndarray owners
+    if partition is None:
+        if n_workers is None:
+            n_workers = get_num_threads()
+        n_workers = max(1, min(n_workers, n_vertices))
+        owners = _hash_partition(n_vertices, n_workers)
+    else:
+        owners = np.asarray(partition, dtype=np.int64)
+        if len(owners) != n_vertices:
+            raise ValueError(f"The partition has {len(owners)} entries, but "
+                             f"the graph has {n_vertices} vertices.")
+        if n_workers is None:
+            n_workers = int(owners.max()) + 1 if n_vertices else 1
+        if n_workers < 1 or ((owners < 0) | (owners >= n_workers)).any():
+            raise ValueError(f"Every vertex must be given a worker between "
+                             f"0 and {n_workers - 1}.")
+    cdef list owned = [np.flatnonzero(owners == w)
+                       for w in range(n_workers)]
+
+    if deterministic is None:
+        deterministic = is_deterministic()
+    cdef bint fixed_order = deterministic
+    # With fixed_order, messages go through edge slots instead of
+    # outboxes, and each vertex reads the slots of its incoming edges,
+    # sorted by source since the edges are.
+    cdef Py_ssize_t n_edges = len(indices)
+    cdef Py_ssize_t outbox_size = 0 if fixed_order else n_vertices
+    cdef Py_ssize_t n_slots = n_edges if fixed_order else 0
+    cdef np.ndarray in_indptr = np.zeros(n_vertices + 1, dtype=np.int64)
+    cdef np.ndarray in_edges = np.zeros(0, dtype=np.int64)
+    if fixed_order:
+        np.cumsum(np.bincount(indices, minlength=n_vertices),
+                  out=in_indptr[1:])
+        in_edges = np.argsort(indices, kind="stable").astype(np.int64)
+
+    program.number_of_vertices = n_vertices
+    cdef np.ndarray values = shared_array(n_vertices, np.float64)
+    cdef np.ndarray inbox = shared_array(n_vertices, np.float64)
+    cdef np.ndarray has_message = shared_array(n_vertices, np.uint8)
+    cdef np.ndarray active = shared_array(n_vertices, np.uint8)
+    cdef np.ndarray outboxes = shared_array((n_workers, outbox_size),
+                                            np.float64)
+    cdef np.ndarray sent = shared_array((n_workers, outbox_size), np.uint8)
+    cdef np.ndarray edge_messages = shared_array(n_slots, np.float64)
+    cdef np.ndarray edge_sent = shared_array(n_slots, np.uint8)
+    cdef np.ndarray active_counts = shared_array(n_workers, np.int64)
+    cdef np.ndarray worker_counters = shared_array((n_workers, 4), np.int64)
+    stats.allocate(inbox.nbytes + has_message.nbytes + active.nbytes
+                   + outboxes.nbytes + sent.nbytes + edge_messages.nbytes
+                   + edge_sent.nbytes + in_indptr.nbytes + in_edges.nbytes)
+    cdef double[::1] values_view = values
+    cdef int64_t v
+    with nogil:
+        for v in range(n_vertices):
+            values_view[v] = program.initial_value(v)
+
+    def work(worker, barrier):
+        cdef const int64_t[::1] indptr_view = indptr
+        cdef const int64_t[::1] indices_view = indices
+        cdef const double[::1] weights_view = weights
+        cdef const int64_t[::1] owned_view = owned[worker]
+        cdef double[::1] values_view = values
+        cdef double[::1] inbox_view = inbox
+        cdef uint8_t[::1] has_message_view = has_message
+        cdef uint8_t[::1] active_view = active
+        cdef double[:, ::1] outboxes_view = outboxes
+        cdef uint8_t[:, ::1] sent_view = sent
+        cdef double[::1] outbox_view = outboxes[worker]
+        cdef uint8_t[::1] worker_sent_view = sent[worker]
+        cdef const int64_t[::1] in_indptr_view = in_indptr
+        cdef const int64_t[::1] in_edges_view = in_edges
+        cdef double[::1] edge_messages_view = edge_messages
+        cdef uint8_t[::1] edge_sent_view = edge_sent
+        cdef Py_ssize_t superstep = 0
+        cdef int64_t n_active, total_active
+        cdef Counters counters = Counters(0, 0, 0, 0)
+        cdef double start
+        while max_supersteps is None or superstep < max_supersteps:
+            start = perf_counter()
+            with nogil:
+                n_active = _compute_superstep(program, indptr_view,
+                    indices_view, weights_view, owned_view, values_view,
+                    inbox_view, has_message_view, active_view, outbox_view,
+                    worker_sent_view, edge_messages_view, edge_sent_view,
+                    fixed_order, superstep, &counters)
+            active_counts[worker] = n_active
+            barrier.wait()
+            total_active = active_counts.sum()
+            # Forked workers fill in copies of stats, which are lost, but
+            # their phases are traced.
+            stats.add_phase("compute", start)
+            if worker == 0:
+                stats.add_iteration(total_active)
+            if total_active == 0:
+                break
+            start = perf_counter()
+            with nogil:
+                if fixed_order:
+                    _gather_edge_messages(program, owned_view,
+                        in_indptr_view, in_edges_view, edge_messages_view,
+                        edge_sent_view, inbox_view, has_message_view)
+                else:
+                    _gather_messages(program, owned_view, outboxes_view,
+                                     sent_view, inbox_view, has_message_view)
+            barrier.wait()
+            stats.add_phase("exchange", start)
+            superstep += 1
+        worker_counters[worker] = (counters.vertices_settled,
+            counters.edges_relaxed, counters.heap_pushes, counters.heap_pops)
+
+    stats.add_phase("setup", start)
+    run_processes(work, n_workers)
+    cdef Counters counters
+    for w in range(n_workers):
+        (counters.vertices_settled, counters.edges_relaxed,
+         counters.heap_pushes, counters.heap_pops) = worker_counters[w]
+        stats.add_counters(counters)
+    return values.copy()
+
+
+def py_run_vertex_program(program, graph, weight=None, max_supersteps=None,
+        n_workers=None, partition=None, deterministic=None, stats=None):
+    """Runs a vertex program on a graph in bulk-synchronous supersteps,
+    on worker processes that exchange combined messages through shared
+    memory.
+
+    Parameters
+    ----------
+    program: cygraph.algorithms.VertexProgram
+        The algorithm to run, such as a PageRankProgram or a
+        ShortestPathProgram.
+    graph: cygraph.Graph or cygraph.IntGraph
+        A graph.
+    weight: str or cygraph.WeightFunction, optional
+        The key of the edge attribute holding the weights given to
+        `program`, or a function computing them. By default, the edge
+        weights are used. Only supported for cygraph.Graph.
+    max_supersteps: int, optional
+        The number of supersteps after which to stop even if vertices
+        still send messages. By default there is no limit.
+    n_workers: int, optional
+        The number of worker processes, including the calling one.
+        Defaults to the number of workers in `partition`, or else
+        cygraph.get_num_threads(). Workers other than the calling
+        process are forked, so several workers are only supported where
+        processes can be forked.
+    partition: array-like of int, optional
+        The worker of each vertex, between 0 and n_workers - 1, for
+        example to keep the communities found by a partitioner on the
+        same worker. By default vertices are spread by hashing them.
+    deterministic: bool, optional
+        Whether to combine the messages sent to each vertex in the order
+        of their sources, so that floating-point results such as
+        PageRank sums are bit-identical whatever the number of workers
+        and the partition. This stores a message slot per edge. Defaults
+        to cygraph.is_deterministic().
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the run. Frontier sizes are the
+        numbers of vertices that sent messages in each superstep, and
+        phase times are those of the calling worker.
+
+    Returns
+    -------
+    np.ndarray
+        The final value of each vertex, in the order of graph.vertices.
+
+    Raises
+    ------
+    RuntimeError
+        A worker process failed.
+
+    Examples
+    --------
+    >>> G = cg.graph(directed=True, vertices=["a", "b", "c"])
+    >>> G.add_edges({("a", "b", 2.0), ("b", "c", 1.0), ("a", "c", 4.0)})
+    >>> alg.run_vertex_program(alg.ShortestPathProgram(0), G, n_workers=2)
+    array([0., 2., 3.])
+    """
+    with span("run_vertex_program", "algorithm"):
+        return run_vertex_program(program, graph, weight, max_supersteps,
+                                  n_workers, partition, deterministic, stats)
@@ -1,6 +1,19 @@
 #!python
 #cython: language_level=3
+from libc.stdint cimport int64_t
+
+from cygraph.algorithms.stats cimport Counters, ExecutionStats
 from cygraph.graph_ cimport DynamicGraph, Graph, StaticGraph
 
 
-cdef list get_shortest_path_dijkstra(Graph graph, object source, object target)
\ No newline at end of file
+cdef void _heap_push(double[::1] keys, int64_t[::1] values, Py_ssize_t size,
+    double key, int64_t value) noexcept nogil
+cdef void _heap_pop(double[::1] keys, int64_t[::1] values,
+    Py_ssize_t size) noexcept nogil
+cdef bint _dijkstra(const int64_t[::1] indptr, const int64_t[::1] indices,
+    const double[::1] weights, int64_t source, int64_t target,
+    double[::1] distances, int64_t[::1] previous, double[::1] heap_keys,
+    int64_t[::1] heap_values, Counters *counters) noexcept nogil
+
+cdef list get_shortest_path_dijkstra(Graph graph, object source, object target,
+    object weight=*, ExecutionStats stats=*)
\ No newline at end of file
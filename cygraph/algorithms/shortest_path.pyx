@@ -3,11 +3,113 @@
 """Functions for finding shortest paths in graphs.
 """
 
+from libc.math cimport INFINITY
+from libc.stdint cimport int64_t
+
+cimport numpy as np
+import numpy as np
+from time import perf_counter
+
+from cygraph.algorithms.stats cimport Counters, ExecutionStats, STATS_ENABLED
 from cygraph.graph_ cimport Graph, StaticGraph, DynamicGraph
+from cygraph.graph_.weights cimport weighted_csr
+from cygraph.tracing import span
+
+
+cdef void _heap_push(double[::1] keys, int64_t[::1] values, Py_ssize_t size,
+        double key, int64_t value) noexcept nogil:
+    """Adds an item to a binary min-heap of size `size`.
+    """
+    cdef Py_ssize_t i = size
+    cdef Py_ssize_t parent
+    while i > 0:
+        parent = (i - 1) // 2
+        if keys[parent] <= key:
+            break
+        keys[i] = keys[parent]
+        values[i] = values[parent]
+        i = parent
+    keys[i] = key
+    values[i] = value
+
+
+cdef void _heap_pop(double[::1] keys, int64_t[::1] values,
+        Py_ssize_t size) noexcept nogil:
+    """Removes the smallest item from a binary min-heap of size `size`.
+    """
+    cdef double key = keys[size - 1]
+    cdef int64_t value = values[size - 1]
+    cdef Py_ssize_t i = 0
+    cdef Py_ssize_t child
+    size -= 1
+    while 2 * i + 1 < size:
+        child = 2 * i + 1
+        if child + 1 < size and keys[child + 1] < keys[child]:
+            child += 1
+        if key <= keys[child]:
+            break
+        keys[i] = keys[child]
+        values[i] = values[child]
+        i = child
+    keys[i] = key
+    values[i] = value
+
+
+cdef bint _dijkstra(const int64_t[::1] indptr, const int64_t[::1] indices,
+        const double[::1] weights, int64_t source, int64_t target,
+        double[::1] distances, int64_t[::1] previous, double[::1] heap_keys,
+        int64_t[::1] heap_values, Counters *counters) noexcept nogil:
+    """Finds the shortest distances from source with Dijkstra's algorithm,
+    stopping once target is reached (never, if it is -1). Vertices enter
+    the heap again when their distance decreases, so the heap needs room
+    for every edge. The work done is added to counters in instrumented
+    builds.
+
+    Returns
+    -------
+    bint
+        Whether target is reachable from source.
+    """
+    cdef Py_ssize_t size = 1
+    cdef Py_ssize_t j
+    cdef int64_t u, v
+    cdef double distance, alternative
+    distances[source] = 0.0
+    heap_keys[0] = 0.0
+    heap_values[0] = source
+    if STATS_ENABLED:
+        counters.heap_pushes += 1
+    while size > 0:
+        distance = heap_keys[0]
+        u = heap_values[0]
+        _heap_pop(heap_keys, heap_values, size)
+        size -= 1
+        if STATS_ENABLED:
+            counters.heap_pops += 1
+        if distance > distances[u]:
+            # A stale entry.
+            continue
+        if STATS_ENABLED:
+            counters.vertices_settled += 1
+        if u == target:
+            return True
+        for j in range(indptr[u], indptr[u + 1]):
+            v = indices[j]
+            alternative = distance + weights[j]
+            if alternative < distances[v]:
+                distances[v] = alternative
+                previous[v] = u
+                _heap_push(heap_keys, heap_values, size, alternative, v)
+                size += 1
+                if STATS_ENABLED:
+                    counters.heap_pushes += 1
+        if STATS_ENABLED:
+            counters.edges_relaxed += indptr[u + 1] - indptr[u]
+    return False
 
 
 cdef list get_shortest_path_dijkstra(Graph graph, object source,
-        object target):
+        object target, object weight=None, ExecutionStats stats=None):
     """Takes a graph and finds the shortest path between two vertices in
     it using dijkstra's algorithm.
 
@@ -19,6 +121,12 @@ cdef list get_shortest_path_dijkstra(Graph graph, object source,
         One of the vertices in `graph`.
     target
         The other vertex in `graph`.
+    weight: str or cygraph.WeightFunction, optional
+        The key of an edge attribute holding the edge lengths, or a
+        function computing them. By default, the edge weights are used.
+        Lengths must not be negative.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the search.
 
     Returns
     -------
@@ -42,50 +150,60 @@ cdef list get_shortest_path_dijkstra(Graph graph, object source,
     >>> alg.get_shortest_path_dijkstra(G, 1, 2)
     [1, 2]
     """
-    cdef dict distances, previous_vertices
-    cdef set unprocessed_vertices = set()
-    # Minimum distance from target to each vertex.
-    distances = {}
-    # Maps vertices to the vertex that comes before it in the path.
-    previous_vertices = {}
-
-    for vertex in graph.vertices:
-        distances[vertex] = None
-        previous_vertices[vertex] = None
-        unprocessed_vertices.add(vertex)
-    distances[source] = 0
-
-    cdef object u ,v
-    while unprocessed_vertices != set():
-        try:
-            u = min([v for v in distances
-                    if v in unprocessed_vertices and distances[v] is not None])
-        except ValueError:
-            raise ValueError(f"There is no path in {graph!r} from"
-                             f"{source} to {target}")
-
-        unprocessed_vertices.remove(u)
-        if u == target:
-            break
-
-        for v in graph.get_children(u):
-            alternate_distance = distances[u] + graph.get_edge_weight(u, v)
-            if ((distances[v] is not None and alternate_distance < distances[v])
-                    or distances[v] is None):
-                distances[v] = alternate_distance
-                previous_vertices[v] = u
-
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("get_shortest_path_dijkstra")
+    cdef double start = perf_counter()
+    cdef Py_ssize_t s = graph._get_vertex_int(source)
+    cdef Py_ssize_t t = graph._get_vertex_int(target)
+    cdef Py_ssize_t n_vertices = len(graph.vertices)
+    cdef np.ndarray indptr, indices, weights
+    indptr, indices, weights = weighted_csr(graph, weight)
+    if (weights < 0).any():
+        raise ValueError("Dijkstra's algorithm requires non-negative edge "
+                         "weights.")
+
+    cdef double[::1] distances = np.full(n_vertices, INFINITY)
+    cdef int64_t[::1] previous = np.full(n_vertices, -1, dtype=np.int64)
+    cdef double[::1] heap_keys = np.empty(len(indices) + 1)
+    cdef int64_t[::1] heap_values = np.empty(len(indices) + 1,
+                                             dtype=np.int64)
+    cdef const int64_t[::1] indptr_view = indptr
+    cdef const int64_t[::1] indices_view = np.ascontiguousarray(
+        indices, dtype=np.int64)
+    cdef const double[::1] weights_view = np.ascontiguousarray(
+        weights, dtype=np.float64)
+    stats.allocate((distances.shape[0] + heap_keys.shape[0]) * sizeof(double)
+                   + (previous.shape[0] + heap_values.shape[0])
+                   * sizeof(int64_t))
+    stats.add_phase("setup", start)
+
+    start = perf_counter()
+    cdef Counters counters = Counters(0, 0, 0, 0)
+    cdef bint reached
+    with nogil:
+        reached = _dijkstra(indptr_view, indices_view, weights_view, s, t,
+                            distances, previous, heap_keys, heap_values,
+                            &counters)
+    stats.add_counters(counters)
+    stats.add_phase("search", start)
+    if not reached:
+        raise ValueError(f"There is no path in {graph!r} from {source} to "
+                         f"{target}")
+
+    start = perf_counter()
     cdef list sequence = []
-    u = target
-    if previous_vertices[u] is not None or u == source:
-        while u is not None:
-            sequence.insert(0, u)
-            u = previous_vertices[u]
-
+    cdef int64_t u = t
+    while u != -1:
+        sequence.append(graph.vertices[u])
+        u = previous[u]
+    sequence.reverse()
+    stats.add_phase("path", start)
     return sequence
 
 
-def py_get_shortest_path_dijkstra(graph, source, target):
+def py_get_shortest_path_dijkstra(graph, source, target, weight=None,
+        stats=None):
     """Takes a graph and finds the shortest path between two vertices in
     it using dijkstra's algorithm.
 
@@ -97,6 +215,12 @@ def py_get_shortest_path_dijkstra(graph, source, target):
         One of the vertices in `graph`.
     target
         The other vertex in `graph`.
+    weight: str or cygraph.WeightFunction, optional
+        The key of an edge attribute holding the edge lengths, or a
+        function computing them. By default, the edge weights are used.
+        Lengths must not be negative.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the search.
 
     Returns
     -------
@@ -120,4 +244,5 @@ def py_get_shortest_path_dijkstra(graph, source, target):
     >>> alg.get_shortest_path_dijkstra(G, 1, 2)
     [1, 2]
     """
-    return get_shortest_path_dijkstra(graph, source, target)
\ No newline at end of file
+    with span("get_shortest_path_dijkstra", "algorithm"):
+        return get_shortest_path_dijkstra(graph, source, target, weight, stats)
\ No newline at end of file
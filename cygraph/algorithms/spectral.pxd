@@ -0,0 +1,14 @@
+#!python
+#cython: language_level=3
+
+from libc.stdint cimport uint64_t
+
+cimport numpy as np
+
+from cygraph.algorithms.stats cimport ExecutionStats
+from cygraph.graph_ cimport Graph
+
+
+cdef np.ndarray spectral_embedding(Graph graph, int k, bint normalized=*,
+    bint drop_first=*, uint64_t seed=*, double tol=*, object weight=*,
+    ExecutionStats stats=*)
@@ -0,0 +1,355 @@
+#!python
+#cython: language_level=3
+"""Functions based on the eigenvectors of graph Laplacians.
+"""
+
+from libc.stdint cimport int64_t, uint64_t
+
+cimport numpy as np
+import numpy as np
+from time import perf_counter
+
+from cygraph.algorithms.stats cimport Counters, ExecutionStats, STATS_ENABLED
+from cygraph.graph_ cimport Graph
+from cygraph.graph_.weights cimport weighted_csr
+from cygraph.parallel import map_blocks
+from cygraph.tracing import span
+
+
+# Number of rows multiplied by a single task.
+cdef Py_ssize_t BLOCK_SIZE = 4096
+
+# The number of restarts after which the eigensolver gives up.
+cdef int MAX_RESTARTS = 1000
+
+
+cdef void _shifted_laplacian_block(const int64_t[::1] indptr,
+        const int64_t[::1] indices, const double[::1] weights,
+        const double[::1] diagonal, const double[::1] scale,
+        const double[::1] x, const double[::1] scaled_x, double[::1] y,
+        Py_ssize_t start, Py_ssize_t stop, Counters *counters) noexcept nogil:
+    """Computes rows [start, stop) of
+    y = diagonal * x + scale * (A @ (scale * x)), where A is the
+    adjacency matrix in CSR form and scaled_x is scale * x. The rows and
+    edges read are added to counters in instrumented builds.
+    """
+    cdef Py_ssize_t i, j
+    cdef double total
+    for i in range(start, stop):
+        total = 0.0
+        for j in range(indptr[i], indptr[i + 1]):
+            total += weights[j] * scaled_x[indices[j]]
+        y[i] = diagonal[i] * x[i] + scale[i] * total
+    if STATS_ENABLED:
+        counters.vertices_settled += stop - start
+        counters.edges_relaxed += indptr[stop] - indptr[start]
+
+
+cdef class _ShiftedLaplacian:
+    """The matrix shift * I - L, where L is the combinatorial or
+    normalized Laplacian of a graph. Its largest eigenvalues are the
+    shifted smallest eigenvalues of L, which are the ones that Krylov
+    methods converge to quickly.
+    """
+    cdef np.ndarray indptr, indices, weights, diagonal, scale
+    cdef readonly double shift
+    cdef Py_ssize_t n_blocks
+    # The work of every multiplication so far.
+    cdef Counters counters
+
+    def __cinit__(self, np.ndarray indptr, np.ndarray indices,
+            np.ndarray weights, bint normalized):
+        cdef Py_ssize_t n_vertices = len(indptr) - 1
+        cdef np.ndarray degrees = np.bincount(
+            np.repeat(np.arange(n_vertices), np.diff(indptr)),
+            weights=weights, minlength=n_vertices)
+        self.indptr = indptr
+        self.indices = indices
+        self.weights = weights
+        self.n_blocks = (n_vertices + BLOCK_SIZE - 1) // BLOCK_SIZE
+        self.counters = Counters(0, 0, 0, 0)
+
+        if normalized:
+            # L = I - D^-1/2 A D^-1/2, with zero rows for isolated
+            # vertices. Its eigenvalues are at most 2.
+            self.shift = 2.0
+            self.scale = np.zeros(n_vertices)
+            np.divide(1.0, np.sqrt(degrees), out=self.scale,
+                      where=degrees > 0)
+            self.diagonal = self.shift - (degrees > 0)
+        else:
+            # L = D - A. Its eigenvalues are at most twice the largest
+            # degree.
+            self.shift = max(2.0 * degrees.max(initial=0.0), 1.0)
+            self.scale = np.ones(n_vertices)
+            self.diagonal = self.shift - degrees
+
+    def __call__(self, np.ndarray x):
+        cdef np.ndarray y = np.empty_like(x)
+        cdef np.ndarray scaled_x = self.scale * x
+
+        def multiply_block(b):
+            cdef const int64_t[::1] indptr = self.indptr
+            cdef const int64_t[::1] indices = self.indices
+            cdef const double[::1] weights = self.weights
+            cdef const double[::1] diagonal = self.diagonal
+            cdef const double[::1] scale = self.scale
+            cdef const double[::1] x_view = x
+            cdef const double[::1] scaled_x_view = scaled_x
+            cdef double[::1] y_view = y
+            cdef Py_ssize_t start = b * BLOCK_SIZE
+            cdef Py_ssize_t stop = min(start + BLOCK_SIZE, len(y))
+            cdef Counters counters = Counters(0, 0, 0, 0)
+            with nogil:
+                _shifted_laplacian_block(indptr, indices, weights, diagonal,
+                    scale, x_view, scaled_x_view, y_view, start, stop,
+                    &counters)
+            return counters
+
+        cdef Counters counters
+        for counters in map_blocks(multiply_block, self.n_blocks):
+            self.counters.vertices_settled += counters.vertices_settled
+            self.counters.edges_relaxed += counters.edges_relaxed
+        return y
+
+
+cdef tuple _krylov_schur(object matrix, Py_ssize_t n, Py_ssize_t k,
+        double tol, uint64_t seed, ExecutionStats stats):
+    """Finds the k largest eigenpairs of a symmetric matrix with a
+    thick-restarted block Lanczos (Krylov-Schur) iteration with full
+    reorthogonalization.
+
+    Starting from a block of random vectors, each step multiplies one
+    basis vector by the matrix and orthogonalizes the product against
+    the whole basis (twice, for stability) to extend it. The projected
+    matrix H = V^T M V is filled in along the way. When the basis is
+    full, the Ritz pairs of H are checked, and the best ones are kept
+    as the start of the next basis. The block has k vectors, so that
+    eigenvalues of multiplicity up to k (such as the zero eigenvalue of
+    the Laplacian of a disconnected graph) are all found.
+
+    Parameters
+    ----------
+    matrix: callable
+        Multiplies a vector by the matrix, and has a `shift` attribute
+        bounding its norm.
+    n: int
+        The size of the matrix.
+    k: int
+        The number of eigenpairs.
+    tol: double
+        The largest residual norm of a converged eigenpair, relative to
+        a bound on the norm of the matrix.
+    seed: int
+        Seeds the random starting block.
+    stats: ExecutionStats
+        Statistics to add the restarts and the basis to, with the number
+        of eigenpairs not yet converged as the frontier of each restart.
+
+    Returns
+    -------
+    tuple
+        The eigenvalues in descending order and the matching
+        eigenvectors as columns of an (n, k) array.
+    """
+    cdef double norm = matrix.shift
+    cdef Py_ssize_t block = k
+    # Number of basis vectors multiplied by the matrix before a
+    # restart.
+    cdef Py_ssize_t m = 2 * k + 16
+    cdef Py_ssize_t kept = (m + k) // 2
+    cdef object random = np.random.default_rng(seed)
+    cdef np.ndarray basis, h, coefficients, correction, values, vectors
+    cdef np.ndarray residuals, w
+    cdef Py_ssize_t j, size, done, restart
+    cdef double length
+
+    if m + block >= n:
+        # The basis would span the whole space anyway.
+        h = np.column_stack([matrix(column) for column in np.eye(n)])
+        stats.allocate(h.nbytes)
+        values, vectors = np.linalg.eigh((h + h.T) / 2)
+        return values[::-1][:k], vectors[:, ::-1][:, :k]
+
+    basis = np.empty((n, m + block), order="F")
+    basis[:, :block] = np.linalg.qr(random.standard_normal((n, block)))[0]
+    h = np.zeros((m + block, m))
+    stats.allocate(basis.nbytes + h.nbytes)
+    done = 0
+    for restart in range(MAX_RESTARTS):
+        for j in range(done, m):
+            size = j + block
+            w = matrix(basis[:, j])
+            coefficients = basis[:, :size].T @ w
+            w -= basis[:, :size] @ coefficients
+            correction = basis[:, :size].T @ w
+            w -= basis[:, :size] @ correction
+            coefficients += correction
+            length = np.linalg.norm(w)
+            h[:size, j] = coefficients
+            h[size, j] = length
+            h[size + 1:, j] = 0.0
+            if length <= 1e-12 * norm:
+                # The basis spans an invariant subspace, so continue
+                # with any vector orthogonal to it.
+                h[size, j] = 0.0
+                w = random.standard_normal(n)
+                for _ in range(2):
+                    w -= basis[:, :size] @ (basis[:, :size].T @ w)
+                length = np.linalg.norm(w)
+            basis[:, size] = w / length
+
+        values, vectors = np.linalg.eigh((h[:m] + h[:m].T) / 2)
+        values = values[::-1]
+        vectors = vectors[:, ::-1]
+        # The residual of a Ritz pair lies in the span of the vectors
+        # added after the first m.
+        residuals = np.linalg.norm(h[m:] @ vectors[:, :k], axis=0)
+        stats.add_iteration(np.count_nonzero(residuals > tol * norm))
+        if (residuals <= tol * norm).all():
+            return values[:k], basis[:, :m] @ vectors[:, :k]
+
+        # Restart from the best Ritz vectors and the last block.
+        basis[:, :kept] = basis[:, :m] @ vectors[:, :kept]
+        basis[:, kept:kept + block] = basis[:, m:m + block]
+        coefficients = h[m:] @ vectors[:, :kept]
+        h[:] = 0.0
+        h[:kept, :kept] = np.diag(values[:kept])
+        h[kept:kept + block, :kept] = coefficients
+        done = kept
+
+    raise RuntimeError(f"The eigensolver did not converge after "
+                       f"{MAX_RESTARTS} restarts.")
+
+
+cdef np.ndarray spectral_embedding(Graph graph, int k,
+        bint normalized=True, bint drop_first=True, uint64_t seed=0,
+        double tol=1e-8, object weight=None, ExecutionStats stats=None):
+    """Embeds the vertices of a graph in k dimensions using the
+    eigenvectors of the smallest eigenvalues of its Laplacian.
+
+    The Laplacian is never formed as a dense matrix: the eigensolver
+    only multiplies vectors by it, using the graph's sparse rows in
+    parallel.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph
+        An undirected graph. Edge weights are used.
+    k: int
+        The number of dimensions.
+    normalized: bint, optional
+        Whether to use the normalized Laplacian
+        I - D^-1/2 A D^-1/2 or the combinatorial Laplacian D - A.
+    drop_first: bint, optional
+        Whether to leave out the eigenvector of the smallest eigenvalue,
+        which is 0 and carries no information for a connected graph.
+    seed: int, optional
+        Seeds the eigensolver's starting vectors.
+    tol: double, optional
+        The tolerance of the eigensolver.
+    weight: str or cygraph.WeightFunction, optional
+        The key of an edge attribute to use as the edge weights, or a
+        function computing them. By default, the edge weights are used.
+    stats: ExecutionStats, optional
+        Statistics to fill in about the run, with an iteration per
+        restart of the eigensolver.
+
+    Returns
+    -------
+    np.ndarray
+        A (number of vertices, k) array whose columns are unit
+        eigenvectors of the Laplacian, by increasing eigenvalue. The
+        sign of each one is chosen so that its entry of largest
+        magnitude is positive.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("spectral_embedding")
+    cdef double start = perf_counter()
+    if graph.directed:
+        raise NotImplementedError("Spectral embedding is not implemented "
+                                  "for directed graphs.")
+    cdef Py_ssize_t n_vertices = len(graph.vertices)
+    cdef Py_ssize_t n_vectors = k + drop_first
+    if k < 1 or n_vectors > n_vertices:
+        raise ValueError(f"Cannot embed {n_vertices} vertices in {k} "
+                         "dimensions.")
+
+    cdef np.ndarray indptr, indices, weights
+    indptr, indices, weights = weighted_csr(graph, weight)
+    cdef _ShiftedLaplacian matrix = _ShiftedLaplacian(indptr, indices,
+                                                      weights, normalized)
+    stats.allocate(matrix.diagonal.nbytes + matrix.scale.nbytes)
+    stats.add_phase("setup", start)
+    start = perf_counter()
+    cdef np.ndarray vectors
+    try:
+        _, vectors = _krylov_schur(matrix, n_vertices, n_vectors, tol, seed,
+                                   stats)
+    finally:
+        stats.add_counters(matrix.counters)
+        stats.add_phase("eigensolver", start)
+    vectors = vectors[:, drop_first:]
+
+    cdef np.ndarray largest = np.abs(vectors).argmax(axis=0)
+    vectors *= np.sign(vectors[largest, np.arange(k)])
+    return vectors
+
+
+def py_spectral_embedding(graph, k, normalized=True, drop_first=True, seed=0,
+        tol=1e-8, weight=None, stats=None):
+    """Embeds the vertices of a graph in k dimensions using the
+    eigenvectors of the smallest eigenvalues of its Laplacian.
+
+    The Laplacian is never formed as a dense matrix: the eigensolver
+    (a thick-restarted block Lanczos iteration with full
+    reorthogonalization) only multiplies vectors by it, using the
+    graph's sparse rows in parallel.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph
+        An undirected graph. Edge weights are used.
+    k: int
+        The number of dimensions.
+    normalized: bint, optional
+        Whether to use the normalized Laplacian
+        I - D^-1/2 A D^-1/2 or the combinatorial Laplacian D - A.
+    drop_first: bint, optional
+        Whether to leave out the eigenvector of the smallest eigenvalue,
+        which is 0 and carries no information for a connected graph.
+    seed: int, optional
+        Seeds the eigensolver's starting vectors.
+    tol: double, optional
+        The tolerance of the eigensolver.
+    weight: str or cygraph.WeightFunction, optional
+        The key of an edge attribute to use as the edge weights, or a
+        function computing them. By default, the edge weights are used.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the run, with an iteration per
+        restart of the eigensolver and the number of eigenvectors not
+        yet converged as its frontier. Every row of the Laplacian
+        multiplied counts as a vertex settled.
+
+    Returns
+    -------
+    np.ndarray
+        A (number of vertices, k) array whose columns are unit
+        eigenvectors of the Laplacian, by increasing eigenvalue. The
+        sign of each one is chosen so that its entry of largest
+        magnitude is positive.
+
+    Examples
+    --------
+    >>> G = cg.graph(vertices=list(range(4)))
+    >>> G.add_edges({(0, 1), (1, 2), (2, 3)})
+    >>> alg.spectral_embedding(G, 1, normalized=False).round(3)
+    array([[ 0.653],
+           [ 0.271],
+           [-0.271],
+           [-0.653]])
+    """
+    with span("spectral_embedding", "algorithm"):
+        return spectral_embedding(graph, k, normalized, drop_first, seed, tol,
+                                  weight, stats)
@@ -0,0 +1,43 @@
+#!python
+#cython: language_level=3
+from libc.stdint cimport int64_t
+
+
+cdef extern from *:
+    """
+    #ifndef CYGRAPH_STATS
+    #define CYGRAPH_STATS 0
+    #endif
+    """
+    # Whether the counters of the nogil kernels are compiled in, which
+    # is set by building with the environment variable CYGRAPH_STATS=1.
+    # Kernels test it before every increment, so that the C compiler
+    # removes the counting from the default build.
+    const bint STATS_ENABLED "CYGRAPH_STATS"
+
+
+# Counts of the work done by a nogil kernel. Each thread or process
+# counts into its own Counters, which are then added to an
+# ExecutionStats.
+cdef struct Counters:
+    int64_t vertices_settled
+    int64_t edges_relaxed
+    int64_t heap_pushes
+    int64_t heap_pops
+
+
+cdef class ExecutionStats:
+    cdef readonly str algorithm
+    cdef Counters _counters
+    cdef readonly Py_ssize_t iterations
+    cdef readonly list frontier_sizes
+    cdef readonly dict phase_times
+    cdef readonly Py_ssize_t peak_scratch_bytes
+    cdef Py_ssize_t _scratch_bytes
+
+    cdef void begin(self, str algorithm)
+    cdef void add_counters(self, Counters counters)
+    cdef void add_phase(self, str phase, double start)
+    cdef void add_iteration(self, Py_ssize_t frontier_size)
+    cdef void allocate(self, Py_ssize_t nbytes)
+    cdef void release(self, Py_ssize_t nbytes)
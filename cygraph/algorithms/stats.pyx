@@ -0,0 +1,156 @@
+#!python
+#cython: language_level=3
+"""Statistics about the work done by a run of an algorithm.
+"""
+
+from libc.string cimport memset
+from time import perf_counter
+
+from cygraph import tracing
+
+
+cdef class ExecutionStats:
+    """Records how an algorithm ran, for finding out why a call was slow.
+    Pass an instance as the `stats` argument of an algorithm that
+    supports it; it is reset and then filled in by the call.
+
+    Phase times, iterations, frontier sizes and scratch memory are
+    always recorded. The counts of vertices settled, edges relaxed and
+    heap operations are only kept by an instrumented build of cygraph
+    (built with the environment variable CYGRAPH_STATS=1), so that the
+    default build pays nothing for them; otherwise they stay 0.
+
+    Attributes
+    ----------
+    algorithm: str
+        The name of the algorithm that filled these statistics in, or
+        None.
+    vertices_settled: int
+        The number of vertices whose distance was settled by a search,
+        or whose value was computed by an iterative algorithm, counting
+        every iteration.
+    edges_relaxed: int
+        The number of edges looked at by a search, or along which an
+        iterative algorithm gathered values or sent messages.
+    heap_pushes, heap_pops: int
+        The number of priority queue operations.
+    iterations: int
+        The number of iterations or supersteps run.
+    frontier_sizes: list
+        The number of active vertices in each iteration.
+    phase_times: dict
+        The wall time in seconds spent in each phase of the algorithm.
+        Phases are also recorded by cygraph.tracing when it is on.
+    peak_scratch_bytes: int
+        The largest amount of memory held at once by the arrays that the
+        algorithm allocated for its own use, excluding the graph and the
+        result.
+    instrumented: bint
+        Whether the counters are compiled in.
+
+    Examples
+    --------
+    >>> G = cg.graph(vertices=list(range(3)))
+    >>> G.add_edges({(0, 1), (1, 2)})
+    >>> stats = alg.ExecutionStats()
+    >>> alg.get_shortest_path_dijkstra(G, 0, 2, stats=stats)
+    [0, 1, 2]
+    >>> sorted(stats.phase_times)
+    ['path', 'search', 'setup']
+    """
+
+    def __cinit__(self):
+        self.begin(None)
+
+    def __repr__(self):
+        return (f"<{self.__class__.__name__}; algorithm={self.algorithm!r}; "
+                f"iterations={self.iterations}; "
+                f"vertices_settled={self.vertices_settled}; "
+                f"edges_relaxed={self.edges_relaxed}>")
+
+    @property
+    def vertices_settled(self):
+        return self._counters.vertices_settled
+
+    @property
+    def edges_relaxed(self):
+        return self._counters.edges_relaxed
+
+    @property
+    def heap_pushes(self):
+        return self._counters.heap_pushes
+
+    @property
+    def heap_pops(self):
+        return self._counters.heap_pops
+
+    @property
+    def instrumented(self):
+        return STATS_ENABLED
+
+    def as_dict(self):
+        """Returns the statistics as a dictionary.
+
+        Returns
+        -------
+        dict
+            The attributes of these statistics.
+        """
+        return {
+            "algorithm": self.algorithm,
+            "vertices_settled": self.vertices_settled,
+            "edges_relaxed": self.edges_relaxed,
+            "heap_pushes": self.heap_pushes,
+            "heap_pops": self.heap_pops,
+            "iterations": self.iterations,
+            "frontier_sizes": list(self.frontier_sizes),
+            "phase_times": dict(self.phase_times),
+            "peak_scratch_bytes": self.peak_scratch_bytes,
+            "instrumented": self.instrumented
+        }
+
+    cdef void begin(self, str algorithm):
+        """Clears the statistics for a run of an algorithm.
+        """
+        self.algorithm = algorithm
+        memset(&self._counters, 0, sizeof(Counters))
+        self.iterations = 0
+        self.frontier_sizes = []
+        self.phase_times = {}
+        self.peak_scratch_bytes = 0
+        self._scratch_bytes = 0
+
+    cdef void add_counters(self, Counters counters):
+        """Adds the counts of a kernel.
+        """
+        self._counters.vertices_settled += counters.vertices_settled
+        self._counters.edges_relaxed += counters.edges_relaxed
+        self._counters.heap_pushes += counters.heap_pushes
+        self._counters.heap_pops += counters.heap_pops
+
+    cdef void add_phase(self, str phase, double start):
+        """Adds the wall time from start, as given by time.perf_counter,
+        to now to a phase, and records the phase when tracing.
+        """
+        cdef double end = perf_counter()
+        self.phase_times[phase] = (self.phase_times.get(phase, 0.0)
+                                   + end - start)
+        tracing.record(phase, "phase", start, end, algorithm=self.algorithm)
+
+    cdef void add_iteration(self, Py_ssize_t frontier_size):
+        """Records an iteration with a frontier of the given size.
+        """
+        self.iterations += 1
+        self.frontier_sizes.append(frontier_size)
+
+    cdef void allocate(self, Py_ssize_t nbytes):
+        """Records scratch memory being allocated.
+        """
+        self._scratch_bytes += nbytes
+        if self._scratch_bytes > self.peak_scratch_bytes:
+            self.peak_scratch_bytes = self._scratch_bytes
+
+    cdef void release(self, Py_ssize_t nbytes):
+        """Records scratch memory being freed.
+        """
+        self._scratch_bytes -= nbytes
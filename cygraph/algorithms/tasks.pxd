@@ -0,0 +1,42 @@
+#!python
+#cython: language_level=3
+from cpython.pythread cimport PyThread_type_lock
+
+
+# The work of a task, called without the GIL with the data it was
+# spawned with and the number of the worker running it, which it passes
+# to spawn for its own subtasks. It owns `data` and must free it.
+ctypedef void (*task_function)(TaskScheduler *scheduler, void *data,
+                               Py_ssize_t worker) noexcept nogil
+
+
+cdef struct Task:
+    task_function function
+    void *data
+
+
+# A ring buffer of tasks, which its worker pushes and pops at the back,
+# and other workers steal from at the front.
+cdef struct TaskDeque:
+    PyThread_type_lock lock
+    Task *tasks
+    Py_ssize_t front
+    Py_ssize_t size
+    Py_ssize_t capacity
+
+
+cdef struct TaskScheduler:
+    TaskDeque *deques
+    Py_ssize_t n_workers
+    # The number of tasks spawned but not finished, updated atomically.
+    Py_ssize_t pending
+    # Set by tasks that failed to allocate memory.
+    int failed
+
+
+cdef TaskScheduler *new_scheduler(Py_ssize_t n_workers) except NULL
+cdef void free_scheduler(TaskScheduler *scheduler) noexcept
+cdef void spawn(TaskScheduler *scheduler, Py_ssize_t worker,
+    task_function function, void *data) noexcept nogil
+cdef void fail(TaskScheduler *scheduler) noexcept nogil
+cdef int run_scheduler(TaskScheduler *scheduler) except -1
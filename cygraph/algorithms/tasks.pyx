@@ -0,0 +1,240 @@
+#!python
+#cython: language_level=3
+"""A work-stealing task runtime for recursive nogil algorithms whose
+subproblems are too unbalanced to split into blocks up front.
+
+A task is a function pointer and a pointer to its data, such as a
+malloc'd struct. Every worker runs tasks from the back of its own deque,
+depth first, and when it runs out steals from the front of the deque of
+another worker, where the oldest and usually largest tasks are. Tasks
+spawn their subtasks onto the deque of the worker running them.
+
+Examples
+--------
+An algorithm module creates a scheduler, spawns its root tasks and runs
+them on the threads of cygraph.parallel.map_blocks:
+
+    scheduler = new_scheduler(get_num_threads())
+    try:
+        spawn(scheduler, 0, _search_task, root_data)
+        run_scheduler(scheduler)
+    finally:
+        free_scheduler(scheduler)
+"""
+
+from cpython.pythread cimport PyThread_acquire_lock, \
+    PyThread_allocate_lock, PyThread_free_lock, PyThread_release_lock, \
+    WAIT_LOCK
+from libc.stdint cimport uint64_t
+from libc.stdlib cimport calloc, free, malloc, realloc
+
+from cygraph.algorithms.neighborhood cimport splitmix64
+from cygraph.parallel import map_blocks
+
+
+cdef extern from *:
+    """
+    #include <sched.h>
+
+    static inline Py_ssize_t cygraph_atomic_add(Py_ssize_t *value,
+                                                Py_ssize_t delta) {
+        return __atomic_add_fetch(value, delta, __ATOMIC_SEQ_CST);
+    }
+
+    static inline Py_ssize_t cygraph_atomic_load(Py_ssize_t *value) {
+        return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+    }
+
+    static inline void cygraph_atomic_store_int(int *value, int new_value) {
+        __atomic_store_n(value, new_value, __ATOMIC_SEQ_CST);
+    }
+    """
+    Py_ssize_t atomic_add "cygraph_atomic_add"(Py_ssize_t *value,
+        Py_ssize_t delta) nogil
+    Py_ssize_t atomic_load "cygraph_atomic_load"(Py_ssize_t *value) nogil
+    void atomic_store_int "cygraph_atomic_store_int"(int *value,
+        int new_value) nogil
+    int sched_yield() nogil
+
+
+# The number of tasks a deque holds before it grows.
+cdef Py_ssize_t INITIAL_CAPACITY = 64
+
+
+cdef TaskScheduler *new_scheduler(Py_ssize_t n_workers) except NULL:
+    """Creates a scheduler with a deque per worker.
+
+    Parameters
+    ----------
+    n_workers: Py_ssize_t
+        The number of workers, which is at least 1.
+
+    Returns
+    -------
+    TaskScheduler *
+        The scheduler, to free with free_scheduler.
+    """
+    if n_workers < 1:
+        raise ValueError("A scheduler needs at least one worker.")
+    cdef TaskScheduler *scheduler = <TaskScheduler *>calloc(1,
+        sizeof(TaskScheduler))
+    if scheduler == NULL:
+        raise MemoryError()
+    scheduler.deques = <TaskDeque *>calloc(n_workers, sizeof(TaskDeque))
+    if scheduler.deques == NULL:
+        free(scheduler)
+        raise MemoryError()
+    scheduler.n_workers = n_workers
+    cdef Py_ssize_t w
+    for w in range(n_workers):
+        scheduler.deques[w].lock = PyThread_allocate_lock()
+        scheduler.deques[w].tasks = <Task *>malloc(
+            INITIAL_CAPACITY * sizeof(Task))
+        scheduler.deques[w].capacity = INITIAL_CAPACITY
+        if scheduler.deques[w].lock == NULL \
+                or scheduler.deques[w].tasks == NULL:
+            free_scheduler(scheduler)
+            raise MemoryError()
+    return scheduler
+
+
+cdef void free_scheduler(TaskScheduler *scheduler) noexcept:
+    """Frees a scheduler. Tasks that never ran are dropped without
+    freeing their data, which only happens if run_scheduler failed.
+    """
+    cdef Py_ssize_t w
+    for w in range(scheduler.n_workers):
+        if scheduler.deques[w].lock != NULL:
+            PyThread_free_lock(scheduler.deques[w].lock)
+        free(scheduler.deques[w].tasks)
+    free(scheduler.deques)
+    free(scheduler)
+
+
+cdef void spawn(TaskScheduler *scheduler, Py_ssize_t worker,
+        task_function function, void *data) noexcept nogil:
+    """Adds a task to the back of the deque of a worker. If the deque
+    cannot grow, the task is run right away instead.
+
+    Parameters
+    ----------
+    scheduler: TaskScheduler *
+        The scheduler.
+    worker: Py_ssize_t
+        The worker spawning the task, or any worker for root tasks
+        spawned before run_scheduler.
+    function: task_function
+        The work of the task.
+    data: void *
+        What to call `function` with.
+    """
+    cdef TaskDeque *deque = &scheduler.deques[worker]
+    cdef Task *tasks
+    cdef Py_ssize_t i
+    cdef bint queued = True
+    atomic_add(&scheduler.pending, 1)
+    PyThread_acquire_lock(deque.lock, WAIT_LOCK)
+    if deque.size == deque.capacity:
+        tasks = <Task *>realloc(deque.tasks,
+                                2 * deque.capacity * sizeof(Task))
+        if tasks == NULL:
+            queued = False
+        else:
+            # Unwrap the ring buffer into the new half.
+            for i in range(deque.front):
+                tasks[deque.capacity + i] = tasks[i]
+            deque.tasks = tasks
+            deque.capacity *= 2
+    if queued:
+        i = (deque.front + deque.size) % deque.capacity
+        deque.tasks[i].function = function
+        deque.tasks[i].data = data
+        deque.size += 1
+    PyThread_release_lock(deque.lock)
+    if not queued:
+        function(scheduler, data, worker)
+        atomic_add(&scheduler.pending, -1)
+
+
+cdef void fail(TaskScheduler *scheduler) noexcept nogil:
+    """Marks a scheduler as failed to allocate memory, so that
+    run_scheduler raises a MemoryError once its tasks are done.
+    """
+    atomic_store_int(&scheduler.failed, 1)
+
+
+cdef bint _pop(TaskDeque *deque, Task *task) noexcept nogil:
+    """Takes the newest task of a deque, for its own worker.
+    """
+    cdef bint found = False
+    PyThread_acquire_lock(deque.lock, WAIT_LOCK)
+    if deque.size:
+        deque.size -= 1
+        task[0] = deque.tasks[(deque.front + deque.size) % deque.capacity]
+        found = True
+    PyThread_release_lock(deque.lock)
+    return found
+
+
+cdef bint _steal(TaskDeque *deque, Task *task) noexcept nogil:
+    """Takes the oldest task of a deque, for another worker.
+    """
+    cdef bint found = False
+    PyThread_acquire_lock(deque.lock, WAIT_LOCK)
+    if deque.size:
+        task[0] = deque.tasks[deque.front]
+        deque.front = (deque.front + 1) % deque.capacity
+        deque.size -= 1
+        found = True
+    PyThread_release_lock(deque.lock)
+    return found
+
+
+cdef void _work(TaskScheduler *scheduler, Py_ssize_t worker) noexcept nogil:
+    """Runs tasks as a worker until every spawned task has finished.
+    """
+    cdef Task task
+    cdef uint64_t state = splitmix64(<uint64_t>worker)
+    cdef Py_ssize_t i, victim
+    cdef bint found
+    while True:
+        found = _pop(&scheduler.deques[worker], &task)
+        if not found and scheduler.n_workers > 1:
+            # Try every other worker, from a random one.
+            state = splitmix64(state)
+            victim = state % scheduler.n_workers
+            for i in range(scheduler.n_workers):
+                if victim != worker \
+                        and _steal(&scheduler.deques[victim], &task):
+                    found = True
+                    break
+                victim = (victim + 1) % scheduler.n_workers
+        if found:
+            task.function(scheduler, task.data, worker)
+            # Subtasks were counted when spawned, so pending only reaches
+            # 0 once no task can spawn more.
+            atomic_add(&scheduler.pending, -1)
+        elif atomic_load(&scheduler.pending) == 0:
+            return
+        else:
+            sched_yield()
+
+
+cdef int run_scheduler(TaskScheduler *scheduler) except -1:
+    """Runs the spawned tasks and all of their subtasks on the threads of
+    cygraph.parallel.map_blocks, one worker per thread, and returns once
+    they have all finished.
+
+    Raises
+    ------
+    MemoryError
+        A task could not allocate memory.
+    """
+    def work(Py_ssize_t worker):
+        with nogil:
+            _work(scheduler, worker)
+
+    map_blocks(work, scheduler.n_workers)
+    if scheduler.failed:
+        raise MemoryError()
+    return 0
@@ -0,0 +1,12 @@
+#!python
+#cython: language_level=3
+
+from cygraph.algorithms.stats cimport ExecutionStats
+from cygraph.graph_.temporal_graph cimport TemporalGraph
+
+
+cdef dict get_earliest_arrival_times(TemporalGraph graph, object source,
+    double start=*, double end=*, ExecutionStats stats=*)
+cdef bint is_temporally_reachable(TemporalGraph graph, object source,
+    object target, double start=*, double end=*,
+    ExecutionStats stats=*) except *
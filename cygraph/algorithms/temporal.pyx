@@ -0,0 +1,299 @@
+#!python
+#cython: language_level=3
+"""Functions for finding time-respecting paths in temporal graphs.
+"""
+
+from libc.math cimport INFINITY
+
+cimport numpy as np
+import numpy as np
+from time import perf_counter
+
+from cygraph.algorithms.stats cimport Counters, ExecutionStats, STATS_ENABLED
+from cygraph.graph_.temporal_graph cimport TemporalGraph, lower_bound
+from cygraph.tracing import span
+
+
+cdef void _heap_push(double[::1] keys, np.int64_t[::1] values,
+        Py_ssize_t* size, double key, np.int64_t value) noexcept nogil:
+    """Pushes a value onto a binary min-heap stored in two arrays.
+    """
+    cdef Py_ssize_t i = size[0]
+    cdef Py_ssize_t parent
+    size[0] += 1
+    while i > 0:
+        parent = (i - 1) // 2
+        if keys[parent] <= key:
+            break
+        keys[i] = keys[parent]
+        values[i] = values[parent]
+        i = parent
+    keys[i] = key
+    values[i] = value
+
+
+cdef void _heap_pop(double[::1] keys, np.int64_t[::1] values,
+        Py_ssize_t* size) noexcept nogil:
+    """Removes the smallest value from a binary min-heap stored in two
+    arrays.
+    """
+    size[0] -= 1
+    cdef Py_ssize_t n = size[0]
+    cdef double key = keys[n]
+    cdef np.int64_t value = values[n]
+    cdef Py_ssize_t i = 0
+    cdef Py_ssize_t child
+    while 2 * i + 1 < n:
+        child = 2 * i + 1
+        if child + 1 < n and keys[child + 1] < keys[child]:
+            child += 1
+        if key <= keys[child]:
+            break
+        keys[i] = keys[child]
+        values[i] = values[child]
+        i = child
+    keys[i] = key
+    values[i] = value
+
+
+cdef void _earliest_arrival(const np.int64_t[::1] indptr,
+        const np.int64_t[::1] targets, const double[::1] times,
+        np.int64_t source, np.int64_t target, double start, double end,
+        double[::1] arrival, double[::1] heap_keys,
+        np.int64_t[::1] heap_values, Counters *counters) noexcept nogil:
+    """Fills `arrival` with the earliest time at which each vertex can
+    be reached from `source` through contacts with non-decreasing times
+    in the window [start, end). Unreachable vertices are left at
+    infinity. Stops early once `target` is settled, if it is not -1.
+    The work done is added to counters in instrumented builds.
+
+    This is Dijkstra's algorithm with arrival times as distances. The
+    contacts of a vertex are sorted by time, so the ones usable after
+    arriving at it are found with a binary search.
+    """
+    cdef Py_ssize_t heap_size = 0
+    cdef Py_ssize_t i, row_end
+    cdef np.int64_t u, v
+    cdef double t
+
+    arrival[source] = start
+    _heap_push(heap_keys, heap_values, &heap_size, start, source)
+    if STATS_ENABLED:
+        counters.heap_pushes += 1
+    while heap_size > 0:
+        t = heap_keys[0]
+        u = heap_values[0]
+        _heap_pop(heap_keys, heap_values, &heap_size)
+        if STATS_ENABLED:
+            counters.heap_pops += 1
+        if t > arrival[u]:
+            # Stale entry.
+            continue
+        if STATS_ENABLED:
+            counters.vertices_settled += 1
+        if u == target:
+            break
+
+        row_end = indptr[u + 1]
+        for i in range(lower_bound(times, indptr[u], row_end, t), row_end):
+            if times[i] >= end:
+                break
+            if STATS_ENABLED:
+                counters.edges_relaxed += 1
+            v = targets[i]
+            if times[i] < arrival[v]:
+                arrival[v] = times[i]
+                _heap_push(heap_keys, heap_values, &heap_size, times[i], v)
+                if STATS_ENABLED:
+                    counters.heap_pushes += 1
+
+
+cdef np.ndarray _get_arrival_times(TemporalGraph graph, object source,
+        object target, double start, double end, ExecutionStats stats):
+    """Runs _earliest_arrival on a graph and returns the arrival time of
+    every vertex as an array, filling in the setup and search phases of
+    `stats`.
+    """
+    cdef double phase_start = perf_counter()
+    cdef np.int64_t source_int = graph._get_vertex_int(source)
+    cdef np.int64_t target_int = -1
+    if target is not None:
+        target_int = graph._get_vertex_int(target)
+    start, end = graph._window(start, end)
+    graph._flush()
+
+    cdef np.ndarray arrival = np.full(len(graph.vertices), INFINITY)
+    # Every vertex is pushed at most once per contact that reaches it.
+    cdef Py_ssize_t capacity = len(graph._targets) + 1
+    cdef double[::1] arrival_view = arrival
+    cdef double[::1] heap_keys = np.empty(capacity)
+    cdef np.int64_t[::1] heap_values = np.empty(capacity, dtype=np.int64)
+    cdef const np.int64_t[::1] indptr = graph._indptr
+    cdef const np.int64_t[::1] targets = graph._targets
+    cdef const double[::1] times = graph._times
+    cdef Counters counters = Counters(0, 0, 0, 0)
+    stats.allocate(arrival.nbytes + capacity * (sizeof(double)
+                                                + sizeof(np.int64_t)))
+    stats.add_phase("setup", phase_start)
+
+    phase_start = perf_counter()
+    if start < end:
+        with nogil:
+            _earliest_arrival(indptr, targets, times, source_int, target_int,
+                              start, end, arrival_view, heap_keys,
+                              heap_values, &counters)
+    else:
+        arrival[source_int] = start
+    stats.add_counters(counters)
+    stats.add_phase("search", phase_start)
+    return arrival
+
+
+cdef dict get_earliest_arrival_times(TemporalGraph graph, object source,
+        double start=-INFINITY, double end=INFINITY,
+        ExecutionStats stats=None):
+    """Finds the earliest time at which each vertex of a temporal graph
+    can be reached from a source vertex.
+
+    A vertex is reachable if there is a time-respecting path to it: a
+    sequence of contacts, each starting where the previous one ended,
+    at non-decreasing times.
+
+    Parameters
+    ----------
+    graph: cygraph.TemporalGraph
+        A temporal graph.
+    source
+        The vertex to start from.
+    start: double, optional
+        The time at which the source is left, inclusive.
+    end: double, optional
+        The time by which vertices must be reached, exclusive.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the search.
+
+    Returns
+    -------
+    dict
+        Maps every reachable vertex to its earliest arrival time. The
+        source maps to the start of the window.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("get_earliest_arrival_times")
+    cdef np.ndarray arrival = _get_arrival_times(graph, source, None, start,
+                                                 end, stats)
+    cdef np.ndarray reached = np.flatnonzero(arrival < INFINITY)
+    cdef list vertices = graph.vertices
+    return {vertices[i]: t for i, t in zip(reached.tolist(),
+                                           arrival[reached].tolist())}
+
+
+cdef bint is_temporally_reachable(TemporalGraph graph, object source,
+        object target, double start=-INFINITY, double end=INFINITY,
+        ExecutionStats stats=None) except *:
+    """Determines whether there is a time-respecting path between two
+    vertices of a temporal graph.
+
+    Parameters
+    ----------
+    graph: cygraph.TemporalGraph
+        A temporal graph.
+    source
+        The vertex to start from.
+    target
+        The vertex to reach.
+    start: double, optional
+        The time at which the source is left, inclusive.
+    end: double, optional
+        The time by which the target must be reached, exclusive.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the search.
+
+    Returns
+    -------
+    bint
+        Whether or not `target` can be reached from `source`.
+    """
+    if stats is None:
+        stats = ExecutionStats()
+    stats.begin("is_temporally_reachable")
+    cdef np.ndarray arrival = _get_arrival_times(graph, source, target, start,
+                                                 end, stats)
+    return arrival[graph._get_vertex_int(target)] < INFINITY
+
+
+def py_get_earliest_arrival_times(graph, source, start=-np.inf, end=np.inf,
+        stats=None):
+    """Finds the earliest time at which each vertex of a temporal graph
+    can be reached from a source vertex.
+
+    A vertex is reachable if there is a time-respecting path to it: a
+    sequence of contacts, each starting where the previous one ended,
+    at non-decreasing times.
+
+    Parameters
+    ----------
+    graph: cygraph.TemporalGraph
+        A temporal graph.
+    source
+        The vertex to start from.
+    start: double, optional
+        The time at which the source is left, inclusive.
+    end: double, optional
+        The time by which vertices must be reached, exclusive.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the search.
+
+    Returns
+    -------
+    dict
+        Maps every reachable vertex to its earliest arrival time. The
+        source maps to the start of the window.
+
+    Examples
+    --------
+    >>> G = cg.TemporalGraph(directed=True, vertices=['a', 'b', 'c'])
+    >>> G.add_edges([('a', 'b', 2.0), ('b', 'c', 1.0), ('b', 'c', 3.0)])
+    >>> alg.get_earliest_arrival_times(G, 'a', start=0.0)
+    {'a': 0.0, 'b': 2.0, 'c': 3.0}
+    """
+    with span("get_earliest_arrival_times", "algorithm"):
+        return get_earliest_arrival_times(graph, source, start, end, stats)
+
+
+def py_is_temporally_reachable(graph, source, target, start=-np.inf,
+        end=np.inf, stats=None):
+    """Determines whether there is a time-respecting path between two
+    vertices of a temporal graph.
+
+    Parameters
+    ----------
+    graph: cygraph.TemporalGraph
+        A temporal graph.
+    source
+        The vertex to start from.
+    target
+        The vertex to reach.
+    start: double, optional
+        The time at which the source is left, inclusive.
+    end: double, optional
+        The time by which the target must be reached, exclusive.
+    stats: cygraph.algorithms.ExecutionStats, optional
+        Statistics to fill in about the search.
+
+    Returns
+    -------
+    bint
+        Whether or not `target` can be reached from `source`.
+
+    Examples
+    --------
+    >>> G = cg.TemporalGraph(directed=True, vertices=['a', 'b', 'c'])
+    >>> G.add_edges([('a', 'b', 2.0), ('b', 'c', 1.0)])
+    >>> alg.is_temporally_reachable(G, 'a', 'c')
+    False
+    """
+    with span("is_temporally_reachable", "algorithm"):
+        return is_temporally_reachable(graph, source, target, start, end,
+                                       stats)
@@ -2,4 +2,10 @@
 #cython: language_level=3
 
 from cygraph.graph_.dynamic_graph cimport *
-from cygraph.graph_.static_graph cimport *
\ No newline at end of file
+from cygraph.graph_.static_graph cimport *
+from cygraph.graph_.temporal_graph cimport *
+from cygraph.graph_.streaming_graph cimport *
+from cygraph.graph_.int_graph cimport *
+from cygraph.graph_.batch cimport *
+from cygraph.graph_.builder cimport *
+from cygraph.graph_.weights cimport *
\ No newline at end of file
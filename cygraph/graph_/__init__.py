@@ -4,3 +4,12 @@
 from cygraph.graph_.dynamic_graph import DynamicGraph
 from cygraph.graph_.static_graph import StaticGraph
 from cygraph.graph_.graph import Graph
+from cygraph.graph_.batch import GraphBatch
+from cygraph.graph_.builder import GraphBuilder
+from cygraph.graph_.int_graph import IntGraph
+from cygraph.graph_.streaming_graph import StreamingGraph
+from cygraph.graph_.temporal_graph import TemporalGraph
+from cygraph.graph_.archive import load_graph
+from cygraph.graph_.arrow import from_arrow
+from cygraph.graph_.sparse import build_csr
+from cygraph.graph_.weights import UnitWeight, WeightFunction
@@ -0,0 +1,24 @@
+#!python
+#cython: language_level=3
+
+from libc.stdint cimport int64_t, uint8_t, uint64_t
+
+
+# Growable byte string used by the encoders. `data` is owned by the
+# buffer and must be released with free().
+cdef struct ByteBuffer:
+    uint8_t* data
+    size_t size
+    size_t capacity
+
+
+cdef int buffer_reserve(ByteBuffer* buffer, size_t extra) except -1 nogil
+cdef int buffer_put_varint(ByteBuffer* buffer, uint64_t value) except -1 nogil
+cdef int read_varint(const uint8_t* data, size_t size, size_t* position,
+    uint64_t* value) except -1 nogil
+
+cdef Py_ssize_t lz_bound(Py_ssize_t size) noexcept nogil
+cdef Py_ssize_t lz_compress(const uint8_t* source, Py_ssize_t size,
+    uint8_t* destination) except -1 nogil
+cdef int lz_decompress(const uint8_t* source, Py_ssize_t size,
+    uint8_t* destination, Py_ssize_t raw_size) except -1 nogil
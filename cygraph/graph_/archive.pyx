@@ -0,0 +1,1212 @@
+#!python
+#cython: language_level=3
+"""Compressed archival file format for graphs.
+
+Adjacency lists are stored WebGraph-style: each list is either copied
+in part from one of the previous lists (reference compression), or
+written as runs of consecutive vertices (intervals) and gap-coded
+residuals, all as varints. Edge weights are delta-coded by XORing their
+bits with the previous weight. Vertices are split into blocks that are
+compressed independently so that they can be decoded in parallel, and
+every attribute column is compressed on its own.
+"""
+
+import struct
+import sys
+import zlib
+
+cimport numpy as np
+import numpy as np
+
+from libc.stdint cimport int64_t, uint8_t, uint32_t, uint64_t
+from libc.stdlib cimport free, malloc, realloc
+from libc.string cimport memcpy, memset
+
+from cygraph.graph_.graph cimport Graph
+from cygraph.graph_.dynamic_graph cimport DynamicGraph
+from cygraph.graph_.static_graph cimport StaticGraph
+from cygraph.parallel import map_blocks
+from cygraph.tracing import traced
+
+
+MAGIC = b"CYGA"
+VERSION = 1
+
+# magic, version, codec, flags, reserved, number of vertices, number of
+# stored edges, block size, number of blocks.
+HEADER = struct.Struct("<4sBBBBQQII")
+# Uncompressed length and compressed length of a section.
+SECTION = struct.Struct("<QQ")
+
+CODECS = {None: 0, "zlib": 1, "lz": 2}
+
+FLAG_DIRECTED = 1
+FLAG_STATIC = 2
+FLAG_WEIGHTED = 4
+
+# Kind and count of a list of labels or attribute values.
+VALUES = struct.Struct("<BQ")
+VALUES_NONE = 0
+VALUES_BOOL = 1
+VALUES_INT = 2
+VALUES_FLOAT = 3
+VALUES_STR = 4
+VALUES_BYTES = 5
+VALUES_MIXED = 6
+VALUES_TUPLE = 7
+VALUES_LIST = 8
+
+# How many previous adjacency lists are considered as references.
+cdef int WINDOW = 7
+# Shortest run of consecutive vertices that is stored as an interval.
+cdef int MIN_INTERVAL = 4
+
+cdef int LZ_HASH_LOG = 14
+cdef int LZ_MIN_MATCH = 4
+cdef int LZ_MAX_OFFSET = 65535
+
+# How deeply tuples and lists of values may be nested.
+cdef int MAX_DEPTH = 32
+
+
+cdef int _corrupt() except -1 nogil:
+    with gil:
+        raise ValueError("Graph archive is corrupt.")
+
+
+cdef int buffer_reserve(ByteBuffer* buffer, size_t extra) except -1 nogil:
+    """Makes room for `extra` more bytes in a buffer.
+    """
+    cdef size_t capacity = buffer.capacity
+    cdef uint8_t* data
+
+    if buffer.size + extra <= capacity:
+        return 0
+    if capacity < 64:
+        capacity = 64
+    while capacity < buffer.size + extra:
+        capacity *= 2
+
+    data = <uint8_t*>realloc(buffer.data, capacity)
+    if data == NULL:
+        with gil:
+            raise MemoryError()
+    buffer.data = data
+    buffer.capacity = capacity
+    return 0
+
+
+cdef int buffer_put_varint(ByteBuffer* buffer, uint64_t value) except -1 nogil:
+    """Appends an unsigned LEB128 varint to a buffer.
+    """
+    buffer_reserve(buffer, 10)
+    while value >= 0x80:
+        buffer.data[buffer.size] = <uint8_t>(value | 0x80)
+        buffer.size += 1
+        value >>= 7
+    buffer.data[buffer.size] = <uint8_t>value
+    buffer.size += 1
+    return 0
+
+
+cdef int read_varint(const uint8_t* data, size_t size, size_t* position,
+        uint64_t* value) except -1 nogil:
+    """Reads an unsigned LEB128 varint, advancing `position` past it.
+    """
+    cdef uint64_t result = 0
+    cdef int shift = 0
+    cdef uint8_t byte
+
+    while True:
+        if position[0] >= size or shift > 63:
+            _corrupt()
+        byte = data[position[0]]
+        position[0] += 1
+        result |= (<uint64_t>(byte & 0x7F)) << shift
+        if byte < 0x80:
+            break
+        shift += 7
+
+    value[0] = result
+    return 0
+
+
+cdef inline uint64_t _zigzag(int64_t value) noexcept nogil:
+    return (<uint64_t>value << 1) ^ <uint64_t>(value >> 63)
+
+
+cdef inline int64_t _unzigzag(uint64_t value) noexcept nogil:
+    return <int64_t>(value >> 1) ^ -<int64_t>(value & 1)
+
+
+cdef inline uint64_t _byteswap(uint64_t value) noexcept nogil:
+    cdef uint64_t result = 0
+    cdef int i
+    for i in range(8):
+        result = (result << 8) | (value & 0xFF)
+        value >>= 8
+    return result
+
+
+cdef int64_t _intersection_size(const int64_t* a, int64_t n_a,
+        const int64_t* b, int64_t n_b) noexcept nogil:
+    """Counts the common elements of two sorted arrays.
+    """
+    cdef int64_t i = 0, j = 0, count = 0
+    while i < n_a and j < n_b:
+        if a[i] < b[j]:
+            i += 1
+        elif a[i] > b[j]:
+            j += 1
+        else:
+            count += 1
+            i += 1
+            j += 1
+    return count
+
+
+cdef int _encode_successors(const int64_t* indptr, const int64_t* indices,
+        int64_t start, int64_t x, uint8_t* copied, int64_t* scratch,
+        int64_t* extras, ByteBuffer* out) except -1 nogil:
+    """Encodes the adjacency list of vertex `x`.
+
+    The list is written as its length, the distance `r` to a reference
+    list (0 for none), the run lengths of the reference elements that
+    are alternately copied and skipped, the intervals among the
+    remaining elements and finally the gaps between the residuals.
+    """
+    cdef const int64_t* successors = indices + indptr[x]
+    cdef int64_t degree = indptr[x + 1] - indptr[x]
+    cdef const int64_t* reference
+    cdef int64_t reference_degree, r, count
+    cdef int64_t best_r = 0
+    cdef int64_t best_count = 0
+    cdef int64_t i, j, k, run, n_runs, n_extras, n_intervals, n_residuals
+    cdef int64_t previous
+    cdef bint state, member, first
+
+    buffer_put_varint(out, degree)
+    if degree == 0:
+        return 0
+
+    # Pick the previous list in the block sharing the most successors.
+    for r in range(1, min(WINDOW, x - start) + 1):
+        reference = indices + indptr[x - r]
+        reference_degree = indptr[x - r + 1] - indptr[x - r]
+        count = _intersection_size(successors, degree, reference,
+            reference_degree)
+        if count > best_count:
+            best_count = count
+            best_r = r
+    buffer_put_varint(out, best_r)
+
+    memset(copied, 0, degree)
+    if best_r > 0:
+        reference = indices + indptr[x - best_r]
+        reference_degree = indptr[x - best_r + 1] - indptr[x - best_r]
+        i = 0
+        state = True
+        run = 0
+        n_runs = 0
+        for j in range(reference_degree):
+            while i < degree and successors[i] < reference[j]:
+                i += 1
+            member = i < degree and successors[i] == reference[j]
+            if member:
+                copied[i] = 1
+            if member == state:
+                run += 1
+            else:
+                scratch[n_runs] = run
+                n_runs += 1
+                state = member
+                run = 1
+        # The last run is implied by the length of the reference list.
+        buffer_put_varint(out, n_runs)
+        for j in range(n_runs):
+            buffer_put_varint(out, scratch[j] if j == 0 else scratch[j] - 1)
+
+    n_extras = 0
+    for i in range(degree):
+        if not copied[i]:
+            extras[n_extras] = successors[i]
+            n_extras += 1
+
+    n_intervals = 0
+    i = 0
+    while i < n_extras:
+        j = i + 1
+        while j < n_extras and extras[j] == extras[j - 1] + 1:
+            j += 1
+        if j - i >= MIN_INTERVAL:
+            n_intervals += 1
+        i = j
+    buffer_put_varint(out, n_intervals)
+
+    first = True
+    previous = 0
+    n_residuals = 0
+    i = 0
+    while i < n_extras:
+        j = i + 1
+        while j < n_extras and extras[j] == extras[j - 1] + 1:
+            j += 1
+        if j - i >= MIN_INTERVAL:
+            if first:
+                buffer_put_varint(out, _zigzag(extras[i] - x))
+                first = False
+            else:
+                buffer_put_varint(out, extras[i] - previous - 1)
+            buffer_put_varint(out, j - i - MIN_INTERVAL)
+            previous = extras[j - 1] + 1
+        else:
+            for k in range(i, j):
+                scratch[n_residuals] = extras[k]
+                n_residuals += 1
+        i = j
+
+    # The number of residuals is implied by the degree.
+    for i in range(n_residuals):
+        if i == 0:
+            buffer_put_varint(out, _zigzag(scratch[0] - x))
+        else:
+            buffer_put_varint(out, scratch[i] - scratch[i - 1] - 1)
+
+    return 0
+
+
+cdef int _encode_block(const int64_t* indptr, const int64_t* indices,
+        const double* weights, bint weighted, int64_t start, int64_t stop,
+        uint8_t* copied, int64_t* scratch, int64_t* extras,
+        ByteBuffer* out) except -1 nogil:
+    """Encodes the adjacency lists and weights of vertices `start` to
+    `stop`. The scratch arrays must hold the largest degree among them.
+    """
+    cdef int64_t x, e
+    cdef uint64_t bits
+    cdef uint64_t previous = 0
+
+    for x in range(start, stop):
+        _encode_successors(indptr, indices, start, x, copied, scratch,
+            extras, out)
+
+    if weighted:
+        for e in range(indptr[start], indptr[stop]):
+            memcpy(&bits, &weights[e], sizeof(uint64_t))
+            buffer_put_varint(out, _byteswap(bits ^ previous))
+            previous = bits
+
+    return 0
+
+
+cdef void _merge(int64_t* values, int64_t n_first, int64_t n_second,
+        int64_t* scratch) noexcept nogil:
+    """Merges the sorted runs values[:n_first] and
+    values[n_first:n_first + n_second] in place.
+    """
+    cdef int64_t i = 0, j = n_first, k = 0
+    cdef int64_t stop = n_first + n_second
+    if n_first == 0 or n_second == 0:
+        return
+    while i < n_first and j < stop:
+        if values[i] <= values[j]:
+            scratch[k] = values[i]
+            i += 1
+        else:
+            scratch[k] = values[j]
+            j += 1
+        k += 1
+    while i < n_first:
+        scratch[k] = values[i]
+        i += 1
+        k += 1
+    while j < stop:
+        scratch[k] = values[j]
+        j += 1
+        k += 1
+    memcpy(values, scratch, stop * sizeof(int64_t))
+
+
+cdef int _decode_successors(const uint8_t* data, size_t size,
+        size_t* position, int64_t start, int64_t x, int64_t degree,
+        const int64_t* row_offsets, const int64_t* degrees,
+        int64_t* successors, int64_t* scratch) except -1 nogil:
+    """Decodes the adjacency list of vertex `x` written by
+    _encode_successors into `successors`.
+    """
+    cdef uint64_t value
+    cdef int64_t r, reference_degree, n_runs, length, i, j, t
+    cdef int64_t n_copied, n_intervals, n_in_intervals, n_residuals, left
+    cdef int64_t previous = 0
+    cdef int64_t k = 0
+    cdef const int64_t* reference
+    cdef bint state = True
+
+    read_varint(data, size, position, &value)
+    if value > <uint64_t>(x - start):
+        _corrupt()
+    r = <int64_t>value
+
+    if r > 0:
+        reference = successors - row_offsets[x - start] \
+            + row_offsets[x - r - start]
+        reference_degree = degrees[x - r]
+        read_varint(data, size, position, &value)
+        n_runs = <int64_t>value
+        j = 0
+        for i in range(n_runs):
+            read_varint(data, size, position, &value)
+            length = <int64_t>value + (1 if i > 0 else 0)
+            if length > reference_degree - j:
+                _corrupt()
+            if state:
+                if length > degree - k:
+                    _corrupt()
+                memcpy(successors + k, reference + j, length * sizeof(int64_t))
+                k += length
+            j += length
+            state = not state
+        if state:
+            length = reference_degree - j
+            if length > degree - k:
+                _corrupt()
+            memcpy(successors + k, reference + j, length * sizeof(int64_t))
+            k += length
+    n_copied = k
+
+    read_varint(data, size, position, &value)
+    n_intervals = <int64_t>value
+    for i in range(n_intervals):
+        read_varint(data, size, position, &value)
+        if i == 0:
+            left = x + _unzigzag(value)
+        else:
+            left = previous + <int64_t>value + 1
+        read_varint(data, size, position, &value)
+        if degree - k < MIN_INTERVAL \
+                or value > <uint64_t>(degree - k - MIN_INTERVAL):
+            _corrupt()
+        length = <int64_t>value + MIN_INTERVAL
+        for t in range(length):
+            successors[k] = left + t
+            k += 1
+        previous = left + length
+    n_in_intervals = k - n_copied
+    n_residuals = degree - k
+
+    for i in range(n_residuals):
+        read_varint(data, size, position, &value)
+        if i == 0:
+            previous = x + _unzigzag(value)
+        else:
+            previous = previous + <int64_t>value + 1
+        successors[k] = previous
+        k += 1
+
+    _merge(successors + n_copied, n_in_intervals, n_residuals, scratch)
+    _merge(successors, n_copied, degree - n_copied, scratch)
+    return 0
+
+
+cdef int _decode_block(const uint8_t* data, size_t size, int64_t start,
+        int64_t stop, int64_t n_edges, bint weighted, int64_t* degrees,
+        int64_t* indices, double* weights, int64_t* row_offsets,
+        int64_t* scratch) except -1 nogil:
+    """Decodes a block written by _encode_block. `indices` and
+    `weights` point at the first edge of the block, `row_offsets` must
+    hold a value per vertex in the block and `scratch` one per edge.
+    """
+    cdef size_t position = 0
+    cdef uint64_t value, bits
+    cdef uint64_t previous = 0
+    cdef int64_t offset = 0
+    cdef int64_t x, e, degree
+
+    for x in range(start, stop):
+        row_offsets[x - start] = offset
+        read_varint(data, size, &position, &value)
+        if value > <uint64_t>(n_edges - offset):
+            _corrupt()
+        degree = <int64_t>value
+        degrees[x] = degree
+        if degree == 0:
+            continue
+        _decode_successors(data, size, &position, start, x, degree,
+            row_offsets, degrees, indices + offset, scratch)
+        offset += degree
+
+    if offset != n_edges:
+        _corrupt()
+
+    if weighted:
+        for e in range(n_edges):
+            read_varint(data, size, &position, &value)
+            bits = _byteswap(value) ^ previous
+            memcpy(&weights[e], &bits, sizeof(uint64_t))
+            previous = bits
+
+    if position != size:
+        _corrupt()
+    return 0
+
+
+cdef Py_ssize_t lz_bound(Py_ssize_t size) noexcept nogil:
+    """Returns the largest size lz_compress can produce for an input of
+    `size` bytes.
+    """
+    return size + size // 255 + 16
+
+
+cdef inline uint32_t _read32(const uint8_t* pointer) noexcept nogil:
+    cdef uint32_t value
+    memcpy(&value, pointer, sizeof(uint32_t))
+    return value
+
+
+cdef Py_ssize_t _lz_emit(uint8_t* destination, Py_ssize_t output,
+        const uint8_t* literals, Py_ssize_t n_literals, Py_ssize_t offset,
+        Py_ssize_t match_length) noexcept nogil:
+    """Writes one LZ4-style sequence: a token holding both lengths, the
+    literals, and then the match offset (omitted for the last
+    sequence).
+    """
+    cdef Py_ssize_t token = output
+    cdef Py_ssize_t remainder
+
+    output += 1
+    if n_literals >= 15:
+        destination[token] = 15 << 4
+        remainder = n_literals - 15
+        while remainder >= 255:
+            destination[output] = 255
+            output += 1
+            remainder -= 255
+        destination[output] = <uint8_t>remainder
+        output += 1
+    else:
+        destination[token] = <uint8_t>(n_literals << 4)
+    memcpy(destination + output, literals, n_literals)
+    output += n_literals
+
+    if match_length:
+        destination[output] = offset & 0xFF
+        destination[output + 1] = offset >> 8
+        output += 2
+        remainder = match_length - LZ_MIN_MATCH
+        if remainder >= 15:
+            destination[token] |= 15
+            remainder -= 15
+            while remainder >= 255:
+                destination[output] = 255
+                output += 1
+                remainder -= 255
+            destination[output] = <uint8_t>remainder
+            output += 1
+        else:
+            destination[token] |= <uint8_t>remainder
+
+    return output
+
+
+cdef Py_ssize_t lz_compress(const uint8_t* source, Py_ssize_t size,
+        uint8_t* destination) except -1 nogil:
+    """Compresses `size` bytes with a greedy LZ4-style matcher.
+
+    `destination` must hold at least lz_bound(size) bytes. Returns the
+    compressed size.
+    """
+    cdef Py_ssize_t* table
+    cdef Py_ssize_t anchor = 0
+    cdef Py_ssize_t position = 0
+    cdef Py_ssize_t output = 0
+    cdef Py_ssize_t reference, length, i
+    cdef uint32_t sequence, hashed
+
+    table = <Py_ssize_t*>malloc(sizeof(Py_ssize_t) << LZ_HASH_LOG)
+    if table == NULL:
+        with gil:
+            raise MemoryError()
+    for i in range(1 << LZ_HASH_LOG):
+        table[i] = -1
+
+    while position + LZ_MIN_MATCH <= size:
+        sequence = _read32(source + position)
+        hashed = (sequence * <uint32_t>2654435761U) >> (32 - LZ_HASH_LOG)
+        reference = table[hashed]
+        table[hashed] = position
+        if (reference >= 0 and position - reference <= LZ_MAX_OFFSET
+                and _read32(source + reference) == sequence):
+            length = LZ_MIN_MATCH
+            while (position + length < size
+                    and source[reference + length] == source[position + length]):
+                length += 1
+            output = _lz_emit(destination, output, source + anchor,
+                position - anchor, position - reference, length)
+            position += length
+            anchor = position
+        else:
+            position += 1
+
+    output = _lz_emit(destination, output, source + anchor, size - anchor,
+        0, 0)
+    free(table)
+    return output
+
+
+cdef int lz_decompress(const uint8_t* source, Py_ssize_t size,
+        uint8_t* destination, Py_ssize_t raw_size) except -1 nogil:
+    """Decompresses the output of lz_compress into exactly `raw_size`
+    bytes.
+    """
+    cdef Py_ssize_t position = 0
+    cdef Py_ssize_t output = 0
+    cdef Py_ssize_t length, offset, i
+    cdef uint8_t token, byte
+
+    while position < size:
+        token = source[position]
+        position += 1
+
+        length = token >> 4
+        if length == 15:
+            while True:
+                if position >= size:
+                    _corrupt()
+                byte = source[position]
+                position += 1
+                length += byte
+                if byte != 255:
+                    break
+        if length > size - position or length > raw_size - output:
+            _corrupt()
+        memcpy(destination + output, source + position, length)
+        position += length
+        output += length
+        if position == size:
+            break
+
+        if position + 2 > size:
+            _corrupt()
+        offset = source[position] | (source[position + 1] << 8)
+        position += 2
+        if offset == 0 or offset > output:
+            _corrupt()
+        length = token & 15
+        if length == 15:
+            while True:
+                if position >= size:
+                    _corrupt()
+                byte = source[position]
+                position += 1
+                length += byte
+                if byte != 255:
+                    break
+        length += LZ_MIN_MATCH
+        if length > raw_size - output:
+            _corrupt()
+        # Byte by byte because the match may overlap the output.
+        for i in range(length):
+            destination[output + i] = destination[output - offset + i]
+        output += length
+
+    if output != raw_size:
+        _corrupt()
+    return 0
+
+
+cdef inline const uint8_t* _pointer(const uint8_t[::1] data) noexcept nogil:
+    if data.shape[0] == 0:
+        return NULL
+    return &data[0]
+
+
+cdef object _compress(int codec, object raw):
+    """Compresses bytes with one of the codecs in CODECS.
+    """
+    cdef const uint8_t[::1] source
+    cdef np.ndarray destination
+    cdef uint8_t[::1] destination_view
+    cdef Py_ssize_t size
+
+    if codec == 1:
+        return zlib.compress(raw)
+    elif codec == 2:
+        source = raw
+        destination = np.empty(lz_bound(source.shape[0]), dtype=np.uint8)
+        destination_view = destination
+        with nogil:
+            size = lz_compress(_pointer(source), source.shape[0],
+                &destination_view[0])
+        return destination[:size].tobytes()
+    return bytes(raw)
+
+
+cdef object _decompress(int codec, object compressed, Py_ssize_t raw_size):
+    """Inverse of _compress. Returns a bytes-like object.
+    """
+    cdef const uint8_t[::1] source
+    cdef np.ndarray destination
+    cdef uint8_t[::1] destination_view
+    cdef object raw
+
+    if codec == 1:
+        try:
+            raw = zlib.decompress(compressed)
+        except zlib.error as e:
+            raise ValueError("Graph archive is corrupt.") from e
+    elif codec == 2:
+        source = compressed
+        destination = np.empty(raw_size, dtype=np.uint8)
+        destination_view = destination
+        with nogil:
+            lz_decompress(_pointer(source), source.shape[0],
+                <uint8_t*>_pointer(destination_view), raw_size)
+        raw = destination
+    else:
+        raw = compressed
+    if len(raw) != raw_size:
+        raise ValueError("Graph archive is corrupt.")
+    return raw
+
+
+cdef bytes _pack(int codec, object raw):
+    """Compresses bytes into a length-prefixed section.
+    """
+    cdef bytes compressed = _compress(codec, raw)
+    return SECTION.pack(len(raw), len(compressed)) + compressed
+
+
+cdef tuple _unpack(int codec, object data, Py_ssize_t position):
+    """Reads a section written by _pack.
+
+    Returns
+    -------
+    tuple
+        The decompressed contents and the position after the section.
+    """
+    cdef object raw_size, size
+    if position + SECTION.size > len(data):
+        raise ValueError("Graph archive is corrupt.")
+    raw_size, size = SECTION.unpack_from(data, position)
+    position += SECTION.size
+    if position + size > len(data) or raw_size > sys.maxsize:
+        raise ValueError("Graph archive is corrupt.")
+    return (_decompress(codec, data[position:position + size], raw_size),
+            position + size)
+
+
+cdef object _value_kind(object value):
+    """Returns the kind of value list that can store a value, or None if
+    the value cannot be stored in an archive.
+    """
+    if isinstance(value, (bool, np.bool_)):
+        return VALUES_BOOL
+    elif isinstance(value, (int, np.integer)):
+        return VALUES_INT if -2**63 <= value < 2**63 else None
+    elif isinstance(value, (float, np.floating)):
+        return VALUES_FLOAT
+    elif isinstance(value, str):
+        return VALUES_STR
+    elif isinstance(value, bytes):
+        return VALUES_BYTES
+    elif isinstance(value, tuple):
+        return VALUES_TUPLE
+    elif isinstance(value, list):
+        return VALUES_LIST
+    elif value is None:
+        return VALUES_NONE
+    return None
+
+
+cdef bytes _encode_values(list values, int depth=0):
+    """Encodes a list of vertex labels or attribute values.
+
+    Lists of bools, 64-bit ints, floats, strs, bytes or None are stored
+    as typed arrays, and lists of tuples or lists as their lengths
+    followed by all of their items, encoded in turn. Lists that mix
+    kinds are stored as a tag per value followed by one list per tag.
+    numpy scalars and subclasses of these types are stored as the
+    builtin type.
+    """
+    cdef list kinds = [_value_kind(value) for value in values]
+    cdef list encoded, parts
+    cdef set distinct
+    cdef object kind, value
+    cdef np.ndarray offsets
+
+    if None in kinds:
+        value = values[kinds.index(None)]
+        raise TypeError(f"{value!r} of type {type(value).__name__} cannot "
+                        f"be stored in a graph archive.")
+
+    distinct = set(kinds)
+    if len(distinct) > 1:
+        parts = [VALUES.pack(VALUES_MIXED, len(values)),
+                 np.array(kinds, dtype=np.uint8).tobytes()]
+        for kind in sorted(distinct):
+            parts.append(_encode_values(
+                [value for value, value_kind in zip(values, kinds)
+                 if value_kind == kind], depth))
+        return b"".join(parts)
+
+    kind = distinct.pop() if distinct else VALUES_NONE
+    header = VALUES.pack(kind, len(values))
+    if kind == VALUES_BOOL:
+        return header + np.array(values, dtype=np.uint8).tobytes()
+    elif kind == VALUES_INT:
+        return header + np.array(values, dtype="<i8").tobytes()
+    elif kind == VALUES_FLOAT:
+        return header + np.array(values, dtype="<f8").tobytes()
+    elif kind == VALUES_NONE:
+        return header
+    elif kind == VALUES_TUPLE or kind == VALUES_LIST:
+        if depth == MAX_DEPTH:
+            raise ValueError(f"Values nested more than {MAX_DEPTH} deep "
+                             f"cannot be stored in a graph archive.")
+        return header \
+            + np.array([len(value) for value in values], dtype="<i8") \
+                .tobytes() \
+            + _encode_values([item for value in values for item in value],
+                depth + 1)
+
+    if kind == VALUES_STR:
+        encoded = [value.encode("utf-8", "surrogatepass") for value in values]
+    else:
+        encoded = values
+    offsets = np.zeros(len(encoded) + 1, dtype="<i8")
+    np.cumsum([len(value) for value in encoded], out=offsets[1:])
+    return header + offsets.tobytes() + b"".join(encoded)
+
+
+cdef tuple _decode_values(object data, Py_ssize_t position, int depth=0):
+    """Inverse of _encode_values.
+
+    Returns
+    -------
+    tuple
+        The list of values and the position after it.
+    """
+    cdef object kind, count
+    cdef Py_ssize_t size, end, i
+    cdef np.ndarray offsets, tags, lengths
+    cdef list values, items, bounds
+    cdef object value
+
+    if position + VALUES.size > len(data):
+        raise ValueError("Graph archive is corrupt.")
+    kind, count = VALUES.unpack_from(data, position)
+    position += VALUES.size
+    if count > sys.maxsize // 8:
+        raise ValueError("Graph archive is corrupt.")
+
+    if kind == VALUES_NONE:
+        return [None] * count, position
+
+    size = {VALUES_BOOL: 1, VALUES_MIXED: 1, VALUES_INT: 8, VALUES_FLOAT: 8,
+            VALUES_STR: 8, VALUES_BYTES: 8, VALUES_TUPLE: 8,
+            VALUES_LIST: 8}.get(kind, -1)
+    if size == -1:
+        raise ValueError("Graph archive is corrupt.")
+    if kind == VALUES_STR or kind == VALUES_BYTES:
+        # One offset more than there are values.
+        count += 1
+    end = position + size * count
+    if end > len(data):
+        raise ValueError("Graph archive is corrupt.")
+
+    if kind == VALUES_BOOL:
+        return np.frombuffer(data, np.uint8, count, position).astype(bool) \
+            .tolist(), end
+    elif kind == VALUES_INT:
+        return np.frombuffer(data, "<i8", count, position).tolist(), end
+    elif kind == VALUES_FLOAT:
+        return np.frombuffer(data, "<f8", count, position).tolist(), end
+
+    elif kind == VALUES_MIXED:
+        tags = np.frombuffer(data, np.uint8, count, position)
+        position = end
+        values = [None] * count
+        for kind in np.unique(tags).tolist():
+            if kind == VALUES_MIXED:
+                raise ValueError("Graph archive is corrupt.")
+            indices = np.flatnonzero(tags == kind).tolist()
+            typed, position = _decode_values(data, position, depth)
+            if len(typed) != len(indices):
+                raise ValueError("Graph archive is corrupt.")
+            for i, value in zip(indices, typed):
+                values[i] = value
+        return values, position
+
+    elif kind == VALUES_TUPLE or kind == VALUES_LIST:
+        lengths = np.frombuffer(data, "<i8", count, position)
+        if depth == MAX_DEPTH or np.any(lengths < 0):
+            raise ValueError("Graph archive is corrupt.")
+        items, position = _decode_values(data, end, depth + 1)
+        if len(items) != lengths.sum():
+            raise ValueError("Graph archive is corrupt.")
+        bounds = np.concatenate(([0], np.cumsum(lengths))).tolist()
+        values = [items[bounds[i]:bounds[i + 1]] for i in range(count)]
+        if kind == VALUES_TUPLE:
+            values = [tuple(value) for value in values]
+        return values, position
+
+    offsets = np.frombuffer(data, "<i8", count, position)
+    if offsets[0] != 0 or np.any(np.diff(offsets) < 0) \
+            or end + offsets[-1] > len(data):
+        raise ValueError("Graph archive is corrupt.")
+    bounds = (offsets + end).tolist()
+    values = [bytes(data[bounds[i]:bounds[i + 1]])
+              for i in range(count - 1)]
+    if kind == VALUES_STR:
+        try:
+            values = [value.decode("utf-8", "surrogatepass")
+                      for value in values]
+        except UnicodeDecodeError as e:
+            raise ValueError("Graph archive is corrupt.") from e
+    return values, bounds[-1]
+
+
+cdef bytes _encode_attributes(Graph graph, int codec):
+    """Stores every vertex and edge attribute key as its own compressed
+    column.
+    """
+    cdef dict vertex_ints = {v: i for i, v in enumerate(graph.vertices)}
+    cdef list dicts
+    cdef object vertex
+    cdef tuple edge
+
+    dicts = [graph._vertex_attributes[vertex] for vertex in graph.vertices]
+    cdef bytes vertex_columns = _encode_columns(codec, dicts)
+
+    cdef list edges = list(graph._edge_attributes)
+    cdef np.ndarray edge_ints = np.array(
+        [(vertex_ints[edge[0]], vertex_ints[edge[1]]) for edge in edges],
+        dtype=np.int64).reshape(-1, 2)
+    dicts = [graph._edge_attributes[edge] for edge in edges]
+    cdef bytes edge_columns = _encode_columns(codec, dicts)
+
+    return vertex_columns + _pack(codec, edge_ints.astype("<i8").tobytes()) \
+        + edge_columns
+
+
+cdef bytes _encode_columns(int codec, list dicts):
+    """Splits a list of attribute dictionaries into one compressed
+    column per key, storing which rows have the key as a bitmask.
+
+    The keys come first, as a section of their own.
+    """
+    cdef dict keys = {}
+    cdef dict attributes
+    cdef object key
+    cdef np.ndarray present
+    cdef bytes mask
+    cdef list sections
+
+    for attributes in dicts:
+        for key in attributes:
+            keys[key] = None
+
+    sections = [_pack(codec, _encode_values(list(keys)))]
+    for key in keys:
+        present = np.array([key in attributes for attributes in dicts],
+            dtype=bool)
+        mask = np.packbits(present).tobytes()
+        sections.append(_pack(codec, struct.pack("<Q", len(mask)) + mask
+            + _encode_values([attributes[key] for attributes in dicts
+                              if key in attributes])))
+
+    return b"".join(sections)
+
+
+cdef Py_ssize_t _decode_columns(int codec, object data, Py_ssize_t position,
+        list dicts) except -1:
+    """Inverse of _encode_columns. Fills in `dicts` and returns the
+    position after the columns.
+    """
+    cdef object key, value, raw, mask_size
+    cdef list keys, values
+    cdef np.ndarray present
+    cdef Py_ssize_t i, end
+
+    raw, position = _unpack(codec, data, position)
+    keys = _decode_values(raw, 0)[0]
+    for key in keys:
+        raw, position = _unpack(codec, data, position)
+        if len(raw) < 8:
+            raise ValueError("Graph archive is corrupt.")
+        mask_size, = struct.unpack_from("<Q", raw, 0)
+        if mask_size != (len(dicts) + 7) // 8 or 8 + mask_size > len(raw):
+            raise ValueError("Graph archive is corrupt.")
+        end = 8 + mask_size
+        present = np.unpackbits(np.frombuffer(raw, np.uint8, mask_size, 8),
+            count=len(dicts)).astype(bool)
+        values, end = _decode_values(raw, end)
+        if len(values) != np.count_nonzero(present) or end != len(raw):
+            raise ValueError("Graph archive is corrupt.")
+        for i, value in zip(np.flatnonzero(present).tolist(), values):
+            dicts[i][key] = value
+
+    return position
+
+
+def save_graph(Graph graph not None, object path, object compression="zlib",
+        int block_size=4096):
+    """Saves a graph to a compressed archive file.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph
+        A graph.
+    path: str or os.PathLike
+        The file to write.
+    compression: str, optional
+        The codec used for every block and column: "zlib", "lz" (a
+        builtin LZ4-style codec that is faster but compresses less) or
+        None.
+    block_size: int, optional
+        The number of vertices per independently compressed block.
+
+    Raises
+    ------
+    ValueError
+        `compression` is not a supported codec, or vertices or attribute
+        values are nested too deeply.
+    TypeError
+        A vertex or an attribute key or value cannot be stored.
+
+    Notes
+    -----
+    Vertices, attribute keys and attribute values can be bools, ints
+    that fit in 64 bits, floats, strs, bytes, None, and tuples and
+    lists of these.
+    """
+    if compression not in CODECS:
+        raise ValueError(f"Unknown compression {compression!r}. Must be "
+                         f"one of {list(CODECS)}.")
+    if block_size < 1:
+        raise ValueError("block_size must be positive.")
+
+    cdef int codec = CODECS[compression]
+    cdef int64_t n_vertices = len(graph.vertices)
+    cdef np.ndarray indptr, indices, weights, rows, keep
+
+    indptr, indices, weights = graph._get_csr()
+    if not graph.directed:
+        # Store each undirected edge once, in the row of its smaller
+        # vertex.
+        rows = np.repeat(np.arange(n_vertices, dtype=np.int64),
+            np.diff(indptr))
+        keep = indices >= rows
+        indices = indices[keep]
+        weights = weights[keep]
+        indptr = np.zeros(n_vertices + 1, dtype=np.int64)
+        np.cumsum(np.bincount(rows[keep], minlength=n_vertices),
+            out=indptr[1:])
+
+    cdef int64_t[::1] indptr_view = np.ascontiguousarray(indptr, dtype=np.int64)
+    cdef int64_t[::1] indices_view = np.ascontiguousarray(indices,
+        dtype=np.int64)
+    cdef double[::1] weights_view = np.ascontiguousarray(weights,
+        dtype=np.float64)
+    cdef bint weighted = bool(np.any(weights != 1.0))
+    cdef int n_blocks = (n_vertices + block_size - 1) // block_size
+    cdef int flags = 0
+
+    if graph.directed:
+        flags |= FLAG_DIRECTED
+    if isinstance(graph, StaticGraph):
+        flags |= FLAG_STATIC
+    if weighted:
+        flags |= FLAG_WEIGHTED
+
+    def encode(int b):
+        cdef ByteBuffer buffer
+        cdef int64_t start = b * <int64_t>block_size
+        cdef int64_t stop = min(start + block_size, n_vertices)
+        cdef int64_t max_degree = np.diff(indptr[start:stop + 1]).max()
+        cdef uint8_t[::1] copied = np.empty(max_degree + 1, dtype=np.uint8)
+        cdef int64_t[::1] scratch = np.empty(max_degree + 1, dtype=np.int64)
+        cdef int64_t[::1] extras = np.empty(max_degree + 1, dtype=np.int64)
+        cdef const int64_t* indptr_pointer = &indptr_view[0]
+        cdef const int64_t* indices_pointer = NULL
+        cdef const double* weights_pointer = NULL
+        cdef bytes raw
+
+        if indices_view.shape[0]:
+            indices_pointer = &indices_view[0]
+            weights_pointer = &weights_view[0]
+        buffer.data = NULL
+        buffer.size = 0
+        buffer.capacity = 0
+        try:
+            with nogil:
+                _encode_block(indptr_pointer, indices_pointer,
+                    weights_pointer, weighted, start, stop, &copied[0],
+                    &scratch[0], &extras[0], &buffer)
+            raw = buffer.data[:buffer.size] if buffer.size else b""
+        finally:
+            free(buffer.data)
+        return (indptr_view[start], len(raw), _compress(codec, raw))
+
+    # Encode the labels and attributes first, so that values that cannot
+    # be stored fail before the file is written.
+    cdef bytes vertex_section = _pack(codec, _encode_values(graph.vertices))
+    cdef bytes attribute_section = _pack(codec,
+        _encode_attributes(graph, codec))
+    cdef list blocks = map_blocks(encode, n_blocks)
+    cdef np.ndarray table = np.array([block[:2] + (len(block[2]),)
+        for block in blocks], dtype="<u8").reshape(-1, 3)
+
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, codec, flags, 0, n_vertices,
+            len(indices), block_size, n_blocks))
+        f.write(vertex_section)
+        f.write(_pack(codec, table.tobytes()))
+        for block in blocks:
+            f.write(block[2])
+        f.write(attribute_section)
+
+
+@traced("load_graph", "graph")
+def load_graph(object path):
+    """Loads a graph saved with cygraph.Graph.save.
+
+    Blocks are decompressed and decoded in parallel.
+
+    Parameters
+    ----------
+    path: str or os.PathLike
+        The file to read.
+
+    Returns
+    -------
+    cygraph.Graph
+        A graph of the same type as the one that was saved.
+
+    Raises
+    ------
+    ValueError
+        The file is not a valid graph archive.
+    """
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if len(data) < HEADER.size:
+        raise ValueError("Graph archive is corrupt.")
+    magic, version, codec, flags, _, n_vertices, n_edges, block_size, \
+        n_blocks = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError(f"{path} is not a graph archive.")
+    if version != VERSION:
+        raise ValueError(f"Unsupported graph archive version {version}.")
+    if codec not in CODECS.values():
+        raise ValueError(f"Unknown compression codec {codec}.")
+
+    cdef object view = memoryview(data)
+    cdef Py_ssize_t position = HEADER.size
+    cdef object raw
+    cdef list vertices
+
+    raw, position = _unpack(codec, view, position)
+    vertices = _decode_values(raw, 0)[0]
+    raw, position = _unpack(codec, view, position)
+    cdef np.ndarray table = np.frombuffer(raw, dtype="<u8").reshape(-1, 3) \
+        .astype(np.int64)
+    if len(vertices) != n_vertices or len(table) != n_blocks:
+        raise ValueError("Graph archive is corrupt.")
+
+    cdef np.ndarray starts = np.zeros(n_blocks + 1, dtype=np.int64)
+    np.cumsum(table[:, 2], out=starts[1:])
+    starts += position
+    position = starts[-1]
+
+    cdef bint weighted = flags & FLAG_WEIGHTED
+    cdef np.ndarray degrees = np.zeros(n_vertices, dtype=np.int64)
+    cdef np.ndarray indices = np.empty(n_edges, dtype=np.int64)
+    cdef np.ndarray weights = (np.empty if weighted else np.ones)(n_edges,
+        dtype=np.float64)
+    cdef int64_t[::1] degrees_view = degrees
+    cdef int64_t[::1] indices_view = indices
+    cdef double[::1] weights_view = weights
+    cdef np.ndarray edge_offsets = np.append(table[:, 0], n_edges)
+
+    if position > len(data) or np.any(np.diff(edge_offsets) < 0) \
+            or (n_blocks and edge_offsets[0] != 0):
+        raise ValueError("Graph archive is corrupt.")
+
+    def decode(int b):
+        cdef int64_t start = b * <int64_t>block_size
+        cdef int64_t stop = min(start + block_size, n_vertices)
+        cdef int64_t edge_offset = edge_offsets[b]
+        cdef int64_t n_block_edges = edge_offsets[b + 1] - edge_offset
+        cdef const uint8_t[::1] block = _decompress(codec,
+            view[starts[b]:starts[b + 1]], table[b, 1])
+        cdef int64_t[::1] row_offsets = np.empty(stop - start, dtype=np.int64)
+        cdef int64_t[::1] scratch = np.empty(n_block_edges + 1,
+            dtype=np.int64)
+        cdef int64_t* indices_pointer = NULL
+        cdef double* weights_pointer = NULL
+
+        if n_edges:
+            indices_pointer = &indices_view[0] + edge_offset
+            weights_pointer = &weights_view[0] + edge_offset
+        with nogil:
+            _decode_block(_pointer(block), block.shape[0], start, stop,
+                n_block_edges, weighted, &degrees_view[0], indices_pointer,
+                weights_pointer, &row_offsets[0], &scratch[0])
+
+    map_blocks(decode, n_blocks)
+
+    if n_edges and (indices.min() < 0 or indices.max() >= n_vertices):
+        raise ValueError("Graph archive is corrupt.")
+
+    cdef object attributes
+    attributes, position = _unpack(codec, view, position)
+
+    cdef np.ndarray rows = np.repeat(np.arange(n_vertices, dtype=np.int64),
+        degrees)
+    cdef bint directed = flags & FLAG_DIRECTED
+    cdef Graph graph
+    cdef np.ndarray matrix
+    cdef list matrix_list
+    cdef int64_t u, v
+    cdef object weight
+
+    if flags & FLAG_STATIC:
+        matrix = np.full((n_vertices, n_vertices), np.nan, dtype=np.float64)
+        matrix[rows, indices] = weights
+        if not directed:
+            matrix[indices, rows] = weights
+        graph = StaticGraph(directed=directed, vertices=vertices,
+            adjacency_matrix=matrix)
+    else:
+        matrix_list = [[None] * n_vertices for _ in range(n_vertices)]
+        for u, v, weight in zip(rows.tolist(), indices.tolist(),
+                weights.tolist()):
+            matrix_list[u][v] = weight
+            if not directed:
+                matrix_list[v][u] = weight
+        graph = DynamicGraph(directed=directed, vertices=vertices,
+            adjacency_matrix=matrix_list)
+
+    cdef list vertex_dicts = [graph._vertex_attributes[vertex]
+                              for vertex in vertices]
+    cdef np.ndarray edge_ints
+    position = _decode_columns(codec, attributes, 0, vertex_dicts)
+    raw, position = _unpack(codec, attributes, position)
+    if len(raw) % 16:
+        raise ValueError("Graph archive is corrupt.")
+    edge_ints = np.frombuffer(raw, dtype="<i8").astype(np.int64) \
+        .reshape(-1, 2)
+    if len(edge_ints) and (edge_ints.min() < 0
+            or edge_ints.max() >= n_vertices):
+        raise ValueError("Graph archive is corrupt.")
+    cdef list edge_dicts = []
+    for u, v in edge_ints.tolist():
+        graph._edge_attributes[(vertices[u], vertices[v])] = {}
+        edge_dicts.append(graph._edge_attributes[(vertices[u], vertices[v])])
+    if _decode_columns(codec, attributes, position, edge_dicts) \
+            != len(attributes):
+        raise ValueError("Graph archive is corrupt.")
+
+    return graph
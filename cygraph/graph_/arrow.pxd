@@ -0,0 +1,43 @@
+#!python
+#cython: language_level=3
+
+from libc.stdint cimport int64_t
+
+
+# Structs of the Arrow C Data Interface, laid out exactly as in
+# https://arrow.apache.org/docs/format/CDataInterface.html
+cdef struct ArrowSchema:
+    const char* format
+    const char* name
+    const char* metadata
+    int64_t flags
+    int64_t n_children
+    ArrowSchema** children
+    ArrowSchema* dictionary
+    void (*release)(ArrowSchema*) noexcept nogil
+    void* private_data
+
+cdef struct ArrowArray:
+    int64_t length
+    int64_t null_count
+    int64_t offset
+    int64_t n_buffers
+    int64_t n_children
+    const void** buffers
+    ArrowArray** children
+    ArrowArray* dictionary
+    void (*release)(ArrowArray*) noexcept nogil
+    void* private_data
+
+
+cdef class ArrowTable:
+    cdef readonly list names
+    cdef list _formats
+    # Per column, the objects backing its buffers, in Arrow buffer order.
+    cdef list _buffers
+    cdef list _null_counts
+    cdef readonly int64_t length
+
+    cdef void _add_column(self, str name, str format_, list buffers,
+        int64_t null_count) except *
+    cdef void _add_values(self, str name, list values) except *
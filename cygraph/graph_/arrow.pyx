@@ -0,0 +1,765 @@
+#!python
+#cython: language_level=3
+"""Exchange of edge and vertex tables through the Arrow C Data
+Interface.
+
+Tables are exported as Arrow struct arrays whose buffers point straight
+into numpy arrays, and imported by reading the producer's buffers in
+place, so no Arrow library is needed on either side. Objects are passed
+around with the Arrow PyCapsule interface (`__arrow_c_schema__` and
+`__arrow_c_array__`), which pyarrow record batches, polars and DuckDB
+all understand.
+"""
+
+cimport cython
+cimport numpy as np
+import numpy as np
+
+from cpython.pycapsule cimport PyCapsule_GetPointer, PyCapsule_IsValid, \
+    PyCapsule_New
+from cpython.ref cimport PyObject, Py_INCREF, Py_XDECREF
+from libc.stdint cimport int64_t, uint8_t
+from libc.stdlib cimport free, malloc
+from libc.string cimport memcpy, memset
+
+from cygraph.graph_.graph cimport Graph
+from cygraph.graph_.dynamic_graph cimport DynamicGraph
+from cygraph.graph_.static_graph cimport StaticGraph
+from cygraph.tracing import traced
+
+
+cdef int64_t ARROW_FLAG_NULLABLE = 2
+
+# Fixed-width Arrow formats and the numpy types they correspond to.
+NUMPY_FORMATS = {
+    "c": np.int8, "C": np.uint8, "s": np.int16, "S": np.uint16,
+    "i": np.int32, "I": np.uint32, "l": np.int64, "L": np.uint64,
+    "e": np.float16, "f": np.float32, "g": np.float64
+}
+INTEGER_FORMATS = {"c", "C", "s", "S", "i", "I", "l", "L"}
+
+# Pointed to by the buffers of empty columns, which may not be NULL.
+cdef int64_t _EMPTY_BUFFER = 0
+
+_MISSING = object()
+
+
+cdef class _Allocations:
+    """Keeps the objects and memory behind exported structs alive until
+    the consumer has released all of them.
+    """
+    cdef list objects
+    cdef list pointers
+
+    def __cinit__(self):
+        self.objects = []
+        self.pointers = []
+
+    def __dealloc__(self):
+        cdef object pointer
+        for pointer in self.pointers:
+            free(<void*><size_t>pointer)
+
+    cdef void* allocate(self, size_t size) except NULL:
+        cdef void* pointer = malloc(size if size else 1)
+        if pointer == NULL:
+            raise MemoryError()
+        memset(pointer, 0, size)
+        self.pointers.append(<size_t>pointer)
+        return pointer
+
+    cdef const char* keep(self, bytes string):
+        self.objects.append(string)
+        return string
+
+
+cdef void _release_schema(ArrowSchema* schema) noexcept nogil:
+    cdef int64_t i
+    for i in range(schema.n_children):
+        if schema.children[i].release != NULL:
+            schema.children[i].release(schema.children[i])
+    schema.release = NULL
+    with gil:
+        Py_XDECREF(<PyObject*>schema.private_data)
+
+
+cdef void _release_array(ArrowArray* array) noexcept nogil:
+    cdef int64_t i
+    for i in range(array.n_children):
+        if array.children[i].release != NULL:
+            array.children[i].release(array.children[i])
+    array.release = NULL
+    with gil:
+        Py_XDECREF(<PyObject*>array.private_data)
+
+
+cdef void _destroy_schema_capsule(object capsule) noexcept:
+    cdef ArrowSchema* schema = <ArrowSchema*>PyCapsule_GetPointer(capsule,
+        "arrow_schema")
+    if schema.release != NULL:
+        schema.release(schema)
+    free(schema)
+
+
+cdef void _destroy_array_capsule(object capsule) noexcept:
+    cdef ArrowArray* array = <ArrowArray*>PyCapsule_GetPointer(capsule,
+        "arrow_array")
+    if array.release != NULL:
+        array.release(array)
+    free(array)
+
+
+cdef const void* _buffer_pointer(object buffer):
+    """Returns the address of a contiguous numpy array or bytes object.
+    """
+    cdef const uint8_t[::1] view
+    if buffer is None:
+        return NULL
+    view = np.frombuffer(buffer, dtype=np.uint8) \
+        if isinstance(buffer, bytes) else buffer.view(np.uint8).reshape(-1)
+    if view.shape[0] == 0:
+        return &_EMPTY_BUFFER
+    return &view[0]
+
+
+cdef class ArrowTable:
+    """A table of named columns that can be handed to Arrow-native
+    tools without copying, through the Arrow PyCapsule interface.
+
+    Instances are created by cygraph.Graph.to_arrow. To get a pyarrow
+    RecordBatch, use `pyarrow.record_batch(table)`.
+
+    Attributes
+    ----------
+    names: list
+        The column names.
+    length: int
+        The number of rows.
+    """
+
+    def __cinit__(self):
+        self.names = []
+        self._formats = []
+        self._buffers = []
+        self._null_counts = []
+
+    def __len__(self):
+        return self.length
+
+    def __repr__(self):
+        return (f"<ArrowTable; length={self.length}; "
+                f"columns={self.names!r}>")
+
+    cdef void _add_column(self, str name, str format_, list buffers,
+            int64_t null_count) except *:
+        self.names.append(name)
+        self._formats.append(format_)
+        self._buffers.append(buffers)
+        self._null_counts.append(null_count)
+
+    cdef void _add_values(self, str name, list values) except *:
+        """Adds a column of Python values, which may include _MISSING
+        for nulls.
+        """
+        format_, buffers, null_count = _encode_values(name, values)
+        self._add_column(name, format_, buffers, null_count)
+
+    def __arrow_c_schema__(self):
+        """Exports the type of this table as an Arrow struct schema.
+
+        Returns
+        -------
+        PyCapsule
+            An "arrow_schema" capsule.
+        """
+        cdef _Allocations allocations = _Allocations()
+        cdef int64_t n_columns = len(self.names)
+        cdef ArrowSchema* schema = <ArrowSchema*>malloc(sizeof(ArrowSchema))
+        cdef ArrowSchema* child
+        cdef int64_t i
+
+        if schema == NULL:
+            raise MemoryError()
+        memset(schema, 0, sizeof(ArrowSchema))
+        capsule = PyCapsule_New(schema, "arrow_schema", _destroy_schema_capsule)
+
+        schema.children = <ArrowSchema**>allocations.allocate(
+            n_columns * sizeof(ArrowSchema*))
+        for i in range(n_columns):
+            child = <ArrowSchema*>allocations.allocate(sizeof(ArrowSchema))
+            child.format = allocations.keep(self._formats[i].encode())
+            child.name = allocations.keep(self.names[i].encode())
+            child.flags = ARROW_FLAG_NULLABLE
+            child.release = _release_schema
+            child.private_data = <PyObject*>allocations
+            Py_INCREF(allocations)
+            schema.children[i] = child
+
+        schema.format = allocations.keep(b"+s")
+        schema.name = allocations.keep(b"")
+        schema.n_children = n_columns
+        schema.release = _release_schema
+        schema.private_data = <PyObject*>allocations
+        Py_INCREF(allocations)
+        return capsule
+
+    def __arrow_c_array__(self, requested_schema=None):
+        """Exports this table as an Arrow struct array. The buffers of
+        the array are those of this table, so they are not copied.
+
+        Parameters
+        ----------
+        requested_schema: PyCapsule, optional
+            Ignored; the table is always exported with its own schema.
+
+        Returns
+        -------
+        tuple
+            An "arrow_schema" capsule and an "arrow_array" capsule.
+        """
+        cdef _Allocations allocations = _Allocations()
+        cdef int64_t n_columns = len(self.names)
+        cdef ArrowArray* array = <ArrowArray*>malloc(sizeof(ArrowArray))
+        cdef ArrowArray* child
+        cdef list buffers
+        cdef int64_t i, j
+
+        if array == NULL:
+            raise MemoryError()
+        memset(array, 0, sizeof(ArrowArray))
+        capsule = PyCapsule_New(array, "arrow_array", _destroy_array_capsule)
+
+        array.children = <ArrowArray**>allocations.allocate(
+            n_columns * sizeof(ArrowArray*))
+        for i in range(n_columns):
+            buffers = self._buffers[i]
+            allocations.objects.append(buffers)
+            child = <ArrowArray*>allocations.allocate(sizeof(ArrowArray))
+            child.length = self.length
+            child.null_count = self._null_counts[i]
+            child.n_buffers = len(buffers)
+            child.buffers = <const void**>allocations.allocate(
+                len(buffers) * sizeof(void*))
+            for j in range(len(buffers)):
+                child.buffers[j] = _buffer_pointer(buffers[j])
+            child.release = _release_array
+            child.private_data = <PyObject*>allocations
+            Py_INCREF(allocations)
+            array.children[i] = child
+
+        array.length = self.length
+        array.n_buffers = 1
+        array.buffers = <const void**>allocations.allocate(sizeof(void*))
+        array.n_children = n_columns
+        array.release = _release_array
+        array.private_data = <PyObject*>allocations
+        Py_INCREF(allocations)
+        return self.__arrow_c_schema__(), capsule
+
+
+cdef tuple _encode_values(str name, list values):
+    """Picks the Arrow type of a column of Python values and builds its
+    buffers.
+
+    Returns
+    -------
+    tuple
+        The Arrow format string, the list of buffers (validity bitmap
+        first) and the null count.
+
+    Raises
+    ------
+    TypeError
+        The values are not all booleans, numbers or strings.
+    """
+    cdef np.ndarray present = np.array([v is not _MISSING for v in values],
+        dtype=bool)
+    cdef list present_values = [v for v in values if v is not _MISSING]
+    cdef int64_t null_count = len(values) - len(present_values)
+    cdef object validity = None
+    cdef list filled
+    cdef np.ndarray offsets
+    cdef bytes data
+
+    if null_count:
+        validity = np.packbits(present, bitorder="little")
+    if not present_values:
+        return "n", [], len(values)
+
+    if all(isinstance(v, (bool, np.bool_)) for v in present_values):
+        filled = [bool(v) if v is not _MISSING else False for v in values]
+        return "b", [validity, np.packbits(np.array(filled, dtype=bool),
+            bitorder="little")], null_count
+    if all(isinstance(v, (int, np.integer)) and not isinstance(v, bool)
+            for v in present_values):
+        filled = [v if v is not _MISSING else 0 for v in values]
+        try:
+            return "l", [validity, np.array(filled, dtype=np.int64)], \
+                null_count
+        except OverflowError:
+            pass
+    if all(isinstance(v, (int, float, np.integer, np.floating))
+            and not isinstance(v, bool) for v in present_values):
+        filled = [v if v is not _MISSING else 0.0 for v in values]
+        return "g", [validity, np.array(filled, dtype=np.float64)], \
+            null_count
+    if all(isinstance(v, str) for v in present_values):
+        filled = [v.encode() if v is not _MISSING else b"" for v in values]
+        offsets = np.zeros(len(values) + 1, dtype=np.int64)
+        np.cumsum([len(v) for v in filled], out=offsets[1:])
+        data = b"".join(filled)
+        if offsets[-1] < 2 ** 31:
+            return "u", [validity, offsets.astype(np.int32), data], null_count
+        return "U", [validity, offsets, data], null_count
+
+    raise TypeError(f"Column {name!r} has values that are not all "
+                    "booleans, numbers or strings, so it cannot be exported "
+                    "to Arrow.")
+
+
+cdef ArrowTable _edge_table(Graph graph):
+    """Builds the table of edges of a graph. See Graph.to_arrow.
+    """
+    cdef int64_t n_vertices = len(graph.vertices)
+    cdef np.ndarray indptr, indices, weights, rows, keep
+    cdef ArrowTable table = ArrowTable()
+    cdef list vertices = graph.vertices
+    cdef list attributes = []
+    cdef dict edge_attributes, empty = {}
+    cdef object key
+    cdef dict keys = {}
+    cdef int64_t u, v
+
+    indptr, indices, weights = graph._get_csr()
+    rows = np.repeat(np.arange(n_vertices, dtype=np.int64), np.diff(indptr))
+    if not graph.directed:
+        keep = indices >= rows
+        rows = rows[keep]
+        indices = indices[keep]
+        weights = weights[keep]
+
+    table.length = len(rows)
+    table._add_column("source", "l", [None, np.ascontiguousarray(rows)], 0)
+    table._add_column("target", "l",
+        [None, np.ascontiguousarray(indices, dtype=np.int64)], 0)
+    table._add_column("weight", "g",
+        [None, np.ascontiguousarray(weights, dtype=np.float64)], 0)
+
+    if graph._edge_attributes:
+        for u, v in zip(rows.tolist(), indices.tolist()):
+            edge_attributes = graph._edge_attributes.get(
+                (vertices[u], vertices[v]))
+            if edge_attributes is None and not graph.directed:
+                edge_attributes = graph._edge_attributes.get(
+                    (vertices[v], vertices[u]))
+            attributes.append(edge_attributes or empty)
+            for key in attributes[-1]:
+                keys[key] = None
+    for key in keys:
+        table._add_values(_column_name(key, table.names),
+            [a.get(key, _MISSING) for a in attributes])
+
+    return table
+
+
+cdef ArrowTable _vertex_table(Graph graph):
+    """Builds the table of vertices of a graph. See Graph.to_arrow.
+    """
+    cdef ArrowTable table = ArrowTable()
+    cdef list attributes = [graph._vertex_attributes[v]
+                            for v in graph.vertices]
+    cdef dict vertex_attributes
+    cdef dict keys = {}
+    cdef object key
+
+    table.length = len(graph.vertices)
+    table._add_column("id", "l",
+        [None, np.arange(len(graph.vertices), dtype=np.int64)], 0)
+    table._add_values("label", list(graph.vertices))
+
+    for vertex_attributes in attributes:
+        for key in vertex_attributes:
+            keys[key] = None
+    for key in keys:
+        table._add_values(_column_name(key, table.names),
+            [a.get(key, _MISSING) for a in attributes])
+
+    return table
+
+
+def graph_to_arrow(Graph graph not None, str kind="edges"):
+    """Exports the edges or vertices of a graph as an Arrow table. See
+    cygraph.Graph.to_arrow.
+    """
+    if kind == "edges":
+        return _edge_table(graph)
+    elif kind == "vertices":
+        return _vertex_table(graph)
+    raise ValueError(f"kind must be 'edges' or 'vertices', not {kind!r}.")
+
+
+cdef str _column_name(object key, list names):
+    """Returns the column name of an attribute key.
+    """
+    cdef str name = str(key)
+    if name in names:
+        raise ValueError(f"Attribute {key!r} clashes with the {name!r} "
+                         "column.")
+    return name
+
+
+@cython.auto_pickle(False)
+cdef class _ImportedArray:
+    """Owns an Arrow schema and array moved out of their capsules and
+    releases them once nothing reads their buffers anymore.
+    """
+    cdef ArrowSchema schema
+    cdef ArrowArray array
+
+    def __dealloc__(self):
+        if self.array.release != NULL:
+            self.array.release(&self.array)
+        if self.schema.release != NULL:
+            self.schema.release(&self.schema)
+
+
+@cython.auto_pickle(False)
+cdef class _BufferView:
+    """Exposes memory owned by an imported Arrow array through the
+    buffer protocol, keeping the array alive.
+    """
+    cdef const uint8_t* pointer
+    cdef Py_ssize_t size
+    cdef _ImportedArray owner
+    cdef Py_ssize_t shape[1]
+
+    def __getbuffer__(self, Py_buffer* buffer, int flags):
+        self.shape[0] = self.size
+        buffer.buf = <void*>self.pointer
+        buffer.obj = self
+        buffer.len = self.size
+        buffer.readonly = 1
+        buffer.itemsize = 1
+        buffer.format = "B"
+        buffer.ndim = 1
+        buffer.shape = self.shape
+        buffer.strides = NULL
+        buffer.suboffsets = NULL
+        buffer.internal = NULL
+
+    def __releasebuffer__(self, Py_buffer* buffer):
+        pass
+
+
+cdef np.ndarray _wrap(_ImportedArray owner, const void* pointer,
+        Py_ssize_t size):
+    """Returns a uint8 array over `size` bytes of an imported buffer.
+    """
+    cdef _BufferView view = _BufferView()
+    if size == 0:
+        return np.zeros(0, dtype=np.uint8)
+    if pointer == NULL:
+        raise ValueError("Arrow column is missing a buffer.")
+    view.pointer = <const uint8_t*>pointer
+    view.size = size
+    view.owner = owner
+    return np.frombuffer(view, dtype=np.uint8)
+
+
+cdef np.ndarray _unpack_bits(np.ndarray bits, int64_t offset, int64_t length):
+    return np.unpackbits(bits, bitorder="little",
+        count=offset + length)[offset:].astype(bool)
+
+
+cdef tuple _decode_column(_ImportedArray owner, ArrowSchema* schema,
+        ArrowArray* array, int64_t offset, int64_t length):
+    """Reads `length` rows of an imported column, starting `offset` rows
+    into its parent.
+
+    Returns
+    -------
+    tuple
+        The values, as a numpy array viewing the Arrow buffer for
+        fixed-width types or as a list otherwise, and a boolean array of
+        which rows are valid (None if they all are).
+    """
+    cdef str format_ = schema.format.decode()
+    cdef str name = schema.name.decode() if schema.name != NULL else ""
+    cdef object dtype
+    cdef object valid = None
+    cdef np.ndarray values, offsets, data
+    cdef Py_ssize_t itemsize
+    cdef int64_t i
+
+    if array.length < offset + length:
+        raise ValueError(f"Arrow column {name!r} is shorter than its table.")
+    offset += array.offset
+    if format_ == "n":
+        return [None] * length, np.zeros(length, dtype=bool)
+    if array.null_count != 0 and array.n_buffers and array.buffers[0] != NULL:
+        valid = _unpack_bits(_wrap(owner, array.buffers[0],
+            (offset + length + 7) // 8), offset, length)
+
+    if format_ in NUMPY_FORMATS:
+        dtype = np.dtype(NUMPY_FORMATS[format_])
+        itemsize = dtype.itemsize
+        values = _wrap(owner, array.buffers[1], (offset + length) * itemsize) \
+            [offset * itemsize:].view(dtype)
+        return values, valid
+    if format_ == "b":
+        values = _unpack_bits(_wrap(owner, array.buffers[1],
+            (offset + length + 7) // 8), offset, length)
+        return values, valid
+    if format_ in ("u", "U"):
+        dtype = np.int32 if format_ == "u" else np.int64
+        itemsize = np.dtype(dtype).itemsize
+        offsets = _wrap(owner, array.buffers[1],
+            (offset + length + 1) * itemsize)[offset * itemsize:].view(dtype)
+        data = _wrap(owner, array.buffers[2],
+            offsets[-1] if length else 0)
+        return [bytes(data[offsets[i]:offsets[i + 1]]).decode()
+                for i in range(length)], valid
+
+    raise TypeError(f"Cannot import Arrow column {name!r} of format "
+                    f"{format_!r}.")
+
+
+cdef dict _import_table(object table):
+    """Reads an Arrow struct array exported through the PyCapsule
+    interface.
+
+    Returns
+    -------
+    dict
+        Maps each column name to the (values, valid) pair returned by
+        _decode_column.
+    """
+    cdef object capsules, schema_capsule, array_capsule
+    cdef ArrowSchema* schema
+    cdef ArrowArray* array
+    cdef _ImportedArray imported = _ImportedArray()
+    cdef dict columns = {}
+    cdef int64_t i
+
+    if hasattr(table, "__arrow_c_array__"):
+        capsules = table.__arrow_c_array__()
+    else:
+        capsules = table
+    try:
+        schema_capsule, array_capsule = capsules
+    except (TypeError, ValueError):
+        raise TypeError("Expected an object implementing __arrow_c_array__ "
+                        "or a pair of arrow_schema and arrow_array "
+                        "capsules.")
+    if not (PyCapsule_IsValid(schema_capsule, "arrow_schema")
+            and PyCapsule_IsValid(array_capsule, "arrow_array")):
+        raise TypeError("Expected arrow_schema and arrow_array capsules.")
+
+    # Move the structs out of the capsules; the capsules then have
+    # nothing left to release.
+    schema = <ArrowSchema*>PyCapsule_GetPointer(schema_capsule, "arrow_schema")
+    array = <ArrowArray*>PyCapsule_GetPointer(array_capsule, "arrow_array")
+    if schema.release == NULL or array.release == NULL:
+        raise ValueError("Arrow data has already been released.")
+    memcpy(&imported.schema, schema, sizeof(ArrowSchema))
+    memcpy(&imported.array, array, sizeof(ArrowArray))
+    schema.release = NULL
+    array.release = NULL
+
+    if imported.schema.format.decode() != "+s":
+        raise TypeError("Arrow data must be a struct array (a table).")
+    # A null count of -1 means unknown, so check the validity bitmap.
+    if imported.array.null_count != 0 and imported.array.n_buffers \
+            and imported.array.buffers[0] != NULL \
+            and not _unpack_bits(_wrap(imported, imported.array.buffers[0],
+                (imported.array.offset + imported.array.length + 7) // 8),
+                imported.array.offset, imported.array.length).all():
+        raise ValueError("Arrow tables with null rows are not supported.")
+    if imported.schema.n_children != imported.array.n_children:
+        raise ValueError("Arrow schema does not match its array.")
+    for i in range(imported.schema.n_children):
+        columns[imported.schema.children[i].name.decode()] = _decode_column(
+            imported, imported.schema.children[i], imported.array.children[i],
+            imported.array.offset, imported.array.length)
+    return columns
+
+
+cdef np.ndarray _integer_column(dict columns, str name):
+    """Returns a required, non-null integer column as int64.
+    """
+    cdef object values, valid
+    if name not in columns:
+        raise ValueError(f"Arrow edge table has no {name!r} column.")
+    values, valid = columns[name]
+    if not isinstance(values, np.ndarray) or values.dtype.kind not in "iu":
+        raise TypeError(f"Column {name!r} must be of an integer type.")
+    if valid is not None and not valid.all():
+        raise ValueError(f"Column {name!r} has nulls.")
+    return values.astype(np.int64, copy=False)
+
+
+cdef list _row_values(tuple column):
+    """Converts a decoded column to a list with _MISSING for nulls.
+    """
+    values, valid = column
+    cdef list result = values.tolist() if isinstance(values, np.ndarray) \
+        else list(values)
+    cdef int64_t i
+    if valid is not None:
+        for i in np.flatnonzero(~valid).tolist():
+            result[i] = _MISSING
+    return result
+
+
+@traced("from_arrow", "graph")
+def from_arrow(edges, vertices=None, bint directed=False, bint static=False):
+    """Creates a graph from Arrow tables, such as those made by
+    cygraph.Graph.to_arrow or pyarrow RecordBatches.
+
+    Parameters
+    ----------
+    edges
+        An object implementing `__arrow_c_array__`, or a pair of
+        "arrow_schema" and "arrow_array" capsules, holding a struct
+        array with integer "source" and "target" columns of vertex ids.
+        An optional numeric "weight" column holds edge weights (nulls
+        mean 1.0) and every other column becomes an edge attribute.
+    vertices: optional
+        A table in the same form describing the vertices. An optional
+        "id" column holds the id of each row (otherwise ids are row
+        numbers), an optional "label" column holds the vertices
+        themselves (otherwise the ids are used), and every other column
+        becomes a vertex attribute. If not given, the vertices are the
+        integers up to the largest id in `edges`.
+    directed: bint, optional
+        Whether to create a directed graph.
+    static: bint, optional
+        Whether to create a cygraph.StaticGraph or cygraph.DynamicGraph.
+
+    Returns
+    -------
+    cygraph.Graph
+        A graph.
+
+    Raises
+    ------
+    TypeError
+        A table is not an Arrow struct array or has a column of an
+        unsupported type.
+    ValueError
+        A table is missing a required column, refers to vertex ids that
+        do not exist, or has the same edge more than once.
+    """
+    cdef dict edge_columns = _import_table(edges)
+    cdef dict vertex_columns = {} if vertices is None \
+        else _import_table(vertices)
+    cdef np.ndarray sources = _integer_column(edge_columns, "source")
+    cdef np.ndarray targets = _integer_column(edge_columns, "target")
+    cdef np.ndarray weights, ids, order
+    cdef int64_t n_vertices, n_edges = len(sources)
+    cdef list labels, rows
+    cdef object values, valid, name, weight
+    cdef Graph graph
+    cdef np.ndarray matrix
+    cdef list matrix_list
+    cdef int64_t u, v, i
+    cdef dict attributes
+
+    # Vertices.
+    if vertices is None:
+        n_vertices = 0
+        if n_edges:
+            n_vertices = max(sources.max(), targets.max()) + 1
+        ids = np.arange(n_vertices, dtype=np.int64)
+    else:
+        n_vertices = -1
+        for values, valid in vertex_columns.values():
+            n_vertices = len(values)
+            break
+        if n_vertices == -1:
+            raise ValueError("Arrow vertex table has no columns.")
+        if "id" in vertex_columns:
+            ids = _integer_column(vertex_columns, "id")
+            if not np.array_equal(np.sort(ids), np.arange(n_vertices)):
+                raise ValueError("Vertex ids must be 0 to the number of "
+                                 "vertices minus one.")
+        else:
+            ids = np.arange(n_vertices, dtype=np.int64)
+    if n_edges and (min(sources.min(), targets.min()) < 0
+            or max(sources.max(), targets.max()) >= n_vertices):
+        raise ValueError("Arrow edge table refers to vertex ids that are "
+                         "not in the graph.")
+
+    order = np.empty(n_vertices, dtype=np.int64)
+    order[ids] = np.arange(n_vertices, dtype=np.int64)
+    if "label" in vertex_columns:
+        rows = _row_values(vertex_columns["label"])
+        labels = [rows[i] for i in order.tolist()]
+        if _MISSING in labels:
+            raise ValueError("Column 'label' has nulls.")
+    else:
+        labels = list(range(n_vertices))
+
+    # Edges.
+    weights = np.ones(n_edges, dtype=np.float64)
+    if "weight" in edge_columns:
+        values, valid = edge_columns["weight"]
+        if not isinstance(values, np.ndarray) or values.dtype.kind not in "iuf":
+            raise TypeError("Column 'weight' must be of a numeric type.")
+        weights = values.astype(np.float64)
+        if valid is not None:
+            weights[~valid] = 1.0
+
+    # Give each undirected edge as (smaller id, larger id), as
+    # GraphBuilder does, so that both orders of a pair are the same
+    # edge.
+    if not directed:
+        sources, targets = (np.minimum(sources, targets),
+                            np.maximum(sources, targets))
+    order = np.lexsort((targets, sources))
+    cdef np.ndarray duplicates = np.flatnonzero(
+        (sources[order][1:] == sources[order][:-1])
+        & (targets[order][1:] == targets[order][:-1]))
+    if len(duplicates):
+        i = order[duplicates[0]]
+        raise ValueError(f"Edge ({labels[sources[i]]}, "
+                         f"{labels[targets[i]]}) appears more than once in "
+                         "the Arrow edge table.")
+
+    if static:
+        matrix = np.full((n_vertices, n_vertices), np.nan, dtype=np.float64)
+        matrix[sources, targets] = weights
+        if not directed:
+            matrix[targets, sources] = weights
+        graph = StaticGraph(directed=directed, vertices=labels,
+            adjacency_matrix=matrix)
+    else:
+        matrix_list = [[None] * n_vertices for _ in range(n_vertices)]
+        for u, v, weight in zip(sources.tolist(), targets.tolist(),
+                weights.tolist()):
+            matrix_list[u][v] = weight
+            if not directed:
+                matrix_list[v][u] = weight
+        graph = DynamicGraph(directed=directed, vertices=labels,
+            adjacency_matrix=matrix_list)
+
+    # Attributes.
+    for name in vertex_columns:
+        if name in ("id", "label"):
+            continue
+        rows = _row_values(vertex_columns[name])
+        for i, u in enumerate(ids.tolist()):
+            if rows[i] is not _MISSING:
+                graph._vertex_attributes[labels[u]][name] = rows[i]
+
+    for u, v in zip(sources.tolist(), targets.tolist()):
+        graph._edge_attributes[(labels[u], labels[v])] = {}
+    for name in edge_columns:
+        if name in ("source", "target", "weight"):
+            continue
+        rows = _row_values(edge_columns[name])
+        for i, (u, v) in enumerate(zip(sources.tolist(), targets.tolist())):
+            if rows[i] is not _MISSING:
+                graph._edge_attributes[(labels[u], labels[v])][name] = rows[i]
+
+    return graph
@@ -0,0 +1,22 @@
+#!python
+#cython: language_level=3
+
+cimport numpy as np
+
+
+cdef class GraphBatch:
+    cdef readonly bint directed
+    cdef readonly Py_ssize_t number_of_graphs
+
+    # The vertices of graph i are _vertex_offsets[i] to
+    # _vertex_offsets[i + 1] - 1 in the block-diagonal compressed sparse
+    # rows below, which hold the edges of all graphs with their
+    # vertices shifted by the offsets. Undirected edges are stored in
+    # the rows of both of their endpoints, as in cygraph.IntGraph.
+    cdef np.ndarray _vertex_offsets
+    cdef np.ndarray _indptr
+    cdef np.ndarray _indices
+    cdef np.ndarray _weights
+
+    cdef Py_ssize_t _check_graph(self, Py_ssize_t i) except -1
+    cdef tuple _get_csr(self)
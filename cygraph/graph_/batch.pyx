@@ -0,0 +1,276 @@
+#!python
+#cython: language_level=3
+"""Implementation of a container that packs many small graphs into one
+set of arrays.
+"""
+
+from libc.stdint cimport int64_t
+
+cimport numpy as np
+import numpy as np
+
+from cygraph.graph_.graph cimport Graph
+from cygraph.graph_.int_graph cimport IntGraph, csr_to_int_graph
+from cygraph.graph_.sparse import build_csr
+from cygraph.tracing import traced
+
+
+cdef class GraphBatch:
+    """A class representing many small graphs packed into a single
+    block-diagonal adjacency structure (compressed sparse rows), so that
+    batched algorithms in cygraph.algorithms can process all of them in
+    one parallel call without the GIL, instead of paying per-graph
+    Python overhead.
+
+    Each member graph's vertices are numbered 0 to n - 1 within it, in
+    the order of its `vertices`. Members are read-only; indexing the
+    batch returns a cygraph.IntGraph copy of a member.
+
+    Parameters
+    ----------
+    graphs: iterable, optional
+        cygraph.Graph or cygraph.IntGraph instances, which must all be
+        directed or all be undirected. Attributes are not kept.
+    directed: bint, optional
+        Whether or not the graphs are directed, if `graphs` is empty.
+
+    Attributes
+    ----------
+    directed: bint
+        Whether or not edges are directed.
+    number_of_graphs: int
+        The number of graphs in the batch.
+    vertex_offsets: np.ndarray
+        The position of the first vertex of each graph among the
+        vertices of all graphs, followed by the total number of
+        vertices.
+    vertex_counts, edge_counts: np.ndarray
+        The number of vertices and edges of each graph, counting
+        undirected edges once.
+    graph_ids: np.ndarray
+        The graph that each vertex of the batch belongs to.
+
+    Examples
+    --------
+    >>> batch = cg.GraphBatch.from_edges([3, 2], [2, 1], [0, 1, 0],
+    ...                                  [1, 2, 1])
+    >>> batch.vertex_offsets
+    array([0, 3, 5])
+    >>> batch[1].get_children(0)
+    array([1], dtype=int32)
+    """
+
+    def __cinit__(self, object graphs=(), object directed=None):
+        cdef list indptrs = [np.zeros(1, dtype=np.int64)]
+        cdef list index_arrays = []
+        cdef list weight_arrays = []
+        cdef list vertex_counts = []
+        cdef np.ndarray indptr, indices, weights
+        cdef object graph
+        # Without an explicit `directed`, the first graph decides.
+        cdef bint known = directed is not None
+        cdef bint batch_directed = known and directed
+        cdef bint graph_directed
+        cdef Py_ssize_t n_vertices = 0
+        cdef int64_t n_entries = 0
+
+        for graph in graphs:
+            if isinstance(graph, Graph):
+                indptr, indices, weights = (<Graph>graph)._get_csr()
+            elif isinstance(graph, IntGraph):
+                indptr, indices, weights = (<IntGraph>graph)._get_csr()
+            else:
+                raise TypeError("A GraphBatch can only hold cygraph.Graph "
+                                "and cygraph.IntGraph instances, not "
+                                f"{type(graph).__name__}.")
+            graph_directed = graph.directed
+            if not known:
+                batch_directed = graph_directed
+                known = True
+            elif batch_directed != graph_directed:
+                raise ValueError("The graphs of a GraphBatch must be all "
+                                 "directed or all undirected.")
+            indptrs.append(indptr[1:] + n_entries)
+            index_arrays.append(indices.astype(np.int64) + n_vertices)
+            weight_arrays.append(weights)
+            vertex_counts.append(len(indptr) - 1)
+            n_vertices += len(indptr) - 1
+            n_entries += len(indices)
+
+        self.directed = batch_directed
+        self.number_of_graphs = len(vertex_counts)
+        self._vertex_offsets = np.zeros(self.number_of_graphs + 1,
+                                        dtype=np.int64)
+        np.cumsum(vertex_counts, out=self._vertex_offsets[1:])
+        self._indptr = np.concatenate(indptrs)
+        self._indices = np.concatenate(index_arrays + [
+            np.zeros(0, dtype=np.int64)])
+        self._weights = np.concatenate(weight_arrays + [
+            np.zeros(0, dtype=np.float64)])
+
+    @staticmethod
+    @traced("GraphBatch.from_edges", "graph")
+    def from_edges(vertex_counts, edge_counts, sources, targets, weights=None,
+            directed=False):
+        """Creates a batch from the edges of all of its graphs at once,
+        without creating a graph object for each of them.
+
+        Parameters
+        ----------
+        vertex_counts: array-like of int
+            The number of vertices of each graph.
+        edge_counts: array-like of int
+            The number of edges of each graph. The edges of the first
+            graph come first in `sources` and `targets`, then those of
+            the second one, and so on.
+        sources, targets: array-like of int
+            The endpoints of every edge, numbered within its graph.
+        weights: array-like of float, optional
+            The weight of every edge. Defaults to 1.
+        directed: bint, optional
+            Whether or not the edges are directed.
+
+        Returns
+        -------
+        cygraph.GraphBatch
+            The batch.
+        """
+        cdef np.ndarray vertex_count_array = np.asarray(vertex_counts,
+                                                        dtype=np.int64)
+        cdef np.ndarray edge_count_array = np.asarray(edge_counts,
+                                                      dtype=np.int64)
+        cdef np.ndarray source_array = np.asarray(sources, dtype=np.int64)
+        cdef np.ndarray target_array = np.asarray(targets, dtype=np.int64)
+        if len(vertex_count_array) != len(edge_count_array):
+            raise ValueError(f"Got {len(vertex_count_array)} vertex counts "
+                             f"and {len(edge_count_array)} edge counts.")
+        if (vertex_count_array < 0).any() or (edge_count_array < 0).any():
+            raise ValueError("Vertex and edge counts cannot be negative.")
+        if edge_count_array.sum() != len(source_array):
+            raise ValueError(f"The edge counts add up to "
+                             f"{edge_count_array.sum()}, but there are "
+                             f"{len(source_array)} edges.")
+
+        cdef GraphBatch batch = GraphBatch(directed=directed)
+        batch.number_of_graphs = len(vertex_count_array)
+        batch._vertex_offsets = np.zeros(batch.number_of_graphs + 1,
+                                         dtype=np.int64)
+        np.cumsum(vertex_count_array, out=batch._vertex_offsets[1:])
+
+        cdef np.ndarray graph_of_edges = np.repeat(
+            np.arange(batch.number_of_graphs), edge_count_array)
+        cdef np.ndarray sizes = vertex_count_array[graph_of_edges]
+        if ((source_array < 0) | (source_array >= sizes)
+                | (target_array < 0) | (target_array >= sizes)).any():
+            raise ValueError("Every edge's endpoints must be vertices of "
+                             "its graph.")
+        cdef np.ndarray offsets = batch._vertex_offsets[graph_of_edges]
+        cdef Py_ssize_t n_vertices = batch._vertex_offsets[-1]
+        cdef object matrix = build_csr(source_array + offsets,
+            target_array + offsets, weights, shape=(n_vertices, n_vertices),
+            combine=None, symmetrize=not directed, index_dtype=np.int64)
+        cdef np.ndarray rows = np.repeat(np.arange(n_vertices),
+                                         np.diff(matrix.indptr))
+        cdef np.ndarray duplicates = np.flatnonzero(
+            (rows[1:] == rows[:-1])
+            & (matrix.indices[1:] == matrix.indices[:-1]))
+        if len(duplicates):
+            raise ValueError(f"Edge ({rows[duplicates[0]]}, "
+                             f"{matrix.indices[duplicates[0]]}) of the batch "
+                             "appears more than once.")
+        batch._indptr = matrix.indptr
+        batch._indices = matrix.indices
+        batch._weights = matrix.data
+        return batch
+
+    def __len__(self):
+        return self.number_of_graphs
+
+    def __iter__(self):
+        cdef Py_ssize_t i
+        for i in range(self.number_of_graphs):
+            yield self[i]
+
+    def __getitem__(self, Py_ssize_t i):
+        i = self._check_graph(i)
+        cdef int64_t first = self._vertex_offsets[i]
+        cdef int64_t last = self._vertex_offsets[i + 1]
+        cdef int64_t start = self._indptr[first]
+        cdef int64_t stop = self._indptr[last]
+        return csr_to_int_graph(self.directed,
+                                self._indptr[first:last + 1] - start,
+                                self._indices[start:stop] - first,
+                                self._weights[start:stop].copy())
+
+    def __repr__(self):
+        return (f"<{self.__class__.__name__}; "
+                f"number_of_graphs={self.number_of_graphs}; "
+                f"number_of_vertices={self.number_of_vertices}>")
+
+    def __reduce__(self):
+        cdef np.ndarray rows = np.repeat(np.arange(self.number_of_vertices),
+                                         np.diff(self._indptr))
+        cdef np.ndarray keep = np.ones(len(rows), dtype=bool)
+        if not self.directed:
+            keep = rows <= self._indices
+        cdef np.ndarray offsets = \
+            self._vertex_offsets[self.graph_ids[rows[keep]]]
+        return (_rebuild_graph_batch, (self.vertex_counts, self.edge_counts,
+                rows[keep] - offsets, self._indices[keep] - offsets,
+                self._weights[keep], self.directed))
+
+    @property
+    def number_of_vertices(self):
+        return int(self._vertex_offsets[-1])
+
+    @property
+    def vertex_offsets(self):
+        cdef np.ndarray view = self._vertex_offsets.view()
+        view.flags.writeable = False
+        return view
+
+    @property
+    def vertex_counts(self):
+        return np.diff(self._vertex_offsets)
+
+    @property
+    def edge_counts(self):
+        cdef np.ndarray entries = np.diff(self._indptr[self._vertex_offsets])
+        if self.directed:
+            return entries
+        cdef np.ndarray loops = np.bincount(
+            self.graph_ids[self._indices[
+                np.repeat(np.arange(self.number_of_vertices),
+                          np.diff(self._indptr)) == self._indices]],
+            minlength=self.number_of_graphs)
+        return (entries + loops) // 2
+
+    @property
+    def graph_ids(self):
+        return np.repeat(np.arange(self.number_of_graphs),
+                         self.vertex_counts)
+
+    cdef Py_ssize_t _check_graph(self, Py_ssize_t i) except -1:
+        """Returns the index of a graph in the batch, counting negative
+        indices from the end.
+        """
+        if i < 0:
+            i += self.number_of_graphs
+        if not 0 <= i < self.number_of_graphs:
+            raise IndexError(f"Graph {i} is not in batch of "
+                             f"{self.number_of_graphs} graphs.")
+        return i
+
+    cdef tuple _get_csr(self):
+        """Returns the block-diagonal compressed sparse rows of all
+        graphs, as (indptr, indices, weights) int64, int64 and float64
+        arrays, together with the vertex offsets of the graphs.
+        """
+        return self._indptr, self._indices, self._weights, \
+            self._vertex_offsets
+
+
+def _rebuild_graph_batch(vertex_counts, edge_counts, sources, targets, weights,
+        directed):
+    return GraphBatch.from_edges(vertex_counts, edge_counts, sources, targets,
+                                 weights, directed)
@@ -0,0 +1,36 @@
+#!python
+#cython: language_level=3
+
+cimport numpy as np
+
+
+cdef class GraphBuilder:
+    cdef readonly list vertices
+    cdef readonly bint directed
+    cdef dict _vertex_ints
+
+    # Edges in the order they were added, as vertex ints. Only the first
+    # _n_edges entries are used; the arrays double in size when full.
+    cdef np.int64_t[::1] _sources
+    cdef np.int64_t[::1] _targets
+    cdef double[::1] _weights
+    cdef Py_ssize_t _n_edges
+
+    # Attributes, keyed by vertex int and by edge position. Vertices
+    # and edges without attributes have no entry.
+    cdef dict _vertex_attributes
+    cdef dict _edge_attributes
+
+    cdef Py_ssize_t _add_vertex_int(self, object vertex) except -1
+    cdef void _reserve(self, Py_ssize_t n_edges) except *
+    cdef tuple _unique_edges(self, object combine)
+    cdef object _finalize(self, str backend, object combine)
+
+    cpdef Py_ssize_t add_vertex(self, object v, dict attributes=*) except -1
+    cpdef void add_vertices(self, object vertices, dict attributes=*) except *
+    cpdef void add_edge(self, object v1, object v2, double weight=*,
+        dict attributes=*) except *
+    cpdef void add_edges(self, object edges) except *
+    cpdef void add_edge_arrays(self, object sources, object targets,
+        object weights=*, dict attributes=*) except *
+    cpdef object finalize(self, str backend=*, object combine=*)
@@ -0,0 +1,398 @@
+#!python
+#cython: language_level=3
+"""Accumulates vertices, edges and attributes, and builds a graph from
+them in one pass.
+"""
+
+cimport numpy as np
+import numpy as np
+
+from cygraph.graph_.graph cimport Graph
+from cygraph.graph_.dynamic_graph cimport DynamicGraph
+from cygraph.graph_.int_graph cimport IntGraph
+from cygraph.graph_.static_graph cimport StaticGraph
+from cygraph.graph_.sparse import build_csr
+from cygraph.tracing import span
+
+
+# The graph types that GraphBuilder.finalize can create.
+BACKENDS = ("dynamic", "static", "int")
+
+
+cdef class GraphBuilder:
+    """Accumulates the vertices, edges and attributes of a graph, and
+    creates the graph once they are all known.
+
+    Adding edges one at a time to a StaticGraph or DynamicGraph, or
+    passing an adjacency list to their constructors, checks every pair
+    of vertices. A GraphBuilder instead appends edges to growable
+    arrays of vertex integers, and finalize sorts them into rows in
+    O(V + E) time before filling in the graph in a single pass.
+
+    Edges may mention vertices that have not been added yet; they are
+    added in the order they are first seen. Duplicate edges are only
+    detected by finalize, where they can be combined.
+
+    Parameters
+    ----------
+    directed: bint, optional
+        Whether or not the graph contains directed edges.
+    vertices: iterable, optional
+        Vertices to add first (can be any hashable type).
+
+    Attributes
+    ----------
+    directed: bint
+        Whether or not the graph contains directed edges.
+    vertices: list
+        The vertices added so far, in the order they were added.
+    number_of_vertices: int
+        The number of vertices added so far.
+    number_of_edges: int
+        The number of edges added so far, including duplicates.
+
+    Examples
+    --------
+    >>> builder = cg.GraphBuilder()
+    >>> builder.add_edges([("a", "b"), ("b", "c", 2.0)])
+    >>> builder.add_edges({"source": ["c"], "target": ["a"],
+    ...                    "color": ["red"]})
+    >>> G = builder.finalize(backend="static")
+    >>> G.get_edge_attribute(("a", "c"), "color")
+    'red'
+    """
+
+    def __cinit__(self, bint directed=False, object vertices=()):
+        self.directed = directed
+        self.vertices = []
+        self._vertex_ints = {}
+        self._sources = np.zeros(16, dtype=np.int64)
+        self._targets = np.zeros(16, dtype=np.int64)
+        self._weights = np.zeros(16, dtype=np.float64)
+        self._n_edges = 0
+        self._vertex_attributes = {}
+        self._edge_attributes = {}
+        self.add_vertices(vertices)
+
+    def __len__(self):
+        return len(self.vertices)
+
+    def __repr__(self):
+        return (f"<{self.__class__.__name__}; "
+                f"number_of_vertices={self.number_of_vertices}; "
+                f"number_of_edges={self.number_of_edges}>")
+
+    @property
+    def number_of_vertices(self):
+        return len(self.vertices)
+
+    @property
+    def number_of_edges(self):
+        return self._n_edges
+
+    cdef Py_ssize_t _add_vertex_int(self, object vertex) except -1:
+        """Returns the int corresponding to a vertex, adding the vertex
+        if it has not been added yet.
+        """
+        cdef Py_ssize_t u
+        try:
+            return self._vertex_ints[vertex]
+        except KeyError:
+            pass
+        u = len(self.vertices)
+        self._vertex_ints[vertex] = u
+        self.vertices.append(vertex)
+        return u
+
+    cdef void _reserve(self, Py_ssize_t n_edges) except *:
+        """Grows the edge arrays so that n_edges more edges fit.
+        """
+        cdef Py_ssize_t capacity = self._sources.shape[0]
+        cdef Py_ssize_t needed = self._n_edges + n_edges
+        if needed <= capacity:
+            return
+        capacity = max(2 * capacity, needed)
+        cdef np.ndarray grown
+        grown = np.zeros(capacity, dtype=np.int64)
+        grown[:self._n_edges] = self._sources[:self._n_edges]
+        self._sources = grown
+        grown = np.zeros(capacity, dtype=np.int64)
+        grown[:self._n_edges] = self._targets[:self._n_edges]
+        self._targets = grown
+        grown = np.zeros(capacity, dtype=np.float64)
+        grown[:self._n_edges] = self._weights[:self._n_edges]
+        self._weights = grown
+
+    cpdef Py_ssize_t add_vertex(self, object v, dict attributes=None
+            ) except -1:
+        """Adds a vertex if it has not been added yet, and sets
+        attributes to it.
+
+        Parameters
+        ----------
+        v
+            A vertex of any hashable type.
+        attributes: dict, optional
+            Maps vertex attribute keys to their values.
+
+        Returns
+        -------
+        int
+            The position of `v` in `vertices`.
+        """
+        cdef Py_ssize_t u = self._add_vertex_int(v)
+        if attributes:
+            self._vertex_attributes.setdefault(u, {}).update(attributes)
+        return u
+
+    cpdef void add_vertices(self, object vertices, dict attributes=None
+            ) except *:
+        """Adds several vertices, and sets attributes to them.
+
+        Parameters
+        ----------
+        vertices: iterable
+            Vertices of any hashable type. Vertices that have already
+            been added are only given the attributes.
+        attributes: dict, optional
+            Maps vertex attribute keys to lists or arrays holding the
+            value for each vertex, in the same order as `vertices`.
+        """
+        cdef list ints = [self._add_vertex_int(v) for v in vertices]
+        cdef object key, column, value
+        cdef Py_ssize_t u
+        for key, column in (attributes or {}).items():
+            if len(column) != len(ints):
+                raise ValueError(f"Vertex attribute {key!r} has "
+                                 f"{len(column)} values for {len(ints)} "
+                                 "vertices.")
+            for u, value in zip(ints, column):
+                self._vertex_attributes.setdefault(u, {})[key] = value
+
+    cpdef void add_edge(self, object v1, object v2, double weight=1.0,
+            dict attributes=None) except *:
+        """Adds an edge between two vertices, adding the vertices if
+        they have not been added yet.
+
+        Parameters
+        ----------
+        v1
+            One of the edge's vertices.
+        v2
+            One of the edge's vertices.
+        weight: double, optional
+            The weight of the edge.
+        attributes: dict, optional
+            Maps edge attribute keys to their values.
+        """
+        cdef Py_ssize_t u = self._add_vertex_int(v1)
+        cdef Py_ssize_t v = self._add_vertex_int(v2)
+        self._reserve(1)
+        self._sources[self._n_edges] = u
+        self._targets[self._n_edges] = v
+        self._weights[self._n_edges] = weight
+        if attributes:
+            self._edge_attributes[self._n_edges] = dict(attributes)
+        self._n_edges += 1
+
+    cpdef void add_edges(self, object edges) except *:
+        """Adds several edges, adding their vertices if they have not
+        been added yet.
+
+        Parameters
+        ----------
+        edges: iterable or dict
+            Either tuples of the form (v1, v2) or (v1, v2, weight), or a
+            dict of equal-length lists or arrays with the keys "source"
+            and "target", an optional "weight", and any other keys as
+            edge attributes.
+        """
+        cdef tuple edge
+        cdef dict attributes
+        if not isinstance(edges, dict):
+            for edge in edges:
+                self.add_edge(*edge)
+            return
+
+        if "source" not in edges or "target" not in edges:
+            raise ValueError("Edge columns must include 'source' and "
+                             "'target'.")
+        attributes = {key: column for key, column in edges.items()
+                      if key not in ("source", "target", "weight")}
+        self.add_edge_arrays(
+            np.array([self._add_vertex_int(v) for v in edges["source"]],
+                     dtype=np.int64),
+            np.array([self._add_vertex_int(v) for v in edges["target"]],
+                     dtype=np.int64),
+            edges.get("weight"), attributes)
+
+    cpdef void add_edge_arrays(self, object sources, object targets,
+            object weights=None, dict attributes=None) except *:
+        """Adds several edges given as arrays of vertex integers, without
+        a Python-level loop over the edges.
+
+        Parameters
+        ----------
+        sources, targets: array-like of int
+            The positions in `vertices` of the endpoints of each edge.
+            The vertices must have been added already.
+        weights: array-like of float, optional
+            The weight of each edge. Defaults to 1.
+        attributes: dict, optional
+            Maps edge attribute keys to lists or arrays holding the
+            value for each edge.
+        """
+        cdef np.ndarray source_array = np.asarray(sources)
+        cdef np.ndarray target_array = np.asarray(targets)
+        cdef Py_ssize_t n_edges = len(source_array)
+        cdef Py_ssize_t n_vertices = len(self.vertices)
+        cdef np.ndarray weight_array
+        if weights is None:
+            weight_array = np.ones(n_edges, dtype=np.float64)
+        else:
+            weight_array = np.asarray(weights, dtype=np.float64)
+
+        if source_array.ndim != 1 or target_array.ndim != 1:
+            raise ValueError("Sources and targets must be one-dimensional.")
+        if len(target_array) != n_edges or len(weight_array) != n_edges:
+            raise ValueError(f"Got {n_edges} sources, {len(target_array)} "
+                             f"targets and {len(weight_array)} weights.")
+        if n_edges and (source_array.dtype.kind not in "iu"
+                        or target_array.dtype.kind not in "iu"):
+            raise TypeError("Sources and targets must be integers.")
+        cdef np.ndarray array
+        for array in (source_array, target_array):
+            if n_edges and (array.min() < 0 or array.max() >= n_vertices):
+                raise ValueError("Sources and targets must be between 0 "
+                                 f"and {n_vertices - 1}.")
+
+        cdef object key, column, value
+        cdef Py_ssize_t i
+        for key, column in (attributes or {}).items():
+            if len(column) != n_edges:
+                raise ValueError(f"Edge attribute {key!r} has "
+                                 f"{len(column)} values for {n_edges} "
+                                 "edges.")
+
+        cdef Py_ssize_t start = self._n_edges
+        self._reserve(n_edges)
+        np.asarray(self._sources)[start:start + n_edges] = source_array
+        np.asarray(self._targets)[start:start + n_edges] = target_array
+        np.asarray(self._weights)[start:start + n_edges] = weight_array
+        self._n_edges += n_edges
+        for key, column in (attributes or {}).items():
+            for i, value in enumerate(column):
+                self._edge_attributes.setdefault(start + i, {})[key] = value
+
+    cdef tuple _unique_edges(self, object combine):
+        """Returns the source, target and weight arrays of the distinct
+        edges, sorted by source and then target, with each undirected
+        edge given once with source <= target, along with the edge
+        arrays they were built from.
+        """
+        cdef Py_ssize_t n_vertices = len(self.vertices)
+        cdef np.ndarray sources = np.asarray(self._sources)[:self._n_edges]
+        cdef np.ndarray targets = np.asarray(self._targets)[:self._n_edges]
+        cdef np.ndarray weights = np.asarray(self._weights)[:self._n_edges]
+        if not self.directed:
+            sources, targets = (np.minimum(sources, targets),
+                                np.maximum(sources, targets))
+
+        cdef object matrix = build_csr(sources, targets, weights,
+            shape=(n_vertices, n_vertices), combine=combine,
+            index_dtype=np.int64)
+        cdef np.ndarray rows = np.repeat(
+            np.arange(n_vertices, dtype=np.int64), np.diff(matrix.indptr))
+        cdef np.ndarray duplicates
+        cdef Py_ssize_t i
+        if combine is None:
+            duplicates = np.flatnonzero(
+                (rows[1:] == rows[:-1])
+                & (matrix.indices[1:] == matrix.indices[:-1]))
+            if len(duplicates):
+                i = duplicates[0]
+                raise ValueError(
+                    f"Edge ({self.vertices[rows[i]]}, "
+                    f"{self.vertices[matrix.indices[i]]}) already exists.")
+        return rows, matrix.indices, matrix.data, sources, targets
+
+    cpdef object finalize(self, str backend="dynamic", object combine=None):
+        """Creates a graph from the vertices, edges and attributes added
+        so far. The builder is left unchanged, so it can keep
+        accumulating and create more graphs.
+
+        Parameters
+        ----------
+        backend: str, optional
+            "dynamic" for a cygraph.DynamicGraph, "static" for a
+            cygraph.StaticGraph, or "int" for a cygraph.IntGraph, whose
+            vertices are the positions of the vertices in `vertices`.
+            An IntGraph cannot store attributes.
+        combine: str, optional
+            How to merge the weights of duplicate edges: "sum", "min",
+            "max", "first" or "last". Their attributes are merged, with
+            later edges taking precedence. By default, duplicate edges
+            are an error.
+
+        Returns
+        -------
+        cygraph.Graph or cygraph.IntGraph
+            The graph.
+        """
+        if backend not in BACKENDS:
+            raise ValueError(f"Unknown backend {backend!r}. Expected one of "
+                             f"{', '.join(BACKENDS)}.")
+        if backend == "int" and (self._vertex_attributes
+                                 or self._edge_attributes):
+            raise ValueError("An IntGraph cannot store attributes.")
+        with span("GraphBuilder.finalize", "graph"):
+            return self._finalize(backend, combine)
+
+    cdef object _finalize(self, str backend, object combine):
+        """Creates a graph once finalize has checked its arguments.
+        """
+        cdef Py_ssize_t n_vertices = len(self.vertices)
+        cdef np.ndarray rows, columns, weights, sources, targets
+        rows, columns, weights, sources, targets = self._unique_edges(combine)
+
+        cdef IntGraph int_graph
+        if backend == "int":
+            int_graph = IntGraph(n_vertices, self.directed)
+            int_graph._set_edges(rows, columns, weights)
+            return int_graph
+
+        cdef Graph graph
+        cdef np.ndarray matrix
+        cdef list matrix_list
+        cdef object u, v, weight
+        if backend == "static":
+            matrix = np.full((n_vertices, n_vertices), np.nan,
+                             dtype=np.float64)
+            matrix[rows, columns] = weights
+            if not self.directed:
+                matrix[columns, rows] = weights
+            graph = StaticGraph(directed=self.directed,
+                vertices=self.vertices, adjacency_matrix=matrix)
+        else:
+            matrix_list = [[None] * n_vertices for _ in range(n_vertices)]
+            for u, v, weight in zip(rows.tolist(), columns.tolist(),
+                    weights.tolist()):
+                matrix_list[u][v] = weight
+                if not self.directed:
+                    matrix_list[v][u] = weight
+            graph = DynamicGraph(directed=self.directed,
+                vertices=self.vertices, adjacency_matrix=matrix_list)
+
+        # Attributes.
+        cdef list labels = self.vertices
+        cdef dict attributes
+        for u, attributes in self._vertex_attributes.items():
+            graph._vertex_attributes[labels[u]].update(attributes)
+        for u, v in zip(rows.tolist(), columns.tolist()):
+            graph._edge_attributes[(labels[u], labels[v])] = {}
+        for u in self._edge_attributes:
+            graph._edge_attributes[(labels[sources[u]],
+                                    labels[targets[u]])].update(
+                self._edge_attributes[u])
+
+        return graph
@@ -1,10 +1,19 @@
 #!python
 #cython: language_level=3
 
+cimport numpy as np
+
 from cygraph.graph_.graph cimport Graph
 
 
+cdef list csr_to_lists(np.ndarray indptr, np.ndarray indices,
+    np.ndarray weights)
+
+
 cdef class DynamicGraph(Graph):
     # _adjacency_matrix[u][v] -> weight of edge between u and v.
     # None means there is no edge.
-    cdef readonly list _adjacency_matrix
\ No newline at end of file
+    cdef readonly list _adjacency_matrix
+
+    cdef void _construct(self, Graph graph, bint directed, list vertices,
+        list adjacency_matrix, list adjacency_list) except *
\ No newline at end of file
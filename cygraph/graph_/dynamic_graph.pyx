@@ -6,7 +6,31 @@ matrix.
 
 import warnings
 
+cimport numpy as np
+import numpy as np
+
 from cygraph.graph_.graph cimport Graph
+from cygraph.tracing import span
+
+
+cdef list csr_to_lists(np.ndarray indptr, np.ndarray indices,
+        np.ndarray weights):
+    """Returns the adjacency matrix of a graph given in compressed sparse
+    row form (see cygraph.Graph._get_csr) as a list of lists, with None
+    where there is no edge.
+    """
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    cdef list pointers = indptr.tolist()
+    cdef list columns = indices.tolist()
+    cdef list values = weights.tolist()
+    cdef list matrix = [[None] * n_vertices for _ in range(n_vertices)]
+    cdef list row
+    cdef Py_ssize_t u, j
+    for u in range(n_vertices):
+        row = matrix[u]
+        for j in range(pointers[u], pointers[u + 1]):
+            row[columns[j]] = values[j]
+    return matrix
 
 
 cdef class DynamicGraph(Graph):
@@ -61,24 +85,36 @@ cdef class DynamicGraph(Graph):
 
     def __cinit__(self, Graph graph=None, bint directed=False, list vertices=[],
             list adjacency_matrix=[], list adjacency_list=[]):
+        cdef str source = "vertices"
+        if graph is not None:
+            source = "graph"
+        elif adjacency_matrix:
+            source = "adjacency_matrix"
+        elif adjacency_list:
+            source = "adjacency_list"
+        with span("DynamicGraph.__init__", "graph", source=source):
+            self._construct(graph, directed, vertices, adjacency_matrix,
+                            adjacency_list)
+
+    cdef void _construct(self, Graph graph, bint directed, list vertices,
+            list adjacency_matrix, list adjacency_list) except *:
 
-        cdef int size
+        cdef Py_ssize_t size
 
-        cdef int i, r, row_size, n_rows, n_vertices, n_adj_list_vertices
+        cdef Py_ssize_t i, r, row_size, n_rows, n_vertices, n_adj_list_vertices
         cdef object v
+        cdef np.ndarray indptr, indices, weights
         cdef list col
 
         if graph is not None:
 
-            size = len(graph.vertices)
-            self._adjacency_matrix = []
-            for i in range(size):
-                self._adjacency_matrix.append([])
-                for _ in range(size):
-                    self._adjacency_matrix[i].append(None)
-
-            for edge in graph.edges:
-                self.add_edge(*edge)
+            if isinstance(graph, DynamicGraph):
+                self._adjacency_matrix = [
+                    row[:] for row in (<DynamicGraph>graph)._adjacency_matrix]
+            else:
+                indptr, indices, weights = graph._get_csr()
+                self._adjacency_matrix = csr_to_lists(indptr, indices,
+                                                      weights)
 
         else:
             self._vertex_attributes = {}
@@ -132,32 +168,11 @@ cdef class DynamicGraph(Graph):
                                         f"{n_adj_list_vertices} in "
                                         "`adjacency_list`")
                     # Fill in the adjacency matrix.
+                    vertex_range = range(n_vertices)
                     for vertex in range(n_vertices):
-                        for vertex_ in range(n_vertices):
-                            if vertex_ in adjacency_list[vertex]:
-                                self._adjacency_matrix[vertex][vertex_] = 1.0
-
-    def __copy__(self):
-        cdef DynamicGraph new_graph = \
-            DynamicGraph(directed=self.directed, vertices=self.vertices)
-
-        # Add edges and edge attributes.
-        cdef tuple edge
-        cdef object key
-        for edge in self.edges:
-            new_graph.add_edge(*edge)
-            for key in self._edge_attributes[edge]:
-                new_graph.set_edge_attribute(
-                    edge, key, self._edge_attributes[edge][key])
-
-        # Add vertex attributes.
-        cdef object vertex
-        for vertex in self.vertices:
-            for key in self._vertex_attributes[vertex]:
-                new_graph.set_vertex_attribtue(
-                    vertex, key, self._vertex_attributes[vertex][key])
-
-        return new_graph
+                        for vertex_ in adjacency_list[vertex]:
+                            if vertex_ in vertex_range:
+                                self._adjacency_matrix[vertex][int(vertex_)] = 1.0
 
     def __reduce__(self):
         return (rebuild_dynamic_graph, (self._vertex_attributes,
@@ -166,7 +181,7 @@ cdef class DynamicGraph(Graph):
 
     @property
     def edges(self):
-        cdef int u, v, n_vertices
+        cdef Py_ssize_t u, v, n_vertices
         cdef set edges = set()
         cdef tuple new_edge, existing_edge
         cdef bint edge_found
@@ -220,8 +235,8 @@ cdef class DynamicGraph(Graph):
         weight: double, optional
             The weight of the edge.
         """
-        cdef int u = self._get_vertex_int(v1)
-        cdef int v = self._get_vertex_int(v2)
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
 
         if self._adjacency_matrix[u][v] is not None:
             raise ValueError(f"Edge ({v1}, {v2}) already exists.")
@@ -245,8 +260,8 @@ cdef class DynamicGraph(Graph):
         weight: double
             The weight of the edge.
         """
-        cdef int u = self._get_vertex_int(v1)
-        cdef int v = self._get_vertex_int(v2)
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
 
         if self._adjacency_matrix[u][v] is None:
             raise ValueError("Edge ({v1}, {v2}) doesn't exist.")
@@ -265,8 +280,8 @@ cdef class DynamicGraph(Graph):
         v2
             One of the edge's vertices.
         """
-        cdef int u = self._get_vertex_int(v1)
-        cdef int v = self._get_vertex_int(v2)
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
 
         if self._adjacency_matrix[u][v] is None:
             warnings.warn("Attempting to remove edge that doesn't exist.")
@@ -290,7 +305,7 @@ cdef class DynamicGraph(Graph):
         bint
             Whether or not edge is in graph.
         """
-        cdef int u, v
+        cdef Py_ssize_t u, v
         try:
             u = self.vertices.index(v1)
             v = self.vertices.index(v2)
@@ -314,8 +329,8 @@ cdef class DynamicGraph(Graph):
         float
             The weight of the edge between v1 and v2.
         """
-        cdef int u = self._get_vertex_int(v1)
-        cdef int v = self._get_vertex_int(v2)
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
         weight = self._adjacency_matrix[u][v]
         if weight is not None:
             return weight
@@ -330,7 +345,7 @@ cdef class DynamicGraph(Graph):
         v
             A vertex of any hashable type.
         """
-        cdef int vertex_number, i
+        cdef Py_ssize_t vertex_number, i
         cdef list new_row
 
         self._vertex_attributes[v] = {}
@@ -357,7 +372,7 @@ cdef class DynamicGraph(Graph):
         vertices: set
             A set of vertices, which can be of any hashable type.
         """
-        cdef int i, starting_n_vertices, new_n_vertices, n_new_vertices
+        cdef Py_ssize_t i, starting_n_vertices, new_n_vertices, n_new_vertices
         cdef object v
         cdef list new_row
 
@@ -383,23 +398,43 @@ cdef class DynamicGraph(Graph):
         for i in range(starting_n_vertices):
             self._adjacency_matrix[i] += [None for _ in range(n_new_vertices)]
 
-    cpdef void remove_vertex(self, object v) except *:
-        """Removes a vertex from this graph.
+    cdef void _compact_adjacency(self, list kept) except *:
+        """Shrinks the adjacency matrix to the rows and columns of the
+        kept vertices.
 
         Parameters
         ----------
-        v
-            A vertex in this graph.
+        kept: list
+            The integers of the vertices to keep, in ascending order.
         """
-        cdef int u = self._get_vertex_int(v)
-
-        self.vertices.remove(v)
-
-        # Delete row and column from adjacency matrix.
-        self._adjacency_matrix.pop(u)
         cdef list row
+        cdef Py_ssize_t i
+        self._adjacency_matrix = [
+            [row[i] for i in kept]
+            for row in [self._adjacency_matrix[i] for i in kept]
+        ]
+
+    cdef tuple _get_csr(self):
+        """Returns the edges of this graph in compressed sparse row
+        form. See cygraph.Graph._get_csr.
+        """
+        cdef list indptr = [0]
+        cdef list indices = []
+        cdef list weights = []
+        cdef list row
+        cdef object weight
+        cdef Py_ssize_t v
+
         for row in self._adjacency_matrix:
-            row.pop(u)
+            for v, weight in enumerate(row):
+                if weight is not None:
+                    indices.append(v)
+                    weights.append(weight)
+            indptr.append(len(indices))
+
+        return (np.array(indptr, dtype=np.int64),
+                np.array(indices, dtype=np.int64),
+                np.array(weights, dtype=np.float64))
 
     cpdef set get_children(self, object v):
         """Returns the names of all the child vertices of a given
@@ -416,7 +451,7 @@ cdef class DynamicGraph(Graph):
             The child vertices of `v`.
         """
         cdef set children = set()
-        cdef int u, w
+        cdef Py_ssize_t u, w
 
         w = self._get_vertex_int(v)
 
@@ -441,7 +476,7 @@ cdef class DynamicGraph(Graph):
             The parent vertices of `v`.
         """
         cdef set parents = set()
-        cdef int u, w
+        cdef Py_ssize_t u, w
 
         w = self._get_vertex_int(v)
 
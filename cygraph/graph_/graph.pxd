@@ -8,11 +8,14 @@ cdef class Graph:
     cdef readonly list vertices
     cdef readonly bint directed
 
-    cdef int _get_vertex_int(self, object vertex) except -1
+    cdef Py_ssize_t _get_vertex_int(self, object vertex) except -1
 
     cpdef void add_vertex(self, object v) except *
     cpdef void add_vertices(self, set vertices) except *
     cpdef void remove_vertex(self, object v) except *
+    cpdef list remove_vertices(self, object vertices)
+    cdef void _compact_adjacency(self, list kept) except *
+    cdef tuple _get_csr(self)
     cpdef void set_vertex_attribute(self, object vertex, object key, object val) except *
     cpdef void remove_vertex_attribute(self, object vertex, object key) except *
     cpdef void set_vertex_attributes(self, object vertex, dict attributes) except *
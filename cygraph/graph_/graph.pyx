@@ -7,11 +7,35 @@ import copy
 
 import numpy as np
 
+from cygraph.tracing import span, traced
+
 
 NOT_IMPLEMENTED = ("%s is not implemented for "
     "cygraph.Graph instance. Try it with cygraph.StaticGraph or "
     "cygraph.DynamicGraph.")
 
+# Attribute values that copy.deepcopy returns unchanged.
+cdef frozenset ATOMIC_TYPES = frozenset({type(None), bool, int, float,
+                                         complex, str, bytes})
+
+
+cdef dict _copy_attributes(dict attributes, dict memo):
+    """Deep-copies a dictionary of attribute dictionaries like
+    copy.deepcopy, but only calls it for values that are not atomic, and
+    keeps the vertices and edges that key it.
+    """
+    cdef dict result = {}
+    cdef dict row, new_row
+    cdef object item, key, value
+    for item, row in attributes.items():
+        new_row = {}
+        for key, value in row.items():
+            if type(value) not in ATOMIC_TYPES:
+                value = copy.deepcopy(value, memo)
+            new_row[key] = value
+        result[item] = new_row
+    return result
+
 
 cdef class Graph:
     """A semi-abstract base graph class.
@@ -37,9 +61,12 @@ cdef class Graph:
             if isinstance(args[0], Graph):
                 graph = args[0]
 
+        cdef dict memo = {}
         if graph is not None:
-            self._vertex_attributes = copy.deepcopy(graph._vertex_attributes)
-            self._edge_attributes = copy.deepcopy(graph._edge_attributes)
+            self._vertex_attributes = _copy_attributes(
+                graph._vertex_attributes, memo)
+            self._edge_attributes = _copy_attributes(graph._edge_attributes,
+                                                     memo)
 
             self.directed = bool(graph.directed)
             self.vertices = graph.vertices[:]
@@ -57,11 +84,157 @@ cdef class Graph:
     def __str__(self):
         return str(np.array(self._adjacency_matrix))
 
+    @traced("Graph.copy", "graph")
+    def __copy__(self):
+        return type(self)(graph=self)
+
+    @traced("Graph.deepcopy", "graph")
+    def __deepcopy__(self, memo):
+        cdef Graph new_graph = type(self)(graph=self)
+        new_graph._vertex_attributes = copy.deepcopy(self._vertex_attributes,
+                                                     memo)
+        new_graph._edge_attributes = copy.deepcopy(self._edge_attributes,
+                                                   memo)
+        return new_graph
+
     def __eq__(self, other):
         raise ValueError("Comparing graphs is ambiguous, use the "
                          ".equals() method to specify whether or not "
                          "to consider edge and vertex attributes.")
 
+    @traced("Graph.save", "graph")
+    def save(self, path, compression="zlib"):
+        """Saves this graph to a compressed archive file, which can be
+        loaded with cygraph.load_graph.
+
+        Parameters
+        ----------
+        path: str or os.PathLike
+            The file to write.
+        compression: str, optional
+            "zlib", "lz" (a builtin LZ4-style codec that compresses
+            less but decompresses faster) or None.
+        """
+        from cygraph.graph_.archive import save_graph
+        save_graph(self, path, compression)
+
+    @traced("Graph.to_arrow", "graph")
+    def to_arrow(self, kind="edges"):
+        """Exports the edges or the vertices of this graph as a table
+        that Arrow-native tools can read without copying, through the
+        Arrow C Data Interface. For example,
+        `pyarrow.record_batch(graph.to_arrow())`.
+
+        Parameters
+        ----------
+        kind: str, optional
+            "edges" for a table with "source" and "target" columns of
+            vertex integers and a "weight" column, or "vertices" for a
+            table with "id" and "label" columns. Undirected edges appear
+            once. In both, every attribute key becomes a column, with
+            nulls where it is not set.
+
+        Returns
+        -------
+        cygraph.graph_.arrow.ArrowTable
+            An object implementing the Arrow PyCapsule interface.
+
+        Raises
+        ------
+        TypeError
+            The values of an attribute (or the vertices themselves, for
+            "vertices") are not all booleans, numbers or strings.
+        """
+        from cygraph.graph_.arrow import graph_to_arrow
+        return graph_to_arrow(self, kind)
+
+    @traced("Graph.to_sparse", "graph")
+    def to_sparse(self, kind="adjacency", dtype=np.float64, weight=None):
+        """Exports this graph as a sparse matrix in compressed sparse row
+        form, in O(V + E) time beyond reading the edges out of the
+        backend. Rows and columns follow the order of self.vertices.
+
+        Parameters
+        ----------
+        kind: str, optional
+            "adjacency" for the weighted adjacency matrix A (undirected
+            edges appear in both rows), "laplacian" for D - A, where D
+            holds the (out-)degrees, "normalized_laplacian" for
+            I - D^-1/2 A D^-1/2, with zero rows for isolated vertices, or
+            "incidence" for the vertex-by-edge incidence matrix. Its
+            columns are the edges (u, v) in row-major order, taking
+            u <= v for undirected graphs, and hold 1 at both endpoints
+            for undirected graphs and -1 at u and 1 at v for directed
+            ones. Directed self-loops have no column.
+        dtype: numpy dtype, optional
+            The dtype of the entries.
+        weight: str or cygraph.WeightFunction, optional
+            The key of an edge attribute to use as the edge weights, or
+            a function computing them. By default, the stored edge
+            weights are used.
+
+        Returns
+        -------
+        cygraph.graph_.sparse.CSRMatrix
+            A (data, indices, indptr, shape) named tuple, with a
+            to_scipy() method.
+
+        Raises
+        ------
+        NotImplementedError
+            The normalized Laplacian of a directed graph was requested.
+        """
+        from cygraph.graph_.sparse import graph_to_sparse
+        return graph_to_sparse(self, kind, dtype, weight)
+
+    @traced("Graph.freeze", "graph")
+    def freeze(self):
+        """Converts this graph to a cygraph.StaticGraph, whose adjacency
+        matrix makes queries faster but adding vertices slow. The
+        adjacency matrix is built directly from this graph's rows, and
+        attributes are deepcopied.
+
+        Returns
+        -------
+        cygraph.StaticGraph
+            A graph with the same vertices, edges and attributes, or
+            this graph itself if it already is a cygraph.StaticGraph.
+        """
+        from cygraph.graph_.static_graph import StaticGraph
+        if isinstance(self, StaticGraph):
+            return self
+        return StaticGraph(graph=self)
+
+    @traced("Graph.thaw", "graph")
+    def thaw(self):
+        """Converts this graph to a cygraph.DynamicGraph, to which
+        vertices can be added quickly. The reverse of freeze.
+
+        Returns
+        -------
+        cygraph.DynamicGraph
+            A graph with the same vertices, edges and attributes, or
+            this graph itself if it already is a cygraph.DynamicGraph.
+        """
+        from cygraph.graph_.dynamic_graph import DynamicGraph
+        if isinstance(self, DynamicGraph):
+            return self
+        return DynamicGraph(graph=self)
+
+    @traced("Graph.to_int_graph", "graph")
+    def to_int_graph(self):
+        """Converts this graph to a cygraph.IntGraph, whose vertex i is
+        self.vertices[i], in O(V + E) time beyond reading the edges out
+        of the backend. Attributes are not kept.
+
+        Returns
+        -------
+        cygraph.IntGraph
+            A graph with the same edges and weights.
+        """
+        from cygraph.graph_.int_graph import graph_to_int_graph
+        return graph_to_int_graph(self)
+
     @property
     def edge_attributes(self):
         return self._edge_attributes
@@ -72,20 +245,18 @@ cdef class Graph:
 
     @property
     def adjacency_list(self):
-        cdef object u, v
-        cdef int i, j
-        cdef list adj_list = [[] for _ in self.vertices]
-        for i, u in enumerate(self.vertices):
-            for j, v in enumerate(self.vertices):
-                if self.has_edge(u, v):
-                    adj_list[i].append(j)
-        return adj_list
+        cdef object indptr, indices
+        indptr, indices, _ = self._get_csr()
+        cdef list children = indices.tolist()
+        cdef list bounds = indptr.tolist()
+        return [children[bounds[i]:bounds[i + 1]]
+                for i in range(len(self.vertices))]
 
     @property
     def adjacency_matrix(self):
         return self._adjacency_matrix
 
-    cdef int _get_vertex_int(self, object vertex) except -1:
+    cdef Py_ssize_t _get_vertex_int(self, object vertex) except -1:
         """Returns the int corresponding to a vertex.
 
         Parameters
@@ -110,7 +281,102 @@ cdef class Graph:
         raise NotImplementedError(NOT_IMPLEMENTED % "add_vertices")
 
     cpdef void remove_vertex(self, object v) except *:
-        raise NotImplementedError(NOT_IMPLEMENTED % "remove_vertex")
+        """Removes a vertex from this graph.
+
+        Parameters
+        ----------
+        v
+            A vertex in this graph.
+        """
+        self.remove_vertices((v,))
+
+    cpdef list remove_vertices(self, object vertices):
+        """Removes several vertices from this graph at once.
+
+        The adjacency matrix, vertex list and attribute dictionaries
+        are each compacted in a single pass, so removing many vertices
+        this way is much faster than calling `remove_vertex` on each of
+        them.
+
+        Parameters
+        ----------
+        vertices: iterable
+            Vertices in this graph. Duplicates are ignored.
+
+        Returns
+        -------
+        list
+            Maps the old integer of each vertex to its new integer, or
+            to -1 if the vertex was removed.
+
+        Raises
+        ------
+        ValueError
+            One of `vertices` is not in the graph. The graph is left
+            unchanged.
+        """
+        cdef dict vertex_ints = {v: i for i, v in enumerate(self.vertices)}
+        cdef Py_ssize_t n_vertices = len(self.vertices)
+        cdef list mapping = [0] * n_vertices
+        cdef list kept = []
+        cdef list kept_vertices = []
+        cdef object vertex
+        cdef tuple edge
+        cdef Py_ssize_t i
+
+        for vertex in vertices:
+            try:
+                mapping[vertex_ints[vertex]] = -1
+            except KeyError:
+                raise ValueError(f"{vertex} is not in graph.")
+
+        for i in range(n_vertices):
+            if mapping[i] == 0:
+                mapping[i] = len(kept)
+                kept.append(i)
+                kept_vertices.append(self.vertices[i])
+
+        if len(kept) == n_vertices:
+            return mapping
+
+        self._compact_adjacency(kept)
+
+        for i in range(n_vertices):
+            if mapping[i] == -1:
+                del self._vertex_attributes[self.vertices[i]]
+        for edge in list(self._edge_attributes):
+            if mapping[vertex_ints[edge[0]]] == -1 \
+                    or mapping[vertex_ints[edge[1]]] == -1:
+                del self._edge_attributes[edge]
+
+        self.vertices = kept_vertices
+        return mapping
+
+    cdef void _compact_adjacency(self, list kept) except *:
+        """Shrinks the adjacency matrix to the rows and columns of the
+        kept vertices.
+
+        Parameters
+        ----------
+        kept: list
+            The integers of the vertices to keep, in ascending order.
+        """
+        raise NotImplementedError(NOT_IMPLEMENTED % "remove_vertices")
+
+    cdef tuple _get_csr(self):
+        """Returns the edges of this graph in compressed sparse row
+        form.
+
+        Returns
+        -------
+        tuple
+            `(indptr, indices, weights)` np.ndarrays, with the children
+            of vertex integer `u` being `indices[indptr[u]:indptr[u + 1]]`
+            in ascending order, and their edge weights being
+            `weights[indptr[u]:indptr[u + 1]]`. Undirected edges appear
+            in the rows of both of their vertices.
+        """
+        raise NotImplementedError(NOT_IMPLEMENTED % "_get_csr")
 
     cpdef void set_vertex_attribute(self, object vertex, object key, object val
             ) except *:
@@ -228,14 +494,15 @@ cdef class Graph:
         """
         cdef tuple edge, edge_
         cdef set added_edges = set()
-        for edge in edges:
-            try:
-                self.add_edge(*edge)
-                added_edges.add(edge)
-            except ValueError as ve:
-                for edge_ in added_edges:
-                    self.remove_edge(*edge_)
-                raise ValueError(str(ve)) from ve
+        with span("Graph.add_edges", "graph", edges=len(edges)):
+            for edge in edges:
+                try:
+                    self.add_edge(*edge)
+                    added_edges.add(edge)
+                except ValueError as ve:
+                    for edge_ in added_edges:
+                        self.remove_edge(*edge_)
+                    raise ValueError(str(ve)) from ve
 
     cpdef void remove_edge(self, object v1, object v2) except *:
         raise NotImplementedError(NOT_IMPLEMENTED % "remove_edge")
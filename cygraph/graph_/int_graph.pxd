@@ -0,0 +1,76 @@
+#!python
+#cython: language_level=3
+
+from libc.stdint cimport int64_t
+
+cimport numpy as np
+
+from cygraph.graph_.sparse cimport index_t
+
+
+cdef Py_ssize_t find_edge(const int64_t[::1] indptr,
+    const index_t[::1] indices, int64_t u, int64_t v) noexcept nogil
+cdef void _find_edges_block(const int64_t[::1] indptr,
+    const index_t[::1] indices, const int64_t[::1] sources,
+    const int64_t[::1] targets, int64_t[::1] positions, Py_ssize_t start,
+    Py_ssize_t stop) noexcept nogil
+
+
+cdef class IntGraph:
+    cdef readonly Py_ssize_t number_of_vertices
+    cdef readonly bint directed
+
+    # Edges added one at a time since the arrays were last built, keyed
+    # by (v1, v2), with v1 <= v2 for undirected graphs.
+    cdef dict _new_edges
+
+    # The children of vertex u are _indices[_indptr[u]:_indptr[u + 1]],
+    # in ascending order, with the edge weights at the same positions in
+    # _weights. Undirected edges are stored in the rows of both of their
+    # endpoints. The rows may be missing vertices added since. _indices
+    # holds int32 or int64 values, see index_dtype.
+    cdef object _index_dtype
+    cdef const int64_t[::1] _indptr
+    cdef np.ndarray _indices
+    cdef double[::1] _weights
+    # The same for the parents of vertices in directed graphs, rebuilt
+    # when needed.
+    cdef const int64_t[::1] _in_indptr
+    cdef np.ndarray _in_indices
+    cdef double[::1] _in_weights
+    cdef bint _in_stale
+
+    cdef int _check_vertex(self, int64_t vertex) except -1
+    cdef np.ndarray _as_vertices(self, object vertices)
+    cdef tuple _edge_key(self, int64_t u, int64_t v)
+    cdef tuple _edge_arrays(self)
+    cdef void _set_edges(self, np.ndarray sources, np.ndarray targets,
+        np.ndarray weights) except *
+    cdef void _flush(self) except *
+    cdef void _flush_in(self) except *
+    cdef np.ndarray _find_edges(self, np.ndarray sources,
+        np.ndarray targets)
+    cdef Py_ssize_t _find_edge(self, int64_t u, int64_t v) except -2
+    cdef tuple _get_csr(self)
+
+    cpdef int64_t add_vertex(self) except -1
+    cpdef np.ndarray add_vertices(self, Py_ssize_t n)
+    cpdef bint has_vertex(self, object vertex) except *
+    cpdef void add_edge(self, int64_t v1, int64_t v2,
+        double weight=*) except *
+    cpdef void add_edges(self, object sources, object targets,
+        object weights=*) except *
+    cpdef void remove_edge(self, int64_t v1, int64_t v2) except *
+    cpdef void remove_edges(self, object sources, object targets) except *
+    cpdef bint has_edge(self, int64_t v1, int64_t v2) except *
+    cpdef np.ndarray has_edges(self, object sources, object targets)
+    cpdef double get_edge_weight(self, int64_t v1, int64_t v2) except *
+    cpdef np.ndarray get_edge_weights(self, object sources, object targets)
+    cpdef void set_edge_weight(self, int64_t v1, int64_t v2,
+        double weight) except *
+    cpdef np.ndarray get_children(self, int64_t v)
+    cpdef np.ndarray get_parents(self, int64_t v)
+
+
+cdef IntGraph csr_to_int_graph(bint directed, np.ndarray indptr,
+    np.ndarray indices, np.ndarray weights)
@@ -0,0 +1,695 @@
+#!python
+#cython: language_level=3
+"""Implementation of a graph whose vertices are the integers 0 to n - 1.
+"""
+
+from libc.stdint cimport int32_t, int64_t
+
+cimport numpy as np
+import numpy as np
+
+from cygraph.graph_.dynamic_graph cimport DynamicGraph, csr_to_lists
+from cygraph.graph_.graph cimport Graph
+from cygraph.graph_.sparse cimport csr_to_sparse, index_t
+from cygraph.graph_.static_graph cimport StaticGraph, csr_to_matrix
+from cygraph.graph_.sparse import build_csr, smallest_index_dtype
+from cygraph.parallel import map_blocks
+from cygraph.tracing import traced
+
+
+# Number of edges looked up by a single task.
+cdef Py_ssize_t BLOCK_SIZE = 4096
+
+
+cdef Py_ssize_t find_edge(const int64_t[::1] indptr,
+        const index_t[::1] indices, int64_t u, int64_t v) noexcept nogil:
+    """Returns the position of v in the sorted row u of a CSR matrix, or
+    -1 if it is not there or the matrix has no row u.
+    """
+    if u >= indptr.shape[0] - 1:
+        return -1
+    cdef Py_ssize_t lo = indptr[u]
+    cdef Py_ssize_t hi = indptr[u + 1]
+    cdef Py_ssize_t middle
+    while lo < hi:
+        middle = lo + (hi - lo) // 2
+        if indices[middle] < v:
+            lo = middle + 1
+        else:
+            hi = middle
+    if lo < indptr[u + 1] and indices[lo] == v:
+        return lo
+    return -1
+
+
+cdef void _find_edges_block(const int64_t[::1] indptr,
+        const index_t[::1] indices, const int64_t[::1] sources,
+        const int64_t[::1] targets, int64_t[::1] positions, Py_ssize_t start,
+        Py_ssize_t stop) noexcept nogil:
+    """Finds edges [start, stop) with find_edge.
+    """
+    cdef Py_ssize_t i
+    for i in range(start, stop):
+        positions[i] = find_edge(indptr, indices, sources[i], targets[i])
+
+
+def _find_edges_task(const int64_t[::1] indptr, const index_t[::1] indices,
+        const int64_t[::1] sources, const int64_t[::1] targets,
+        int64_t[::1] positions, Py_ssize_t start, Py_ssize_t stop):
+    with nogil:
+        _find_edges_block(indptr, indices, sources, targets, positions, start,
+                          stop)
+
+
+cdef class IntGraph:
+    """A class representing a graph whose vertices are the integers 0 to
+    n - 1, stored as sorted adjacency arrays (compressed sparse rows).
+
+    Vertices are their own ids, so there is no mapping between vertices
+    and integers, and methods that take or return many vertices or edges
+    use numpy integer arrays instead of Python collections. Single edges
+    are buffered and merged into the arrays the next time the graph is
+    queried, so add edges in batches where possible, and with add_edges
+    when they are already in arrays.
+
+    Parameters
+    ----------
+    n_vertices: int, optional
+        The number of vertices.
+    directed: bint, optional
+        Whether or not edges are directed.
+    sources, targets: array-like of int, optional
+        The endpoints of the initial edges.
+    weights: array-like of float, optional
+        The weights of the initial edges. Defaults to 1.
+    index_dtype: numpy dtype, optional
+        np.int32 or np.int64, the dtype in which the endpoints of edges
+        are stored. By default, np.int32 is used while there are at
+        most 2^31 - 1 vertices, and np.int64 beyond. The offsets of the
+        adjacency arrays are always np.int64, so either way the graph
+        can have more than 2^31 edges.
+
+    Attributes
+    ----------
+    number_of_vertices: int
+        The number of vertices.
+    directed: bint
+        Whether or not edges are directed.
+    vertices: np.ndarray
+        The vertices, 0 to number_of_vertices - 1.
+    edges: tuple
+        The source, target and weight arrays of the edges, sorted by
+        source and then target. Undirected edges appear once, with
+        source <= target.
+    number_of_edges: int
+        The number of edges, counting undirected edges once.
+    out_degrees, in_degrees: np.ndarray
+        The number of children and parents of each vertex.
+
+    Examples
+    --------
+    >>> G = cg.IntGraph(4, sources=[0, 1, 2], targets=[1, 2, 3])
+    >>> G.get_children(1)
+    array([0, 2], dtype=int32)
+    >>> G.has_edges(np.array([0, 0]), np.array([1, 3]))
+    array([ True, False])
+    """
+
+    def __cinit__(self, Py_ssize_t n_vertices=0, bint directed=False,
+            object sources=None, object targets=None, object weights=None,
+            object index_dtype=None):
+        if n_vertices < 0:
+            raise ValueError("The number of vertices cannot be negative.")
+        self.number_of_vertices = n_vertices
+        self.directed = directed
+        self._new_edges = {}
+        self._indptr = np.zeros(n_vertices + 1, dtype=np.int64)
+        self._index_dtype = index_dtype
+        self._indices = np.zeros(0, dtype=index_dtype
+                                 or smallest_index_dtype(n_vertices))
+        self._weights = np.zeros(0, dtype=np.float64)
+        self._in_stale = True
+        if sources is not None or targets is not None:
+            self.add_edges(sources, targets, weights)
+
+    def __iter__(self):
+        return iter(range(self.number_of_vertices))
+
+    def __len__(self):
+        return self.number_of_vertices
+
+    def __repr__(self):
+        return (f"<{self.__class__.__name__}; "
+                f"number_of_vertices={self.number_of_vertices}; "
+                f"number_of_edges={self.number_of_edges}>")
+
+    def __reduce__(self):
+        return (IntGraph, (self.number_of_vertices, self.directed)
+                          + self.edges)
+
+    @traced("IntGraph.copy", "graph")
+    def __copy__(self):
+        cdef IntGraph new_graph = IntGraph(0, self.directed,
+                                           index_dtype=self._index_dtype)
+        new_graph.number_of_vertices = self.number_of_vertices
+        new_graph._new_edges = self._new_edges.copy()
+        new_graph._indptr = np.array(self._indptr)
+        new_graph._indices = self._indices.copy()
+        new_graph._weights = np.array(self._weights)
+        return new_graph
+
+    @traced("IntGraph.deepcopy", "graph")
+    def __deepcopy__(self, memo):
+        return self.__copy__()
+
+    @property
+    def vertices(self):
+        return np.arange(self.number_of_vertices)
+
+    @property
+    def edges(self):
+        self._flush()
+        return self._edge_arrays()
+
+    @property
+    def number_of_edges(self):
+        self._flush()
+        if self.directed:
+            return len(self._indices)
+        cdef Py_ssize_t loops = np.count_nonzero(
+            np.repeat(np.arange(self.number_of_vertices),
+                      np.diff(self._indptr)) == self._indices)
+        return (len(self._indices) + loops) // 2
+
+    @property
+    def out_degrees(self):
+        self._flush()
+        return np.diff(self._indptr)
+
+    @property
+    def in_degrees(self):
+        self._flush_in()
+        return np.diff(self._in_indptr)
+
+    cdef int _check_vertex(self, int64_t vertex) except -1:
+        if not 0 <= vertex < self.number_of_vertices:
+            raise ValueError(f"{vertex} is not in graph.")
+        return 0
+
+    cdef np.ndarray _as_vertices(self, object vertices):
+        """Returns an array of vertices as a contiguous int64 array,
+        checking that they are all in this graph.
+        """
+        cdef np.ndarray array = np.asarray(vertices)
+        if array.size and array.dtype.kind not in "iu":
+            raise TypeError(f"Vertices must be integers, not {array.dtype}.")
+        array = np.ascontiguousarray(array, dtype=np.int64).ravel()
+        cdef np.ndarray outside = (array < 0) | (array >= self.number_of_vertices)
+        if outside.any():
+            raise ValueError(f"{array[outside.argmax()]} is not in graph.")
+        return array
+
+    cdef tuple _edge_key(self, int64_t u, int64_t v):
+        if not self.directed and v < u:
+            return v, u
+        return u, v
+
+    cdef tuple _edge_arrays(self):
+        """Returns the source, target and weight arrays of the edges in
+        the arrays, with undirected edges appearing once.
+        """
+        cdef np.ndarray indptr = np.asarray(self._indptr)
+        cdef np.ndarray sources = np.repeat(np.arange(len(indptr) - 1),
+                                            np.diff(indptr))
+        cdef np.ndarray targets = self._indices
+        cdef np.ndarray weights = np.asarray(self._weights)
+        if self.directed:
+            return sources, targets.copy(), weights.copy()
+        cdef np.ndarray mask = sources <= targets
+        return sources[mask], targets[mask], weights[mask]
+
+    cdef void _set_edges(self, np.ndarray sources, np.ndarray targets,
+            np.ndarray weights) except *:
+        """Replaces the edges of this graph, with each undirected edge
+        given in one direction.
+        """
+        cdef Py_ssize_t n = self.number_of_vertices
+        cdef object matrix = build_csr(sources, targets, weights,
+            shape=(n, n), combine=None, symmetrize=not self.directed,
+            index_dtype=self._index_dtype)
+        self._weights, self._indices, self._indptr = matrix[:3]
+        self._in_stale = True
+
+    cdef void _flush(self) except *:
+        """Merges the buffered edges and vertices into the arrays.
+        """
+        if (not self._new_edges
+                and self._indptr.shape[0] == self.number_of_vertices + 1):
+            return
+        cdef np.ndarray pairs = np.array(list(self._new_edges),
+                                         dtype=np.int64).reshape(-1, 2)
+        cdef np.ndarray new_weights = np.array(
+            list(self._new_edges.values()), dtype=np.float64)
+        self._new_edges = {}
+        cdef np.ndarray sources, targets, weights
+        sources, targets, weights = self._edge_arrays()
+        self._set_edges(np.concatenate((sources, pairs[:, 0])),
+                        np.concatenate((targets, pairs[:, 1])),
+                        np.concatenate((weights, new_weights)))
+
+    cdef void _flush_in(self) except *:
+        """Updates the arrays of incoming edges of a directed graph.
+        """
+        self._flush()
+        if not self._in_stale:
+            return
+        cdef np.ndarray sources, targets, weights
+        cdef object matrix
+        if self.directed:
+            sources, targets, weights = self.edges
+            matrix = build_csr(targets, sources, weights, combine=None,
+                shape=(self.number_of_vertices, self.number_of_vertices),
+                index_dtype=self._indices.dtype)
+            self._in_weights, self._in_indices, self._in_indptr = matrix[:3]
+        else:
+            self._in_indptr = self._indptr
+            self._in_indices = self._indices
+            self._in_weights = self._weights
+        self._in_stale = False
+
+    cdef np.ndarray _find_edges(self, np.ndarray sources,
+            np.ndarray targets):
+        """Returns the position of each edge in the arrays, or -1 for
+        edges that are not in this graph.
+        """
+        self._flush()
+        cdef Py_ssize_t n_edges = len(sources)
+        if len(targets) != n_edges:
+            raise ValueError("sources and targets must have the same length.")
+        cdef np.ndarray positions = np.empty(n_edges, dtype=np.int64)
+
+        def find_block(b):
+            cdef Py_ssize_t start = b * BLOCK_SIZE
+            _find_edges_task(self._indptr, self._indices, sources, targets,
+                             positions, start, min(start + BLOCK_SIZE, n_edges))
+
+        map_blocks(find_block, (n_edges + BLOCK_SIZE - 1) // BLOCK_SIZE)
+        return positions
+
+    cdef Py_ssize_t _find_edge(self, int64_t u, int64_t v) except -2:
+        """Returns the position of an edge in the arrays, or -1 if it is
+        not there.
+        """
+        cdef const int32_t[::1] indices32
+        cdef const int64_t[::1] indices64
+        if self._indices.itemsize == 4:
+            indices32 = self._indices
+            return find_edge(self._indptr, indices32, u, v)
+        indices64 = self._indices
+        return find_edge(self._indptr, indices64, u, v)
+
+    cdef tuple _get_csr(self):
+        """Returns the adjacency matrix of this graph in CSR form. See
+        cygraph.Graph._get_csr.
+        """
+        self._flush()
+        return (np.asarray(self._indptr), self._indices,
+                np.asarray(self._weights))
+
+    cpdef int64_t add_vertex(self) except -1:
+        """Adds a vertex to the graph.
+
+        Returns
+        -------
+        int
+            The new vertex, which is the previous number of vertices.
+        """
+        self.number_of_vertices += 1
+        return self.number_of_vertices - 1
+
+    cpdef np.ndarray add_vertices(self, Py_ssize_t n):
+        """Adds vertices to the graph.
+
+        Parameters
+        ----------
+        n: int
+            The number of vertices to add.
+
+        Returns
+        -------
+        np.ndarray
+            The new vertices.
+        """
+        if n < 0:
+            raise ValueError("The number of vertices cannot be negative.")
+        self.number_of_vertices += n
+        return np.arange(self.number_of_vertices - n, self.number_of_vertices)
+
+    cpdef bint has_vertex(self, object vertex) except *:
+        """Returns whether or not a vertex is in the graph.
+
+        Parameters
+        ----------
+        vertex
+            Any object.
+
+        Returns
+        -------
+        bint
+            Whether or not `vertex` is an integer from 0 to
+            number_of_vertices - 1.
+        """
+        return (isinstance(vertex, (int, np.integer))
+                and 0 <= vertex < self.number_of_vertices)
+
+    cpdef void add_edge(self, int64_t v1, int64_t v2,
+            double weight=1.0) except *:
+        """Adds an edge to the graph.
+
+        Parameters
+        ----------
+        v1: int
+            A vertex in the graph.
+        v2: int
+            A vertex in the graph.
+        weight: double, optional
+            The weight of the edge.
+        """
+        self._check_vertex(v1)
+        self._check_vertex(v2)
+        if self.has_edge(v1, v2):
+            raise ValueError(f"Edge ({v1}, {v2}) already exists.")
+        self._new_edges[self._edge_key(v1, v2)] = weight
+
+    cpdef void add_edges(self, object sources, object targets,
+            object weights=None) except *:
+        """Adds several edges to the graph, in O(V + E) time for the
+        whole batch.
+
+        Parameters
+        ----------
+        sources: array-like of int
+            The first vertex of each edge.
+        targets: array-like of int
+            The second vertex of each edge.
+        weights: array-like of float, optional
+            The weight of each edge. Defaults to 1.
+        """
+        cdef np.ndarray new_sources = self._as_vertices(sources)
+        cdef np.ndarray new_targets = self._as_vertices(targets)
+        cdef np.ndarray new_weights
+        if weights is None:
+            new_weights = np.ones(len(new_sources))
+        else:
+            new_weights = np.asarray(weights, dtype=np.float64).ravel()
+        if not len(new_sources) == len(new_targets) == len(new_weights):
+            raise ValueError("sources, targets and weights must have the "
+                             "same length.")
+        if not self.directed:
+            new_sources, new_targets = (np.minimum(new_sources, new_targets),
+                                        np.maximum(new_sources, new_targets))
+
+        cdef np.ndarray order = np.lexsort((new_targets, new_sources))
+        cdef np.ndarray repeated = np.zeros(len(order), dtype=bool)
+        repeated[order[1:]] = (
+            (new_sources[order[1:]] == new_sources[order[:-1]])
+            & (new_targets[order[1:]] == new_targets[order[:-1]]))
+        repeated |= self._find_edges(new_sources, new_targets) != -1
+        cdef Py_ssize_t i
+        if repeated.any():
+            i = repeated.argmax()
+            raise ValueError(f"Edge ({new_sources[i]}, {new_targets[i]}) "
+                             "already exists.")
+
+        cdef np.ndarray old_sources, old_targets, old_weights
+        old_sources, old_targets, old_weights = self.edges
+        self._set_edges(np.concatenate((old_sources, new_sources)),
+                        np.concatenate((old_targets, new_targets)),
+                        np.concatenate((old_weights, new_weights)))
+
+    cpdef void remove_edge(self, int64_t v1, int64_t v2) except *:
+        """Removes an edge from the graph.
+
+        Parameters
+        ----------
+        v1: int
+            A vertex in the graph.
+        v2: int
+            A vertex in the graph.
+        """
+        cdef tuple key = self._edge_key(v1, v2)
+        if key in self._new_edges:
+            del self._new_edges[key]
+        else:
+            self.remove_edges([v1], [v2])
+
+    cpdef void remove_edges(self, object sources, object targets) except *:
+        """Removes several edges from the graph, in O(V + E) time for the
+        whole batch.
+
+        Parameters
+        ----------
+        sources: array-like of int
+            The first vertex of each edge.
+        targets: array-like of int
+            The second vertex of each edge.
+        """
+        cdef np.ndarray removed_sources = self._as_vertices(sources)
+        cdef np.ndarray removed_targets = self._as_vertices(targets)
+        cdef np.ndarray positions = self._find_edges(removed_sources,
+                                                     removed_targets)
+        cdef Py_ssize_t i
+        if (positions == -1).any():
+            i = (positions == -1).argmax()
+            raise ValueError(f"Edge ({removed_sources[i]}, "
+                             f"{removed_targets[i]}) does not exist.")
+
+        cdef np.ndarray keep = np.ones(len(self._indices), dtype=bool)
+        keep[positions] = False
+        if not self.directed:
+            keep[self._find_edges(removed_targets, removed_sources)] = False
+        cdef np.ndarray indptr = np.asarray(self._indptr)
+        cdef np.ndarray rows = np.repeat(
+            np.arange(self.number_of_vertices), np.diff(indptr))
+        indptr = np.zeros_like(indptr)
+        np.cumsum(np.bincount(rows[keep], minlength=self.number_of_vertices),
+                  out=indptr[1:])
+        self._indptr = indptr
+        self._indices = self._indices[keep]
+        self._weights = np.asarray(self._weights)[keep]
+        self._in_stale = True
+
+    cpdef bint has_edge(self, int64_t v1, int64_t v2) except *:
+        """Returns whether or not an edge is in the graph.
+
+        Parameters
+        ----------
+        v1: int
+            A vertex in the graph.
+        v2: int
+            A vertex in the graph.
+
+        Returns
+        -------
+        bint
+            Whether or not there is an edge from `v1` to `v2`.
+        """
+        self._check_vertex(v1)
+        self._check_vertex(v2)
+        return (self._edge_key(v1, v2) in self._new_edges
+                or self._find_edge(v1, v2) != -1)
+
+    cpdef np.ndarray has_edges(self, object sources, object targets):
+        """Returns whether or not each of several edges is in the graph.
+
+        Parameters
+        ----------
+        sources: array-like of int
+            The first vertex of each edge.
+        targets: array-like of int
+            The second vertex of each edge.
+
+        Returns
+        -------
+        np.ndarray
+            A boolean array.
+        """
+        return self._find_edges(self._as_vertices(sources),
+                                self._as_vertices(targets)) != -1
+
+    cpdef double get_edge_weight(self, int64_t v1, int64_t v2) except *:
+        """Gets the weight of an edge.
+
+        Parameters
+        ----------
+        v1: int
+            A vertex in the graph.
+        v2: int
+            A vertex in the graph.
+
+        Returns
+        -------
+        double
+            The weight of the edge from `v1` to `v2`.
+        """
+        self._check_vertex(v1)
+        self._check_vertex(v2)
+        cdef tuple key = self._edge_key(v1, v2)
+        if key in self._new_edges:
+            return self._new_edges[key]
+        cdef Py_ssize_t position = self._find_edge(v1, v2)
+        if position == -1:
+            raise ValueError(f"There is no edge ({v1}, {v2}) in graph.")
+        return self._weights[position]
+
+    cpdef np.ndarray get_edge_weights(self, object sources, object targets):
+        """Gets the weights of several edges.
+
+        Parameters
+        ----------
+        sources: array-like of int
+            The first vertex of each edge.
+        targets: array-like of int
+            The second vertex of each edge.
+
+        Returns
+        -------
+        np.ndarray
+            The weight of each edge.
+        """
+        cdef np.ndarray edge_sources = self._as_vertices(sources)
+        cdef np.ndarray edge_targets = self._as_vertices(targets)
+        cdef np.ndarray positions = self._find_edges(edge_sources,
+                                                     edge_targets)
+        cdef Py_ssize_t i
+        if (positions == -1).any():
+            i = (positions == -1).argmax()
+            raise ValueError(f"There is no edge ({edge_sources[i]}, "
+                             f"{edge_targets[i]}) in graph.")
+        return np.asarray(self._weights)[positions]
+
+    cpdef void set_edge_weight(self, int64_t v1, int64_t v2,
+            double weight) except *:
+        """Sets the weight of an edge.
+
+        Parameters
+        ----------
+        v1: int
+            A vertex in the graph.
+        v2: int
+            A vertex in the graph.
+        weight: double
+            The new weight.
+        """
+        self._check_vertex(v1)
+        self._check_vertex(v2)
+        cdef tuple key = self._edge_key(v1, v2)
+        if key in self._new_edges:
+            self._new_edges[key] = weight
+            return
+        cdef Py_ssize_t position = self._find_edge(v1, v2)
+        if position == -1:
+            raise ValueError(f"Edge ({v1}, {v2}) does not exist.")
+        self._weights[position] = weight
+        if not self.directed:
+            self._weights[self._find_edge(v2, v1)] = weight
+        self._in_stale = True
+
+    cpdef np.ndarray get_children(self, int64_t v):
+        """Gets the children of a vertex.
+
+        Parameters
+        ----------
+        v: int
+            A vertex in the graph.
+
+        Returns
+        -------
+        np.ndarray
+            The children of `v` in ascending order, as a read-only view.
+        """
+        self._check_vertex(v)
+        self._flush()
+        cdef np.ndarray children = \
+            self._indices[self._indptr[v]:self._indptr[v + 1]]
+        children.flags.writeable = False
+        return children
+
+    cpdef np.ndarray get_parents(self, int64_t v):
+        """Gets the parents of a vertex.
+
+        Parameters
+        ----------
+        v: int
+            A vertex in the graph.
+
+        Returns
+        -------
+        np.ndarray
+            The parents of `v` in ascending order, as a read-only view.
+        """
+        self._check_vertex(v)
+        self._flush_in()
+        cdef np.ndarray parents = \
+            self._in_indices[self._in_indptr[v]:self._in_indptr[v + 1]]
+        parents.flags.writeable = False
+        return parents
+
+    @traced("IntGraph.to_sparse", "graph")
+    def to_sparse(self, kind="adjacency", dtype=np.float64):
+        """Exports this graph as a sparse matrix in compressed sparse row
+        form. See cygraph.Graph.to_sparse.
+        """
+        cdef np.ndarray indptr, indices, weights
+        indptr, indices, weights = self._get_csr()
+        # The weights are updated in place by set_edge_weight.
+        return csr_to_sparse(indptr, indices, weights.copy(), self.directed,
+                             kind, dtype)
+
+    @traced("IntGraph.to_graph", "graph")
+    def to_graph(self, static=False):
+        """Converts this graph to a cygraph.Graph whose vertices are the
+        integers 0 to number_of_vertices - 1.
+
+        Parameters
+        ----------
+        static: bint, optional
+            Whether to create a cygraph.StaticGraph or
+            cygraph.DynamicGraph.
+
+        Returns
+        -------
+        cygraph.Graph
+            A graph with the same edges.
+        """
+        cdef list vertices = list(range(self.number_of_vertices))
+        cdef np.ndarray indptr, indices, weights
+        indptr, indices, weights = self._get_csr()
+        if static:
+            return StaticGraph(directed=self.directed, vertices=vertices,
+                adjacency_matrix=csr_to_matrix(indptr, indices, weights))
+        return DynamicGraph(directed=self.directed, vertices=vertices,
+            adjacency_matrix=csr_to_lists(indptr, indices, weights))
+
+
+cdef IntGraph csr_to_int_graph(bint directed, np.ndarray indptr,
+        np.ndarray indices, np.ndarray weights):
+    """Creates a cygraph.IntGraph that takes over the sorted rows of a
+    graph in compressed sparse row form (see cygraph.Graph._get_csr).
+    """
+    cdef IntGraph int_graph = IntGraph(len(indptr) - 1, directed)
+    int_graph._indptr = np.ascontiguousarray(indptr, dtype=np.int64)
+    int_graph._indices = np.ascontiguousarray(indices,
+                                              dtype=int_graph._indices.dtype)
+    int_graph._weights = np.ascontiguousarray(weights, dtype=np.float64)
+    return int_graph
+
+
+def graph_to_int_graph(Graph graph):
+    """Converts a cygraph.Graph to a cygraph.IntGraph whose vertex i is
+    graph.vertices[i], by taking over its rows. See
+    cygraph.Graph.to_int_graph.
+    """
+    cdef np.ndarray indptr, indices, weights
+    indptr, indices, weights = graph._get_csr()
+    return csr_to_int_graph(graph.directed, indptr, indices, weights)
@@ -0,0 +1,45 @@
+#!python
+#cython: language_level=3
+
+from libc.stdint cimport int32_t, int64_t
+
+cimport numpy as np
+
+
+# The type of the column indices of a CSR matrix, which are 32-bit when
+# the number of columns allows it. Row offsets are always int64_t.
+ctypedef fused index_t:
+    int32_t
+    int64_t
+
+
+cdef void _count_chunk(const int64_t[::1] rows, const int64_t[::1] columns,
+    int64_t[::1] counts, bint symmetrize, Py_ssize_t start,
+    Py_ssize_t stop) noexcept nogil
+cdef void _offsets_block(int64_t[:, ::1] counts, int64_t[::1] row_sizes,
+    Py_ssize_t start, Py_ssize_t stop) noexcept nogil
+cdef void _scatter_chunk(const int64_t[::1] rows, const int64_t[::1] columns,
+    const double[::1] values, const int64_t[::1] indptr,
+    int64_t[::1] offsets, index_t[::1] indices, double[::1] data,
+    bint symmetrize, Py_ssize_t start, Py_ssize_t stop) noexcept nogil
+cdef void _sort_row(index_t* keys, double* values, index_t* key_buffer,
+    double* value_buffer, Py_ssize_t n) noexcept nogil
+cdef void _sort_block(const int64_t[::1] indptr, index_t[::1] indices,
+    double[::1] data, index_t[::1] index_buffer, double[::1] data_buffer,
+    int64_t[::1] unique_counts, Py_ssize_t start,
+    Py_ssize_t stop) noexcept nogil
+cdef void _combine_block(const int64_t[::1] indptr,
+    const index_t[::1] indices, const double[::1] data,
+    const int64_t[::1] out_indptr, index_t[::1] out_indices,
+    double[::1] out_data, int policy, Py_ssize_t start,
+    Py_ssize_t stop) noexcept nogil
+cdef void _laplacian_block(const int64_t[::1] indptr,
+    const index_t[::1] indices, const double[::1] weights,
+    const double[::1] diagonal, const double[::1] scale,
+    const int64_t[::1] out_indptr, index_t[::1] out_indices,
+    double[::1] out_data, Py_ssize_t start, Py_ssize_t stop) noexcept nogil
+cdef tuple _laplacian(np.ndarray indptr, np.ndarray indices,
+    np.ndarray weights, bint normalized)
+cdef tuple _incidence(np.ndarray indptr, np.ndarray indices, bint directed)
+cpdef object csr_to_sparse(np.ndarray indptr, np.ndarray indices,
+    np.ndarray weights, bint directed, str kind=*, object dtype=*)
@@ -0,0 +1,561 @@
+#!python
+#cython: language_level=3
+"""Construction of sparse matrices in compressed sparse row form, and
+export of graphs as them.
+"""
+
+from collections import namedtuple
+
+from libc.stdint cimport INT32_MAX, int32_t, int64_t
+
+cimport numpy as np
+import numpy as np
+
+from cygraph.graph_.graph cimport Graph
+from cygraph.graph_.weights cimport weighted_csr
+from cygraph.parallel import get_num_threads, map_blocks
+from cygraph.tracing import traced
+
+
+KINDS = ("adjacency", "laplacian", "normalized_laplacian", "incidence")
+
+# Number of rows handled by a single task.
+cdef Py_ssize_t BLOCK_SIZE = 4096
+
+
+class CSRMatrix(namedtuple("CSRMatrix", ["data", "indices", "indptr",
+                                         "shape"])):
+    """A sparse matrix in compressed sparse row form. The entries of row
+    i are `data[indptr[i]:indptr[i + 1]]`, in the columns
+    `indices[indptr[i]:indptr[i + 1]]`, which are in ascending order.
+
+    The fields are in the order scipy.sparse expects, so
+    `scipy.sparse.csr_array(matrix[:3], shape=matrix.shape)` works too.
+    """
+    __slots__ = ()
+
+    def toarray(self):
+        """Returns the matrix as a dense np.ndarray.
+        """
+        cdef np.ndarray array = np.zeros(self.shape, dtype=self.data.dtype)
+        cdef np.ndarray rows = np.repeat(np.arange(self.shape[0]),
+                                         np.diff(self.indptr))
+        array[rows, self.indices] = self.data
+        return array
+
+    def to_scipy(self):
+        """Returns the matrix as a scipy.sparse.csr_array, without
+        copying it.
+        """
+        import scipy.sparse
+        return scipy.sparse.csr_array(tuple(self[:3]), shape=self.shape,
+                                      copy=False)
+
+
+def smallest_index_dtype(n_columns):
+    """Returns the dtype used for the column indices of a CSR matrix
+    with n_columns columns: np.int32 when they fit, to halve the memory
+    of the indices, and np.int64 otherwise. Row offsets are always
+    np.int64, so matrices can hold more than 2^31 entries either way.
+    """
+    return np.int32 if n_columns <= INT32_MAX else np.int64
+
+
+# Ways of combining the weights of duplicate entries in build_csr.
+COMBINE_POLICIES = ("sum", "min", "max", "first", "last")
+
+# Rows shorter than this are sorted by insertion.
+cdef Py_ssize_t INSERTION_SORT_SIZE = 16
+
+
+cdef void _count_chunk(const int64_t[::1] rows, const int64_t[::1] columns,
+        int64_t[::1] counts, bint symmetrize, Py_ssize_t start,
+        Py_ssize_t stop) noexcept nogil:
+    """Counts the entries of each row among entries [start, stop).
+    """
+    cdef Py_ssize_t i
+    for i in range(start, stop):
+        counts[rows[i]] += 1
+        if symmetrize and rows[i] != columns[i]:
+            counts[columns[i]] += 1
+
+
+cdef void _offsets_block(int64_t[:, ::1] counts, int64_t[::1] row_sizes,
+        Py_ssize_t start, Py_ssize_t stop) noexcept nogil:
+    """For rows [start, stop), replaces the count of each chunk by the
+    number of entries of the row in earlier chunks, and stores the row
+    sizes.
+    """
+    cdef Py_ssize_t c, i
+    cdef int64_t total, count
+    for i in range(start, stop):
+        total = 0
+        for c in range(counts.shape[0]):
+            count = counts[c, i]
+            counts[c, i] = total
+            total += count
+        row_sizes[i] = total
+
+
+cdef void _scatter_chunk(const int64_t[::1] rows, const int64_t[::1] columns,
+        const double[::1] values, const int64_t[::1] indptr,
+        int64_t[::1] offsets, index_t[::1] indices, double[::1] data,
+        bint symmetrize, Py_ssize_t start, Py_ssize_t stop) noexcept nogil:
+    """Writes entries [start, stop) into their rows, after the entries
+    of earlier chunks, advancing this chunk's offset into each row.
+    """
+    cdef Py_ssize_t i, position
+    for i in range(start, stop):
+        position = indptr[rows[i]] + offsets[rows[i]]
+        offsets[rows[i]] += 1
+        indices[position] = <index_t>columns[i]
+        data[position] = values[i]
+        if symmetrize and rows[i] != columns[i]:
+            position = indptr[columns[i]] + offsets[columns[i]]
+            offsets[columns[i]] += 1
+            indices[position] = <index_t>rows[i]
+            data[position] = values[i]
+
+
+def _scatter_task(const int64_t[::1] rows, const int64_t[::1] columns,
+        const double[::1] values, const int64_t[::1] indptr,
+        int64_t[::1] offsets, index_t[::1] indices, double[::1] data,
+        bint symmetrize, Py_ssize_t start, Py_ssize_t stop):
+    with nogil:
+        _scatter_chunk(rows, columns, values, indptr, offsets, indices, data,
+                       symmetrize, start, stop)
+
+
+cdef void _sort_row(index_t* keys, double* values, index_t* key_buffer,
+        double* value_buffer, Py_ssize_t n) noexcept nogil:
+    """Stably sorts keys, moving values along with them, using buffers
+    of the same length. Short runs are sorted by insertion and then
+    merged bottom-up, alternating between the arrays and the buffers.
+    """
+    cdef Py_ssize_t i, j, run, width, left, middle, right, a, b, k
+    cdef index_t key
+    cdef double value
+    cdef index_t* source_keys = keys
+    cdef double* source_values = values
+    cdef index_t* target_keys = key_buffer
+    cdef double* target_values = value_buffer
+    cdef index_t* swap_keys
+    cdef double* swap_values
+
+    run = 0
+    while run < n:
+        for i in range(run + 1, min(run + INSERTION_SORT_SIZE, n)):
+            key = keys[i]
+            value = values[i]
+            j = i
+            while j > run and keys[j - 1] > key:
+                keys[j] = keys[j - 1]
+                values[j] = values[j - 1]
+                j -= 1
+            keys[j] = key
+            values[j] = value
+        run += INSERTION_SORT_SIZE
+
+    width = INSERTION_SORT_SIZE
+    while width < n:
+        left = 0
+        while left < n:
+            middle = min(left + width, n)
+            right = min(left + 2 * width, n)
+            a = left
+            b = middle
+            for k in range(left, right):
+                if a < middle and (b >= right
+                        or source_keys[a] <= source_keys[b]):
+                    target_keys[k] = source_keys[a]
+                    target_values[k] = source_values[a]
+                    a += 1
+                else:
+                    target_keys[k] = source_keys[b]
+                    target_values[k] = source_values[b]
+                    b += 1
+            left += 2 * width
+        swap_keys = source_keys
+        source_keys = target_keys
+        target_keys = swap_keys
+        swap_values = source_values
+        source_values = target_values
+        target_values = swap_values
+        width *= 2
+
+    if source_keys != keys:
+        for k in range(n):
+            keys[k] = source_keys[k]
+            values[k] = source_values[k]
+
+
+cdef void _sort_block(const int64_t[::1] indptr, index_t[::1] indices,
+        double[::1] data, index_t[::1] index_buffer, double[::1] data_buffer,
+        int64_t[::1] unique_counts, Py_ssize_t start,
+        Py_ssize_t stop) noexcept nogil:
+    """Sorts rows [start, stop) by column, keeping the order of equal
+    columns, and counts the distinct columns of each row. Each row uses
+    its own part of the buffers.
+    """
+    cdef Py_ssize_t i, j, begin, end
+    cdef bint is_sorted
+    for i in range(start, stop):
+        begin = indptr[i]
+        end = indptr[i + 1]
+        is_sorted = True
+        for j in range(begin + 1, end):
+            if indices[j - 1] > indices[j]:
+                is_sorted = False
+                break
+        if not is_sorted:
+            _sort_row(&indices[begin], &data[begin], &index_buffer[begin],
+                      &data_buffer[begin], end - begin)
+        unique_counts[i] = end > begin
+        for j in range(begin + 1, end):
+            if indices[j] != indices[j - 1]:
+                unique_counts[i] += 1
+
+
+def _sort_task(const int64_t[::1] indptr, index_t[::1] indices,
+        double[::1] data, index_t[::1] index_buffer, double[::1] data_buffer,
+        int64_t[::1] unique_counts, Py_ssize_t start, Py_ssize_t stop):
+    with nogil:
+        _sort_block(indptr, indices, data, index_buffer, data_buffer,
+                    unique_counts, start, stop)
+
+
+cdef void _combine_block(const int64_t[::1] indptr,
+        const index_t[::1] indices, const double[::1] data,
+        const int64_t[::1] out_indptr, index_t[::1] out_indices,
+        double[::1] out_data, int policy, Py_ssize_t start,
+        Py_ssize_t stop) noexcept nogil:
+    """Merges the entries with equal columns in the sorted rows
+    [start, stop), combining their values with the policy, an index
+    into COMBINE_POLICIES.
+    """
+    cdef Py_ssize_t i, j, position
+    for i in range(start, stop):
+        position = out_indptr[i] - 1
+        for j in range(indptr[i], indptr[i + 1]):
+            if j == indptr[i] or indices[j] != indices[j - 1]:
+                position += 1
+                out_indices[position] = indices[j]
+                out_data[position] = data[j]
+            elif policy == 0:
+                out_data[position] += data[j]
+            elif policy == 1:
+                out_data[position] = min(out_data[position], data[j])
+            elif policy == 2:
+                out_data[position] = max(out_data[position], data[j])
+            elif policy == 4:
+                out_data[position] = data[j]
+
+
+def _combine_task(const int64_t[::1] indptr, const index_t[::1] indices,
+        const double[::1] data, const int64_t[::1] out_indptr,
+        index_t[::1] out_indices, double[::1] out_data, int policy,
+        Py_ssize_t start, Py_ssize_t stop):
+    with nogil:
+        _combine_block(indptr, indices, data, out_indptr, out_indices,
+                       out_data, policy, start, stop)
+
+
+@traced("build_csr", "graph")
+def build_csr(sources, targets, weights=None, shape=None, combine="sum",
+        bint symmetrize=False, index_dtype=None):
+    """Builds a sparse matrix in compressed sparse row form from entries
+    in any order, such as the edges of a graph.
+
+    All passes are parallel and run without the GIL: each thread counts
+    the entries of every row in its chunk of the input, the counts are
+    turned into offsets with a prefix sum, each thread scatters its
+    chunk into place, and then the rows are sorted and their duplicate
+    entries combined in parallel blocks of rows. Entries keep their
+    input order up to the sort, which is stable, so "first" and "last"
+    are well defined and the result does not depend on the number of
+    threads.
+
+    Parameters
+    ----------
+    sources: array-like of int
+        The row of each entry, such as the source of each edge.
+    targets: array-like of int
+        The column of each entry.
+    weights: array-like of float, optional
+        The value of each entry. Defaults to 1.
+    shape: tuple, optional
+        The (number of rows, number of columns) of the matrix. Defaults
+        to a square matrix just big enough for the entries.
+    combine: str, optional
+        How to combine the values of entries in the same place: "sum",
+        "min", "max", "first" or "last". None keeps all of them, in
+        input order.
+    symmetrize: bint, optional
+        Whether to also add the entry (j, i) for every entry (i, j) with
+        i != j, as for the edges of an undirected graph. An edge given in
+        both directions is then combined with itself.
+    index_dtype: numpy dtype, optional
+        np.int32 or np.int64, the dtype of the column indices. Defaults
+        to np.int32 when the number of columns allows it. Row offsets
+        are always np.int64.
+
+    Returns
+    -------
+    cygraph.graph_.sparse.CSRMatrix
+        The matrix, with indices in ascending order within each row.
+
+    Raises
+    ------
+    ValueError
+        The arrays have different lengths, an entry is outside of the
+        shape, or the combine policy is unknown.
+
+    Examples
+    --------
+    >>> build_csr([2, 0, 2], [1, 1, 1], [1.0, 2.0, 3.0], combine="max")
+    CSRMatrix(data=array([2., 3.]), indices=array([1, 1], dtype=int32), indptr=array([0, 1, 1, 2]), shape=(3, 3))
+    """
+    cdef int policy = -1
+    if combine is not None:
+        if combine not in COMBINE_POLICIES:
+            raise ValueError(f"{combine!r} is not one of {COMBINE_POLICIES}.")
+        policy = COMBINE_POLICIES.index(combine)
+
+    cdef np.ndarray rows = np.ascontiguousarray(sources, dtype=np.int64)
+    cdef np.ndarray columns = np.ascontiguousarray(targets, dtype=np.int64)
+    cdef np.ndarray values
+    if weights is None:
+        values = np.ones(len(rows))
+    else:
+        values = np.ascontiguousarray(weights, dtype=np.float64)
+    if rows.ndim != 1 or not len(rows) == len(columns) == len(values):
+        raise ValueError("sources, targets and weights must be 1-D arrays "
+                         "of the same length.")
+    cdef Py_ssize_t n_entries = len(rows)
+    if shape is None:
+        size = max(rows.max(initial=-1), columns.max(initial=-1)) + 1
+        shape = (size, size)
+    shape = (int(shape[0]), int(shape[1]))
+    cdef Py_ssize_t n_rows = shape[0]
+    if symmetrize and shape[0] != shape[1]:
+        raise ValueError("Only square matrices can be symmetrized.")
+    cdef object dtype = np.dtype(index_dtype or smallest_index_dtype(shape[1]))
+    if dtype not in (np.int32, np.int64):
+        raise ValueError("index_dtype must be np.int32 or np.int64.")
+    if dtype == np.int32 and shape[1] > INT32_MAX:
+        raise ValueError(f"{shape[1]} columns do not fit in np.int32 indices.")
+    if n_entries and (rows.min() < 0 or rows.max() >= shape[0]
+            or columns.min() < 0 or columns.max() >= shape[1]):
+        raise ValueError(f"An entry is outside of a matrix of shape {shape}.")
+
+    # Each chunk needs its own count of every row, so use fewer chunks
+    # than threads when there are few entries per row.
+    cdef Py_ssize_t n_chunks = max(1, min(get_num_threads(),
+                                          n_entries // max(n_rows, BLOCK_SIZE)))
+    cdef Py_ssize_t chunk_size = (n_entries + n_chunks - 1) // n_chunks
+    cdef Py_ssize_t n_row_blocks = (n_rows + BLOCK_SIZE - 1) // BLOCK_SIZE
+    cdef np.ndarray counts = np.zeros((n_chunks, n_rows), dtype=np.int64)
+    cdef np.ndarray row_sizes = np.empty(n_rows, dtype=np.int64)
+    cdef np.ndarray indptr = np.zeros(n_rows + 1, dtype=np.int64)
+
+    def count_chunk(c):
+        cdef const int64_t[::1] rows_view = rows
+        cdef const int64_t[::1] columns_view = columns
+        cdef int64_t[::1] counts_view = counts[c]
+        cdef Py_ssize_t start = c * chunk_size
+        cdef Py_ssize_t stop = min(start + chunk_size, n_entries)
+        with nogil:
+            _count_chunk(rows_view, columns_view, counts_view, symmetrize,
+                         start, stop)
+
+    def offsets_block(b):
+        cdef int64_t[:, ::1] counts_view = counts
+        cdef int64_t[::1] row_sizes_view = row_sizes
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        cdef Py_ssize_t stop = min(start + BLOCK_SIZE, n_rows)
+        with nogil:
+            _offsets_block(counts_view, row_sizes_view, start, stop)
+
+    map_blocks(count_chunk, n_chunks)
+    map_blocks(offsets_block, n_row_blocks)
+    np.cumsum(row_sizes, out=indptr[1:])
+    cdef np.ndarray indices = np.empty(indptr[-1], dtype=dtype)
+    cdef np.ndarray data = np.empty(indptr[-1])
+
+    # The kernels are compiled for both index types, and the tasks pick
+    # one from the dtype of the indices.
+    def scatter_chunk(c):
+        cdef Py_ssize_t start = c * chunk_size
+        _scatter_task(rows, columns, values, indptr, counts[c], indices, data,
+                      symmetrize, start, min(start + chunk_size, n_entries))
+
+    map_blocks(scatter_chunk, n_chunks)
+
+    cdef np.ndarray index_buffer = np.empty_like(indices)
+    cdef np.ndarray data_buffer = np.empty_like(data)
+    cdef np.ndarray unique_counts = row_sizes
+
+    def sort_block(b):
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        _sort_task(indptr, indices, data, index_buffer, data_buffer,
+                   unique_counts, start, min(start + BLOCK_SIZE, n_rows))
+
+    map_blocks(sort_block, n_row_blocks)
+    if policy == -1 or unique_counts.sum() == indptr[-1]:
+        return CSRMatrix(data, indices, indptr, shape)
+
+    cdef np.ndarray out_indptr = np.zeros(n_rows + 1, dtype=np.int64)
+    np.cumsum(unique_counts, out=out_indptr[1:])
+    cdef np.ndarray out_indices = np.empty(out_indptr[-1], dtype=dtype)
+    cdef np.ndarray out_data = np.empty(out_indptr[-1])
+
+    def combine_block(b):
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        _combine_task(indptr, indices, data, out_indptr, out_indices,
+                      out_data, policy, start, min(start + BLOCK_SIZE, n_rows))
+
+    map_blocks(combine_block, n_row_blocks)
+    return CSRMatrix(out_data, out_indices, out_indptr, shape)
+
+
+cdef void _laplacian_block(const int64_t[::1] indptr,
+        const index_t[::1] indices, const double[::1] weights,
+        const double[::1] diagonal, const double[::1] scale,
+        const int64_t[::1] out_indptr, index_t[::1] out_indices,
+        double[::1] out_data, Py_ssize_t start, Py_ssize_t stop) noexcept nogil:
+    """Fills rows [start, stop) of the matrix
+    diag(diagonal) - diag(scale) A diag(scale), where A is given in CSR
+    form, merging the diagonal entry into each sorted row.
+    """
+    cdef Py_ssize_t i, j, position
+    cdef bint placed
+    for i in range(start, stop):
+        position = out_indptr[i]
+        placed = out_indptr[i + 1] - position == indptr[i + 1] - indptr[i]
+        for j in range(indptr[i], indptr[i + 1]):
+            if not placed and indices[j] > i:
+                out_indices[position] = <index_t>i
+                out_data[position] = diagonal[i]
+                position += 1
+                placed = True
+            out_indices[position] = indices[j]
+            out_data[position] = -scale[i] * weights[j] * scale[indices[j]]
+            if indices[j] == i:
+                out_data[position] += diagonal[i]
+            position += 1
+        if not placed:
+            out_indices[position] = <index_t>i
+            out_data[position] = diagonal[i]
+
+
+def _laplacian_task(const int64_t[::1] indptr, const index_t[::1] indices,
+        const double[::1] weights, const double[::1] diagonal,
+        const double[::1] scale, const int64_t[::1] out_indptr,
+        index_t[::1] out_indices, double[::1] out_data, Py_ssize_t start,
+        Py_ssize_t stop):
+    with nogil:
+        _laplacian_block(indptr, indices, weights, diagonal, scale,
+                         out_indptr, out_indices, out_data, start, stop)
+
+
+cdef tuple _laplacian(np.ndarray indptr, np.ndarray indices,
+        np.ndarray weights, bint normalized):
+    """Returns the combinatorial or normalized Laplacian of the graph
+    whose adjacency matrix is given, in CSR form.
+    """
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    cdef np.ndarray rows = np.repeat(np.arange(n_vertices), np.diff(indptr))
+    cdef np.ndarray degrees = np.bincount(
+        rows, weights=weights, minlength=n_vertices).astype(np.float64)
+    cdef np.ndarray diagonal, scale
+    if normalized:
+        scale = np.zeros(n_vertices)
+        np.divide(1.0, np.sqrt(degrees), out=scale, where=degrees > 0)
+        diagonal = (degrees > 0).astype(np.float64)
+    else:
+        scale = np.ones(n_vertices)
+        diagonal = degrees
+
+    # Every row gets a diagonal entry, unless it is all zero or already
+    # has one from a self-loop.
+    cdef np.ndarray has_loop = np.zeros(n_vertices, dtype=bool)
+    has_loop[rows[rows == indices]] = True
+    cdef np.ndarray out_indptr = np.zeros(n_vertices + 1, dtype=np.int64)
+    np.cumsum(np.diff(indptr) + (~has_loop & (diagonal != 0)),
+              out=out_indptr[1:])
+    cdef np.ndarray out_indices = np.empty(out_indptr[-1],
+                                           dtype=indices.dtype)
+    cdef np.ndarray out_data = np.empty(out_indptr[-1])
+
+    def fill_block(b):
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        _laplacian_task(indptr, indices, weights, diagonal, scale, out_indptr,
+                        out_indices, out_data, start,
+                        min(start + BLOCK_SIZE, n_vertices))
+
+    map_blocks(fill_block, (n_vertices + BLOCK_SIZE - 1) // BLOCK_SIZE)
+    return out_data, out_indices, out_indptr
+
+
+cdef tuple _incidence(np.ndarray indptr, np.ndarray indices, bint directed):
+    """Returns the incidence matrix of the graph whose adjacency matrix
+    is given, in CSR form.
+    """
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    cdef np.ndarray sources = np.repeat(np.arange(n_vertices),
+                                        np.diff(indptr))
+    cdef np.ndarray targets = indices
+    cdef np.ndarray keep
+    if directed:
+        # Self-loops would have a -1 and a +1 in the same place.
+        keep = sources != targets
+    else:
+        keep = sources <= targets
+    sources = sources[keep]
+    targets = targets[keep]
+    cdef Py_ssize_t n_edges = len(sources)
+    cdef np.ndarray edge_ids = np.arange(n_edges)
+
+    cdef np.ndarray loops = sources == targets
+    cdef np.ndarray rows = np.concatenate((sources, targets[~loops]))
+    cdef np.ndarray columns = np.concatenate((edge_ids, edge_ids[~loops]))
+    cdef np.ndarray values = np.ones(len(rows))
+    if directed:
+        values[:n_edges] = -1.0
+    return tuple(build_csr(rows, columns, values, shape=(n_vertices, n_edges),
+                           combine=None))
+
+
+cpdef object csr_to_sparse(np.ndarray indptr, np.ndarray indices,
+        np.ndarray weights, bint directed, str kind="adjacency",
+        object dtype=np.float64):
+    """Exports a graph given by its adjacency matrix in CSR form as a
+    sparse matrix. See cygraph.Graph.to_sparse.
+    """
+    if kind not in KINDS:
+        raise ValueError(f"{kind!r} is not one of {KINDS}.")
+    if kind == "normalized_laplacian" and directed:
+        raise NotImplementedError("The normalized Laplacian is not "
+                                  "implemented for directed graphs.")
+
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    cdef tuple shape = (n_vertices, n_vertices)
+    cdef np.ndarray data
+    if kind == "adjacency":
+        data = weights
+    elif kind == "incidence":
+        data, indices, indptr, shape = _incidence(indptr, indices, directed)
+    else:
+        data, indices, indptr = _laplacian(indptr, indices, weights,
+                                           kind == "normalized_laplacian")
+    return CSRMatrix(data.astype(dtype, copy=False), indices, indptr, shape)
+
+
+def graph_to_sparse(Graph graph, str kind="adjacency", object dtype=np.float64,
+        object weight=None):
+    """Exports a graph as a sparse matrix. See cygraph.Graph.to_sparse.
+    """
+    cdef np.ndarray indptr, indices, weights
+    indptr, indices, weights = weighted_csr(graph, weight)
+    return csr_to_sparse(indptr, indices, weights, graph.directed, kind,
+                         dtype)
@@ -6,8 +6,15 @@ cimport numpy as np
 from cygraph.graph_.graph cimport Graph
 
 
+cdef np.ndarray csr_to_matrix(np.ndarray indptr, np.ndarray indices,
+    np.ndarray weights)
+
+
 cdef class StaticGraph(Graph):
     # _adjacency_matrix_view[u][v] -> weight of edge between u and v.
     # np.nan means there is no edge.
     cdef double[:,:] _adjacency_matrix_view
-    cdef readonly np.ndarray _adjacency_matrix
\ No newline at end of file
+    cdef readonly np.ndarray _adjacency_matrix
+
+    cdef void _construct(self, Graph graph, bint directed, list vertices,
+        np.ndarray adjacency_matrix, list adjacency_list) except *
\ No newline at end of file
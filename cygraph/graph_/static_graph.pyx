@@ -10,12 +10,27 @@ cimport numpy as np
 import numpy as np
 
 from cygraph.graph_.graph cimport Graph
+from cygraph.tracing import span
 
 
 cdef type DTYPE = np.float64
 ctypedef np.float64_t DTYPE_t
 
 
+cdef np.ndarray csr_to_matrix(np.ndarray indptr, np.ndarray indices,
+        np.ndarray weights):
+    """Returns the adjacency matrix of a graph given in compressed sparse
+    row form (see cygraph.Graph._get_csr), with np.nan where there is no
+    edge.
+    """
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    cdef np.ndarray rows = np.repeat(np.arange(n_vertices), np.diff(indptr))
+    cdef np.ndarray matrix = np.full((n_vertices, n_vertices), np.nan,
+                                     dtype=DTYPE)
+    matrix[rows, indices] = weights
+    return matrix
+
+
 cdef class StaticGraph(Graph):
     """A class representing a graph data structure.
 
@@ -66,19 +81,35 @@ cdef class StaticGraph(Graph):
 
     def __cinit__(self, Graph graph=None, bint directed=False, list vertices=[],
             np.ndarray adjacency_matrix=None, list adjacency_list=[]):
-
-        cdef int size, n_vertices, n_rows, n_adj_list_vertices, vertex
+        cdef str source = "vertices"
+        if graph is not None:
+            source = "graph"
+        elif adjacency_matrix is not None:
+            source = "adjacency_matrix"
+        elif adjacency_list:
+            source = "adjacency_list"
+        with span("StaticGraph.__init__", "graph", source=source):
+            self._construct(graph, directed, vertices, adjacency_matrix,
+                            adjacency_list)
+
+    cdef void _construct(self, Graph graph, bint directed, list vertices,
+            np.ndarray adjacency_matrix, list adjacency_list) except *:
+
+        cdef Py_ssize_t size, n_vertices, n_rows, n_adj_list_vertices, vertex
         cdef object v
+        cdef np.ndarray indptr, indices, weights
 
         if graph is not None:
 
-            size = len(graph.vertices)
-            self._adjacency_matrix = np.full((size, size), np.nan, dtype=DTYPE)
+            if isinstance(graph, StaticGraph):
+                self._adjacency_matrix = \
+                    (<StaticGraph>graph)._adjacency_matrix.copy()
+            else:
+                indptr, indices, weights = graph._get_csr()
+                self._adjacency_matrix = csr_to_matrix(indptr, indices,
+                                                       weights)
             self._adjacency_matrix_view = self._adjacency_matrix
 
-            for edge in graph.edges:
-                self.add_edge(*edge)
-
         else:
             self._vertex_attributes = {}
             self._edge_attributes = {}
@@ -123,32 +154,12 @@ cdef class StaticGraph(Graph):
                                         f"{n_adj_list_vertices} in "
                                         "`adjacency_list`")
                     # Fill in the adjacency matrix.
+                    vertex_range = range(n_vertices)
                     for vertex in range(n_vertices):
-                        for vertex_ in range(n_vertices):
-                            if vertex_ in adjacency_list[vertex]:
-                                self._adjacency_matrix[vertex][vertex_] = 1.0
-
-    def __copy__(self):
-        cdef StaticGraph new_graph = \
-            StaticGraph(directed=self.directed, vertices=self.vertices)
-
-        # Add edges and edge attributes.
-        cdef tuple edge
-        cdef object key
-        for edge in self.edges:
-            new_graph.add_edge(*edge)
-            for key in self._edge_attributes[edge]:
-                new_graph.set_edge_attribute(
-                    edge, key, self._edge_attributes[edge][key])
-
-        # Add vertex attributes.
-        cdef object vertex
-        for vertex in self.vertices:
-            for key in self._vertex_attributes[vertex]:
-                new_graph.set_vertex_attribtue(
-                    vertex, key, self._vertex_attributes[vertex][key])
-
-        return new_graph
+                        for vertex_ in adjacency_list[vertex]:
+                            if vertex_ in vertex_range:
+                                self._adjacency_matrix_view[vertex,
+                                                            int(vertex_)] = 1.0
 
     def __reduce__(self):
         return (rebuild_static_graph, (self._vertex_attributes,
@@ -157,7 +168,7 @@ cdef class StaticGraph(Graph):
 
     @property
     def edges(self):
-        cdef int u, v, n_vertices
+        cdef Py_ssize_t u, v, n_vertices
         cdef set edges = set()
         cdef tuple new_edge, existing_edge
         cdef bint edge_found
@@ -212,8 +223,8 @@ cdef class StaticGraph(Graph):
         weight: np.float64, optional
             The weight of the edge.
         """
-        cdef int u = self._get_vertex_int(v1)
-        cdef int v = self._get_vertex_int(v2)
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
 
         if not np.isnan(self._adjacency_matrix_view[u][v]):
             raise ValueError(f"Edge ({v1}, {v2}) already exists.")
@@ -237,8 +248,8 @@ cdef class StaticGraph(Graph):
         weight: np.float64
             The new weight of the edge.
         """
-        cdef int u = self._get_vertex_int(v1)
-        cdef int v = self._get_vertex_int(v2)
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
 
         if np.isnan(self._adjacency_matrix_view[u][v]):
             raise ValueError(f"Edge ({v1}, {v2}) does not exist.")
@@ -257,8 +268,8 @@ cdef class StaticGraph(Graph):
         v2
             One of the edge's vertices.
         """
-        cdef int u = self._get_vertex_int(v1)
-        cdef int v = self._get_vertex_int(v2)
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
 
         if np.isnan(self._adjacency_matrix_view[u][v]):
             warnings.warn("Attempting to remove edge that doesn't exist.")
@@ -283,7 +294,7 @@ cdef class StaticGraph(Graph):
         bint
             Whether or not edge is in graph.
         """
-        cdef int u, v
+        cdef Py_ssize_t u, v
         try:
             u = self.vertices.index(v1)
             v = self.vertices.index(v2)
@@ -307,8 +318,8 @@ cdef class StaticGraph(Graph):
         np.float64
             The weight of the edge between v1 and v2.
         """
-        cdef int u = self._get_vertex_int(v1)
-        cdef int v = self._get_vertex_int(v2)
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
         cdef DTYPE_t weight = self._adjacency_matrix_view[u][v]
         if not np.isnan(weight):
             return weight
@@ -323,7 +334,7 @@ cdef class StaticGraph(Graph):
         v
             A vertex of any hashable type.
         """
-        cdef int vertex_number = len(self.vertices)
+        cdef Py_ssize_t vertex_number = len(self.vertices)
         cdef np.ndarray new_row, new_column
 
         self._vertex_attributes[v] = {}
@@ -358,7 +369,7 @@ cdef class StaticGraph(Graph):
         """
         cdef object v
         cdef np.ndarray new_rows, new_columns
-        cdef int starting_n_vertices, new_n_vertices, n_new_vertices
+        cdef Py_ssize_t starting_n_vertices, new_n_vertices, n_new_vertices
 
         starting_n_vertices = len(self.vertices)
         n_new_vertices = len(vertices)
@@ -387,19 +398,33 @@ cdef class StaticGraph(Graph):
             self._adjacency_matrix = np.append(self._adjacency_matrix, new_columns,
                 axis=1)
 
-    cpdef void remove_vertex(self, object v) except *:
-        """Removes a vertex from this graph.
+    cdef void _compact_adjacency(self, list kept) except *:
+        """Shrinks the adjacency matrix to the rows and columns of the
+        kept vertices.
 
         Parameters
         ----------
-        v
-            A vertex in this graph.
+        kept: list
+            The integers of the vertices to keep, in ascending order.
+        """
+        cdef np.ndarray kept_ints = np.array(kept, dtype=np.intp)
+        self._adjacency_matrix = \
+            self._adjacency_matrix[np.ix_(kept_ints, kept_ints)]
+        self._adjacency_matrix_view = self._adjacency_matrix
+
+    cdef tuple _get_csr(self):
+        """Returns the edges of this graph in compressed sparse row
+        form. See cygraph.Graph._get_csr.
         """
-        cdef int u = self._get_vertex_int(v)
+        cdef np.ndarray mask = ~np.isnan(self._adjacency_matrix)
+        cdef np.ndarray rows, columns
+        cdef np.ndarray indptr = np.zeros(len(self.vertices) + 1,
+            dtype=np.int64)
 
-        self.vertices.remove(v)
-        np.delete(self._adjacency_matrix, u, axis=1)  # Delete column.
-        np.delete(self._adjacency_matrix, u, axis=0)  # Delete row.
+        rows, columns = np.nonzero(mask)
+        np.cumsum(mask.sum(axis=1), out=indptr[1:])
+        return (indptr, columns.astype(np.int64),
+                self._adjacency_matrix[rows, columns])
 
     cpdef set get_children(self, object v):
         """Returns the names of all the child vertices of a given
@@ -416,7 +441,7 @@ cdef class StaticGraph(Graph):
             The child vertices of `v`.
         """
         cdef set children = set()
-        cdef int u, w
+        cdef Py_ssize_t u, w
 
         w = self._get_vertex_int(v)
 
@@ -441,7 +466,7 @@ cdef class StaticGraph(Graph):
             The parent vertices of `v`.
         """
         cdef set parents = set()
-        cdef int u, w
+        cdef Py_ssize_t u, w
 
         w = self._get_vertex_int(v)
 
@@ -0,0 +1,72 @@
+#!python
+#cython: language_level=3
+
+cimport numpy as np
+
+
+cdef np.int64_t _find(np.int64_t[::1] parents, np.int64_t v) noexcept nogil
+cdef bint _union(np.int64_t[::1] parents, np.int64_t[::1] sizes,
+    np.int64_t u, np.int64_t v) noexcept nogil
+
+
+cdef class StreamingGraph:
+    cdef readonly list vertices
+    cdef readonly bint directed
+    cdef readonly double window
+    # The time of the latest edge or call to advance().
+    cdef readonly double now
+    cdef readonly bint track_components
+    cdef readonly bint track_triangles
+    cdef dict _vertex_ints
+
+    # Live edges in insertion order, in a ring buffer whose oldest edge
+    # is at _head.
+    cdef np.int64_t[::1] _sources
+    cdef np.int64_t[::1] _targets
+    cdef double[::1] _times
+    cdef double[::1] _weights
+    cdef Py_ssize_t _head
+    cdef Py_ssize_t _size
+
+    # _neighbors[u][v] is the number of live edges between u and v, in
+    # either direction. For directed graphs, _successors[u][v] and
+    # _predecessors[v][u] count the edges from u to v. For undirected
+    # graphs, all three are the same list.
+    cdef list _neighbors
+    cdef list _successors
+    cdef list _predecessors
+
+    # Union-find forest over the live edges, rebuilt on the next query
+    # after an edge between two vertices expires.
+    cdef np.int64_t[::1] _parents
+    cdef np.int64_t[::1] _component_sizes
+    cdef Py_ssize_t _n_components
+    cdef bint _components_stale
+
+    cdef long long _triangles
+    cdef list _vertex_triangles
+
+    cdef Py_ssize_t _get_vertex_int(self, object vertex) except -1
+    cdef Py_ssize_t _add_vertex_int(self, object vertex) except -1
+    cdef void _push(self, np.int64_t u, np.int64_t v, double time,
+        double weight) except *
+    cdef void _link(self, np.int64_t u, np.int64_t v) except *
+    cdef void _unlink(self, np.int64_t u, np.int64_t v) except *
+    cdef void _update_triangles(self, np.int64_t u, np.int64_t v,
+        int sign) except *
+    cdef void _rebuild_components(self) except *
+
+    cpdef void add_vertex(self, object v) except *
+    cpdef bint has_vertex(self, object vertex) except *
+    cpdef void add_edge(self, object v1, object v2, double time,
+        double weight=*) except *
+    cpdef void add_edges(self, object edges) except *
+    cpdef Py_ssize_t advance(self, double time) except -1
+    cpdef bint has_edge(self, object v1, object v2) except *
+    cpdef set get_children(self, object v)
+    cpdef set get_parents(self, object v)
+    cpdef int get_degree(self, object v) except -1
+    cpdef int get_out_degree(self, object v) except -1
+    cpdef int get_in_degree(self, object v) except -1
+    cpdef bint are_connected(self, object v1, object v2) except *
+    cpdef long long get_triangles(self, object v) except -1
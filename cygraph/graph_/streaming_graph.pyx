@@ -0,0 +1,638 @@
+#!python
+#cython: language_level=3
+"""Implementation of a graph that only keeps the edges of a sliding time
+window.
+"""
+
+from libc.math cimport INFINITY, isnan
+
+cimport numpy as np
+import numpy as np
+
+from cygraph.graph_.temporal_graph cimport contacts_to_graph
+from cygraph.tracing import traced
+
+
+cdef np.int64_t _find(np.int64_t[::1] parents, np.int64_t v) noexcept nogil:
+    """Finds the root of a vertex in a union-find forest, halving the
+    path to it along the way.
+    """
+    while parents[v] != v:
+        parents[v] = parents[parents[v]]
+        v = parents[v]
+    return v
+
+
+cdef bint _union(np.int64_t[::1] parents, np.int64_t[::1] sizes,
+        np.int64_t u, np.int64_t v) noexcept nogil:
+    """Merges the trees of two vertices in a union-find forest. Returns
+    whether or not they were in different trees.
+    """
+    u = _find(parents, u)
+    v = _find(parents, v)
+    if u == v:
+        return False
+    if sizes[u] < sizes[v]:
+        u, v = v, u
+    parents[v] = u
+    sizes[u] += sizes[v]
+    return True
+
+
+cdef class StreamingGraph:
+    """A class representing a graph over a stream of timestamped edges,
+    which keeps only the edges of the last `window` time units.
+
+    Edges are stored in a ring buffer in the order they arrive, which is
+    also the order in which they expire, so expiring edges only pops
+    them off the front of the ring. Edges must arrive in
+    non-decreasing time order. Vertices are added automatically the
+    first time they appear in an edge, and are kept after their edges
+    expire.
+
+    An edge arriving at time t expires once the clock passes t + window.
+    The clock moves forward with each new edge, or with advance().
+
+    Degree counts are maintained as edges arrive and expire. Connected
+    components (weakly connected, for directed graphs) and triangle
+    counts are maintained if requested. Both consider the simple
+    undirected graph underlying the live edges, in which two vertices
+    are adjacent if there is at least one live edge between them.
+
+    Parameters
+    ----------
+    window: double
+        How long an edge stays in the graph.
+    directed: bint, optional
+        Whether or not the graph contains directed edges.
+    vertices: list, optional
+        A list of vertices (can be any hashable type).
+    track_components: bint, optional
+        Whether to maintain a union-find structure for are_connected()
+        and number_of_components. Edge insertions update it directly;
+        after an edge between two vertices expires, it is rebuilt from
+        the live edges on the next query.
+    track_triangles: bint, optional
+        Whether to maintain the number of triangles in the graph and at
+        each vertex.
+
+    Attributes
+    ----------
+    directed: bint
+        Whether or not the graph contains directed edges.
+    vertices: list
+        The vertices in this graph.
+    edges: list
+        (v1, v2, time, weight) tuples for the live edges, oldest first.
+    number_of_edges: int
+        The number of live edges, counting repeated edges.
+    window: double
+        How long an edge stays in the graph.
+    now: double
+        The current time.
+    number_of_components: int
+        The number of connected components, including isolated vertices.
+    triangles: int
+        The number of triangles.
+
+    Examples
+    --------
+    >>> G = cg.StreamingGraph(10.0, track_triangles=True)
+    >>> G.add_edges([('a', 'b', 0.0), ('b', 'c', 4.0), ('c', 'a', 8.0)])
+    >>> G.triangles
+    1
+    >>> G.advance(12.0)
+    1
+    >>> G.edges, G.triangles
+    ([('b', 'c', 4.0, 1.0), ('c', 'a', 8.0, 1.0)], 0)
+    """
+
+    def __cinit__(self, double window, bint directed=False,
+            object vertices=(), bint track_components=False,
+            bint track_triangles=False):
+        if not window > 0:
+            raise ValueError("The window of a StreamingGraph must be "
+                             "positive.")
+        self.window = window
+        self.directed = directed
+        self.now = -INFINITY
+        self.track_components = track_components
+        self.track_triangles = track_triangles
+
+        self.vertices = []
+        self._vertex_ints = {}
+        self._neighbors = []
+        if directed:
+            self._successors = []
+            self._predecessors = []
+        else:
+            self._successors = self._neighbors
+            self._predecessors = self._neighbors
+
+        self._sources = np.zeros(16, dtype=np.int64)
+        self._targets = np.zeros(16, dtype=np.int64)
+        self._times = np.zeros(16)
+        self._weights = np.zeros(16)
+        self._head = 0
+        self._size = 0
+
+        self._parents = np.zeros(16, dtype=np.int64)
+        self._component_sizes = np.zeros(16, dtype=np.int64)
+        self._n_components = 0
+        self._components_stale = False
+
+        self._triangles = 0
+        self._vertex_triangles = []
+
+        cdef object v
+        for v in vertices:
+            self.add_vertex(v)
+
+    def __iter__(self):
+        return iter(self.vertices)
+
+    def __len__(self):
+        return len(self.vertices)
+
+    def __repr__(self):
+        return (f"<{self.__class__.__name__}; window={self.window!r}; "
+                f"now={self.now!r}; number_of_edges={self._size}>")
+
+    @property
+    def edges(self):
+        cdef Py_ssize_t capacity = len(self._times)
+        cdef Py_ssize_t i, j
+        cdef list edges = []
+        for i in range(self._size):
+            j = (self._head + i) % capacity
+            edges.append((self.vertices[self._sources[j]],
+                          self.vertices[self._targets[j]],
+                          self._times[j], self._weights[j]))
+        return edges
+
+    @property
+    def number_of_edges(self):
+        return self._size
+
+    @property
+    def number_of_components(self):
+        if not self.track_components:
+            raise ValueError("This StreamingGraph does not track "
+                             "components.")
+        self._rebuild_components()
+        return self._n_components
+
+    @property
+    def triangles(self):
+        if not self.track_triangles:
+            raise ValueError("This StreamingGraph does not track triangles.")
+        return self._triangles
+
+    cdef Py_ssize_t _get_vertex_int(self, object vertex) except -1:
+        """Returns the int corresponding to a vertex.
+
+        Parameters
+        ----------
+        vertex
+            A vertex in the graph.
+
+        Returns
+        -------
+        int
+            The integer corresponding to `vertex`.
+        """
+        try:
+            return self._vertex_ints[vertex]
+        except KeyError:
+            raise ValueError(f"{vertex} is not in graph.")
+
+    cdef Py_ssize_t _add_vertex_int(self, object vertex) except -1:
+        """Returns the int corresponding to a vertex, adding the vertex
+        to the graph if it is not in it yet.
+        """
+        cdef Py_ssize_t u
+        try:
+            return self._vertex_ints[vertex]
+        except KeyError:
+            pass
+
+        u = len(self.vertices)
+        self._vertex_ints[vertex] = u
+        self.vertices.append(vertex)
+        self._neighbors.append({})
+        if self.directed:
+            self._successors.append({})
+            self._predecessors.append({})
+        self._vertex_triangles.append(0)
+
+        cdef np.ndarray grown
+        if u == len(self._parents):
+            grown = np.zeros(2 * u, dtype=np.int64)
+            grown[:u] = self._parents
+            self._parents = grown
+            grown = np.zeros(2 * u, dtype=np.int64)
+            grown[:u] = self._component_sizes
+            self._component_sizes = grown
+        self._parents[u] = u
+        self._component_sizes[u] = 1
+        self._n_components += 1
+        return u
+
+    cpdef void add_vertex(self, object v) except *:
+        """Adds vertex to the graph.
+
+        Parameters
+        ----------
+        v
+            A vertex of any hashable type.
+        """
+        if v in self._vertex_ints:
+            raise ValueError(f"{v} is already in graph")
+        self._add_vertex_int(v)
+
+    cpdef bint has_vertex(self, object vertex) except *:
+        """Returns whether or not a vertex is in the graph.
+
+        Parameters
+        ----------
+        vertex
+            A vertex of any hashable type.
+
+        Returns
+        -------
+        bint
+            Whether or not `vertex` is in this graph.
+        """
+        return vertex in self._vertex_ints
+
+    cdef void _push(self, np.int64_t u, np.int64_t v, double time,
+            double weight) except *:
+        """Appends an edge to the ring and updates the adjacency counts.
+        """
+        cdef Py_ssize_t capacity = len(self._times)
+        cdef np.ndarray order
+        if self._size == capacity:
+            # Unroll the ring into arrays twice the size.
+            order = (np.arange(capacity) + self._head) % capacity
+            self._sources = np.concatenate((np.asarray(self._sources)[order],
+                                            np.zeros(capacity, dtype=np.int64)))
+            self._targets = np.concatenate((np.asarray(self._targets)[order],
+                                            np.zeros(capacity, dtype=np.int64)))
+            self._times = np.concatenate((np.asarray(self._times)[order],
+                                          np.zeros(capacity)))
+            self._weights = np.concatenate((np.asarray(self._weights)[order],
+                                            np.zeros(capacity)))
+            self._head = 0
+            capacity *= 2
+
+        cdef Py_ssize_t i = (self._head + self._size) % capacity
+        self._sources[i] = u
+        self._targets[i] = v
+        self._times[i] = time
+        self._weights[i] = weight
+        self._size += 1
+        self._link(u, v)
+
+    cdef void _link(self, np.int64_t u, np.int64_t v) except *:
+        """Counts a new edge from u to v in the adjacency counts, degree
+        counts, union-find forest and triangle counts.
+        """
+        cdef dict counts = self._neighbors[u]
+        cdef object count = counts.get(v, 0)
+        counts[v] = count + 1
+        if u != v:
+            counts = self._neighbors[v]
+            counts[u] = counts.get(u, 0) + 1
+        if self.directed:
+            counts = self._successors[u]
+            counts[v] = counts.get(v, 0) + 1
+            counts = self._predecessors[v]
+            counts[u] = counts.get(u, 0) + 1
+
+        if count == 0 and u != v:
+            # u and v just became adjacent.
+            if self.track_components and not self._components_stale:
+                if _union(self._parents, self._component_sizes, u, v):
+                    self._n_components -= 1
+            if self.track_triangles:
+                self._update_triangles(u, v, 1)
+
+    cdef void _unlink(self, np.int64_t u, np.int64_t v) except *:
+        """Reverses _link for an expiring edge from u to v.
+        """
+        cdef dict counts
+        cdef object count
+        if self.directed:
+            counts = self._successors[u]
+            count = counts.pop(v)
+            if count > 1:
+                counts[v] = count - 1
+            counts = self._predecessors[v]
+            count = counts.pop(u)
+            if count > 1:
+                counts[u] = count - 1
+        if u != v:
+            counts = self._neighbors[v]
+            count = counts.pop(u)
+            if count > 1:
+                counts[u] = count - 1
+        counts = self._neighbors[u]
+        count = counts.pop(v)
+        if count > 1:
+            counts[v] = count - 1
+        elif u != v:
+            # u and v are no longer adjacent.
+            self._components_stale = True
+            if self.track_triangles:
+                self._update_triangles(u, v, -1)
+
+    cdef void _update_triangles(self, np.int64_t u, np.int64_t v,
+            int sign) except *:
+        """Adds (sign = 1) or removes (sign = -1) the triangles closed by
+        the pair u, v, which must not currently be counted as adjacent
+        in each other's triangles.
+        """
+        cdef dict u_neighbors = self._neighbors[u]
+        cdef dict v_neighbors = self._neighbors[v]
+        if len(u_neighbors) > len(v_neighbors):
+            u_neighbors, v_neighbors = v_neighbors, u_neighbors
+
+        cdef list vertex_triangles = self._vertex_triangles
+        cdef long long n_triangles = 0
+        cdef object w
+        for w in u_neighbors:
+            if w != u and w != v and w in v_neighbors:
+                n_triangles += 1
+                vertex_triangles[w] += sign
+        vertex_triangles[u] += sign * n_triangles
+        vertex_triangles[v] += sign * n_triangles
+        self._triangles += sign * n_triangles
+
+    cdef void _rebuild_components(self) except *:
+        """Rebuilds the union-find forest from the live edges if an edge
+        has expired since it was last built.
+        """
+        if not self._components_stale:
+            return
+
+        cdef np.int64_t[::1] parents = self._parents
+        cdef np.int64_t[::1] sizes = self._component_sizes
+        cdef np.int64_t[::1] sources = self._sources
+        cdef np.int64_t[::1] targets = self._targets
+        cdef Py_ssize_t n_vertices = len(self.vertices)
+        cdef Py_ssize_t capacity = len(self._times)
+        cdef Py_ssize_t n_components = n_vertices
+        cdef Py_ssize_t i, j
+        with nogil:
+            for i in range(n_vertices):
+                parents[i] = i
+                sizes[i] = 1
+            for i in range(self._size):
+                j = (self._head + i) % capacity
+                if _union(parents, sizes, sources[j], targets[j]):
+                    n_components -= 1
+        self._n_components = n_components
+        self._components_stale = False
+
+    cpdef void add_edge(self, object v1, object v2, double time,
+            double weight=1.0) except *:
+        """Adds an edge to the graph, after expiring the edges that are
+        older than the window at `time`.
+
+        Parameters
+        ----------
+        v1
+            A vertex of any hashable type.
+        v2
+            A vertex of any hashable type.
+        time: double
+            When the edge arrived. Must not be earlier than the latest
+            edge.
+        weight: double, optional
+            The weight of the edge.
+        """
+        self.advance(time)
+        cdef Py_ssize_t u = self._add_vertex_int(v1)
+        cdef Py_ssize_t v = self._add_vertex_int(v2)
+        self._push(u, v, time, weight)
+
+    cpdef void add_edges(self, object edges) except *:
+        """Adds several edges to the graph, then expires the edges that
+        are older than the window at the time of the latest one in a
+        single batch.
+
+        Parameters
+        ----------
+        edges: iterable of tuple
+            (v1, v2, time) or (v1, v2, time, weight) tuples, in
+            non-decreasing time order.
+        """
+        cdef list edges_ = list(edges)
+        cdef double time = self.now
+        cdef tuple edge
+        for edge in edges_:
+            if not edge[2] >= time:
+                raise ValueError(f"Edge {edge} is older than the edge before "
+                                 "it, or its time is NaN.")
+            time = edge[2]
+
+        cdef double weight
+        for edge in edges_:
+            weight = edge[3] if len(edge) > 3 else 1.0
+            self._push(self._add_vertex_int(edge[0]),
+                       self._add_vertex_int(edge[1]), edge[2], weight)
+        if edges_:
+            self.advance(time)
+
+    cpdef Py_ssize_t advance(self, double time) except -1:
+        """Moves the clock forward and expires the edges that are now
+        older than the window.
+
+        Parameters
+        ----------
+        time: double
+            The new time. Must not be earlier than the current time.
+
+        Returns
+        -------
+        int
+            The number of edges that expired.
+        """
+        if isnan(time) or time < self.now:
+            raise ValueError(f"Cannot move the clock from {self.now} back "
+                             f"to {time}.")
+        self.now = time
+
+        cdef double cutoff = time - self.window
+        cdef Py_ssize_t capacity = len(self._times)
+        cdef Py_ssize_t n_expired = 0
+        while self._size > 0 and self._times[self._head] <= cutoff:
+            self._unlink(self._sources[self._head], self._targets[self._head])
+            self._head = (self._head + 1) % capacity
+            self._size -= 1
+            n_expired += 1
+        return n_expired
+
+    cpdef bint has_edge(self, object v1, object v2) except *:
+        """Returns whether or not there is a live edge between two
+        vertices.
+
+        Parameters
+        ----------
+        v1
+            A vertex in the graph.
+        v2
+            A vertex in the graph.
+
+        Returns
+        -------
+        bint
+            Whether or not there is a live edge from `v1` to `v2`.
+        """
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
+        return v in self._successors[u]
+
+    cpdef set get_children(self, object v):
+        """Gets the vertices that a vertex has live edges to.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+
+        Returns
+        -------
+        set
+            The children of `v`.
+        """
+        cdef list vertices = self.vertices
+        return {vertices[u] for u in self._successors[self._get_vertex_int(v)]}
+
+    cpdef set get_parents(self, object v):
+        """Gets the vertices that have live edges to a vertex.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+
+        Returns
+        -------
+        set
+            The parents of `v`.
+        """
+        cdef list vertices = self.vertices
+        return {vertices[u]
+                for u in self._predecessors[self._get_vertex_int(v)]}
+
+    cpdef int get_degree(self, object v) except -1:
+        """Gets the number of vertices that share a live edge with a
+        vertex, in either direction.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+
+        Returns
+        -------
+        int
+            The degree of `v`.
+        """
+        return len(self._neighbors[self._get_vertex_int(v)])
+
+    cpdef int get_out_degree(self, object v) except -1:
+        """Gets the number of children of a vertex.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+
+        Returns
+        -------
+        int
+            The out-degree of `v`.
+        """
+        return len(self._successors[self._get_vertex_int(v)])
+
+    cpdef int get_in_degree(self, object v) except -1:
+        """Gets the number of parents of a vertex.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+
+        Returns
+        -------
+        int
+            The in-degree of `v`.
+        """
+        return len(self._predecessors[self._get_vertex_int(v)])
+
+    cpdef bint are_connected(self, object v1, object v2) except *:
+        """Returns whether or not two vertices are in the same connected
+        component of the live edges.
+
+        Parameters
+        ----------
+        v1
+            A vertex in the graph.
+        v2
+            A vertex in the graph.
+
+        Returns
+        -------
+        bint
+            Whether or not `v1` and `v2` are connected.
+        """
+        if not self.track_components:
+            raise ValueError("This StreamingGraph does not track "
+                             "components.")
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
+        self._rebuild_components()
+        return _find(self._parents, u) == _find(self._parents, v)
+
+    cpdef long long get_triangles(self, object v) except -1:
+        """Gets the number of triangles that a vertex is part of.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+
+        Returns
+        -------
+        int
+            The number of triangles at `v`.
+        """
+        if not self.track_triangles:
+            raise ValueError("This StreamingGraph does not track triangles.")
+        return self._vertex_triangles[self._get_vertex_int(v)]
+
+    @traced("StreamingGraph.to_graph", "graph")
+    def to_graph(self, static=False):
+        """Aggregates the live edges into a cygraph.Graph with an edge
+        for each pair of adjacent vertices.
+
+        Parameters
+        ----------
+        static: bint, optional
+            Whether to create a cygraph.StaticGraph or
+            cygraph.DynamicGraph.
+
+        Returns
+        -------
+        cygraph.Graph
+            A graph whose edge weights are the sums of the weights of
+            the live edges between the same vertices.
+        """
+        cdef Py_ssize_t capacity = len(self._times)
+        cdef np.ndarray order = (np.arange(self._size) + self._head) % capacity
+        return contacts_to_graph(self.vertices, self.directed,
+                                 np.asarray(self._sources)[order],
+                                 np.asarray(self._targets)[order],
+                                 np.asarray(self._weights)[order], static)
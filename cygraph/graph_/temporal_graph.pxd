@@ -0,0 +1,58 @@
+#!python
+#cython: language_level=3
+
+cimport numpy as np
+
+
+cdef Py_ssize_t lower_bound(const double[::1] values, Py_ssize_t lo,
+    Py_ssize_t hi, double value) noexcept nogil
+cdef object contacts_to_graph(list vertices, bint directed,
+    np.ndarray sources, np.ndarray targets, np.ndarray weights,
+    bint static)
+
+
+cdef class TemporalGraph:
+    cdef readonly list vertices
+    cdef readonly bint directed
+    # Only contacts with start <= time < end are visible.
+    cdef readonly double start
+    cdef readonly double end
+    cdef readonly bint is_view
+    cdef dict _vertex_ints
+
+    # Contacts added since the sorted arrays were last built.
+    cdef list _new_sources
+    cdef list _new_targets
+    cdef list _new_times
+    cdef list _new_weights
+    cdef bint _dirty
+
+    # The outgoing contacts of vertex u are at _indptr[u]:_indptr[u + 1]
+    # in the other arrays, sorted by time. Undirected contacts are
+    # stored in the rows of both of their endpoints.
+    cdef np.int64_t[::1] _indptr
+    cdef np.int64_t[::1] _targets
+    cdef double[::1] _times
+    cdef double[::1] _weights
+    # The same for the incoming contacts of directed graphs.
+    cdef np.int64_t[::1] _in_indptr
+    cdef np.int64_t[::1] _in_sources
+    cdef double[::1] _in_times
+    cdef double[::1] _in_weights
+
+    cdef tuple _visible_contacts(self)
+    cdef Py_ssize_t _get_vertex_int(self, object vertex) except -1
+    cdef void _flush(self) except *
+    cdef void _check_mutable(self) except *
+    cdef tuple _window(self, double start, double end)
+
+    cpdef void add_vertex(self, object v) except *
+    cpdef void add_vertices(self, object vertices) except *
+    cpdef bint has_vertex(self, object vertex) except *
+    cpdef void add_edge(self, object v1, object v2, double time,
+        double weight=*) except *
+    cpdef void add_edges(self, object edges) except *
+    cpdef list get_contacts(self, object v, double start=*, double end=*)
+    cpdef set get_children(self, object v, double start=*, double end=*)
+    cpdef set get_parents(self, object v, double start=*, double end=*)
+    cpdef TemporalGraph snapshot(self, double start, double end)
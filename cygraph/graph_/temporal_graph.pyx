@@ -0,0 +1,516 @@
+#!python
+#cython: language_level=3
+"""Implementation of a graph whose edges are timestamped contacts.
+"""
+
+from libc.math cimport INFINITY, isnan
+
+cimport numpy as np
+import numpy as np
+
+from cygraph.graph_.dynamic_graph cimport DynamicGraph
+from cygraph.graph_.static_graph cimport StaticGraph
+from cygraph.tracing import span, traced
+
+
+cdef Py_ssize_t lower_bound(const double[::1] values, Py_ssize_t lo,
+        Py_ssize_t hi, double value) noexcept nogil:
+    """Finds the first position in values[lo:hi], which must be sorted,
+    whose value is not less than `value`, or `hi` if there is none.
+    """
+    cdef Py_ssize_t middle
+    while lo < hi:
+        middle = lo + (hi - lo) // 2
+        if values[middle] < value:
+            lo = middle + 1
+        else:
+            hi = middle
+    return lo
+
+
+cdef object contacts_to_graph(list vertices, bint directed,
+        np.ndarray sources, np.ndarray targets, np.ndarray weights,
+        bint static):
+    """Creates a cygraph.Graph with an edge for each pair of vertices in
+    contact, weighted by the sum of the weights of their contacts.
+
+    Parameters
+    ----------
+    vertices: list
+        The vertices of the graph.
+    directed: bint
+        Whether or not the contacts are directed.
+    sources, targets: np.ndarray
+        The vertex integers at both ends of each contact.
+    weights: np.ndarray
+        The weight of each contact.
+    static: bint
+        Whether to create a cygraph.StaticGraph or cygraph.DynamicGraph.
+
+    Returns
+    -------
+    cygraph.Graph
+        The aggregated graph.
+    """
+    cdef Py_ssize_t n_vertices = len(vertices)
+    cdef np.ndarray pairs, inverse
+    if not directed:
+        sources, targets = (np.minimum(sources, targets),
+                            np.maximum(sources, targets))
+    pairs, inverse = np.unique(sources * n_vertices + targets,
+                               return_inverse=True)
+    weights = np.bincount(inverse.ravel(), weights=weights,
+                          minlength=len(pairs))
+
+    cdef np.ndarray matrix = np.full((n_vertices, n_vertices), np.nan)
+    matrix[pairs // n_vertices, pairs % n_vertices] = weights
+    if not directed:
+        matrix[pairs % n_vertices, pairs // n_vertices] = weights
+
+    if static:
+        return StaticGraph(directed=directed, vertices=vertices[:],
+                           adjacency_matrix=matrix)
+    cdef np.ndarray object_matrix = matrix.astype(object)
+    object_matrix[np.isnan(matrix)] = None
+    return DynamicGraph(directed=directed, vertices=vertices[:],
+                        adjacency_matrix=object_matrix.tolist())
+
+
+cdef class TemporalGraph:
+    """A class representing a graph in which every edge is a contact
+    between two vertices at a point in time.
+
+    Two vertices can be in contact any number of times. The contacts of
+    each vertex are kept in an array sorted by time, so the contacts in
+    a time window are found with a binary search instead of a scan.
+    New contacts are buffered and merged into the arrays the next time
+    the graph is queried, so add contacts in batches where possible.
+
+    Time windows are half-open: a window from `start` to `end` contains
+    the contacts with start <= time < end.
+
+    Parameters
+    ----------
+    directed: bint, optional
+        Whether or not contacts are directed.
+    vertices: list, optional
+        A list of vertices (can be any hashable type).
+
+    Attributes
+    ----------
+    directed: bint
+        Whether or not contacts are directed.
+    vertices: list
+        The vertices in this graph.
+    edges: list
+        (v1, v2, time, weight) tuples for the contacts in this graph,
+        sorted by time. Undirected contacts appear once.
+    start: double
+        The start of the time window of this graph.
+    end: double
+        The end of the time window of this graph.
+    is_view: bint
+        Whether or not this graph is a read-only snapshot of another.
+
+    Examples
+    --------
+    >>> G = cg.TemporalGraph(vertices=['a', 'b', 'c'])
+    >>> G.add_edges([('a', 'b', 1.0), ('b', 'c', 2.0), ('a', 'c', 5.0)])
+    >>> G.get_children('a', start=0.0, end=3.0)
+    {'b'}
+    >>> G.snapshot(1.5, 10.0).edges
+    [('b', 'c', 2.0, 1.0), ('a', 'c', 5.0, 1.0)]
+    """
+
+    def __cinit__(self, bint directed=False, object vertices=()):
+        self.directed = directed
+        self.vertices = []
+        self.start = -INFINITY
+        self.end = INFINITY
+        self.is_view = False
+        self._vertex_ints = {}
+
+        self._new_sources = []
+        self._new_targets = []
+        self._new_times = []
+        self._new_weights = []
+
+        self._indptr = np.zeros(1, dtype=np.int64)
+        self._targets = np.zeros(0, dtype=np.int64)
+        self._times = np.zeros(0, dtype=np.float64)
+        self._weights = np.zeros(0, dtype=np.float64)
+        self._in_indptr = self._indptr
+        self._in_sources = self._targets
+        self._in_times = self._times
+        self._in_weights = self._weights
+
+        self.add_vertices(vertices)
+
+    def __iter__(self):
+        return iter(self.vertices)
+
+    def __len__(self):
+        return len(self.vertices)
+
+    def __repr__(self):
+        return (f"<{self.__class__.__name__}; vertices={self.vertices!r}; "
+                f"start={self.start!r}; end={self.end!r}>")
+
+    @property
+    def edges(self):
+        cdef np.ndarray sources, targets, times, weights
+        sources, targets, times, weights = self._visible_contacts()
+        return [(self.vertices[u], self.vertices[v], t, w) for u, v, t, w
+                in zip(sources.tolist(), targets.tolist(), times.tolist(),
+                       weights.tolist())]
+
+    @property
+    def number_of_contacts(self):
+        return len(self._visible_contacts()[0])
+
+    cdef tuple _visible_contacts(self):
+        """Returns the source, target, time and weight arrays of the
+        contacts in this graph's time window, sorted by time, with
+        undirected contacts appearing once.
+        """
+        self._flush()
+
+        cdef np.ndarray indptr = np.asarray(self._indptr)
+        cdef np.ndarray sources = np.repeat(
+            np.arange(len(indptr) - 1, dtype=np.int64), np.diff(indptr))
+        cdef np.ndarray targets = np.asarray(self._targets)
+        cdef np.ndarray times = np.asarray(self._times)
+        cdef np.ndarray mask = (times >= self.start) & (times < self.end)
+        if not self.directed:
+            mask &= sources <= targets
+
+        cdef np.ndarray order = np.argsort(times[mask], kind="stable")
+        return (sources[mask][order], targets[mask][order],
+                times[mask][order], np.asarray(self._weights)[mask][order])
+
+    cdef Py_ssize_t _get_vertex_int(self, object vertex) except -1:
+        """Returns the int corresponding to a vertex.
+
+        Parameters
+        ----------
+        vertex
+            A vertex in the graph.
+
+        Returns
+        -------
+        int
+            The integer corresponding to `vertex`.
+        """
+        try:
+            return self._vertex_ints[vertex]
+        except KeyError:
+            raise ValueError(f"{vertex} is not in graph.")
+
+    cdef void _flush(self) except *:
+        """Merges the buffered contacts and vertices into the sorted
+        contact arrays.
+        """
+        if not self._dirty:
+            return
+
+        cdef Py_ssize_t n_vertices = len(self.vertices)
+        cdef np.ndarray indptr = np.asarray(self._indptr)
+        cdef np.ndarray new_sources = np.array(self._new_sources, dtype=np.int64)
+        cdef np.ndarray new_targets = np.array(self._new_targets, dtype=np.int64)
+        cdef np.ndarray new_times = np.array(self._new_times, dtype=np.float64)
+        cdef np.ndarray new_weights = np.array(self._new_weights,
+                                               dtype=np.float64)
+        cdef np.ndarray non_loops
+        if not self.directed:
+            # Store each contact in the rows of both endpoints by adding
+            # its reverse, except for self-loops, whose reverse is the
+            # contact itself.
+            non_loops = new_sources != new_targets
+            new_sources, new_targets = (
+                np.concatenate((new_sources, new_targets[non_loops])),
+                np.concatenate((new_targets, new_sources[non_loops])))
+            new_times = np.concatenate((new_times, new_times[non_loops]))
+            new_weights = np.concatenate((new_weights,
+                                          new_weights[non_loops]))
+
+        cdef np.ndarray sources = np.concatenate((
+            np.repeat(np.arange(len(indptr) - 1, dtype=np.int64),
+                      np.diff(indptr)),
+            new_sources))
+        cdef np.ndarray targets = np.concatenate((np.asarray(self._targets),
+                                                  new_targets))
+        cdef np.ndarray times = np.concatenate((np.asarray(self._times),
+                                                new_times))
+        cdef np.ndarray weights = np.concatenate((np.asarray(self._weights),
+                                                  new_weights))
+
+        # lexsort is stable, so contacts at equal times stay in the
+        # order they were added.
+        cdef np.ndarray order = np.lexsort((times, sources))
+        indptr = np.zeros(n_vertices + 1, dtype=np.int64)
+        np.cumsum(np.bincount(sources, minlength=n_vertices), out=indptr[1:])
+        self._indptr = indptr
+        self._targets = np.ascontiguousarray(targets[order])
+        self._times = np.ascontiguousarray(times[order])
+        self._weights = np.ascontiguousarray(weights[order])
+
+        if self.directed:
+            order = np.lexsort((times, targets))
+            indptr = np.zeros(n_vertices + 1, dtype=np.int64)
+            np.cumsum(np.bincount(targets, minlength=n_vertices),
+                      out=indptr[1:])
+            self._in_indptr = indptr
+            self._in_sources = np.ascontiguousarray(sources[order])
+            self._in_times = np.ascontiguousarray(times[order])
+            self._in_weights = np.ascontiguousarray(weights[order])
+        else:
+            self._in_indptr = self._indptr
+            self._in_sources = self._targets
+            self._in_times = self._times
+            self._in_weights = self._weights
+
+        self._new_sources = []
+        self._new_targets = []
+        self._new_times = []
+        self._new_weights = []
+        self._dirty = False
+
+    cdef void _check_mutable(self) except *:
+        if self.is_view:
+            raise ValueError("Snapshots of a TemporalGraph are read-only.")
+
+    cpdef void add_vertex(self, object v) except *:
+        """Adds vertex to the graph.
+
+        Parameters
+        ----------
+        v
+            A vertex of any hashable type.
+        """
+        self._check_mutable()
+        if v in self._vertex_ints:
+            raise ValueError(f"{v} is already in graph")
+        self._vertex_ints[v] = len(self.vertices)
+        self.vertices.append(v)
+        self._dirty = True
+
+    cpdef void add_vertices(self, object vertices) except *:
+        """Adds vertices to the graph.
+
+        Parameters
+        ----------
+        vertices: iterable
+            Vertices, which can be of any hashable type.
+        """
+        cdef object v
+        for v in vertices:
+            self.add_vertex(v)
+
+    cpdef bint has_vertex(self, object vertex) except *:
+        """Returns whether or not a vertex is in the graph.
+
+        Parameters
+        ----------
+        vertex
+            A vertex of any hashable type.
+
+        Returns
+        -------
+        bint
+            Whether or not `vertex` is in this graph.
+        """
+        return vertex in self._vertex_ints
+
+    cpdef void add_edge(self, object v1, object v2, double time,
+            double weight=1.0) except *:
+        """Adds a contact between two vertices.
+
+        Parameters
+        ----------
+        v1
+            A vertex in the graph.
+        v2
+            A vertex in the graph.
+        time: double
+            When the contact happened.
+        weight: double, optional
+            The weight of the contact.
+        """
+        self._check_mutable()
+        if isnan(time):
+            raise ValueError("The time of a contact cannot be NaN.")
+        cdef Py_ssize_t u = self._get_vertex_int(v1)
+        cdef Py_ssize_t v = self._get_vertex_int(v2)
+        self._new_sources.append(u)
+        self._new_targets.append(v)
+        self._new_times.append(time)
+        self._new_weights.append(weight)
+        self._dirty = True
+
+    cpdef void add_edges(self, object edges) except *:
+        """Adds several contacts to the graph.
+
+        Parameters
+        ----------
+        edges: iterable of tuple
+            (v1, v2, time) or (v1, v2, time, weight) tuples.
+        """
+        cdef tuple edge
+        for edge in edges:
+            self.add_edge(*edge)
+
+    cdef tuple _window(self, double start, double end):
+        if isnan(start) or isnan(end):
+            raise ValueError("The bounds of a time window cannot be NaN.")
+        return max(start, self.start), min(end, self.end)
+
+    cpdef list get_contacts(self, object v, double start=-INFINITY,
+            double end=INFINITY):
+        """Gets the outgoing contacts of a vertex in a time window.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+        start: double, optional
+            The start of the window, inclusive.
+        end: double, optional
+            The end of the window, exclusive.
+
+        Returns
+        -------
+        list
+            (vertex, time, weight) tuples sorted by time.
+        """
+        cdef Py_ssize_t u = self._get_vertex_int(v)
+        start, end = self._window(start, end)
+        self._flush()
+        cdef Py_ssize_t lo = lower_bound(self._times, self._indptr[u],
+                                         self._indptr[u + 1], start)
+        cdef Py_ssize_t hi = lower_bound(self._times, lo,
+                                         self._indptr[u + 1], end)
+        cdef Py_ssize_t i
+        return [(self.vertices[self._targets[i]], self._times[i],
+                 self._weights[i]) for i in range(lo, hi)]
+
+    cpdef set get_children(self, object v, double start=-INFINITY,
+            double end=INFINITY):
+        """Gets the vertices that a vertex contacts in a time window.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+        start: double, optional
+            The start of the window, inclusive.
+        end: double, optional
+            The end of the window, exclusive.
+
+        Returns
+        -------
+        set
+            The vertices contacted by `v` in the window.
+        """
+        cdef Py_ssize_t u = self._get_vertex_int(v)
+        start, end = self._window(start, end)
+        self._flush()
+        cdef Py_ssize_t lo = lower_bound(self._times, self._indptr[u],
+                                         self._indptr[u + 1], start)
+        cdef Py_ssize_t hi = lower_bound(self._times, lo,
+                                         self._indptr[u + 1], end)
+        cdef Py_ssize_t i
+        return {self.vertices[self._targets[i]] for i in range(lo, hi)}
+
+    cpdef set get_parents(self, object v, double start=-INFINITY,
+            double end=INFINITY):
+        """Gets the vertices that contact a vertex in a time window.
+
+        Parameters
+        ----------
+        v
+            A vertex in the graph.
+        start: double, optional
+            The start of the window, inclusive.
+        end: double, optional
+            The end of the window, exclusive.
+
+        Returns
+        -------
+        set
+            The vertices that contact `v` in the window.
+        """
+        cdef Py_ssize_t u = self._get_vertex_int(v)
+        start, end = self._window(start, end)
+        self._flush()
+        cdef Py_ssize_t lo = lower_bound(self._in_times, self._in_indptr[u],
+                                         self._in_indptr[u + 1], start)
+        cdef Py_ssize_t hi = lower_bound(self._in_times, lo,
+                                         self._in_indptr[u + 1], end)
+        cdef Py_ssize_t i
+        return {self.vertices[self._in_sources[i]] for i in range(lo, hi)}
+
+    cpdef TemporalGraph snapshot(self, double start, double end):
+        """Gets a read-only view of the contacts in a time window.
+
+        The view shares the contact arrays of this graph instead of
+        copying them. Contacts added to this graph afterwards do not
+        appear in it.
+
+        Parameters
+        ----------
+        start: double
+            The start of the window, inclusive.
+        end: double
+            The end of the window, exclusive.
+
+        Returns
+        -------
+        cygraph.TemporalGraph
+            The view, which supports all queries and algorithms that
+            this graph does, restricted to the window.
+        """
+        if start > end:
+            raise ValueError(f"The window [{start}, {end}) ends before it "
+                             "starts.")
+        cdef TemporalGraph view
+        with span("TemporalGraph.snapshot", "graph"):
+            start, end = self._window(start, end)
+            self._flush()
+
+            view = TemporalGraph(directed=self.directed)
+            view.vertices = self.vertices[:]
+            view._vertex_ints = self._vertex_ints.copy()
+            view.start = start
+            view.end = end
+            view.is_view = True
+            view._indptr = self._indptr
+            view._targets = self._targets
+            view._times = self._times
+            view._weights = self._weights
+            view._in_indptr = self._in_indptr
+            view._in_sources = self._in_sources
+            view._in_times = self._in_times
+            view._in_weights = self._in_weights
+            return view
+
+    @traced("TemporalGraph.to_graph", "graph")
+    def to_graph(self, static=False):
+        """Aggregates the contacts in this graph's time window into a
+        cygraph.Graph with an edge for each pair of vertices in contact.
+
+        Parameters
+        ----------
+        static: bint, optional
+            Whether to create a cygraph.StaticGraph or
+            cygraph.DynamicGraph.
+
+        Returns
+        -------
+        cygraph.Graph
+            A graph whose edge weights are the sums of the weights of
+            the contacts between the same vertices.
+        """
+        cdef np.ndarray sources, targets, times, weights
+        sources, targets, times, weights = self._visible_contacts()
+        return contacts_to_graph(self.vertices, self.directed, sources,
+                                 targets, weights, static)
@@ -0,0 +1,20 @@
+#!python
+#cython: language_level=3
+
+cimport numpy as np
+
+from cygraph.graph_.graph cimport Graph
+
+
+cdef class WeightFunction:
+    cdef double weight(self, Py_ssize_t u, Py_ssize_t v,
+        double weight) noexcept nogil
+
+
+cdef class UnitWeight(WeightFunction):
+    pass
+
+
+cdef np.ndarray edge_weights(Graph graph, object weight, np.ndarray indptr,
+    np.ndarray indices, np.ndarray weights)
+cdef tuple weighted_csr(Graph graph, object weight)
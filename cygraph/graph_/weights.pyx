@@ -0,0 +1,142 @@
+#!python
+#cython: language_level=3
+"""Ways for algorithms to weigh edges other than by their stored weight.
+"""
+
+from libc.stdint cimport int64_t
+
+cimport numpy as np
+import numpy as np
+
+from cygraph.graph_.graph cimport Graph
+from cygraph.parallel import map_blocks
+
+
+# Number of rows weighed by a single task.
+cdef Py_ssize_t BLOCK_SIZE = 4096
+
+
+cdef class WeightFunction:
+    """Computes the weight of each edge for an algorithm, in C.
+
+    Subclass this in Cython and override the cdef method
+    `double weight(self, Py_ssize_t u, Py_ssize_t v, double weight)
+    noexcept nogil`, which is given the integers of both vertices (their
+    positions in graph.vertices) and the stored weight of the edge. It
+    is called once per edge and direction, in parallel and without the
+    GIL. This base class returns the stored weight.
+    """
+
+    cdef double weight(self, Py_ssize_t u, Py_ssize_t v,
+            double weight) noexcept nogil:
+        return weight
+
+
+cdef class UnitWeight(WeightFunction):
+    """Weighs every edge 1, so that algorithms count edges.
+    """
+
+    cdef double weight(self, Py_ssize_t u, Py_ssize_t v,
+            double weight) noexcept nogil:
+        return 1.0
+
+
+cdef np.ndarray edge_weights(Graph graph, object weight, np.ndarray indptr,
+        np.ndarray indices, np.ndarray weights):
+    """Returns the weight of each edge of a graph, in the order of its
+    compressed sparse rows.
+
+    Parameters
+    ----------
+    graph: cygraph.Graph
+        A graph.
+    weight: None, str or WeightFunction
+        None for the stored edge weights, the key of an edge attribute
+        holding numbers, or a WeightFunction.
+    indptr, indices, weights: np.ndarray
+        The rows of `graph`, as returned by graph._get_csr().
+
+    Returns
+    -------
+    np.ndarray
+        A float64 array aligned with `indices`.
+
+    Raises
+    ------
+    KeyError
+        An edge does not have the attribute `weight`.
+    TypeError
+        `weight` is of none of the above types.
+    """
+    if weight is None:
+        return weights
+    if isinstance(weight, WeightFunction):
+        return _apply_weight_function(weight, indptr, indices, weights)
+    if not isinstance(weight, str):
+        raise TypeError("weight must be None, the key of an edge attribute "
+                        f"or a cygraph.WeightFunction, not {weight!r}.")
+
+    # Gather the attribute into an array once, so that algorithms never
+    # look it up again.
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+    cdef list rows = np.repeat(np.arange(n_vertices),
+                               np.diff(indptr)).tolist()
+    cdef list columns = indices.tolist()
+    cdef list labels = graph.vertices
+    cdef dict attributes = graph._edge_attributes
+    cdef np.ndarray values = np.empty(len(columns), dtype=np.float64)
+    cdef double[::1] values_view = values
+    cdef dict edge_attributes
+    cdef object u, v
+    cdef Py_ssize_t j
+    for j in range(len(columns)):
+        u = labels[rows[j]]
+        v = labels[columns[j]]
+        edge_attributes = attributes.get((u, v))
+        if edge_attributes is None and not graph.directed:
+            edge_attributes = attributes.get((v, u))
+        if edge_attributes is None or weight not in edge_attributes:
+            raise KeyError(f"Edge {(u, v)} has no attribute {weight}.")
+        values_view[j] = edge_attributes[weight]
+    return values
+
+
+cdef np.ndarray _apply_weight_function(WeightFunction function,
+        np.ndarray indptr, np.ndarray indices, np.ndarray weights):
+    """Calls a WeightFunction on every edge, in parallel blocks of rows.
+    """
+    cdef np.ndarray int_indptr = np.ascontiguousarray(indptr, dtype=np.int64)
+    cdef np.ndarray int_indices = np.ascontiguousarray(indices,
+                                                       dtype=np.int64)
+    cdef np.ndarray float_weights = np.ascontiguousarray(weights,
+                                                         dtype=np.float64)
+    cdef np.ndarray values = np.empty(len(indices), dtype=np.float64)
+    cdef Py_ssize_t n_vertices = len(indptr) - 1
+
+    def weigh_block(b):
+        cdef const int64_t[::1] indptr_view = int_indptr
+        cdef const int64_t[::1] indices_view = int_indices
+        cdef const double[::1] weights_view = float_weights
+        cdef double[::1] values_view = values
+        cdef Py_ssize_t start = b * BLOCK_SIZE
+        cdef Py_ssize_t stop = min(start + BLOCK_SIZE, n_vertices)
+        cdef Py_ssize_t u, j
+        with nogil:
+            for u in range(start, stop):
+                for j in range(indptr_view[u], indptr_view[u + 1]):
+                    values_view[j] = function.weight(u, indices_view[j],
+                                                     weights_view[j])
+
+    map_blocks(weigh_block, (n_vertices + BLOCK_SIZE - 1) // BLOCK_SIZE)
+    return values
+
+
+cdef tuple weighted_csr(Graph graph, object weight):
+    """Returns the compressed sparse rows of a graph (see
+    cygraph.Graph._get_csr), with the weights given by `weight` (see
+    edge_weights).
+    """
+    cdef np.ndarray indptr, indices, weights
+    indptr, indices, weights = graph._get_csr()
+    return indptr, indices, edge_weights(graph, weight, indptr, indices,
+                                         weights)
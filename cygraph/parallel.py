@@ -0,0 +1,375 @@
+"""Helpers for running the nogil kernels of cygraph on several threads,
+or on several processes that share memory, and the settings that
+control them.
+"""
+
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import contextmanager
+import mmap
+import multiprocessing
+from multiprocessing.connection import wait
+import os
+import threading
+import traceback
+
+import numpy as np
+
+from cygraph import tracing
+
+
+# The number of threads set by set_num_threads, or None for one per core
+# this process may run on.
+_num_threads = None
+_deterministic = False
+# The thread pool shared by all calls to map_blocks, created on first
+# use, and whether the current thread is one of its threads.
+_executor = None
+_executor_size = 0
+_executor_lock = threading.Lock()
+_local = threading.local()
+
+
+def get_num_threads():
+    """Returns the number of threads parallel algorithms use.
+
+    Returns
+    -------
+    int
+        The number set by set_num_threads, or by default the number of
+        cores this process is allowed to run on.
+    """
+    if _num_threads is not None:
+        return _num_threads
+    try:
+        return len(os.sched_getaffinity(0))
+    except AttributeError:
+        return os.cpu_count() or 1
+
+
+def set_num_threads(n_threads):
+    """Sets the number of threads parallel algorithms use, which is also
+    the default number of worker processes of run_vertex_program.
+
+    Parameters
+    ----------
+    n_threads: int or None
+        The number of threads, or None to go back to one per core this
+        process is allowed to run on.
+    """
+    global _num_threads
+    if n_threads is not None and n_threads < 1:
+        raise ValueError("The number of threads must be at least 1.")
+    _num_threads = None if n_threads is None else int(n_threads)
+
+
+def is_deterministic():
+    """Returns whether parallel reductions combine values in a fixed
+    order.
+
+    Returns
+    -------
+    bool
+        Whether results are bit-identical whatever the number of threads
+        and workers.
+    """
+    return _deterministic
+
+
+def set_deterministic(deterministic):
+    """Sets whether parallel reductions combine values in a fixed order,
+    so that floating-point results are bit-identical whatever the number
+    of threads and workers, at some cost in speed and memory.
+
+    Most reductions already run in a fixed order: blocks are combined in
+    block order, and sums over the neighbors of a vertex follow the
+    order of its edges. This setting changes those whose order depends
+    on how the work is divided, such as the message combination of
+    run_vertex_program.
+
+    Parameters
+    ----------
+    deterministic: bool
+        Whether to use fixed-order reductions.
+    """
+    global _deterministic
+    _deterministic = bool(deterministic)
+
+
+@contextmanager
+def parallel_config(num_threads=None, deterministic=None):
+    """Changes the settings of parallel algorithms for a block of code,
+    and restores them afterwards. The settings apply to the whole
+    process, not only to the calling thread.
+
+    Parameters
+    ----------
+    num_threads: int, optional
+        The number of threads to use, as for set_num_threads. By default
+        it is unchanged.
+    deterministic: bool, optional
+        Whether to use fixed-order reductions, as for set_deterministic.
+        By default it is unchanged.
+
+    Examples
+    --------
+    >>> with cygraph.parallel_config(num_threads=2, deterministic=True):
+    ...     ranks = alg.run_vertex_program(alg.PageRankProgram(), G)
+    """
+    old_num_threads, old_deterministic = _num_threads, _deterministic
+    try:
+        if num_threads is not None:
+            set_num_threads(num_threads)
+        if deterministic is not None:
+            set_deterministic(deterministic)
+        yield
+    finally:
+        set_num_threads(old_num_threads)
+        set_deterministic(old_deterministic)
+
+
+def map_blocks(function, n_blocks):
+    """Calls `function` on every block number, on the threads of a pool
+    shared by all parallel algorithms, which take the next block as soon
+    as they finish one. The work done on each block should release the
+    GIL. Blocks run from a block of another call run on its thread. When
+    tracing, each block is recorded on the thread that runs it.
+
+    Parameters
+    ----------
+    function: callable
+        Takes a block number and returns the result for that block.
+    n_blocks: int
+        The number of blocks.
+
+    Returns
+    -------
+    list
+        The results, in block order.
+    """
+    if tracing.is_enabled():
+        function = _traced_block(function)
+    n_workers = min(n_blocks, get_num_threads())
+    if n_workers <= 1 or getattr(_local, "in_pool", False):
+        return [function(b) for b in range(n_blocks)]
+    executor = _get_executor(get_num_threads())
+    # Only n_workers blocks are queued at once, so that a pool larger
+    # than needed does not run blocks on more threads than set.
+    blocks = iter(range(n_blocks))
+    results = [None] * n_blocks
+    lock = threading.Lock()
+    failed = threading.Event()
+
+    def run():
+        while not failed.is_set():
+            with lock:
+                b = next(blocks, None)
+            if b is None:
+                return
+            try:
+                results[b] = function(b)
+            except BaseException:
+                failed.set()
+                raise
+
+    futures = [executor.submit(run) for _ in range(n_workers)]
+    for future in futures:
+        future.exception()
+    for future in futures:
+        future.result()
+    return results
+
+
+def _get_executor(n_threads):
+    """Returns the shared thread pool, replacing it if it has a
+    different number of threads.
+    """
+    global _executor, _executor_size
+    with _executor_lock:
+        if _executor is None or _executor_size != n_threads:
+            if _executor is not None:
+                _executor.shutdown(wait=False)
+            _executor = ThreadPoolExecutor(max_workers=n_threads,
+                thread_name_prefix="cygraph",
+                initializer=_mark_pool_thread)
+            _executor_size = n_threads
+        return _executor
+
+
+def _mark_pool_thread():
+    _local.in_pool = True
+
+
+def _forget_executor():
+    """Drops the thread pool inherited by a forked process, whose threads
+    were not forked with it.
+    """
+    global _executor, _executor_lock
+    _executor = None
+    _executor_lock = threading.Lock()
+
+
+os.register_at_fork(after_in_child=_forget_executor)
+
+
+def _traced_block(function):
+    """Wraps a block function of map_blocks to record each call.
+    """
+    name = getattr(function, "__name__", "block")
+
+    def traced(b):
+        with tracing.span(name, "block", block=b):
+            return function(b)
+
+    return traced
+
+
+def shared_array(shape, dtype):
+    """Allocates a zeroed array in anonymous shared memory, so that
+    processes forked by run_processes afterwards write to the same
+    memory as the caller.
+
+    Parameters
+    ----------
+    shape: int or tuple
+        The shape of the array.
+    dtype: numpy dtype
+        The type of its elements.
+
+    Returns
+    -------
+    np.ndarray
+        The array, which keeps the memory alive.
+    """
+    dtype = np.dtype(dtype)
+    size = int(np.prod(shape))
+    buffer = mmap.mmap(-1, max(size * dtype.itemsize, 1))
+    return np.frombuffer(buffer, dtype=dtype, count=size).reshape(shape)
+
+
+def run_processes(function, n_workers):
+    """Calls `function(worker, barrier)` for every worker number, in the
+    calling process for worker 0 and in forked processes for the others,
+    which see the memory of the caller as it was when they were forked,
+    except for arrays from shared_array, which they share. When tracing,
+    the events recorded by the forked workers are added to those of the
+    caller.
+
+    Parameters
+    ----------
+    function: callable
+        Takes a worker number and a barrier that all workers wait at to
+        synchronize.
+    n_workers: int
+        The number of workers.
+
+    Raises
+    ------
+    RuntimeError
+        A forked worker failed, or processes cannot be forked on this
+        platform. Errors raised by worker 0 are raised as is. Either way
+        the barrier is broken so that no worker waits forever.
+    """
+    if n_workers <= 1:
+        function(0, threading.Barrier(1))
+        return
+    if "fork" not in multiprocessing.get_all_start_methods():
+        raise RuntimeError("Running several workers requires processes to "
+                           "be forked, which this platform does not "
+                           "support.")
+    context = multiprocessing.get_context("fork")
+    barrier = context.Barrier(n_workers)
+    processes = []
+    readers = []
+    for worker in range(1, n_workers):
+        reader, writer = context.Pipe(duplex=False)
+        processes.append(context.Process(target=_run_worker,
+            args=(function, worker, barrier, writer)))
+        processes[-1].start()
+        writer.close()
+        readers.append(reader)
+    # Workers that die without raising, such as when killed or crashing
+    # in a kernel, cannot break the barrier themselves.
+    stop_reader, stop_writer = context.Pipe(duplex=False)
+    watcher = threading.Thread(target=_watch_workers,
+                               args=(processes, barrier, stop_reader),
+                               daemon=True)
+    watcher.start()
+    try:
+        function(0, barrier)
+    except threading.BrokenBarrierError:
+        # A forked worker failed, which is reported below.
+        pass
+    except BaseException:
+        barrier.abort()
+        raise
+    finally:
+        # Reports are read before joining, so that no worker is stuck
+        # writing a report larger than the pipe can hold.
+        reports = [_receive_report(process, reader)
+                   for process, reader in zip(processes, readers)]
+        stop_writer.send(None)
+        watcher.join()
+        stop_writer.close()
+        stop_reader.close()
+        for process in processes:
+            process.join()
+    errors = []
+    for report in reports:
+        if report is not None and report[0] == "events":
+            tracing._add_events(report[1])
+        elif report is not None:
+            errors.append(report[1])
+    if barrier.broken or errors or any(process.exitcode
+                                       for process in processes):
+        raise RuntimeError("\n".join(["A worker process failed."]
+                                      + errors[:1]))
+
+
+def _run_worker(function, worker, barrier, writer):
+    """Runs a forked worker of run_processes, and sends the process that
+    forked it either its trace events or why it failed.
+    """
+    try:
+        function(worker, barrier)
+    except threading.BrokenBarrierError:
+        # Another worker failed and reports why.
+        writer.send(None)
+        os._exit(1)
+    except BaseException:
+        barrier.abort()
+        writer.send(("error", traceback.format_exc()[-4096:]))
+        os._exit(1)
+    writer.send(("events", tracing._take_events()))
+    writer.close()
+
+
+def _watch_workers(processes, barrier, stop):
+    """Breaks the barrier of run_processes as soon as a forked worker
+    exits with an error, until told to stop.
+    """
+    running = {process.sentinel: process for process in processes}
+    while running:
+        ready = wait(list(running) + [stop])
+        if stop in ready:
+            return
+        for sentinel in ready:
+            # The sentinel is ready as the process exits, which can be
+            # just before its exit code is.
+            process = running.pop(sentinel)
+            process.join()
+            if process.exitcode:
+                barrier.abort()
+                return
+
+
+def _receive_report(process, reader):
+    """Returns what a forked worker of run_processes sent, or None if it
+    exited without sending anything.
+    """
+    wait([reader, process.sentinel])
+    try:
+        return reader.recv() if reader.poll() else None
+    except EOFError:
+        return None
+    finally:
+        reader.close()
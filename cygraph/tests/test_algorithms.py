@@ -2,8 +2,13 @@
 """
 
 import itertools
+import json
+import os
+import signal
 import string
+import time
 
+import numpy as np
 import pytest
 
 import cygraph as cg
@@ -87,6 +92,25 @@ def test_get_shortest_path_dijkstra():
         with pytest.raises(ValueError):
             alg.get_shortest_path_dijkstra(disconnected_directed_graph, 'b', 'a')
 
+        # Lengths taken from an edge attribute or a weight function.
+        for u, v, weight in directed_graph_edges:
+            directed_graph.set_edge_attribute((u, v), 'time', 20.0 - weight)
+        assert alg.get_shortest_path_dijkstra(
+            directed_graph, 's', 'e', weight='time') == ['s', 'a', 'e']
+        assert alg.get_shortest_path_dijkstra(
+            directed_graph, 's', 'c', weight='time') == \
+            ['s', 'a', 'e', 'b', 'c']
+        assert alg.get_shortest_path_dijkstra(
+            undirected_graph, 's', 'e', weight=cg.UnitWeight()) == \
+            ['s', 'b', 'h', 'g', 'e']
+        with pytest.raises(KeyError):
+            alg.get_shortest_path_dijkstra(undirected_graph, 's', 'e',
+                                           weight='time')
+        directed_graph.set_edge_attribute(('s', 'a'), 'time', -1.0)
+        with pytest.raises(ValueError):
+            alg.get_shortest_path_dijkstra(directed_graph, 's', 'e',
+                                           weight='time')
+
 
 def test_get_min_spanning_tree():
     """Tests get_min_spanning_tree function.
@@ -143,6 +167,50 @@ def test_partition_karger():
             == set(input_graph.vertices)
 
 
+def test_min_cut_karger_stein():
+    """Tests finding minimum cuts on the work-stealing scheduler.
+    """
+    rng = np.random.default_rng(0)
+    for seed in range(20):
+        n = int(rng.integers(2, 12))
+        g = cg.graph(vertices=list(range(n)))
+        matrix = np.zeros((n, n))
+        for u, v in itertools.combinations(range(n), 2):
+            if rng.random() < 0.4:
+                matrix[u, v] = matrix[v, u] = float(rng.integers(1, 5))
+                g.add_edge(u, v, matrix[u, v])
+        cuts = []
+        for mask in range(1, 2 ** (n - 1)):
+            side = np.array([(mask >> v) & 1 for v in range(n)], dtype=bool)
+            cuts.append(matrix[side][:, ~side].sum())
+        weight, sides = alg.min_cut_karger_stein(g, seed=seed)
+        assert weight == min(cuts)
+        assert sides[0] == 0 and 0 < sides.sum() < n
+        assert matrix[sides == 1][:, sides == 0].sum() == weight
+
+    # Two cliques joined by two light edges.
+    g = cg.graph(vertices=list(range(40)))
+    for start in [0, 20]:
+        for u, v in itertools.combinations(range(start, start + 20), 2):
+            g.add_edge(u, v, 1.0)
+    g.add_edge(0, 20, 0.5)
+    g.add_edge(5, 30, 0.25)
+    weight, sides = alg.min_cut_karger_stein(g, seed=1)
+    assert weight == 0.75
+    assert (sides == np.repeat([0, 1], 20)).all()
+    # The result does not depend on the number of threads.
+    with cg.parallel_config(num_threads=3):
+        weight, threaded_sides = alg.min_cut_karger_stein(g, seed=1)
+        assert (threaded_sides == sides).all()
+    assert alg.min_cut_karger_stein(g.to_int_graph(), trials=4)[0] == 0.75
+    assert alg.min_cut_karger_stein(cg.graph(vertices=[1, 2, 3]))[0] == 0.0
+
+    with pytest.raises(NotImplementedError):
+        alg.min_cut_karger_stein(cg.graph(directed=True, vertices=[1, 2]))
+    with pytest.raises(ValueError):
+        alg.min_cut_karger_stein(cg.graph(vertices=[1]))
+
+
 def test_get_connected_components():
     """Tests get_connected_components and get_number_connected_components functions.
     """
@@ -208,4 +276,678 @@ def test_get_strongly_connected_components():
         with pytest.raises(NotImplementedError):
             alg.get_strongly_connected_components(g2)
         with pytest.raises(NotImplementedError):
-            alg.get_number_strongly_connected_components(g2)
\ No newline at end of file
+            alg.get_number_strongly_connected_components(g2)
+
+
+def test_get_earliest_arrival_times():
+    """Tests get_earliest_arrival_times and is_temporally_reachable
+    functions.
+    """
+    g = cg.TemporalGraph(directed=True, vertices=list(range(5)))
+    g.add_edges([(0, 1, 2.0), (1, 2, 1.0), (1, 2, 3.0), (2, 3, 3.0),
+                 (3, 0, 4.0), (4, 0, 0.0)])
+
+    assert alg.get_earliest_arrival_times(g, 0, start=0.0) == \
+        {0: 0.0, 1: 2.0, 2: 3.0, 3: 3.0}
+    assert alg.get_earliest_arrival_times(g, 0, start=2.5) == {0: 2.5}
+    assert alg.get_earliest_arrival_times(g, 1, end=3.0) == {1: float('-inf'),
+                                                             2: 1.0}
+    assert alg.get_earliest_arrival_times(g.snapshot(0.0, 3.0), 0) == \
+        {0: 0.0, 1: 2.0}
+
+    assert alg.is_temporally_reachable(g, 4, 3)
+    assert not alg.is_temporally_reachable(g, 2, 1)
+    assert not alg.is_temporally_reachable(g, 0, 3, end=3.0)
+    assert alg.is_temporally_reachable(g, 0, 0, start=10.0)
+
+    # Undirected contacts can be used in either direction.
+    g = cg.TemporalGraph(vertices=list(range(3)))
+    g.add_edges([(1, 0, 1.0), (2, 1, 2.0)])
+    assert alg.get_earliest_arrival_times(g, 0, start=0.0) == \
+        {0: 0.0, 1: 1.0, 2: 2.0}
+    assert alg.get_earliest_arrival_times(g, 2, start=0.0) == \
+        {2: 0.0, 1: 2.0}
+
+    with pytest.raises(ValueError):
+        alg.get_earliest_arrival_times(g, 5)
+
+
+def test_neighborhood_function():
+    """Tests neighborhood_function function.
+    """
+    for static in [True, False]:
+        # A path of 10 vertices.
+        g = cg.graph(static=static, vertices=list(range(10)))
+        g.add_edges({(i, i + 1) for i in range(9)})
+        stats = alg.neighborhood_function(g, registers=4096)
+        exact = [10 + sum(2 * (10 - d) for d in range(1, t + 1))
+                 for t in range(10)]
+        assert stats["neighborhood_function"] == \
+            pytest.approx(exact, rel=0.05)
+        assert stats["diameter_lower_bound"] == 9
+        assert stats["reachable_pairs"] == pytest.approx(90, rel=0.05)
+        assert stats["average_distance"] == pytest.approx(11 / 3, rel=0.05)
+        assert stats["distance_distribution"][1] == pytest.approx(18, rel=0.05)
+
+        stats = alg.neighborhood_function(g, registers=16, max_distance=2)
+        assert len(stats["neighborhood_function"]) == 3
+
+        # Distances follow edge directions.
+        g = cg.graph(static=static, directed=True, vertices=list(range(4)))
+        g.add_edges({(0, 1), (1, 2), (3, 2)})
+        stats = alg.neighborhood_function(g, registers=1024, seed=1)
+        assert stats["neighborhood_function"] == \
+            pytest.approx([4, 7, 8], rel=0.05)
+        assert stats["effective_diameter"] == pytest.approx(1.2, rel=0.05)
+
+    # Isolated vertices.
+    stats = alg.neighborhood_function(cg.graph(vertices=[0, 1]))
+    assert stats["neighborhood_function"] == pytest.approx([2], rel=0.05)
+    assert np.isnan(stats["average_distance"])
+
+    for registers in [8, 100, 131072]:
+        with pytest.raises(ValueError):
+            alg.neighborhood_function(g, registers=registers)
+
+
+def test_neighborhood_sketches():
+    """Tests neighborhood_sketches function and MinHashIndex class.
+    """
+    for static in [True, False]:
+        g = cg.graph(static=static, directed=True, vertices=list(range(8)))
+        g.add_edges({(0, 4), (0, 5), (0, 6), (1, 4), (1, 5), (1, 6), (2, 4),
+                     (2, 5), (2, 7), (3, 7)})
+        sketches = alg.neighborhood_sketches(g, k=256, seed=7)
+        assert sketches.shape == (8, 256)
+        assert sketches.dtype == np.uint64
+        assert (sketches[0] == sketches[1]).all()
+        assert (sketches[4] == np.iinfo(np.uint64).max).all()
+        assert (alg.neighborhood_sketches(g, k=256, seed=7) == sketches).all()
+        assert not (alg.neighborhood_sketches(g, k=256, seed=8)
+                    == sketches).all()
+
+        index = alg.MinHashIndex(g, sketches, bands=64)
+        assert index.rows == 4
+        assert index.similarity(0, 1) == 1.0
+        assert index.similarity(0, 2) == pytest.approx(0.5, abs=0.1)
+        assert index.similarity(0, 3) == 0.0
+        assert index.similarity(4, 4) == 0.0
+        results = index.query(0)
+        assert results[0] == (1, 1.0)
+        assert [v for v, _ in results] == [1, 2]
+        assert index.query(0, n=1) == [(1, 1.0)]
+        assert index.query(0, threshold=0.9) == [(1, 1.0)]
+        assert index.query(4) == []
+
+        with pytest.raises(ValueError):
+            alg.MinHashIndex(g, sketches, bands=3)
+        with pytest.raises(ValueError):
+            alg.MinHashIndex(g, sketches[:4])
+        with pytest.raises(ValueError):
+            index.query(8)
+    with pytest.raises(ValueError):
+        alg.neighborhood_sketches(g, k=0)
+
+
+def _bfs_distances(graph, source):
+    """Finds the number of hops from a vertex of a graph to every vertex
+    by breadth-first search in Python, np.inf for unreachable ones.
+    """
+    adjacency = graph.to_sparse()
+    distances = np.full(adjacency.shape[0], np.inf)
+    distances[source] = 0
+    frontier = [source]
+    hop = 0
+    while frontier:
+        hop += 1
+        frontier = [u for v in frontier
+                    for u in adjacency.indices[
+                        adjacency.indptr[v]:adjacency.indptr[v + 1]]
+                    if distances[u] == np.inf]
+        distances[frontier] = hop
+    return distances
+
+
+def test_khop_neighbors():
+    """Tests khop_neighbors function.
+    """
+    rng = np.random.default_rng(0)
+    for directed in [False, True]:
+        builder = cg.GraphBuilder(directed=directed, vertices=list(range(80)))
+        for u, v in rng.integers(0, 80, (160, 2)).tolist():
+            if u != v:
+                builder.add_edge(u, v)
+        g = builder.finalize(backend="int", combine="first")
+        all_distances = np.array([_bfs_distances(g, source)
+                                  for source in range(80)])
+        for k in [0, 1, 2, 4]:
+            distances = np.where(all_distances <= k, all_distances, -1)
+            assert (alg.khop_neighbors(g, k=k) ==
+                    (distances > 0).sum(axis=1)).all()
+            members = alg.khop_neighbors(g, range(0, 80, 3), k=k,
+                                         output="members")
+            assert members.shape == (27, 80)
+            for row, source in enumerate(range(0, 80, 3)):
+                expected = np.flatnonzero(distances[source] > 0)
+                found = slice(members.indptr[row], members.indptr[row + 1])
+                assert (members.indices[found] == expected).all()
+                assert (members.data[found] ==
+                        distances[source, expected]).all()
+            estimates = alg.khop_neighbors(g, k=k, output="approximate_count",
+                                           registers=4096)
+            assert estimates == pytest.approx((distances > 0).sum(axis=1),
+                                              rel=0.1, abs=0.5)
+
+    g = cg.graph(vertices=["a", "b", "c"])
+    g.add_edges({("a", "b"), ("b", "c")})
+    assert list(alg.khop_neighbors(g, ["a", "b"], k=1)) == [1, 2]
+    assert alg.khop_neighbors(g, [], output="members").shape == (0, 3)
+    with pytest.raises(ValueError):
+        alg.khop_neighbors(g, ["a"], output="sizes")
+    with pytest.raises(ValueError):
+        alg.khop_neighbors(g, ["d"])
+    with pytest.raises(ValueError):
+        alg.khop_neighbors(g.to_int_graph(), [3])
+
+    g = cg.graph(vertices=list(range(5)))
+    g.add_edges({(0, 1), (1, 2), (2, 3), (3, 4)})
+    stats = alg.ExecutionStats()
+    for output in ["count", "members"]:
+        alg.khop_neighbors(g, [0, 2], k=3, output=output, stats=stats)
+        assert stats.algorithm == "khop_neighbors"
+        # The frontiers of 0 and 2 at each hop: {0} and {2}, {1} and
+        # {1, 3}, {2} and {0, 4}.
+        assert stats.frontier_sizes == [2, 3, 3]
+        if stats.instrumented:
+            assert stats.vertices_settled == 4 + 5
+    assert set(stats.phase_times) == {"setup", "search", "assemble"}
+    alg.khop_neighbors(g, [0], k=3, output="approximate_count", stats=stats)
+    assert stats.frontier_sizes[0] == 5 and stats.iterations <= 3
+    assert set(stats.phase_times) == {"setup", "union", "estimate"}
+
+
+def test_landmark_index(tmp_path):
+    """Tests LandmarkIndex class.
+    """
+    rng = np.random.default_rng(0)
+    for directed in [False, True]:
+        builder = cg.GraphBuilder(directed=directed, vertices=list(range(60)))
+        for u, v in rng.integers(0, 60, (90, 2)).tolist():
+            if u != v:
+                builder.add_edge(u, v)
+        g = builder.finalize(backend="int", combine="first")
+        distances = np.array([_bfs_distances(g, source)
+                              for source in range(60)])
+        sources, targets = np.divmod(np.arange(3600), 60)
+        for num_threads in [1, 3]:
+            with cg.parallel_config(num_threads=num_threads):
+                index = alg.LandmarkIndex(g)
+                assert (index.distances(sources, targets) ==
+                        distances.ravel()).all()
+                assert (index.are_reachable(sources, targets) ==
+                        np.isfinite(distances.ravel())).all()
+        assert index.distance(5, 7) == distances[5, 7]
+        assert index.is_reachable(5, 7) == np.isfinite(distances[5, 7])
+        index.save(tmp_path / "index.npz")
+        loaded = alg.LandmarkIndex.load(tmp_path / "index.npz", g)
+        assert (loaded.distances(sources, targets) == distances.ravel()).all()
+
+    g = cg.graph(directed=True, vertices=["a", "b", "c", "d"])
+    g.add_edges({("a", "b"), ("b", "c"), ("c", "a"), ("c", "d")})
+    index = alg.LandmarkIndex(g)
+    assert index.distance("b", "a") == 2
+    assert not index.is_reachable("d", "a")
+    assert list(index.distances(["a", "a"], ["c", "d"])) == [2, 3]
+    with pytest.raises(ValueError):
+        index.distance("a", "e")
+    with pytest.raises(ValueError):
+        index.distances(["a"], ["b", "c"])
+    with pytest.raises(ValueError):
+        alg.LandmarkIndex.load(tmp_path / "index.npz", g)
+
+
+def test_spectral_embedding():
+    """Tests spectral_embedding function.
+    """
+    for static in [True, False]:
+        # Two triangles joined by an edge, and a separate pair of
+        # vertices.
+        g = cg.graph(static=static, vertices=list(range(8)))
+        g.add_edges({(0, 1), (1, 2), (2, 0), (3, 4), (4, 5), (5, 3),
+                     (2, 3, 0.5), (6, 7)})
+        adjacency = np.zeros((8, 8))
+        for u, v, weight in g.edges:
+            adjacency[u, v] = adjacency[v, u] = weight
+        degrees = adjacency.sum(axis=1)
+
+        for normalized in [True, False]:
+            if normalized:
+                scale = 1 / np.sqrt(degrees)
+                laplacian = np.eye(8) - scale[:, None] * adjacency * scale
+            else:
+                laplacian = np.diag(degrees) - adjacency
+            eigenvalues = np.linalg.eigvalsh(laplacian)
+
+            embedding = alg.spectral_embedding(g, 3, normalized=normalized)
+            assert embedding.shape == (8, 3)
+            assert embedding.T @ embedding == pytest.approx(np.eye(3))
+            quotients = np.einsum('ij,ij->j', embedding,
+                                  laplacian @ embedding)
+            assert quotients == pytest.approx(eigenvalues[1:4], abs=1e-6)
+            assert laplacian @ embedding == \
+                pytest.approx(embedding * quotients, abs=1e-6)
+            assert (embedding[np.abs(embedding).argmax(axis=0),
+                              np.arange(3)] > 0).all()
+
+        for u, v, weight in g.edges:
+            g.set_edge_attribute((u, v), 'strength', weight)
+        assert alg.spectral_embedding(g, 3, weight='strength') == \
+            pytest.approx(alg.spectral_embedding(g, 3))
+        assert (g.to_sparse(weight=cg.UnitWeight()).data == 1.0).all()
+
+        # The graph has two components, so 0 is a double eigenvalue.
+        embedding = alg.spectral_embedding(g, 2, normalized=False,
+                                           drop_first=False)
+        assert laplacian @ embedding == pytest.approx(0, abs=1e-6)
+
+    # Larger than the Krylov basis.
+    g = cg.graph(static=True, vertices=list(range(100)))
+    g.add_edges({(i, (i + 1) % 100) for i in range(100)})
+    embedding = alg.spectral_embedding(g, 2, normalized=False)
+    angles = 2 * np.pi * np.arange(100) / 100
+    circle = np.column_stack([np.cos(angles), np.sin(angles)])
+    # The first two nontrivial eigenvectors of a cycle span the circle.
+    projection = embedding @ (embedding.T @ circle)
+    assert projection == pytest.approx(circle, abs=1e-6)
+
+    with pytest.raises(NotImplementedError):
+        alg.spectral_embedding(cg.graph(directed=True, vertices=[0, 1]), 1)
+    with pytest.raises(ValueError):
+        alg.spectral_embedding(g, 100)
+    with pytest.raises(ValueError):
+        alg.spectral_embedding(g, 0)
+
+
+def test_batch_algorithms():
+    """Tests the batched algorithms against their per-graph results.
+    """
+    rng = np.random.default_rng(0)
+    for directed in [True, False]:
+        graphs = []
+        for _ in range(50):
+            n = int(rng.integers(0, 8))
+            g = cg.graph(static=True, directed=directed,
+                         vertices=list(range(n)))
+            for u, v in rng.integers(0, max(n, 1), (n, 2)).tolist():
+                if not g.has_edge(u, v):
+                    g.add_edge(u, v, float(rng.integers(1, 5)))
+            graphs.append(g)
+        batch = cg.GraphBatch(graphs)
+        offsets = batch.vertex_offsets
+
+        counts, labels = alg.batch_connected_components(batch)
+        distances = alg.batch_shortest_path_lengths(batch, [0] * len(graphs))
+        minima, maxima, means = alg.batch_degree_stats(batch)
+        for i, g in enumerate(graphs):
+            graph_labels = labels[offsets[i]:offsets[i + 1]].tolist()
+            undirected = cg.graph(vertices=g.vertices)
+            undirected.add_edges({(min(u, v), max(u, v))
+                                  for u, v, _ in g.edges})
+            assert counts[i] == alg.get_number_connected_components(undirected)
+            assert len(set(graph_labels)) == counts[i]
+            for u, v, _ in g.edges:
+                assert graph_labels[u] == graph_labels[v]
+            assert list(dict.fromkeys(graph_labels)) == list(range(counts[i]))
+            for v in g.vertices:
+                try:
+                    path = alg.get_shortest_path_dijkstra(g, 0, v)
+                except ValueError:
+                    assert distances[offsets[i] + v] == np.inf
+                    continue
+                assert distances[offsets[i] + v] == sum(
+                    g.get_edge_weight(*e) for e in zip(path, path[1:]))
+            degrees = [len(g.get_children(v)) for v in g.vertices] or [0]
+            assert (minima[i], maxima[i]) == (min(degrees), max(degrees))
+            assert means[i] == pytest.approx(np.mean(degrees))
+
+        # Relabeled copies of the graphs hash the same.
+        relabeled = []
+        for g in graphs:
+            permutation = rng.permutation(len(g.vertices)).tolist()
+            h = cg.graph(directed=directed, vertices=g.vertices)
+            h.add_edges({(permutation[u], permutation[v], 1.0)
+                         for u, v, _ in g.edges})
+            relabeled.append(h)
+        hashes = alg.batch_wl_hash(batch)
+        assert hashes.dtype == np.uint64
+        assert (alg.batch_wl_hash(cg.GraphBatch(relabeled)) == hashes).all()
+
+    path = cg.GraphBatch.from_edges([4, 4], [3, 3], [0, 1, 2, 0, 0, 0],
+                                    [1, 2, 3, 1, 2, 3])
+    star_hash, path_hash = alg.batch_wl_hash(path)[::-1]
+    assert star_hash != path_hash
+    assert alg.batch_wl_hash(path, iterations=0).tolist() == [
+        alg.batch_wl_hash(path, iterations=0)[1]] * 2
+    with pytest.raises(ValueError):
+        alg.batch_shortest_path_lengths(path, [0])
+    with pytest.raises(ValueError):
+        alg.batch_shortest_path_lengths(path, [0, 4])
+    with pytest.raises(ValueError):
+        alg.batch_shortest_path_lengths(
+            cg.GraphBatch.from_edges([2], [1], [0], [1], [-1.0]), [0])
+
+
+def test_run_vertex_program():
+    """Tests running vertex programs on one or several worker processes.
+    """
+    rng = np.random.default_rng(0)
+    g = cg.graph(static=True, directed=True, vertices=list(range(60)))
+    for u, v in rng.integers(0, 60, (240, 2)).tolist():
+        if not g.has_edge(u, v):
+            g.add_edge(u, v, float(rng.integers(1, 10)))
+    g.add_edge(0, 59, -1.0)
+    adjacency = (g.to_sparse().toarray() != 0).astype(float)
+    degrees = adjacency.sum(axis=1)
+    ranks = np.full(60, 1 / 60)
+    for _ in range(20):
+        ranks = 0.1 / 60 + 0.9 * adjacency.T @ (ranks / np.maximum(degrees, 1))
+    distances = g.to_sparse().toarray()
+    distances[adjacency == 0] = np.inf
+    np.fill_diagonal(distances, 0.0)
+    for k in range(60):
+        distances = np.minimum(distances,
+                               distances[:, [k]] + distances[[k], :])
+
+    for n_workers in [1, 3]:
+        program = alg.PageRankProgram(damping=0.9, iterations=20)
+        assert alg.run_vertex_program(program, g, n_workers=n_workers) == \
+            pytest.approx(ranks)
+        for source in [0, 7]:
+            program = alg.ShortestPathProgram(source)
+            assert (alg.run_vertex_program(program, g, n_workers=n_workers)
+                    == distances[source]).all()
+    partition = np.arange(60) % 2
+    assert (alg.run_vertex_program(alg.ShortestPathProgram(0),
+                                   g.to_int_graph(), partition=partition)
+            == distances[0]).all()
+    for u, v, weight in g.edges:
+        g.set_edge_attribute((u, v), "length", 2 * weight)
+    assert (alg.run_vertex_program(alg.ShortestPathProgram(0), g,
+                                   weight="length", n_workers=2)
+            == 2 * distances[0]).all()
+    steps = alg.run_vertex_program(alg.ShortestPathProgram(0), g,
+                                   max_supersteps=2)
+    assert (steps[distances[0] == np.inf] == np.inf).all()
+    assert (steps >= distances[0]).all() and (steps > distances[0]).any()
+
+    with pytest.raises(ValueError):
+        alg.run_vertex_program(alg.PageRankProgram(), g, partition=[0])
+    with pytest.raises(ValueError):
+        alg.run_vertex_program(alg.PageRankProgram(), g, n_workers=1,
+                               partition=partition)
+    with pytest.raises(TypeError):
+        alg.run_vertex_program(alg.PageRankProgram(), g.to_int_graph(),
+                               weight="length")
+    with pytest.raises(ValueError):
+        alg.PageRankProgram(damping=2.0)
+
+
+def test_run_processes():
+    """Tests that worker processes dying without an exception do not
+    leave the others waiting.
+    """
+    def work(worker, barrier):
+        if worker == 1:
+            os.kill(os.getpid(), signal.SIGKILL)
+        barrier.wait()
+
+    start = time.monotonic()
+    with pytest.raises(RuntimeError):
+        cg.parallel.run_processes(work, 3)
+    assert time.monotonic() - start < 10
+
+
+def test_run_gas():
+    """Tests running gather-apply-scatter programs to convergence.
+    """
+    rng = np.random.default_rng(0)
+    for directed in [True, False]:
+        g = cg.graph(static=True, directed=directed, vertices=list(range(80)))
+        for u, v in rng.integers(0, 80, (200, 2)).tolist():
+            if not g.has_edge(u, v):
+                g.add_edge(u, v)
+        adjacency = (g.to_sparse().toarray() != 0).astype(float)
+        degrees = np.maximum(adjacency.sum(axis=1), 1)
+        seeds = (np.arange(80) % 10 == 0).astype(float)
+        scores = np.linalg.solve(
+            np.eye(80) - 0.8 * (adjacency / degrees[:, None]).T, 0.2 * seeds)
+
+        program = alg.DiffusionProgram(seeds, damping=0.8, tolerance=1e-12)
+        values, iterations = alg.run_gas(program, g)
+        assert values == pytest.approx(scores, abs=1e-9)
+        assert 1 < iterations < 500
+        for other in [g.to_int_graph(), g.thaw()]:
+            assert alg.run_gas(program, other)[0] == \
+                pytest.approx(values, abs=1e-12)
+        values, iterations = alg.run_gas(program, g, max_iterations=3)
+        assert iterations == 3
+        assert not values == pytest.approx(scores, abs=1e-9)
+
+        # Only the vertices reachable from the active one change.
+        values, _ = alg.run_gas(program, g, active=[1])
+        reachable = {1}
+        frontier = [1]
+        while frontier:
+            u = frontier.pop()
+            for v in g.get_children(u):
+                if v not in reachable:
+                    reachable.add(v)
+                    frontier.append(v)
+        changed = np.flatnonzero(values != 0.2 * seeds)
+        assert set(changed.tolist()) <= reachable
+
+    values, iterations = alg.run_gas(alg.GASProgram(), g)
+    assert (values == 0).all() and iterations == 1
+    with pytest.raises(ValueError):
+        alg.run_gas(program, g, active=[80])
+    with pytest.raises(ValueError):
+        alg.DiffusionProgram(seeds, damping=1.0)
+    with pytest.raises(ValueError):
+        alg.run_gas(alg.DiffusionProgram(seeds[:-1]), g)
+
+
+def test_execution_stats():
+    """Tests the execution statistics filled in by algorithms.
+    """
+    g = cg.graph(static=True, directed=True, vertices=list(range(5)))
+    g.add_edges({(0, 1, 1.0), (0, 2, 5.0), (1, 2, 1.0), (2, 3, 1.0)})
+
+    stats = alg.ExecutionStats()
+    assert stats.algorithm is None
+    assert alg.get_shortest_path_dijkstra(g, 0, 3, stats=stats) == \
+        [0, 1, 2, 3]
+    assert stats.algorithm == "get_shortest_path_dijkstra"
+    assert set(stats.phase_times) == {"setup", "search", "path"}
+    assert all(seconds >= 0 for seconds in stats.phase_times.values())
+    assert stats.peak_scratch_bytes == 2 * 5 * 8 + 2 * 5 * 8
+    if stats.instrumented:
+        # 0, 1, 2 and 3 are settled; 2 is pushed twice and popped once
+        # stale before 3 is reached.
+        assert (stats.vertices_settled, stats.edges_relaxed,
+                stats.heap_pushes, stats.heap_pops) == (4, 4, 5, 4)
+    else:
+        assert stats.as_dict()["heap_pushes"] == 0
+
+    batch = cg.GraphBatch([g, g])
+    alg.batch_shortest_path_lengths(batch, [0, 0], stats=stats)
+    assert stats.algorithm == "batch_shortest_path_lengths"
+    if stats.instrumented:
+        assert stats.vertices_settled == 8 and stats.heap_pushes == 10
+
+    alg.batch_connected_components(batch, stats=stats)
+    assert stats.algorithm == "batch_connected_components"
+    assert set(stats.phase_times) == {"setup", "label"}
+    if stats.instrumented:
+        assert (stats.vertices_settled, stats.edges_relaxed) == (10, 8)
+    alg.batch_wl_hash(batch, stats=stats)
+    assert stats.frontier_sizes == [10, 10, 10]
+    assert set(stats.phase_times) == {"setup", "hash"}
+    if stats.instrumented:
+        assert (stats.vertices_settled, stats.edges_relaxed) == (30, 24)
+    alg.batch_degree_stats(batch, stats=stats)
+    assert set(stats.phase_times) == {"setup", "summarize"}
+    if stats.instrumented:
+        assert stats.vertices_settled == 10
+
+    temporal = cg.TemporalGraph(directed=True, vertices=['a', 'b', 'c'])
+    temporal.add_edges([('a', 'b', 2.0), ('b', 'c', 1.0), ('b', 'c', 3.0)])
+    alg.get_earliest_arrival_times(temporal, 'a', start=0.0, stats=stats)
+    assert stats.algorithm == "get_earliest_arrival_times"
+    assert set(stats.phase_times) == {"setup", "search"}
+    if stats.instrumented:
+        # The contact from b to c at time 1 is too early to be taken.
+        assert (stats.vertices_settled, stats.edges_relaxed,
+                stats.heap_pushes, stats.heap_pops) == (3, 2, 3, 3)
+    assert alg.is_temporally_reachable(temporal, 'a', 'c', stats=stats)
+    assert stats.algorithm == "is_temporally_reachable"
+
+    alg.run_vertex_program(alg.ShortestPathProgram(0), g, n_workers=2,
+                           stats=stats)
+    # The vertices whose distance improved in each superstep.
+    assert stats.frontier_sizes == [1, 2, 2, 1, 0]
+    assert stats.iterations == 5
+    if stats.instrumented:
+        assert stats.vertices_settled == 5 + 3 + 3 + 2 + 1
+        assert stats.edges_relaxed == 2 + 2 + 1
+
+    _, iterations = alg.run_gas(alg.DiffusionProgram([1, 0, 0, 0, 0]), g,
+                                stats=stats)
+    assert stats.iterations == iterations
+    assert stats.frontier_sizes[0] == 5
+    assert stats.as_dict()["frontier_sizes"] == stats.frontier_sizes
+    assert set(stats.phase_times) == {"setup", "gather_apply", "scatter"}
+    assert stats.peak_scratch_bytes > 0
+    if stats.instrumented:
+        assert stats.vertices_settled == sum(stats.frontier_sizes)
+
+    # A cycle of 10 vertices.
+    cycle = cg.graph(vertices=list(range(10)))
+    cycle.add_edges({(v, (v + 1) % 10) for v in range(10)})
+    alg.neighborhood_function(cycle, stats=stats)
+    assert stats.algorithm == "neighborhood_function"
+    # Distances go up to 5, and the last iteration changes nothing.
+    assert stats.frontier_sizes == [10] * 6
+    assert set(stats.phase_times) == {"setup", "union"}
+    if stats.instrumented:
+        assert stats.vertices_settled == 60
+        assert stats.edges_relaxed == 120
+
+    large_cycle = cg.graph(vertices=list(range(60)))
+    large_cycle.add_edges({(v, (v + 1) % 60) for v in range(60)})
+    alg.spectral_embedding(large_cycle, 2, stats=stats)
+    assert stats.algorithm == "spectral_embedding"
+    # The eigenvectors not yet converged at each restart.
+    assert stats.frontier_sizes[-1] == 0
+    assert stats.iterations == len(stats.frontier_sizes)
+    if stats.instrumented:
+        assert stats.edges_relaxed == 2 * stats.vertices_settled
+    assert set(stats.phase_times) == {"setup", "eigensolver"}
+    assert stats.peak_scratch_bytes > 0
+
+    # Every task on more than 6 vertices contracts to 9, 8, 7 and then 6.
+    alg.min_cut_karger_stein(cycle, trials=2, stats=stats)
+    assert stats.frontier_sizes == [2, 4, 8, 16, 32]
+    assert set(stats.phase_times) == {"setup", "contraction"}
+    if stats.instrumented:
+        assert stats.vertices_settled == 4 + 8 + 16 + 32
+
+    index = alg.LandmarkIndex(g, stats=stats)
+    assert stats.algorithm == "LandmarkIndex"
+    assert sum(stats.frontier_sizes) == index.label_sizes.sum()
+    assert set(stats.phase_times) == {"setup", "labeling", "compress"}
+    if stats.instrumented:
+        assert stats.vertices_settled == index.label_sizes.sum()
+
+
+def test_tracing(tmp_path):
+    """Tests tracing graph operations and the phases of algorithms.
+    """
+    g = cg.graph(static=True, directed=True, vertices=list(range(5)))
+    g.add_edges({(0, 1, 1.0), (0, 2, 5.0), (1, 2, 1.0), (2, 3, 1.0)})
+    path = tmp_path / "trace.json"
+    with cg.tracing.trace(path):
+        assert cg.tracing.is_enabled()
+        g.thaw()
+        cg.StaticGraph(vertices=[0, 1], adjacency_list=[[1], []])
+        g.add_edges({(3, 4, 1.0)})
+        alg.get_shortest_path_dijkstra(g, 0, 3)
+        alg.run_vertex_program(alg.ShortestPathProgram(0), g, n_workers=2)
+        cg.build_csr([0, 1], [1, 2])
+    assert not cg.tracing.is_enabled()
+
+    events = cg.tracing.events()
+    assert [event["ts"] for event in events] == \
+        sorted(event["ts"] for event in events)
+    # Spans are balanced on every thread of every process.
+    threads = {(event["pid"], event["tid"]) for event in events}
+    for thread in threads:
+        depth = 0
+        for event in events:
+            if (event["pid"], event["tid"]) == thread:
+                depth += 1 if event["ph"] == "B" else -1
+                assert depth >= 0
+        assert depth == 0
+    spans = {(event["cat"], event["name"]) for event in events}
+    assert {("graph", "Graph.thaw"), ("graph", "DynamicGraph.__init__"),
+            ("graph", "StaticGraph.__init__"), ("graph", "Graph.add_edges"),
+            ("graph", "build_csr"),
+            ("algorithm", "get_shortest_path_dijkstra"),
+            ("algorithm", "run_vertex_program"), ("phase", "setup"),
+            ("phase", "search"), ("phase", "compute"),
+            ("block", "count_chunk")} <= spans
+    assert len({event["pid"] for event in events
+                if event["name"] == "compute"}) == 2
+    assert [event["args"]["source"] for event in events
+            if event["name"].endswith(".__init__") and event["ph"] == "B"] \
+        == ["graph", "adjacency_list"]
+
+    with open(path) as f:
+        assert json.load(f)["traceEvents"] == events
+
+    cg.tracing.clear()
+    alg.get_shortest_path_dijkstra(g, 0, 3)
+    assert cg.tracing.events() == []
+
+
+def test_parallel_config():
+    """Tests setting the number of threads and deterministic reductions.
+    """
+    default_threads = cg.get_num_threads()
+    assert default_threads >= 1
+    with pytest.raises(ValueError):
+        cg.set_num_threads(0)
+    with cg.parallel_config(num_threads=3, deterministic=True):
+        assert cg.get_num_threads() == 3
+        assert cg.is_deterministic()
+        assert alg.get_number_connected_components(
+            cg.graph(vertices=list(range(4)))) == 4
+    assert cg.get_num_threads() == default_threads
+    assert not cg.is_deterministic()
+
+    rng = np.random.default_rng(1)
+    builder = cg.GraphBuilder(directed=True, vertices=list(range(300)))
+    for u, v in rng.integers(0, 300, (3000, 2)).tolist():
+        builder.add_edge(u, v)
+    g = builder.finalize(backend="int", combine="first")
+    ranks = alg.run_vertex_program(alg.PageRankProgram(), g, n_workers=1)
+    partition = rng.integers(0, 3, 300)
+    # Fixed-order sums give the same bits as a single worker.
+    assert (alg.run_vertex_program(alg.PageRankProgram(), g,
+                                   partition=partition, deterministic=True)
+            == ranks).all()
+    with cg.parallel_config(num_threads=4, deterministic=True):
+        assert (alg.run_vertex_program(alg.PageRankProgram(), g) ==
+                ranks).all()
+        matrix = cg.build_csr(rng.integers(0, 10, 10000),
+                              rng.integers(0, 10, 10000))
+    assert matrix.data.sum() == 10000
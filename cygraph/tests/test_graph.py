@@ -1,6 +1,8 @@
 """Unit tests for classes implemented in cygraph/graph.pyx
 """
 
+import copy
+import ctypes
 import os
 import pickle
 
@@ -297,6 +299,26 @@ def test_vertices():
         assert not g.has_vertex('c')
         assert g.has_vertex('s')
 
+        # remove_vertices
+        g = cg.graph(static=static, directed=True, vertices=list(range(5)))
+        g.add_edges({(0, 1, 2.0), (1, 2), (2, 3), (3, 4, 3.0), (4, 0)})
+        g.set_vertex_attribute(1, key='key', val='val')
+        g.set_vertex_attribute(4, key='key', val='val')
+        g.set_edge_attribute((3, 4), key='key', val='val')
+        g.set_edge_attribute((1, 2), key='key', val='val')
+        assert g.remove_vertices([1, 3, 1]) == [0, -1, 1, -1, 2]
+        assert g.vertices == [0, 2, 4]
+        assert g.edges == {(4, 0, 1.0)}
+        assert g.get_children(4) == {0}
+        assert g.vertex_attributes == {0: {}, 2: {}, 4: {'key': 'val'}}
+        assert g.edge_attributes == {(4, 0): {}}
+        with pytest.raises(ValueError):
+            g.remove_vertices([0, 'a'])
+        assert g.vertices == [0, 2, 4]
+        g.remove_vertex(2)
+        assert g.vertices == [0, 4]
+        assert g.edges == {(4, 0, 1.0)}
+
 def test_attributes():
     """Tests various edge and vertex attribute-related methods.
 
@@ -471,3 +493,667 @@ def test_pickling():
         os.remove('tmp.pickle')
         assert g.equals(loaded_g)
         assert loaded_g.equals(g)
+
+
+def test_copy():
+    """Tests copying graphs.
+    """
+    for static in [True, False]:
+        g = cg.graph(static=static, vertices=list(range(3)))
+        g.add_edges({(0, 1), (1, 2)})
+        g.set_vertex_attribute(0, "tags", ["a"])
+        g.set_edge_attribute((0, 1), "color", "red")
+
+        h = copy.copy(g)
+        assert h.equals(g, vertex_attrs=True, edge_attrs=True)
+        h.add_edge(2, 0)
+        h.set_edge_attribute((0, 1), "color", "blue")
+        h.set_vertex_attribute(1, "tags", [])
+        assert not g.has_edge(2, 0)
+        assert g.get_edge_attribute((0, 1), "color") == "red"
+        assert g.vertex_attributes[1] == {}
+
+        # Copies deep-copy attribute values, so mutating a value in one
+        # graph leaves the other unchanged.
+        h = copy.copy(g)
+        h.get_vertex_attribute(0, "tags").append("b")
+        assert g.get_vertex_attribute(0, "tags") == ["a"]
+        h = cg.graph(graph_=g, static=static)
+        g.get_vertex_attribute(0, "tags").append("c")
+        assert h.get_vertex_attribute(0, "tags") == ["a"]
+        g.remove_vertex_attribute(0, "tags")
+        assert h.get_vertex_attribute(0, "tags") == ["a"]
+        assert h.get_edge_attribute((0, 1), "color") == "red"
+        g.set_vertex_attribute(1, "pair", ([1], [1]))
+        g.set_vertex_attribute(2, "pair", g.get_vertex_attribute(1, "pair"))
+        h = g.freeze() if not static else g.thaw()
+        assert h.get_vertex_attribute(1, "pair") == ([1], [1])
+        assert h.get_vertex_attribute(1, "pair") is not \
+            g.get_vertex_attribute(1, "pair")
+        # Values shared within a graph stay shared within its copy.
+        assert h.get_vertex_attribute(1, "pair") is \
+            h.get_vertex_attribute(2, "pair")
+        g.remove_vertex_attribute(1, "pair")
+        g.remove_vertex_attribute(2, "pair")
+
+        g.set_vertex_attribute(0, "tags", ["a"])
+        h = copy.deepcopy(g)
+        h.get_vertex_attribute(0, "tags").append("b")
+        assert g.get_vertex_attribute(0, "tags") == ["a"]
+
+    g = cg.IntGraph(3, sources=[0, 1], targets=[1, 2])
+    h = copy.copy(g)
+    h.add_edge(0, 2)
+    h.set_edge_weight(0, 1, 2.0)
+    assert not g.has_edge(0, 2) and g.get_edge_weight(0, 1) == 1.0
+
+
+def test_conversions():
+    """Tests converting graphs between backends.
+    """
+    for directed in [True, False]:
+        g = cg.graph(directed=directed, vertices=["a", "b", "c"])
+        g.add_edge("a", "b", 2.0)
+        g.add_edge("c", "c", 3.0)
+        g.set_edge_attribute(("a", "b"), "color", "red")
+        g.set_vertex_attribute("c", "size", 1)
+
+        frozen = g.freeze()
+        assert isinstance(frozen, cg.StaticGraph)
+        assert frozen.freeze() is frozen
+        thawed = frozen.thaw()
+        assert isinstance(thawed, cg.DynamicGraph)
+        for h in [frozen, thawed]:
+            assert h.equals(g, vertex_attrs=True, edge_attrs=True)
+            assert h.has_edge("b", "a") == (not directed)
+        frozen.set_edge_attribute(("a", "b"), "color", "blue")
+        assert g.get_edge_attribute(("a", "b"), "color") == "red"
+
+        int_graph = frozen.to_int_graph()
+        assert int_graph.directed == directed
+        assert int_graph.get_children(0).tolist() == [1]
+        assert int_graph.get_edge_weight(2, 2) == 3.0
+        for static in [True, False]:
+            h = int_graph.to_graph(static=static)
+            assert (h.to_sparse().toarray() == g.to_sparse().toarray()).all()
+
+
+def test_save_load():
+    """Tests saving graphs to and loading them from compressed archives.
+    """
+    for static in [True, False]:
+        for directed in [True, False]:
+            for compression in ['zlib', 'lz', None]:
+                g = cg.graph(static=static, directed=directed,
+                    vertices=['a', 'b', 'c', 'd', 'e', 'f'])
+                g.add_edges({('a', 'b', 2.5), ('a', 'c'), ('a', 'd'),
+                             ('a', 'e'), ('a', 'f', -1.0), ('b', 'c'),
+                             ('c', 'd', 0.0)})
+                if directed:
+                    g.add_edge('f', 'a')
+                g.set_vertex_attribute('a', key='key', val='val')
+                g.set_vertex_attribute('c', key=2, val=3)
+                g.set_vertex_attribute('d', key=2, val=b'\x00')
+                g.set_edge_attribute(('a', 'b'), key='key', val=1.5)
+                g.save('tmp.cyg', compression=compression)
+                loaded_g = cg.load_graph('tmp.cyg')
+                assert type(loaded_g) is type(g)
+                assert loaded_g.equals(g)
+                assert loaded_g.vertex_attributes == g.vertex_attributes
+                assert loaded_g.edge_attributes == g.edge_attributes
+
+                # Nested tuples and lists.
+                g.set_vertex_attribute('c', key=2, val=[1, ('x', [])])
+                g.save('tmp.cyg', compression=compression)
+                loaded_g = cg.load_graph('tmp.cyg')
+                os.remove('tmp.cyg')
+                assert loaded_g.vertex_attributes == g.vertex_attributes
+
+    # Labels of several types, which keep their types.
+    g = cg.graph(vertices=['a', 1, 2.5, b'b', None])
+    g.add_edge('a', 1)
+    g.save('tmp.cyg')
+    loaded_g = cg.load_graph('tmp.cyg')
+    assert [(v, type(v)) for v in loaded_g.vertices] == \
+        [(v, type(v)) for v in g.vertices]
+    assert loaded_g.equals(g)
+    g = cg.graph(vertices=[(0, 0), (0, 1), 'a'])
+    g.add_edge((0, 0), 'a')
+    g.save('tmp.cyg')
+    loaded_g = cg.load_graph('tmp.cyg')
+    assert loaded_g.vertices == [(0, 0), (0, 1), 'a']
+    assert loaded_g.equals(g)
+
+    # Values that cannot be stored.
+    g.set_vertex_attribute('a', key='key', val={1: 2})
+    with pytest.raises(TypeError):
+        g.save('tmp.cyg')
+    nested = []
+    nested.append(nested)
+    g.set_vertex_attribute('a', key='key', val=nested)
+    with pytest.raises(ValueError):
+        g.save('tmp.cyg')
+
+    # Lists spanning several blocks that reference each other.
+    g = cg.graph(static=True, directed=True, vertices=list(range(50)))
+    for u in range(50):
+        for v in range(u % 7, 50, 3):
+            g.add_edge(u, v, weight=float(v % 4))
+    g.save('tmp.cyg', compression='lz')
+    loaded_g = cg.load_graph('tmp.cyg')
+    assert loaded_g.equals(g)
+
+    with open('tmp.cyg', 'r+b') as f:
+        f.seek(40)
+        f.write(b'\xff' * 8)
+    with pytest.raises(ValueError):
+        cg.load_graph('tmp.cyg')
+    os.remove('tmp.cyg')
+
+    with pytest.raises(ValueError):
+        g.save('tmp.cyg', compression='bz2')
+
+
+def test_arrow():
+    """Tests exporting graphs to and importing them from Arrow tables.
+    """
+    for static in [True, False]:
+        for directed in [True, False]:
+            g = cg.graph(static=static, directed=directed,
+                vertices=['a', 'b', 'c', 'd'])
+            g.add_edges({('a', 'b', 2.0), ('c', 'b'), ('d', 'd', 0.5)})
+            g.set_edge_attribute(('a', 'b'), key='color', val='red')
+            g.set_edge_attribute(('c', 'b'), key='lanes', val=3)
+            g.set_vertex_attribute('a', key='x', val=1.5)
+            g.set_vertex_attribute('c', key='flag', val=True)
+
+            edges = g.to_arrow()
+            vertices = g.to_arrow('vertices')
+            assert len(edges) == 3
+            assert edges.names == ['source', 'target', 'weight', 'color',
+                                   'lanes']
+            assert vertices.names == ['id', 'label', 'x', 'flag']
+
+            for static_ in [True, False]:
+                loaded_g = cg.from_arrow(edges, vertices, directed=directed,
+                    static=static_)
+                assert loaded_g.equals(g)
+                assert loaded_g.vertex_attributes == g.vertex_attributes
+                assert loaded_g.get_edge_attribute(('a', 'b'), 'color') == 'red'
+                assert loaded_g.get_edge_attribute(('c', 'b'), 'lanes') == 3
+
+            # Without a vertex table, vertices are integers.
+            loaded_g = cg.from_arrow(edges, directed=directed)
+            assert loaded_g.vertices == [0, 1, 2, 3]
+            assert loaded_g.has_edge(0, 1)
+
+    g = cg.graph(vertices=[(0, 1)])
+    with pytest.raises(TypeError):
+        g.to_arrow('vertices')
+    with pytest.raises(ValueError):
+        g.to_arrow('faces')
+    with pytest.raises(ValueError):
+        cg.from_arrow(cg.graph(vertices=['a']).to_arrow('vertices'))
+    with pytest.raises(TypeError):
+        cg.from_arrow([1, 2])
+
+    # Both orders of an undirected pair are the same edge, and repeated
+    # edges are rejected.
+    pa = pytest.importorskip('pyarrow')
+    table = pa.record_batch({'source': [1, 2], 'target': [0, 1],
+                             'color': ['red', 'blue']})
+    g = cg.from_arrow(table)
+    assert g.get_edge_attribute((0, 1), 'color') == 'red'
+    assert g.get_edge_attribute((1, 0), 'color') == 'red'
+    assert len(g.edge_attributes) == 2
+    for sources, targets in [([0, 1], [1, 0]), ([0, 0], [1, 1])]:
+        table = pa.record_batch({'source': sources, 'target': targets})
+        with pytest.raises(ValueError):
+            cg.from_arrow(table)
+    table = pa.record_batch({'source': [0, 1], 'target': [1, 0]})
+    assert cg.from_arrow(table, directed=True).edges == \
+        {(0, 1, 1.0), (1, 0, 1.0)}
+
+
+def test_arrow_interoperability():
+    """Tests exchanging Arrow tables with pyarrow.
+    """
+    pa = pytest.importorskip('pyarrow')
+
+    g = cg.graph(directed=True, vertices=['a', 'b', 'c'])
+    g.add_edges({('a', 'b', 2.0), ('b', 'c')})
+    g.set_edge_attribute(('a', 'b'), key='color', val='red')
+    batch = pa.record_batch(g.to_arrow())
+    assert batch.to_pydict() == {'source': [0, 1], 'target': [1, 2],
+                                 'weight': [2.0, 1.0],
+                                 'color': ['red', None]}
+
+    batch = pa.record_batch({
+        'source': pa.array([0, 1, 2, 3], pa.int32()),
+        'target': pa.array([1, 2, 3, 0], pa.int32()),
+        'weight': pa.array([1.0, None, 3.0, 4.0]),
+        'name': pa.array(['w', None, 'y', 'z'])
+    }).slice(1, 2)
+    vertices = pa.record_batch({'id': [1, 0, 2, 3],
+                                'label': ['b', 'a', 'c', 'd']})
+    g = cg.from_arrow(batch, vertices, directed=True, static=True)
+    assert g.vertices == ['a', 'b', 'c', 'd']
+    assert g.edges == {('b', 'c', 1.0), ('c', 'd', 3.0)}
+    assert g.get_edge_attribute(('c', 'd'), 'name') == 'y'
+    with pytest.raises(KeyError):
+        g.get_edge_attribute(('b', 'c'), 'name')
+
+    # Producers may leave the null count of a table unknown (-1).
+    get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+    get_pointer.restype = ctypes.c_void_p
+    get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+
+    def unknown_null_count(table):
+        schema, array = table.__arrow_c_array__()
+        ctypes.c_int64.from_address(
+            get_pointer(array, b'arrow_array') + 8).value = -1
+        return schema, array
+
+    sources, targets = pa.array([0, 1]), pa.array([1, 2])
+    table = pa.StructArray.from_arrays([sources, targets],
+        names=['source', 'target'])
+    g = cg.from_arrow(unknown_null_count(table), directed=True)
+    assert g.edges == {(0, 1, 1.0), (1, 2, 1.0)}
+    table = pa.StructArray.from_arrays([sources, targets],
+        names=['source', 'target'], mask=pa.array([False, True]))
+    with pytest.raises(ValueError):
+        cg.from_arrow(unknown_null_count(table))
+
+
+def test_to_sparse():
+    """Tests exporting graphs as sparse matrices.
+    """
+    for static in [True, False]:
+        for directed in [True, False]:
+            g = cg.graph(static=static, directed=directed,
+                vertices=['a', 'b', 'c', 'd'])
+            g.add_edges({('a', 'b', 2.0), ('c', 'b'), ('c', 'c', 0.5)})
+
+            adjacency = np.zeros((4, 4))
+            adjacency[0, 1] = 2.0
+            adjacency[2, 1] = 1.0
+            adjacency[2, 2] = 0.5
+            if not directed:
+                adjacency = np.maximum(adjacency, adjacency.T)
+            matrix = g.to_sparse()
+            assert matrix.shape == (4, 4)
+            if directed:
+                assert matrix.indptr.tolist() == [0, 1, 1, 3, 3]
+            else:
+                assert matrix.indptr.tolist() == [0, 1, 3, 5, 5]
+            assert (matrix.toarray() == adjacency).all()
+            assert g.adjacency_list == \
+                [list(np.flatnonzero(row)) for row in adjacency]
+
+            degrees = adjacency.sum(axis=1)
+            laplacian = g.to_sparse('laplacian', dtype=np.float32)
+            assert laplacian.data.dtype == np.float32
+            assert (laplacian.toarray() == np.diag(degrees) - adjacency).all()
+
+            incidence = g.to_sparse('incidence').toarray()
+            if directed:
+                # The self-loop has no column.
+                assert incidence.T.tolist() == [[-1, 1, 0, 0], [0, 1, -1, 0]]
+            else:
+                assert incidence.T.tolist() == \
+                    [[1, 1, 0, 0], [0, 1, 1, 0], [0, 0, 1, 0]]
+
+    g = cg.graph(vertices=['a', 'b', 'c'])
+    g.add_edge('a', 'b', 4.0)
+    expected = np.array([[1.0, -1.0, 0.0], [-1.0, 1.0, 0.0], [0.0, 0.0, 0.0]])
+    assert np.allclose(g.to_sparse('normalized_laplacian').toarray(),
+                       expected)
+    with pytest.raises(ValueError):
+        g.to_sparse('laplacien')
+    with pytest.raises(NotImplementedError):
+        cg.graph(directed=True).to_sparse('normalized_laplacian')
+
+
+def test_build_csr():
+    """Tests building sparse matrices from unsorted entries.
+    """
+    sources = [2, 0, 2, 1, 2]
+    targets = [1, 1, 0, 2, 1]
+    weights = [1.0, 2.0, 3.0, 4.0, 5.0]
+    for combine, expected in [('sum', 6.0), ('min', 1.0), ('max', 5.0),
+                              ('first', 1.0), ('last', 5.0)]:
+        matrix = cg.build_csr(sources, targets, weights, combine=combine)
+        assert matrix.shape == (3, 3)
+        assert matrix.indptr.tolist() == [0, 1, 2, 4]
+        assert matrix.indices.tolist() == [1, 2, 0, 1]
+        assert matrix.data.tolist() == [2.0, 4.0, 3.0, expected]
+
+    matrix = cg.build_csr(sources, targets, combine=None, shape=(4, 3))
+    assert matrix.indptr.tolist() == [0, 1, 2, 5, 5]
+    assert matrix.indices.tolist() == [1, 2, 0, 1, 1]
+
+    matrix = cg.build_csr([0, 1, 1], [1, 1, 2], symmetrize=True)
+    assert matrix.toarray().tolist() == \
+        [[0.0, 1.0, 0.0], [1.0, 1.0, 1.0], [0.0, 1.0, 0.0]]
+
+    # Enough entries to be split between threads.
+    rng = np.random.default_rng(0)
+    sources, targets = rng.integers(0, 100, (2, 100000))
+    weights = rng.random(100000)
+    expected = np.zeros((100, 100))
+    np.add.at(expected, (sources, targets), weights)
+    matrix = cg.build_csr(sources, targets, weights)
+    assert np.allclose(matrix.toarray(), expected)
+    for i in range(100):
+        row = matrix.indices[matrix.indptr[i]:matrix.indptr[i + 1]]
+        assert (np.diff(row) > 0).all()
+
+    with pytest.raises(ValueError):
+        cg.build_csr([0, 1], [0])
+    with pytest.raises(ValueError):
+        cg.build_csr([0, 3], [0, 1], shape=(3, 3))
+    with pytest.raises(ValueError):
+        cg.build_csr([0], [0], combine='mean')
+
+    # Column indices are 32-bit unless there are too many columns.
+    assert cg.build_csr([0], [1]).indices.dtype == np.int32
+    assert cg.build_csr([0], [1], index_dtype=np.int64).indices.dtype == \
+        np.int64
+    matrix = cg.build_csr([0, 0], [2**31, 5], shape=(1, 2**31 + 1))
+    assert matrix.indices.dtype == np.int64
+    assert matrix.indices.tolist() == [5, 2**31]
+    with pytest.raises(ValueError):
+        cg.build_csr([0], [1], shape=(1, 2**31 + 1), index_dtype=np.int32)
+
+
+def test_int_graph():
+    """Tests cygraph.IntGraph.
+    """
+    for directed in [True, False]:
+        g = cg.IntGraph(4, directed=directed, sources=np.array([0, 1, 2]),
+                        targets=np.array([1, 2, 3]),
+                        weights=np.array([1.0, 2.0, 3.0]))
+        g.add_edge(3, 3, 0.5)
+        assert len(g) == 4
+        assert g.number_of_edges == 4
+        assert g.get_children(1).tolist() == ([2] if directed else [0, 2])
+        assert g.get_parents(1).tolist() == ([0] if directed else [0, 2])
+        assert g.has_edge(2, 1) == (not directed)
+        assert g.has_edges([0, 1, 0], [1, 0, 3]).tolist() == \
+            [True, not directed, False]
+        assert g.get_edge_weights([2, 3], [3, 3]).tolist() == [3.0, 0.5]
+        with pytest.raises(ValueError):
+            g.get_children(1)[0] = 3
+        with pytest.raises(ValueError):
+            g.add_edge(0, 1)
+        with pytest.raises(ValueError):
+            g.add_edges([0, 0], [2, 2])
+        with pytest.raises(ValueError):
+            g.has_edge(0, 4)
+        with pytest.raises(TypeError):
+            g.has_edges([0.5], [1])
+
+        g.set_edge_weight(1, 2, 5.0)
+        g.remove_edges([0, 3], [1, 3])
+        assert g.add_vertex() == 4
+        g.add_edge(4, 0)
+        sources, targets, weights = g.edges
+        if directed:
+            assert sources.tolist() == [1, 2, 4]
+            assert targets.tolist() == [2, 3, 0]
+            assert weights.tolist() == [5.0, 3.0, 1.0]
+        else:
+            assert sources.tolist() == [0, 1, 2]
+            assert targets.tolist() == [4, 2, 3]
+            assert weights.tolist() == [1.0, 5.0, 3.0]
+        assert g.get_edge_weight(1, 2) == 5.0
+        assert g.in_degrees.tolist() == \
+            ([1, 0, 1, 1, 0] if directed else [1, 1, 2, 1, 1])
+
+        h = g.to_graph(static=True)
+        assert h.vertices == [0, 1, 2, 3, 4]
+        assert h.has_edge(4, 0) and h.get_edge_weight(1, 2) == 5.0
+        assert (g.to_sparse().toarray() == h.to_sparse().toarray()).all()
+        assert pickle.loads(pickle.dumps(g)).edges[1].tolist() == \
+            targets.tolist()
+
+    for index_dtype in [np.int32, np.int64]:
+        g = cg.IntGraph(3, directed=True, sources=[0, 1], targets=[1, 2],
+                        index_dtype=index_dtype)
+        assert g.get_children(0).dtype == index_dtype
+        assert g.get_parents(2).tolist() == [1]
+        assert g.has_edges([0, 2], [1, 0]).tolist() == [True, False]
+
+
+def test_graph_builder():
+    """Tests cygraph.GraphBuilder.
+    """
+    for directed in [True, False]:
+        builder = cg.GraphBuilder(directed=directed, vertices=["a"])
+        builder.add_edges([("a", "b"), ("b", "c", 2.0)])
+        builder.add_edges({"source": ["c", "d"], "target": ["a", "d"],
+                           "weight": [3.0, 4.0], "color": ["red", "blue"]})
+        builder.add_vertices(["e", "a"], {"size": [1, 2]})
+        builder.add_edge_arrays(np.array([4]), np.array([0]))
+        assert builder.vertices == ["a", "b", "c", "d", "e"]
+        assert builder.number_of_edges == 5
+        with pytest.raises(ValueError):
+            builder.add_edge_arrays([0], [5])
+        with pytest.raises(TypeError):
+            builder.add_edge_arrays([0.5], [1.0])
+        with pytest.raises(ValueError):
+            builder.finalize(backend="temporal")
+        with pytest.raises(ValueError):
+            builder.finalize(backend="int")
+
+        for backend in ["static", "dynamic"]:
+            g = builder.finalize(backend=backend)
+            assert isinstance(g, cg.StaticGraph if backend == "static"
+                              else cg.DynamicGraph)
+            assert g.directed == directed
+            assert g.vertices == builder.vertices
+            assert g.has_edge("e", "a")
+            assert g.has_edge("a", "c") == (not directed)
+            assert g.get_edge_weight("c", "a") == 3.0
+            assert g.get_edge_weight("d", "d") == 4.0
+            assert g.get_edge_attribute(("c", "a"), "color") == "red"
+            assert g.get_vertex_attribute("a", "size") == 2
+            assert g.vertex_attributes["b"] == {}
+
+        builder.add_edge("a", "c", 5.0, {"color": "green"})
+        if directed:
+            assert builder.finalize().get_edge_weight("a", "c") == 5.0
+        else:
+            with pytest.raises(ValueError):
+                builder.finalize()
+            g = builder.finalize(combine="sum")
+            assert g.get_edge_weight("a", "c") == 8.0
+            assert g.get_edge_attribute(("a", "c"), "color") == "green"
+
+    builder = cg.GraphBuilder(directed=True)
+    builder.add_vertices(range(4))
+    builder.add_edge_arrays([0, 1, 2], [1, 2, 3], [1.0, 2.0, 3.0])
+    g = builder.finalize(backend="int")
+    assert isinstance(g, cg.IntGraph)
+    assert g.get_children(1).tolist() == [2]
+    assert g.get_edge_weight(2, 3) == 3.0
+
+    g = cg.graph(vertices=list(range(3)), adjacency_list=[[1, 2], [0], [0]],
+                 static=True)
+    assert g.has_edge(0, 2) and not g.has_edge(1, 2)
+
+
+def test_graph_batch():
+    """Tests packing graphs into a cygraph.GraphBatch.
+    """
+    for directed in [True, False]:
+        g = cg.graph(directed=directed, vertices=["a", "b", "c"])
+        g.add_edges({("a", "b", 2.0), ("c", "c")})
+        h = cg.IntGraph(2, directed=directed)
+        h.add_edge(1, 0, 3.0)
+        batch = cg.GraphBatch([g, cg.graph(directed=directed), h])
+        assert len(batch) == 3
+        assert batch.directed == directed
+        assert batch.number_of_vertices == 5
+        assert batch.vertex_offsets.tolist() == [0, 3, 3, 5]
+        assert batch.vertex_counts.tolist() == [3, 0, 2]
+        assert batch.edge_counts.tolist() == [2, 0, 1]
+        assert batch.graph_ids.tolist() == [0, 0, 0, 2, 2]
+        with pytest.raises(ValueError):
+            batch.vertex_offsets[0] = 1
+
+        member = batch[-1]
+        assert isinstance(member, cg.IntGraph)
+        assert member.get_edge_weight(1, 0) == 3.0
+        assert member.has_edge(0, 1) == (not directed)
+        assert batch[0].get_edge_weight(0, 1) == 2.0
+        assert [len(m.vertices) for m in batch] == [3, 0, 2]
+        with pytest.raises(IndexError):
+            batch[3]
+
+        same = cg.GraphBatch.from_edges([3, 0, 2], [2, 0, 1], [0, 2, 1],
+                                        [1, 2, 0], [2.0, 1.0, 3.0],
+                                        directed=directed)
+        copied = pickle.loads(pickle.dumps(batch))
+        for other in [same, copied]:
+            assert other.vertex_offsets.tolist() == [0, 3, 3, 5]
+            assert other.edge_counts.tolist() == [2, 0, 1]
+            for i in range(3):
+                assert (other[i].to_graph().to_sparse().toarray()
+                        == batch[i].to_graph().to_sparse().toarray()).all()
+
+    with pytest.raises(ValueError):
+        cg.GraphBatch([cg.graph(directed=True), cg.graph()])
+    with pytest.raises(TypeError):
+        cg.GraphBatch([[(0, 1)]])
+    with pytest.raises(ValueError):
+        cg.GraphBatch.from_edges([2], [1], [0], [2])
+    with pytest.raises(ValueError):
+        cg.GraphBatch.from_edges([2], [2], [0, 1], [1, 0])
+    assert cg.GraphBatch.from_edges([2], [2], [0, 1], [1, 0],
+                                    directed=True).edge_counts.tolist() == [2]
+
+
+def test_temporal_graph():
+    """Tests TemporalGraph contact storage, windowed queries and
+    snapshots.
+    """
+    for directed in [True, False]:
+        g = cg.TemporalGraph(directed=directed, vertices=['a', 'b', 'c'])
+        g.add_edges([('a', 'b', 3.0), ('a', 'c', 1.0, 2.0), ('a', 'b', 2.0)])
+        g.add_edge('c', 'c', 4.0)
+        assert g.number_of_contacts == 4
+        assert g.edges == [('a', 'c', 1.0, 2.0), ('a', 'b', 2.0, 1.0),
+                           ('a', 'b', 3.0, 1.0), ('c', 'c', 4.0, 1.0)]
+
+        # Windows are half-open.
+        assert g.get_contacts('a') == [('c', 1.0, 2.0), ('b', 2.0, 1.0),
+                                       ('b', 3.0, 1.0)]
+        assert g.get_contacts('a', start=2.0, end=3.0) == [('b', 2.0, 1.0)]
+        assert g.get_children('a', end=2.0) == {'c'}
+        assert g.get_parents('b', start=2.5) == {'a'}
+        if directed:
+            assert g.get_children('b') == set()
+        else:
+            assert g.get_children('b') == {'a'}
+
+        # Contacts added after a query are merged in.
+        g.add_vertex('d')
+        g.add_edge('d', 'a', 0.0)
+        assert g.get_parents('a') == ({'d'} if directed else {'b', 'c', 'd'})
+
+        snapshot = g.snapshot(1.0, 3.0)
+        assert snapshot.is_view
+        assert snapshot.edges == [('a', 'c', 1.0, 2.0), ('a', 'b', 2.0, 1.0)]
+        assert snapshot.get_contacts('a', start=0.0) == \
+            [('c', 1.0, 2.0), ('b', 2.0, 1.0)]
+        assert snapshot.snapshot(2.0, 10.0).edges == [('a', 'b', 2.0, 1.0)]
+        g.add_edge('a', 'b', 1.5)
+        assert snapshot.number_of_contacts == 2
+        with pytest.raises(ValueError):
+            snapshot.add_edge('a', 'b', 1.0)
+        with pytest.raises(ValueError):
+            g.snapshot(2.0, 1.0)
+
+        aggregated = g.to_graph()
+        assert aggregated.directed == directed
+        assert aggregated.get_edge_weight('a', 'b') == 3.0
+        assert aggregated.get_edge_weight('a', 'c') == 2.0
+        assert snapshot.to_graph(static=True).edges == \
+            {('a', 'b', 1.0), ('a', 'c', 2.0)}
+
+        with pytest.raises(ValueError):
+            g.add_edge('a', 'e', 1.0)
+        with pytest.raises(ValueError):
+            g.add_edge('a', 'b', float('nan'))
+        with pytest.raises(ValueError):
+            g.add_vertex('a')
+
+
+def test_streaming_graph():
+    """Tests StreamingGraph edge expiration and the degree, component
+    and triangle counts maintained over it.
+    """
+    for directed in [True, False]:
+        g = cg.StreamingGraph(10.0, directed=directed, vertices=['z'],
+                              track_components=True, track_triangles=True)
+        g.add_edges([('a', 'b', 0.0), ('b', 'c', 4.0), ('c', 'a', 8.0, 2.0)])
+        assert g.vertices == ['z', 'a', 'b', 'c']
+        assert g.number_of_edges == 3
+        assert g.triangles == 1
+        assert g.get_triangles('a') == 1
+        assert g.number_of_components == 2
+        assert g.are_connected('a', 'c')
+        assert not g.are_connected('a', 'z')
+        assert g.get_degree('a') == 2
+        if directed:
+            assert g.get_children('a') == {'b'}
+            assert g.get_parents('a') == {'c'}
+            assert g.get_out_degree('a') == g.get_in_degree('a') == 1
+            assert not g.has_edge('b', 'a')
+        else:
+            assert g.get_children('a') == {'b', 'c'}
+            assert g.get_out_degree('a') == 2
+            assert g.has_edge('b', 'a')
+
+        # A repeated edge keeps the pair adjacent after the first expires.
+        g.add_edge('b', 'a', 9.0)
+        assert g.advance(10.0) == 1
+        assert g.edges == [('b', 'c', 4.0, 1.0), ('c', 'a', 8.0, 2.0),
+                           ('b', 'a', 9.0, 1.0)]
+        assert g.triangles == 1
+
+        assert g.advance(14.0) == 1
+        assert g.triangles == 0
+        assert g.get_triangles('a') == 0
+        assert g.get_degree('c') == 1
+        assert g.are_connected('b', 'c')
+        assert g.number_of_components == 2
+        aggregated = g.to_graph(static=True)
+        assert aggregated.get_edge_weight('c', 'a') == 2.0
+        assert aggregated.get_edge_weight('b', 'a') == 1.0
+        assert not aggregated.has_edge('b', 'c')
+
+        # Edges must arrive in time order.
+        with pytest.raises(ValueError):
+            g.add_edge('a', 'b', 13.0)
+        with pytest.raises(ValueError):
+            g.add_edges([('a', 'b', 20.0), ('a', 'b', 15.0)])
+        assert g.now == 14.0
+        assert g.advance(100.0) == 2
+        assert g.number_of_edges == 0
+        assert g.number_of_components == 4
+
+    g = cg.StreamingGraph(1.0)
+    # Enough edges to grow the ring.
+    g.add_edges([(i, i + 1, i / 100) for i in range(100)])
+    assert g.number_of_edges == 100
+    g.add_edge(0, 1, 1.5)
+    assert g.number_of_edges == 50
+    assert g.edges[0] == (51, 52, 0.51, 1.0)
+    with pytest.raises(ValueError):
+        g.triangles
+    with pytest.raises(ValueError):
+        g.are_connected(0, 1)
+    with pytest.raises(ValueError):
+        cg.StreamingGraph(0.0)
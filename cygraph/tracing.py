@@ -0,0 +1,270 @@
+"""An opt-in tracer recording when graph operations and the phases of
+algorithms begin and end, on every thread and worker process, for
+viewing as a timeline in chrome://tracing or Perfetto.
+
+Examples
+--------
+>>> import cygraph.tracing
+>>> G = cg.graph(vertices=list(range(3)))
+>>> with cygraph.tracing.trace("trace.json"):
+...     frozen = G.freeze()
+...     components = alg.get_number_connected_components(frozen)
+
+Each thread appends events to its own buffer, so recording takes no
+lock. While tracing is off, spans cost a function call.
+"""
+
+from contextlib import contextmanager
+from functools import wraps
+import json
+import os
+import threading
+from time import perf_counter
+
+
+_enabled = False
+# The buffers of all threads that recorded events, and that of the
+# current thread.
+_buffers = []
+_local = threading.local()
+
+
+class _Span:
+    """Records a begin event on entry and an end event on exit.
+    """
+
+    __slots__ = ("name", "category", "args")
+
+    def __init__(self, name, category, args):
+        self.name = name
+        self.category = category
+        self.args = args
+
+    def __enter__(self):
+        _append("B", self.name, self.category, perf_counter(), self.args)
+        return self
+
+    def __exit__(self, *exc_info):
+        _append("E", self.name, self.category, perf_counter(), None)
+        return False
+
+
+class _NullSpan:
+    """Does nothing, for spans opened while tracing is off.
+    """
+
+    __slots__ = ()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        return False
+
+
+_NULL_SPAN = _NullSpan()
+
+
+def start():
+    """Starts recording events.
+    """
+    global _enabled
+    _enabled = True
+
+
+def stop():
+    """Stops recording events, keeping those recorded so far.
+    """
+    global _enabled
+    _enabled = False
+
+
+def is_enabled():
+    """Returns whether events are being recorded.
+
+    Returns
+    -------
+    bool
+        Whether tracing is on.
+    """
+    return _enabled
+
+
+def clear():
+    """Discards the events recorded so far.
+    """
+    for buffer in list(_buffers):
+        buffer.clear()
+
+
+def span(name, category="cygraph", **args):
+    """Returns a context manager recording the begin and end of an
+    operation on the current thread, if tracing is on.
+
+    Parameters
+    ----------
+    name: str
+        The name of the operation.
+    category: str, optional
+        The kind of operation, such as "graph", "algorithm" or "phase".
+    **args
+        Values to show with the operation, which must be serializable to
+        JSON.
+
+    Returns
+    -------
+    context manager
+        The span.
+    """
+    if not _enabled:
+        return _NULL_SPAN
+    return _Span(name, category, args or None)
+
+
+def traced(name, category="cygraph"):
+    """Returns a decorator making a function record each of its calls
+    as a span, for functions whose bodies cannot be put in a with
+    statement, such as those declaring C variables.
+
+    Parameters
+    ----------
+    name: str
+        The name of the operation.
+    category: str, optional
+        The kind of operation.
+
+    Returns
+    -------
+    callable
+        The decorator.
+    """
+    def decorator(function):
+        @wraps(function)
+        def traced_function(*args, **kwargs):
+            if not _enabled:
+                return function(*args, **kwargs)
+            with _Span(name, category, None):
+                return function(*args, **kwargs)
+        return traced_function
+    return decorator
+
+
+def record(name, category, start, end, **args):
+    """Records an operation that has already ended, if tracing is on.
+
+    Parameters
+    ----------
+    name: str
+        The name of the operation.
+    category: str
+        The kind of operation.
+    start, end: float
+        When the operation began and ended, as given by
+        time.perf_counter.
+    **args
+        Values to show with the operation.
+    """
+    if _enabled:
+        _append("B", name, category, start, args or None)
+        _append("E", name, category, end, None)
+
+
+def events():
+    """Returns the events recorded so far, in Chrome trace event format,
+    sorted by time.
+
+    Returns
+    -------
+    list
+        Dictionaries with the phase ("B" or "E"), name, category,
+        timestamp in microseconds, process id and thread id of each
+        event.
+    """
+    merged = [event for buffer in list(_buffers) for event in list(buffer)]
+    merged.sort(key=lambda event: event[3])
+    result = []
+    for phase, name, category, timestamp, pid, tid, args in merged:
+        event = {"ph": phase, "name": name, "cat": category,
+                 "ts": timestamp * 1e6, "pid": pid, "tid": tid}
+        if args:
+            event["args"] = args
+        result.append(event)
+    return result
+
+
+def dump(path):
+    """Writes the events recorded so far to a file in Chrome trace JSON
+    format, which chrome://tracing and Perfetto open.
+
+    Parameters
+    ----------
+    path: str or os.PathLike
+        The path of the file.
+    """
+    with open(path, "w") as f:
+        json.dump({"traceEvents": events(), "displayTimeUnit": "ms"}, f)
+
+
+@contextmanager
+def trace(path=None):
+    """Records the events of a block of code, discarding older ones.
+
+    Parameters
+    ----------
+    path: str or os.PathLike, optional
+        A file to write the events to, as by dump, once the block ends.
+    """
+    clear()
+    start()
+    try:
+        yield
+    finally:
+        stop()
+        if path is not None:
+            dump(path)
+
+
+def _buffer():
+    """Returns the buffer of the current thread.
+    """
+    try:
+        return _local.buffer
+    except AttributeError:
+        _local.buffer = []
+        # Appending is atomic, so threads register without a lock.
+        _buffers.append(_local.buffer)
+        return _local.buffer
+
+
+def _append(phase, name, category, timestamp, args):
+    """Adds an event to the buffer of the current thread.
+    """
+    _buffer().append((phase, name, category, timestamp, os.getpid(),
+                      threading.get_native_id(), args))
+
+
+def _take_events():
+    """Removes and returns the raw events of all threads, for a forked
+    worker to send to the process that forked it.
+    """
+    taken = [event for buffer in list(_buffers) for event in buffer]
+    clear()
+    return taken
+
+
+def _add_events(raw_events):
+    """Adds raw events received from a forked worker.
+    """
+    _buffer().extend(raw_events)
+
+
+def _forget_events():
+    """Drops the buffers inherited by a forked process, which belong to
+    the process that forked it.
+    """
+    global _buffers, _local
+    _buffers = []
+    _local = threading.local()
+
+
+os.register_at_fork(after_in_child=_forget_events)
@@ -1,4 +1,6 @@
-from setuptools import setup
+import os
+
+from setuptools import Extension, setup
 
 import numpy as np
 from Cython.Build import cythonize
@@ -7,6 +9,12 @@ from Cython.Build import cythonize
 with open('README.md', 'r') as f:
     long_description = f.read()
 
+# Building with CYGRAPH_STATS=1 compiles in the counters reported by
+# cygraph.algorithms.ExecutionStats, which the default build leaves out.
+define_macros = []
+if os.environ.get('CYGRAPH_STATS', '0') not in ('', '0'):
+    define_macros.append(('CYGRAPH_STATS', '1'))
+
 
 setup(
     name='cygraph',
@@ -18,9 +26,10 @@ setup(
     long_description_content_type='text/markdown',
     url='https://github.com/lol-cubes/cygraph',
     packages=['cygraph', 'cygraph/algorithms', 'cygraph/graph_'],
-    ext_modules=cythonize(
-        ['cygraph/algorithms/*.pyx', 'cygraph/graph_/*.pyx']
-    ),
+    ext_modules=cythonize([
+        Extension('*', [pattern], define_macros=define_macros)
+        for pattern in ['cygraph/algorithms/*.pyx', 'cygraph/graph_/*.pyx']
+    ]),
     include_dirs=[np.get_include()],
     install_requires=['numpy>=1.19.0'],
     package_data={